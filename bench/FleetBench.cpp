@@ -0,0 +1,269 @@
+// Fleet aggregator cost with many agents streaming over loopback (--fleet).
+//
+// Usage: sysmon_fleet_bench [agents] [seconds] [cores] [port]
+//   agents   Simulated --agent connections (default: 1000)
+//   seconds  Measured run time; every agent updates once a second (default: 10)
+//   cores    Logical CPUs per simulated host (default: 64)
+//   port     Loopback port for the aggregator (default: 47810)
+//
+// Agents are simulated by a few sender threads speaking the real protocol,
+// each agent's update spread evenly over the second as real hosts would be.
+// A consumer thread copies and sorts the host table on every publish, like
+// the fleet view does. The figure of interest is the CPU used by everything
+// but the senders (aggregator plus consumer) as a share of one core; the
+// run also checks that every agent's every update arrived.
+
+#include "FleetAggregator.h"
+#include "TcpSocket.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace sysmon;
+
+namespace {
+    constexpr size_t SENDER_THREADS = 4;
+    constexpr size_t TOP_PROCESSES = 10;
+    
+    struct SimulatedAgent {
+        int fd{-1};
+        SystemMetrics metrics;
+        SystemMetrics sentMetrics;
+        std::vector<ProcessSummary> processes;
+        std::vector<ProcessSummary> sentProcesses;
+        recording::ProcessDeltaScratch scratch;
+        std::string outbox;
+    };
+    
+    bool sendAll(int fd, const std::string& bytes) {
+        size_t offset = 0;
+        while (offset < bytes.size()) {
+            ssize_t sent = send(fd, bytes.data() + offset, bytes.size() - offset, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+            offset += static_cast<size_t>(sent);
+        }
+        return true;
+    }
+    
+    void step(SimulatedAgent& agent, std::mt19937& random, uint64_t nowMs) {
+        std::uniform_real_distribution<double> jitter(-5.0, 5.0);
+        auto clamp = [](double value) { return std::clamp(value, 0.0, 100.0); };
+        
+        SystemMetrics& m = agent.metrics;
+        m.timestampMs = nowMs;
+        for (auto& core : m.perCoreCpuUsage) {
+            core = clamp(core + jitter(random));
+        }
+        m.cpuUsagePercent = clamp(m.cpuUsagePercent + jitter(random));
+        m.usedMemoryBytes = std::min(m.totalMemoryBytes,
+                                     m.usedMemoryBytes + static_cast<uint64_t>(random() % (1 << 20)));
+        m.memoryUsagePercent = 100.0 * static_cast<double>(m.usedMemoryBytes) / static_cast<double>(m.totalMemoryBytes);
+        m.diskReadBytesPerSec = random() % (50u << 20);
+        m.diskWriteBytesPerSec = random() % (50u << 20);
+        m.networkRecvBytesPerSec = random() % (10u << 20);
+        m.networkSendBytesPerSec = random() % (10u << 20);
+        
+        for (auto& proc : agent.processes) {
+            proc.cpuPercent = std::max(0.0, proc.cpuPercent + jitter(random));
+            proc.memoryBytes += random() % 4096;
+        }
+        // Now and then a different process makes the top list
+        if (random() % 10 == 0) {
+            agent.processes[random() % agent.processes.size()].pid += 100000;
+            std::sort(agent.processes.begin(), agent.processes.end(),
+                      [](const ProcessSummary& a, const ProcessSummary& b) { return a.pid < b.pid; });
+        }
+    }
+    
+    bool sendUpdate(SimulatedAgent& agent) {
+        agent.outbox.clear();
+        stream::appendMetricsFrame(agent.sentMetrics, agent.metrics, agent.outbox);
+        stream::appendProcessFrame(agent.sentProcesses, agent.processes, agent.outbox, agent.scratch);
+        agent.sentMetrics = agent.metrics;
+        agent.sentProcesses = agent.processes;
+        return sendAll(agent.fd, agent.outbox);
+    }
+    
+    double threadCpuSeconds() {
+        timespec time{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+        return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) / 1e9;
+    }
+    
+    double processCpuSeconds() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        auto seconds = [](const timeval& t) { return static_cast<double>(t.tv_sec) + static_cast<double>(t.tv_usec) / 1e6; };
+        return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t agents = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    size_t seconds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10;
+    size_t cores = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 64;
+    std::string port = argc > 4 ? argv[4] : "47810";
+    const std::string address = "127.0.0.1:" + port;
+    
+    // Both ends of every connection live in this process
+    rlimit files{};
+    getrlimit(RLIMIT_NOFILE, &files);
+    files.rlim_cur = files.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &files);
+    if (files.rlim_cur < 2 * agents + 64) {
+        std::cerr << "Open file limit " << files.rlim_cur << " is too low for " << agents << " agents\n";
+        return 1;
+    }
+    
+    FleetAggregator aggregator;
+    if (!aggregator.start(address)) {
+        return 1;
+    }
+    
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> publishes{0};
+    std::atomic<bool> tableReady{false};
+    std::thread consumer([&] {
+        std::vector<FleetHost> hosts;
+        uint64_t seen = 0;
+        while (!stop) {
+            uint64_t version = aggregator.getVersion();
+            if (version == seen) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            seen = version;
+            aggregator.getHosts(hosts);
+            std::sort(hosts.begin(), hosts.end(), [](const FleetHost& a, const FleetHost& b) {
+                return a.metrics.cpuUsagePercent > b.metrics.cpuUsagePercent;
+            });
+            publishes.fetch_add(1, std::memory_order_relaxed);
+            tableReady = true;
+        }
+    });
+    
+    std::vector<SimulatedAgent> fleet(agents);
+    for (size_t i = 0; i < agents; ++i) {
+        SimulatedAgent& agent = fleet[i];
+        std::string error;
+        agent.fd = net::connectTcp(address, 5, error);
+        if (agent.fd < 0) {
+            std::cerr << "Agent " << i << " cannot connect: " << error << "\n";
+            return 1;
+        }
+        agent.outbox.clear();
+        stream::appendAgentHelloFrame(agent.outbox, "host-" + std::to_string(i));
+        sendAll(agent.fd, agent.outbox);
+        
+        agent.metrics.perCoreCpuUsage.assign(cores, 20.0);
+        agent.metrics.totalMemoryBytes = 256ull << 30;
+        agent.metrics.usedMemoryBytes = 64ull << 30;
+        agent.processes.resize(TOP_PROCESSES);
+        for (size_t p = 0; p < TOP_PROCESSES; ++p) {
+            agent.processes[p].pid = static_cast<uint32_t>(1000 + p * 37);
+            agent.processes[p].parentPid = 1;
+            agent.processes[p].name = "worker-" + std::to_string(p);
+            agent.processes[p].cpuPercent = 10.0 * static_cast<double>(p);
+            agent.processes[p].memoryBytes = (p + 1) << 28;
+        }
+    }
+    
+    // One warm-up second plus the measured ones
+    const size_t rounds = seconds + 1;
+    auto begin = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    std::atomic<size_t> failedSends{0};
+    std::vector<double> senderCpu(SENDER_THREADS, 0.0);
+    std::vector<std::thread> senders;
+    for (size_t t = 0; t < SENDER_THREADS; ++t) {
+        senders.emplace_back([&, t] {
+            std::mt19937 random(static_cast<uint32_t>(t + 1));
+            double warmedUp = 0.0;
+            for (size_t round = 0; round < rounds; ++round) {
+                if (round == 1) {
+                    warmedUp = threadCpuSeconds();
+                }
+                for (size_t i = t; i < agents; i += SENDER_THREADS) {
+                    auto due = begin + std::chrono::seconds(round) +
+                               std::chrono::microseconds(1000000 * i / agents);
+                    std::this_thread::sleep_until(due);
+                    uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::system_clock::now().time_since_epoch()).count());
+                    step(fleet[i], random, nowMs);
+                    if (!sendUpdate(fleet[i])) {
+                        failedSends.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+            senderCpu[t] = threadCpuSeconds() - warmedUp;
+        });
+    }
+    
+    std::this_thread::sleep_until(begin + std::chrono::seconds(1));
+    double cpuStart = processCpuSeconds();
+    uint64_t bytesStart = aggregator.bytesReceived();
+    uint64_t framesStart = aggregator.framesReceived();
+    auto wallStart = std::chrono::steady_clock::now();
+    
+    std::this_thread::sleep_until(begin + std::chrono::seconds(rounds));
+    double cpuEnd = processCpuSeconds();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    uint64_t bytes = aggregator.bytesReceived() - bytesStart;
+    uint64_t frames = aggregator.framesReceived() - framesStart;
+    
+    double sendersCpu = 0.0;
+    for (size_t t = 0; t < SENDER_THREADS; ++t) {
+        senders[t].join();
+        sendersCpu += senderCpu[t];
+    }
+    // Let the last frames and the final publish land
+    std::this_thread::sleep_for(FleetAggregator::PUBLISH_INTERVAL * 3);
+    
+    std::vector<FleetHost> hosts;
+    aggregator.getHosts(hosts);
+    size_t online = 0;
+    size_t complete = 0;
+    for (const auto& host : hosts) {
+        online += host.online();
+        complete += host.updates == rounds;
+    }
+    FleetHost sample;
+    bool haveSample = aggregator.getHost("host-0", sample);
+    
+    stop = true;
+    consumer.join();
+    for (auto& agent : fleet) {
+        close(agent.fd);
+    }
+    aggregator.stop();
+    
+    double aggregatorCpu = (cpuEnd - cpuStart) - sendersCpu;
+    std::printf("%zu agents x %zu cores, %zu top processes, %.1f s measured\n",
+                agents, cores, TOP_PROCESSES, wall);
+    std::printf("received      %.0f frames/s, %.1f KiB/s (%.0f B per host update)\n",
+                static_cast<double>(frames) / wall, static_cast<double>(bytes) / wall / 1024.0,
+                frames ? 2.0 * static_cast<double>(bytes) / static_cast<double>(frames) : 0.0);
+    std::printf("aggregator    %.1f%% of one core (incl. consumer, %llu table copies)\n",
+                100.0 * aggregatorCpu / wall, static_cast<unsigned long long>(publishes.load()));
+    std::printf("senders       %.1f%% of one core\n", 100.0 * sendersCpu / wall);
+    std::printf("hosts         %zu known, %zu online, %zu with all %zu updates, %zu failed sends\n",
+                hosts.size(), online, complete, rounds, failedSends.load());
+    
+    bool ok = hosts.size() == agents && complete == agents && failedSends == 0 && tableReady &&
+              haveSample && sample.topProcesses.size() == TOP_PROCESSES &&
+              sample.metrics.perCoreCpuUsage.size() == cores;
+    std::printf("%s\n", ok ? "OK" : "MISMATCH");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Head-to-head comparison of synchronous vs io_uring batched procfs reads.
+//
+// Usage: sysmon_procfs_bench [iterations] [file]
+//   iterations  Number of full scans per backend (default: 50)
+//   file        Per-process file to read, e.g. stat, status, io (default: stat)
+
+#include "ProcfsReader.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <cctype>
+
+using namespace sysmon;
+
+namespace {
+    std::vector<std::string> listProcFiles(const std::string& file) {
+        std::vector<std::string> paths;
+        DIR* dir = opendir("/proc");
+        if (!dir) {
+            return paths;
+        }
+        
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (entry->d_type == DT_DIR && std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+                paths.push_back(std::string("/proc/") + entry->d_name + "/" + file);
+            }
+        }
+        closedir(dir);
+        return paths;
+    }
+    
+    struct Result {
+        double meanUs{0.0};
+        double minUs{0.0};
+        size_t files{0};
+        size_t bytes{0};
+    };
+    
+    Result run(ProcfsReader& reader, const std::vector<std::string>& paths, int iterations) {
+        Result result;
+        result.minUs = 1e18;
+        double totalUs = 0.0;
+        
+        for (int i = 0; i < iterations; ++i) {
+            size_t bytes = 0;
+            auto start = std::chrono::steady_clock::now();
+            result.files = reader.readBatch(paths, [&](size_t, std::string_view contents) {
+                bytes += contents.size();
+            });
+            auto end = std::chrono::steady_clock::now();
+            
+            double us = std::chrono::duration<double, std::micro>(end - start).count();
+            totalUs += us;
+            result.minUs = std::min(result.minUs, us);
+            result.bytes = bytes;
+        }
+        
+        result.meanUs = totalUs / iterations;
+        return result;
+    }
+    
+    void report(const char* name, const Result& r) {
+        std::cout << std::left << std::setw(10) << name << std::right
+                  << std::setw(8) << r.files << " files"
+                  << std::setw(10) << r.bytes << " bytes"
+                  << std::fixed << std::setprecision(1)
+                  << "  mean " << std::setw(9) << r.meanUs << " us"
+                  << "  min " << std::setw(9) << r.minUs << " us"
+                  << "  (" << std::setprecision(2) << (r.files ? r.meanUs / r.files : 0.0)
+                  << " us/file)\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 50;
+    std::string file = argc > 2 ? argv[2] : "stat";
+    if (iterations < 1) {
+        iterations = 1;
+    }
+    
+    auto paths = listProcFiles(file);
+    std::cout << "Reading /proc/[pid]/" << file << " for " << paths.size()
+              << " processes, " << iterations << " iterations\n";
+    
+    ProcfsReader syncReader(false);
+    ProcfsReader ringReader(true);
+    
+    // Warm up dentry caches so the first backend measured isn't penalised
+    run(syncReader, paths, 1);
+    
+    report("sync", run(syncReader, paths, iterations));
+    
+    if (ringReader.usingIoUring()) {
+        report("io_uring", run(ringReader, paths, iterations));
+    } else {
+        std::cout << "io_uring  unavailable (kernel < 5.15 or kernel.io_uring_disabled set)\n";
+    }
+    
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Reader latency of the shared-memory metrics segment (sysmon_shm.h).
+//
+// Usage: sysmon_shm_bench [cores] [reads]
+//   cores  Logical CPUs per published sample (default: 128)
+//   reads  Reads per scenario (default: 1000000)
+//
+// Scenarios: idle writer, writer publishing every 1 ms (10-1000x sysmon's
+// real rate) and a writer publishing back to back. The last is a stress case:
+// a reader can lose every race against it and give up after
+// SYSMON_SHM_READ_ATTEMPTS tries, which sysmon's 1 Hz publishing never causes.
+
+#include "SharedMetricsSegment.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace sysmon;
+
+namespace {
+    struct Scenario {
+        const char* name;
+        int writerPeriodUs;     // < 0: no writer, 0: back to back
+    };
+    
+    void runScenario(const Scenario& scenario, SharedMetricsSegment& writer,
+                     const sysmon_shm_segment* segment, size_t cores, size_t reads) {
+        SystemMetrics metrics;
+        metrics.perCoreCpuUsage.assign(cores, 12.5);
+        std::vector<ProcessSummary> processes(SYSMON_SHM_MAX_PROCESSES);
+        for (size_t i = 0; i < processes.size(); ++i) {
+            processes[i].pid = static_cast<uint32_t>(1000 + i);
+            processes[i].name = "worker-" + std::to_string(i);
+        }
+        
+        // Readers always copy a fully populated snapshot
+        writer.publishMetrics(metrics);
+        writer.publishProcesses(processes);
+        
+        std::atomic<bool> stop{false};
+        std::thread writerThread;
+        if (scenario.writerPeriodUs >= 0) {
+            writerThread = std::thread([&] {
+                uint64_t tick = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    metrics.timestampMs = ++tick;
+                    metrics.cpuUsagePercent = static_cast<double>(tick % 100);
+                    writer.publishMetrics(metrics);
+                    if (tick % 2 == 0) {
+                        writer.publishProcesses(processes);
+                    }
+                    if (scenario.writerPeriodUs > 0) {
+                        std::this_thread::sleep_for(std::chrono::microseconds(scenario.writerPeriodUs));
+                    }
+                }
+            });
+        }
+        
+        // Time batches of reads so clock overhead doesn't dominate
+        constexpr size_t BATCH = 64;
+        static sysmon_shm_snapshot snapshot;
+        std::vector<double> batchNs;
+        batchNs.reserve(reads / BATCH);
+        size_t failures = 0;
+        uint64_t sequenceBefore = __atomic_load_n(&segment->sequence, __ATOMIC_RELAXED);
+        for (size_t done = 0; done < reads; done += BATCH) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < BATCH; ++i) {
+                failures += sysmon_shm_read(segment, &snapshot) != 0;
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            batchNs.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / BATCH);
+        }
+        uint64_t writes = (__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) - sequenceBefore) / 2;
+        
+        stop = true;
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+        
+        std::sort(batchNs.begin(), batchNs.end());
+        auto percentile = [&](double p) {
+            return batchNs[std::min(batchNs.size() - 1, static_cast<size_t>(p * batchNs.size()))];
+        };
+        std::printf("%-14s p50 %7.1f ns  p99 %7.1f ns  max %9.1f ns  writes %9llu  failed %zu\n",
+                    scenario.name, percentile(0.50), percentile(0.99), batchNs.back(),
+                    static_cast<unsigned long long>(writes), failures);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t cores = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 128;
+    size_t reads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000;
+    
+    const std::string name = "/sysmon_shm_bench";
+    SharedMetricsSegment writer;
+    if (!writer.create(name)) {
+        return 1;
+    }
+    sysmon_shm_reader reader;
+    if (sysmon_shm_open(&reader, name.c_str()) != 0) {
+        std::cerr << "Cannot map " << name << " for reading\n";
+        return 1;
+    }
+    
+    std::cout << "Segment " << sizeof(sysmon_shm_segment) << " bytes, " << cores
+              << " cores, " << SYSMON_SHM_MAX_PROCESSES << " processes; mean ns per read over batches of 64\n";
+    const Scenario scenarios[] = {
+        {"idle writer", -1},
+        {"writer 1 kHz", 1000},
+        {"writer flat out", 0},
+    };
+    for (const auto& scenario : scenarios) {
+        runScenario(scenario, writer, reader.segment, cores, reads);
+    }
+    
+    sysmon_shm_close(&reader);
+    writer.close();
+    return 0;
+}
@@ -0,0 +1,546 @@
+// Google Benchmark suite for the collector, tree-building and rendering hot paths.
+//
+// Usage: sysmon_bench [--benchmark_filter=<regex>] [--benchmark_out=<file>] ...
+//
+// Every benchmark runs on a generated procfs fixture (ProcfsFixture) of
+// 1k to 200k processes and 4 or 64 cores. Fixtures are written once under
+// $SYSMON_BENCH_FIXTURES (default: $TMPDIR/sysmon_bench_fixtures, else
+// /tmp) and reused; the first run spends a minute or so generating them.
+//
+// Unless --benchmark_out is given, results are also written as JSON to
+// sysmon_bench.json, so two runs compare with Google Benchmark's
+// tools/compare.py:
+//   compare.py benchmarks before.json after.json
+
+#include "ProcessTreeBuilder.h"
+#include "ProcessTable.h"
+#include "ProcessDelta.h"
+#include "ProcessSearch.h"
+#include "ProcessOrder.h"
+#include "ProcessHistory.h"
+#include "ProcessGroups.h"
+#include "SystemDataCollector.h"
+#include "ISystemCollector.h"
+#include "IProcessCollector.h"
+#include "MonitorUI.h"
+#include "ProcfsFixture.h"
+#include <benchmark/benchmark.h>
+#include <ftxui/screen/screen.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace sysmon;
+
+namespace {
+    const std::vector<int64_t> PROCESS_COUNTS = {1000, 10000, 100000, 200000};
+    const std::vector<int64_t> CORE_COUNTS = {4, 64};
+    
+    // Off-screen terminal size for the render benchmark
+    constexpr int SCREEN_WIDTH = 160;
+    constexpr int SCREEN_HEIGHT = 60;
+    
+    std::string fixtureBase() {
+        if (const char* dir = std::getenv("SYSMON_BENCH_FIXTURES")) {
+            return dir;
+        }
+        const char* tmp = std::getenv("TMPDIR");
+        return std::string(tmp ? tmp : "/tmp") + "/sysmon_bench_fixtures";
+    }
+    
+    /**
+     * @brief Directory of the fixture for (processes, cores), generated on first use
+     * @return Empty after marking @p state skipped if it can't be generated
+     */
+    std::string fixtureDir(benchmark::State& state, int64_t processes, int64_t cores) {
+        std::string base = fixtureBase();
+        std::string dir = base + "/" + std::to_string(processes) + "p" + std::to_string(cores) + "c.v" +
+                          std::to_string(procfs::FIXTURE_VERSION);
+        struct stat info;
+        if (stat((dir + "/proc/stat").c_str(), &info) == 0) {
+            return dir;
+        }
+        
+        // Generated aside and renamed, so an interrupted run never leaves half a fixture
+        mkdir(base.c_str(), 0755);
+        std::string partial = dir + ".partial." + std::to_string(getpid());
+        procfs::FixtureShape shape;
+        shape.processes = static_cast<size_t>(processes);
+        shape.cores = static_cast<size_t>(cores);
+        procfs::FixtureSummary summary;
+        std::string error;
+        if (!procfs::generateFixture(partial, shape, summary, error) || rename(partial.c_str(), dir.c_str()) != 0) {
+            state.SkipWithError(("Cannot generate fixture " + dir + ": " + error).c_str());
+            return {};
+        }
+        return dir;
+    }
+    
+    Configuration fixtureConfig(const std::string& dir) {
+        Configuration config;
+        config.procRoot = dir + "/proc";
+        config.sysRoot = dir + "/sys";
+        return config;
+    }
+    
+    /**
+     * @brief The fixture's processes as the collector parses them, with CPU filled in
+     *
+     * A static fixture reads as 0% CPU everywhere; most processes stay idle
+     * here too and the rest get a heavy-tailed share, capped at all cores.
+     */
+    const std::vector<ProcessSummary>* fixtureProcesses(benchmark::State& state, int64_t processes, int64_t cores) {
+        static std::map<std::pair<int64_t, int64_t>, std::vector<ProcessSummary>> cache;
+        auto key = std::make_pair(processes, cores);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            return &it->second;
+        }
+        
+        std::string dir = fixtureDir(state, processes, cores);
+        if (dir.empty()) {
+            return nullptr;
+        }
+        auto collector = createProcessCollector(fixtureConfig(dir));
+        collector->initialize();
+        ProcessTable parsed;
+        collector->enumerateProcesses(parsed);
+        
+        std::mt19937 rng(static_cast<uint32_t>(processes * 131 + cores));
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::lognormal_distribution<double> busy(0.0, 1.5);
+        std::vector<ProcessSummary> summaries(parsed.size());
+        for (ProcessTable::Row row = 0; row < parsed.size(); ++row) {
+            parsed.fillSummary(row, summaries[row]);
+            summaries[row].cpuPercent = unit(rng) < 0.9 ? 0.0 : std::min(busy(rng), 100.0 * static_cast<double>(cores));
+        }
+        return &cache.emplace(key, std::move(summaries)).first->second;
+    }
+    
+    void fillTable(const std::vector<ProcessSummary>& summaries, ProcessTable& table) {
+        table.addAll(summaries);
+    }
+    
+    /**
+     * @brief Hands the builder the same process list on every scan
+     */
+    class SyntheticProcessCollector : public IProcessCollector {
+    public:
+        explicit SyntheticProcessCollector(const std::vector<ProcessSummary>& processes)
+            : processes_(processes) {}
+        
+        void enumerateProcesses(ProcessTable& out) override {
+            fillTable(processes_, out);
+        }
+        bool terminateProcess(uint32_t /*pid*/) override { return false; }
+        bool initialize() override { return true; }
+        void shutdown() override {}
+        
+    private:
+        const std::vector<ProcessSummary>& processes_;
+    };
+    
+    void waitForFirstTree(const ProcessTreeBuilder& builder) {
+        while (builder.getVersion() == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    
+    void setProcessesProcessed(benchmark::State& state, size_t processes) {
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(processes));
+    }
+    
+    // ---- /proc parsers ----
+    
+    void BM_ParseProcessStats(benchmark::State& state) {
+        std::string dir = fixtureDir(state, state.range(0), state.range(1));
+        if (dir.empty()) {
+            return;
+        }
+        auto collector = createProcessCollector(fixtureConfig(dir));
+        collector->initialize();
+        
+        // Same table every scan, as the builder does
+        ProcessTable processes;
+        for (auto _ : state) {
+            processes.clear();
+            collector->enumerateProcesses(processes);
+            benchmark::ClobberMemory();
+        }
+        setProcessesProcessed(state, processes.size());
+    }
+    
+    // /proc/stat grows with cores; the other system files are fixed-size
+    void BM_ParseSystemStats(benchmark::State& state) {
+        std::string dir = fixtureDir(state, PROCESS_COUNTS.front(), state.range(0));
+        if (dir.empty()) {
+            return;
+        }
+        auto collector = createSystemCollector(fixtureConfig(dir));
+        collector->initialize();
+        
+        SystemMetrics metrics;
+        for (auto _ : state) {
+            collector->collectCPUMetrics(metrics);
+            collector->collectMemoryMetrics(metrics);
+            collector->collectDiskMetrics(metrics);
+            collector->collectNetworkMetrics(metrics);
+            benchmark::DoNotOptimize(metrics.perCoreCpuUsage.data());
+        }
+    }
+    
+    // ---- Tree building and traversal ----
+    
+    void BM_BuildTree(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        // Fill and link one table per scan, reusing its storage as the builder does
+        ProcessTable processes;
+        for (auto _ : state) {
+            processes.clear();
+            fillTable(*summaries, processes);
+            processes.buildTree();
+            benchmark::ClobberMemory();
+        }
+        setProcessesProcessed(state, summaries->size());
+        state.counters["bytes_per_process"] =
+            static_cast<double>(processes.memoryFootprint()) / static_cast<double>(processes.size());
+    }
+    
+    void BM_TotalCpuWithChildren(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        ProcessTable processes;
+        fillTable(*summaries, processes);
+        processes.buildTree();
+        
+        // A totals column: every row's subtree, as an aggregated tree view needs
+        for (auto _ : state) {
+            double total = 0.0;
+            for (ProcessTable::Row row = 0; row < processes.size(); ++row) {
+                total += processes.subtreeCpu(row);
+            }
+            benchmark::DoNotOptimize(total);
+        }
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    // ---- Scan deltas ----
+    
+    void BM_DiffProcesses(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        // The next scan: 1% of processes replaced by new ones, 10% with moved CPU
+        std::vector<ProcessSummary> nextScan = *summaries;
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        uint32_t nextPid = 1u << 24;
+        for (auto& process : nextScan) {
+            double roll = unit(rng);
+            if (roll < 0.01) {
+                process.pid = nextPid++;
+            } else if (roll < 0.11) {
+                process.cpuPercent += 5.0;
+            }
+        }
+        ProcessTable previous;
+        ProcessTable current;
+        fillTable(*summaries, previous);
+        fillTable(nextScan, current);
+        
+        ProcessDelta delta;
+        for (auto _ : state) {
+            delta.compute(previous, current, 1.0, 1u << 20);
+            benchmark::DoNotOptimize(delta.changed.data());
+        }
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    // ---- Filtering ----
+    
+    void BM_FilterProcesses(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        ProcessTable processes;
+        fillTable(*summaries, processes);
+        ProcessNameInterner interner;
+        ProcessNameIndex names;
+        interner.index(processes, names);
+        
+        // One keystroke per iteration: typing a name, then clearing it
+        const std::string word = "kworker";
+        ProcessFilter filter;
+        std::vector<uint8_t> visibility;
+        std::string error;
+        size_t typed = 0;
+        for (auto _ : state) {
+            typed = typed % word.size() + 1;
+            filter.setQuery(std::string_view(word).substr(0, typed), error);
+            filter.apply(processes, names, visibility);
+            benchmark::DoNotOptimize(visibility.data());
+        }
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    // ---- Grouping ----
+    
+    void BM_GroupProcesses(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        ProcessTable processes;
+        fillTable(*summaries, processes);
+        ProcessNameInterner interner;
+        ProcessNameIndex names;
+        interner.index(processes, names);
+        
+        // One scan's totals by executable, user and cgroup per iteration
+        ProcessGrouper grouper;
+        ProcessGroups groups;
+        for (auto _ : state) {
+            grouper.group(processes, names, groups);
+            benchmark::DoNotOptimize(groups.byExecutable.data());
+        }
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    // ---- Sorting ----
+    
+    void BM_SortProcesses(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        // Consecutive scans: 10% of processes with moved CPU
+        std::vector<ProcessSummary> nextScan = *summaries;
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        for (auto& process : nextScan) {
+            if (unit(rng) < 0.1) {
+                process.cpuPercent += 5.0 * unit(rng);
+            }
+        }
+        ProcessTable scans[2];
+        fillTable(*summaries, scans[0]);
+        fillTable(nextScan, scans[1]);
+        scans[0].buildTree();
+        scans[1].buildTree();
+        
+        // Each iteration re-sorts the other scan, starting from this one's order
+        bool tree = state.range(2) != 0;
+        ProcessOrder order;
+        order.update(scans[0], ProcessSortKey::Cpu, true, tree);
+        size_t scan = 0;
+        for (auto _ : state) {
+            scan ^= 1;
+            order.update(scans[scan], ProcessSortKey::Cpu, true, tree);
+            benchmark::DoNotOptimize(order.rows().data());
+        }
+        state.counters["displaced"] = static_cast<double>(order.displaced());
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    // ---- Process history ----
+    
+    // Default history_processes
+    constexpr size_t HISTORY_PROCESSES = 2048;
+    
+    void BM_RecordProcessHistory(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        ProcessTable processes;
+        fillTable(*summaries, processes);
+        
+        // Steady state: every slot taken, each scan matched against the tracked processes
+        ProcessHistory history(HISTORY_PROCESSES);
+        history.record(processes);
+        for (auto _ : state) {
+            history.record(processes);
+        }
+        state.counters["history_bytes"] = static_cast<double>(history.memoryFootprint());
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    // ---- Top-K indexes ----
+    
+    // Processes kept per index; queries above it fall back to a full pass
+    constexpr size_t TOP_K = 32;
+    
+    void BM_SelectTopProcesses(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        ProcessTable processes;
+        fillTable(*summaries, processes);
+        std::vector<ProcessTable::Row> top;
+        
+        // What each scan adds to maintain both indexes
+        for (auto _ : state) {
+            ProcessTreeBuilder::selectTop(processes, TOP_K, ProcessRanking::Cpu, top);
+            ProcessTreeBuilder::selectTop(processes, TOP_K, ProcessRanking::Memory, top);
+            benchmark::DoNotOptimize(top.data());
+        }
+        setProcessesProcessed(state, summaries->size());
+    }
+    
+    void BM_GetTopProcesses(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        Configuration config;
+        config.topProcessIndexSize = TOP_K;
+        ProcessTreeBuilder builder(config, std::make_unique<SyntheticProcessCollector>(*summaries));
+        builder.start();
+        waitForFirstTree(builder);
+        builder.stop();
+        
+        // indexed=1 reads K entries from the index; indexed=0 asks for K+1 and scans the table
+        size_t count = state.range(2) ? TOP_K : TOP_K + 1;
+        std::vector<ProcessSummary> top;
+        for (auto _ : state) {
+            builder.getTopProcesses(count, top);
+            benchmark::DoNotOptimize(top.data());
+        }
+    }
+    
+    // ---- getSnapshot() while the builder keeps publishing ----
+    
+    // Shared by the benchmark's threads; thread 0 sets it up and tears it down
+    std::unique_ptr<ProcessTreeBuilder> contendedBuilder;
+    uint64_t contendedStartVersion = 0;
+    
+    void BM_GetSnapshotContended(benchmark::State& state) {
+        if (state.thread_index() == 0) {
+            const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+            if (summaries) {
+                // No scan interval: the enumeration thread rebuilds and publishes back to back
+                Configuration config;
+                config.processSampleIntervalMs = 0;
+                contendedBuilder = std::make_unique<ProcessTreeBuilder>(
+                    config, std::make_unique<SyntheticProcessCollector>(*summaries));
+                contendedBuilder->start();
+                waitForFirstTree(*contendedBuilder);
+                contendedStartVersion = contendedBuilder->getVersion();
+            }
+        }
+        
+        for (auto _ : state) {
+            if (!contendedBuilder) {
+                state.SkipWithError("No fixture");
+                break;
+            }
+            // Held across the iteration, like a frame, so retired snapshots are sometimes still in use
+            ProcessSnapshotPtr snapshot = contendedBuilder->getSnapshot();
+            benchmark::DoNotOptimize(snapshot->table.size());
+        }
+        
+        if (state.thread_index() == 0 && contendedBuilder) {
+            // Trees the writer published per read of this thread: how much the readers starve it
+            state.counters["publishes"] = benchmark::Counter(
+                static_cast<double>(contendedBuilder->getVersion() - contendedStartVersion) /
+                static_cast<double>(std::max<benchmark::IterationCount>(state.iterations(), 1)));
+            contendedBuilder->stop();
+            contendedBuilder.reset();
+        }
+    }
+    
+    // ---- Rendering ----
+    
+    void BM_RenderProcessTree(benchmark::State& state) {
+        const auto* summaries = fixtureProcesses(state, state.range(0), state.range(1));
+        if (!summaries) {
+            return;
+        }
+        // Expanded, so the panel draws up to maxProcessDisplay rows rather than roots only
+        Configuration config = fixtureConfig(fixtureDir(state, state.range(0), state.range(1)));
+        config.expandTreeByDefault = true;
+        
+        ProcessTreeBuilder builder(config, std::make_unique<SyntheticProcessCollector>(*summaries));
+        builder.start();
+        waitForFirstTree(builder);
+        builder.stop();
+        SystemDataCollector dataCollector(config);
+        MonitorUI ui(dataCollector, builder, config);
+        
+        auto screen = ftxui::Screen::Create(ftxui::Dimension::Fixed(SCREEN_WIDTH),
+                                            ftxui::Dimension::Fixed(SCREEN_HEIGHT));
+        // The first frame pulls the tree; frames after it only render
+        ui.renderProcessTree(screen);
+        for (auto _ : state) {
+            ui.renderProcessTree(screen);
+            benchmark::ClobberMemory();
+        }
+    }
+}
+
+BENCHMARK(BM_ParseProcessStats)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParseSystemStats)->ArgsProduct({CORE_COUNTS})->ArgNames({"cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildTree)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TotalCpuWithChildren)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_DiffProcesses)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FilterProcesses)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GroupProcesses)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SortProcesses)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS, {0, 1}})
+    ->ArgNames({"processes", "cores", "tree"})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RecordProcessHistory)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SelectTopProcesses)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetTopProcesses)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS, {0, 1}})
+    ->ArgNames({"processes", "cores", "indexed"})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetSnapshotContended)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Threads(1)->Threads(2)->Threads(4)->UseRealTime()->Unit(benchmark::kNanosecond);
+BENCHMARK(BM_RenderProcessTree)->ArgsProduct({PROCESS_COUNTS, CORE_COUNTS})->ArgNames({"processes", "cores"})
+    ->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv) {
+    // Keep a JSON report of every run unless the caller chose an output
+    std::vector<char*> args(argv, argv + argc);
+    bool hasOutput = std::any_of(args.begin(), args.end(), [](const char* arg) {
+        return std::string(arg).rfind("--benchmark_out=", 0) == 0;
+    });
+    std::string outFlag = "--benchmark_out=sysmon_bench.json";
+    std::string formatFlag = "--benchmark_out_format=json";
+    if (!hasOutput) {
+        args.push_back(outFlag.data());
+        args.push_back(formatFlag.data());
+    }
+    
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * Minimal consumer of the sysmon shared-memory segment.
+ *
+ * Usage: sysmon_shm_reader [name] [count]
+ *   name   Shared-memory object passed to sysmon --shm (default: /sysmon)
+ *   count  Snapshots to print, one per second (default: 5)
+ */
+#include "sysmon_shm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[]) {
+    const char* name = argc > 1 ? argv[1] : SYSMON_SHM_DEFAULT_NAME;
+    int count = argc > 2 ? atoi(argv[2]) : 5;
+    struct sysmon_shm_reader reader;
+    static struct sysmon_shm_snapshot snapshot;
+    int i;
+    uint32_t p;
+    
+    if (sysmon_shm_open(&reader, name) != 0) {
+        fprintf(stderr, "No sysmon segment at %s (is sysmon running with --shm %s?)\n", name, name);
+        return 1;
+    }
+    
+    for (i = 0; i < count; ++i) {
+        if (i > 0) {
+            sleep(1);
+        }
+        if (sysmon_shm_read(reader.segment, &snapshot) != 0) {
+            fprintf(stderr, "Writer kept the segment busy; skipping\n");
+            continue;
+        }
+        
+        printf("t=%llu cpu=%.1f%% mem=%.1f%% (%u cores, %llu samples, writer %s)\n",
+               (unsigned long long)snapshot.timestamp_ms, snapshot.cpu_usage_percent,
+               snapshot.memory_usage_percent, snapshot.core_count,
+               (unsigned long long)snapshot.metrics_updates,
+               reader.segment->writer_pid != 0 ? "running" : "exited");
+        for (p = 0; p < snapshot.process_count && p < 3; ++p) {
+            printf("  %6u %-20s %5.1f%% %llu KiB\n", snapshot.processes[p].pid,
+                   snapshot.processes[p].name, snapshot.processes[p].cpu_percent,
+                   (unsigned long long)(snapshot.processes[p].memory_bytes / 1024));
+        }
+    }
+    
+    sysmon_shm_close(&reader);
+    return 0;
+}
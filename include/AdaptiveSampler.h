@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sysmon {
+
+/**
+ * @brief Per-source sampling interval that follows signal volatility
+ *
+ * Each sample's delta is compared against a volatility threshold (in percentage
+ * points). A delta above the threshold, or a high EWMA deviation of recent
+ * deltas, halves the interval so bursts are captured; a quiet signal backs the
+ * interval off by 1.5x. The interval always stays within [min, max].
+ *
+ * Rate-style signals (bytes/s) are normalised to a percentage of their decaying
+ * observed peak so one threshold works for every source.
+ *
+ * Thread-safety: Not thread-safe; owned by the collection thread
+ */
+class AdaptiveSampler {
+public:
+    enum class Scale {
+        Percent,        // Signal is already 0-100
+        PercentOfPeak   // Signal is a rate; normalise against its observed peak
+    };
+    
+    AdaptiveSampler(uint32_t initialIntervalMs, uint32_t minIntervalMs, uint32_t maxIntervalMs,
+                    double volatilityThreshold, Scale scale = Scale::Percent);
+    
+    /**
+     * @brief Feed a new sample and return the interval until the next one
+     */
+    uint32_t update(double value);
+    
+    /**
+     * @brief Current effective interval
+     */
+    uint32_t intervalMs() const { return intervalMs_; }
+    
+private:
+    double normalize(double value);
+    
+    uint32_t intervalMs_;
+    uint32_t minIntervalMs_;
+    uint32_t maxIntervalMs_;
+    double threshold_;
+    Scale scale_;
+    
+    bool hasLast_{false};
+    double last_{0.0};
+    double deltaVariance_{0.0};
+    double peak_{0.0};
+};
+
+} // namespace sysmon
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "AlertRules.h"
+#include "ChangeNotifier.h"
+#include "SampleObserver.h"
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Evaluates compiled alert rules against every sample as it is taken
+ *
+ * Registered as an ISampleObserver, so rules run on the collector threads
+ * once per sample rather than once per frame. System rules only look at the
+ * sources re-sampled in that pass; process rules are matched by a hash
+ * lookup on the process name or pid, plus the proc(*) rules, so a scan costs
+ * O(processes) however many rules watch specific names.
+ *
+ * Only instances whose condition holds (pending or firing) keep state.
+ * A process that exits resolves its firing alerts. Fired and resolved
+ * alerts go to an event log that sinks read incrementally; the active set
+ * is what the UI shows.
+ *
+ * Thread-safety: compile() before the collectors start; everything else is thread-safe
+ */
+class AlertEngine : public ISampleObserver {
+public:
+    // Events kept for readers that fall behind
+    static constexpr size_t MAX_EVENTS = 1024;
+    
+    /**
+     * @brief Compile @p rules, replacing any previous program
+     * @return false with @p error naming the first bad rule
+     */
+    bool compile(const std::vector<std::string>& rules, std::string& error);
+    
+    void onSystemSample(const SystemMetrics& sample, uint32_t sources) override;
+    void onProcessScan(const ProcessTable& processes, uint64_t timestampMs) override;
+    
+    /**
+     * @brief Copy the firing alerts into @p out, oldest first
+     */
+    void getActive(std::vector<ActiveAlert>& out) const;
+    
+    /**
+     * @brief Copy events with a sequence above @p after into @p out
+     * @return Sequence of the newest event, to pass as @p after next time
+     */
+    uint64_t getEvents(uint64_t after, std::vector<AlertEvent>& out) const;
+    
+    /**
+     * @brief Bumped whenever an alert fires or resolves (0 = none yet)
+     */
+    uint64_t getVersion() const { return notifier_.version(); }
+    
+    /**
+     * @brief Register a callback for fired and resolved alerts
+     * @note Callbacks run on a collector thread and must not block
+     */
+    ChangeNotifier::SubscriptionId subscribe(ChangeNotifier::Callback callback);
+    void unsubscribe(ChangeNotifier::SubscriptionId id);
+    
+    size_t ruleCount() const { return program_.labels.size(); }
+    bool watchesProcesses() const { return !program_.process.empty(); }
+    uint64_t alertsFired() const { return alertsFired_.load(std::memory_order_relaxed); }
+    
+private:
+    // Instruction (system ones first, then process ones) and instance
+    struct InstanceKey {
+        uint32_t instruction;
+        uint32_t id;                        // Core or pid; 0 for host-wide rules
+        uint64_t startTime;                 // Process creation time
+        bool operator==(const InstanceKey& other) const {
+            return instruction == other.instruction && id == other.id && startTime == other.startTime;
+        }
+    };
+    
+    struct InstanceKeyHash {
+        size_t operator()(const InstanceKey& key) const {
+            uint64_t mixed = (static_cast<uint64_t>(key.instruction) << 32 | key.id) ^
+                             key.startTime * 0x9E3779B97F4A7C15ull;
+            return std::hash<uint64_t>()(mixed);
+        }
+    };
+    
+    // Lets processesByName_ be probed with a table's string_view names
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+    };
+    
+    struct InstanceState {
+        uint64_t pendingSinceMs{0};         // First sample of the current run that held
+        uint64_t firedMs{0};
+        uint64_t scan{0};                   // Last process scan that saw it
+        double value{0.0};
+        bool firing{false};
+        std::string instance;               // Display name, set when it fires
+    };
+    
+    /**
+     * @brief Advance one instance's state machine
+     * @param describe Returns the instance's display name; only called when it fires
+     * @return Whether an alert fired or resolved
+     */
+    template <typename Describe>
+    bool evaluate(const AlertInstruction& instruction, const InstanceKey& key, double value,
+                  uint64_t timestampMs, Describe&& describe);
+    
+    void pushEvent(const AlertInstruction& instruction, const InstanceState& state, bool firing,
+                   double value, uint64_t timestampMs);
+    
+    AlertProgram program_;
+    std::vector<uint32_t> anyProcess_;      // Indices into program_.process
+    std::unordered_map<std::string, std::vector<uint32_t>, NameHash, std::equal_to<>> processesByName_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> processesByPid_;
+    
+    mutable std::mutex mutex_;
+    std::unordered_map<InstanceKey, InstanceState, InstanceKeyHash> states_;
+    uint64_t scan_{0};
+    std::deque<AlertEvent> events_;
+    uint64_t lastSequence_{0};
+    
+    ChangeNotifier notifier_;
+    std::atomic<uint64_t> alertsFired_{0};
+};
+
+} // namespace sysmon
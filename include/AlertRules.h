@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Value an alert instruction reads from a sample
+ */
+enum class AlertOperand : uint8_t {
+    CpuPercent,         // cpu
+    CorePercent,        // cpu.core[N] / cpu.core[*]
+    CoreStealPercent,   // cpu.core[N].steal / cpu.core[*].steal
+    MemoryPercent,      // memory
+    MemoryUsedBytes,    // memory.used
+    DiskReadRate,       // disk.read (bytes/s)
+    DiskWriteRate,      // disk.write (bytes/s)
+    NetworkRecvRate,    // net.recv (bytes/s)
+    NetworkSendRate,    // net.send (bytes/s)
+    ProcessCpuPercent,  // proc(...).cpu
+    ProcessRssBytes     // proc(...).rss
+};
+
+enum class AlertCompare : uint8_t {
+    Greater,
+    GreaterEqual,
+    Less,
+    LessEqual
+};
+
+enum class AlertSelector : uint8_t {
+    Any,                // cpu.core[*], proc(*)
+    Index,              // cpu.core[N], proc(pid=N)
+    Name                // proc(name=NAME)
+};
+
+/**
+ * @brief One compiled rule: a single comparison, its delay and clear level
+ *
+ * An instance (a core, a process, or the host) fires once the comparison has
+ * held for forMs, and resolves once the value is back on the safe side of
+ * clearThreshold, which defaults to the threshold itself.
+ */
+struct AlertInstruction {
+    AlertOperand operand{AlertOperand::CpuPercent};
+    AlertCompare compare{AlertCompare::Greater};
+    AlertSelector selector{AlertSelector::Any};
+    uint32_t index{0};                      // Core or pid for AlertSelector::Index
+    uint32_t rule{0};                       // Index into AlertProgram::labels
+    uint32_t sources{0};                    // SAMPLE_* bits the operand is sampled by (0 = process scan)
+    double threshold{0.0};
+    double clearThreshold{0.0};
+    uint64_t forMs{0};
+    std::string name;                       // Process name for AlertSelector::Name
+};
+
+/**
+ * @brief Every configured rule, compiled once into flat instruction lists
+ *
+ * System instructions are evaluated against each system sample and process
+ * instructions against each process scan; labels are indexed by
+ * AlertInstruction::rule.
+ */
+struct AlertProgram {
+    std::vector<AlertInstruction> system;
+    std::vector<AlertInstruction> process;
+    std::vector<std::string> labels;
+    
+    size_t size() const { return system.size() + process.size(); }
+};
+
+/**
+ * @brief An alert that fired or resolved
+ */
+struct AlertEvent {
+    uint64_t sequence{0};                   // 1-based, increasing
+    uint64_t timestampMs{0};                // Sample that changed the state
+    bool firing{false};                     // true = fired, false = resolved
+    std::string rule;                       // Rule label
+    std::string instance;                   // e.g. core3 or java[1234]; empty for host-wide rules
+    double value{0.0};
+    double threshold{0.0};
+};
+
+/**
+ * @brief A currently firing alert
+ */
+struct ActiveAlert {
+    std::string rule;
+    std::string instance;
+    double value{0.0};                      // Latest value evaluated
+    uint64_t sinceMs{0};
+};
+
+/**
+ * @brief Compile one rule and append it to @p program
+ *
+ * Syntax: [label:] metric op number[unit] [for duration] [clear number[unit]]
+ *   metric    cpu | cpu.core[N|*][.steal] | memory | memory.used | disk.read | disk.write
+ *             | net.recv | net.send | proc(name=NAME|pid=N|*).cpu | proc(...).rss
+ *   op        > >= < <=
+ *   unit      % | KB MB GB TB | KiB MiB GiB TiB, optionally followed by /s
+ *   duration  number followed by ms, s, m or h
+ *
+ * e.g. "cpu.core[*] > 95 for 30s", "java-rss: proc(name=java).rss > 8GiB clear 7GiB"
+ *
+ * @return false with @p error describing the first problem
+ */
+bool compileAlertRule(const std::string& source, AlertProgram& program, std::string& error);
+
+} // namespace sysmon
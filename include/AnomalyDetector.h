@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Online per-series baselines with z-score anomaly alerts
+ *
+ * Each series keeps an exponentially weighted mean and variance, updated in
+ * O(1) per sample. The decay is time-based (a half-life), so irregular
+ * sampling from adaptive intervals weighs each sample by the time it covers.
+ * Until a baseline has seen warmupSamples samples it is a plain running
+ * average, so the first variance estimate is not biased low.
+ *
+ * Seasonal series also keep one baseline per slot of the day (e.g. 24
+ * hourly buckets) and switch to the slot's baseline once it has warmed up,
+ * so a nightly backup is compared with earlier nights rather than with the
+ * afternoon. A slot only sees its own hour, so it forgets seasonBuckets
+ * times more slowly in wall-clock terms.
+ *
+ * A series raises when |z| reaches raiseZ and clears only once |z| drops
+ * below clearZ. Samples feed the baseline clamped to raiseZ standard
+ * deviations, so a sustained shift is absorbed gradually rather than
+ * swallowing the alert on its first sample.
+ *
+ * Thread-safety: Not thread-safe; AnomalyMonitor serializes access
+ */
+class AnomalyDetector {
+public:
+    using SeriesId = uint32_t;
+    
+    struct Options {
+        double halfLifeSeconds{600.0};  // Age at which a sample's weight has halved
+        uint32_t seasonBuckets{24};     // Baselines per day for seasonal series (0/1 = none)
+        double raiseZ{4.0};             // |z| that raises an anomaly
+        double clearZ{2.0};             // |z| below which a raised anomaly clears
+        uint32_t warmupSamples{30};     // Samples before a baseline may raise
+    };
+    
+    enum class Transition : uint8_t {
+        None,
+        Raised,
+        Cleared
+    };
+    
+    struct Observation {
+        double zScore{0.0};             // Against the baseline before this sample
+        double mean{0.0};
+        Transition transition{Transition::None};
+        bool anomalous{false};          // State after this sample
+    };
+    
+    explicit AnomalyDetector(const Options& options);
+    
+    /**
+     * @brief Start a series with an empty baseline
+     * @param minStdDev Floor for the standard deviation, in the series' unit, so a
+     *        perfectly flat series doesn't alert on its first wobble
+     */
+    SeriesId addSeries(bool seasonal, double minStdDev);
+    
+    /**
+     * @brief Release a series; its id may be handed out again
+     */
+    void removeSeries(SeriesId id);
+    
+    /**
+     * @brief Score @p value against the series' baseline, then fold it in
+     */
+    Observation observe(SeriesId id, double value, uint64_t timestampMs);
+    
+    size_t seriesCount() const { return series_.size() - freeSeries_.size(); }
+    
+private:
+    struct Baseline {
+        double mean{0.0};
+        double variance{0.0};
+        uint32_t samples{0};
+    };
+    
+    static constexpr uint32_t NO_SEASONS = UINT32_MAX;
+    
+    struct Series {
+        Baseline overall;
+        uint64_t lastMs{0};
+        uint32_t seasonOffset{NO_SEASONS};  // First of seasonBuckets baselines in seasons_
+        double minStdDev{0.0};
+        bool anomalous{false};
+    };
+    
+    void update(Baseline& baseline, double value, double alpha) const;
+    
+    Options options_;
+    uint64_t bucketMs_{0};
+    std::vector<Series> series_;
+    std::vector<SeriesId> freeSeries_;
+    std::vector<Baseline> seasons_;
+    std::vector<uint32_t> freeSeasons_;
+};
+
+} // namespace sysmon
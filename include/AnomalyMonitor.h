@@ -0,0 +1,143 @@
+#pragma once
+
+#include "AnomalyDetector.h"
+#include "ChangeNotifier.h"
+#include "Configuration.h"
+#include "SampleObserver.h"
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief A series currently outside its baseline
+ */
+struct Anomaly {
+    std::string series;                     // e.g. cpu, cpu3, memory, disk.sda.read, net.eth0.send, process.42.cpu
+    std::string process;                    // Process name for process.* series
+    double value{0.0};                      // Sample that raised it
+    double mean{0.0};                       // Baseline it was scored against
+    double zScore{0.0};                     // Signed; positive = above the baseline
+    uint64_t sinceMs{0};                    // Sample timestamp when raised
+};
+
+/**
+ * @brief Runs an AnomalyDetector over every sample the collectors take
+ *
+ * Registered as an ISampleObserver, so it scores samples on the collection
+ * and enumeration threads as they are taken. Series are created on first
+ * sight: overall and per-core CPU, memory, disk and network totals, per
+ * disk and interface rates (derived from the cumulative counters), and CPU
+ * and memory per process. Processes are keyed by (pid, creation time), so
+ * a reused pid starts a fresh baseline, and their series are dropped when
+ * they exit. Host series are seasonal; process series are not, since few
+ * processes live for days.
+ *
+ * Thread-safety: All public methods are thread-safe
+ */
+class AnomalyMonitor : public ISampleObserver {
+public:
+    explicit AnomalyMonitor(const Configuration& config);
+    
+    void onSystemSample(const SystemMetrics& sample, uint32_t sources) override;
+    void onProcessScan(const ProcessTable& processes, uint64_t timestampMs) override;
+    
+    /**
+     * @brief Copy the active anomalies into @p out, largest |z| first
+     */
+    void getActive(std::vector<Anomaly>& out) const;
+    
+    /**
+     * @brief Bumped whenever an anomaly is raised or cleared (0 = none yet)
+     */
+    uint64_t getVersion() const { return notifier_.version(); }
+    
+    /**
+     * @brief Register a callback for raised and cleared anomalies
+     * @note Callbacks run on a collector thread and must not block
+     */
+    ChangeNotifier::SubscriptionId subscribe(ChangeNotifier::Callback callback);
+    void unsubscribe(ChangeNotifier::SubscriptionId id);
+    
+    size_t seriesCount() const;
+    uint64_t samplesScored() const { return samplesScored_.load(std::memory_order_relaxed); }
+    uint64_t anomaliesRaised() const { return anomaliesRaised_.load(std::memory_order_relaxed); }
+    
+private:
+    using SeriesId = AnomalyDetector::SeriesId;
+    static constexpr SeriesId NO_SERIES = UINT32_MAX;
+    
+    // Cumulative device counters turned into rates between samples
+    struct DeviceSeries {
+        SeriesId read{NO_SERIES};
+        SeriesId write{NO_SERIES};
+        uint64_t lastRead{0};
+        uint64_t lastWrite{0};
+        uint64_t lastMs{0};
+        bool seen{false};
+    };
+    
+    struct ProcessKey {
+        uint32_t pid;
+        uint64_t creationTime;
+        bool operator==(const ProcessKey& other) const {
+            return pid == other.pid && creationTime == other.creationTime;
+        }
+    };
+    
+    struct ProcessKeyHash {
+        size_t operator()(const ProcessKey& key) const {
+            return std::hash<uint64_t>()(key.creationTime * 0x9E3779B97F4A7C15ull ^ key.pid);
+        }
+    };
+    
+    struct ProcessSeries {
+        SeriesId cpu;
+        SeriesId memory;
+        uint64_t scan;
+    };
+    
+    /**
+     * @brief Score one sample; @p describe fills in an Anomaly's names only when one is raised
+     * @return Whether the set of active anomalies changed
+     */
+    template <typename Describe>
+    bool score(SeriesId id, double value, uint64_t timestampMs, Describe&& describe);
+    
+    SeriesId hostSeries(SeriesId& id, double minStdDev);
+    /**
+     * @brief Drop @p id from the active anomalies, and from the detector if @p remove
+     * @return Whether it was active
+     */
+    bool clearSeries(SeriesId id, bool remove);
+    bool scoreDevices(std::unordered_map<std::string, DeviceSeries>& devices,
+                      const std::vector<DeviceCounters>& counters, const char* prefix,
+                      const char* readName, const char* writeName, uint64_t timestampMs);
+    
+    mutable std::mutex mutex_;
+    AnomalyDetector detector_;
+    
+    SeriesId cpu_{NO_SERIES};
+    SeriesId memory_{NO_SERIES};
+    SeriesId diskRead_{NO_SERIES};
+    SeriesId diskWrite_{NO_SERIES};
+    SeriesId networkRecv_{NO_SERIES};
+    SeriesId networkSend_{NO_SERIES};
+    std::vector<SeriesId> cores_;
+    std::unordered_map<std::string, DeviceSeries> disks_;
+    std::unordered_map<std::string, DeviceSeries> interfaces_;
+    std::unordered_map<ProcessKey, ProcessSeries, ProcessKeyHash> processes_;
+    uint64_t scan_{0};
+    
+    std::vector<std::pair<SeriesId, Anomaly>> active_;
+    ChangeNotifier notifier_;
+    std::atomic<uint64_t> samplesScored_{0};
+    std::atomic<uint64_t> anomaliesRaised_{0};
+};
+
+} // namespace sysmon
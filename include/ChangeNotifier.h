@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Version counter plus subscriber list for published snapshots
+ *
+ * Producers call publish() after swapping in a new snapshot; consumers either
+ * poll version() to skip unchanged data or subscribe() to be woken up.
+ * Thread-safety: All public methods are thread-safe. Callbacks run on the
+ * publishing thread and must not block.
+ */
+class ChangeNotifier {
+public:
+    using Callback = std::function<void(uint64_t version)>;
+    using SubscriptionId = uint64_t;
+    
+    /**
+     * @brief Version of the most recently published snapshot (0 = none yet)
+     */
+    uint64_t version() const {
+        return version_.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief Register a callback invoked after every publish
+     */
+    SubscriptionId subscribe(Callback callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SubscriptionId id = ++lastId_;
+        subscribers_.emplace_back(id, std::move(callback));
+        return id;
+    }
+    
+    /**
+     * @brief Remove a previously registered callback
+     */
+    void unsubscribe(SubscriptionId id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = subscribers_.begin(); it != subscribers_.end(); ++it) {
+            if (it->first == id) {
+                subscribers_.erase(it);
+                break;
+            }
+        }
+    }
+    
+    /**
+     * @brief Bump the version and notify all subscribers
+     */
+    uint64_t publish() {
+        uint64_t version = version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& subscriber : subscribers_) {
+            subscriber.second(version);
+        }
+        return version;
+    }
+    
+private:
+    std::atomic<uint64_t> version_{0};
+    mutable std::mutex mutex_;
+    SubscriptionId lastId_{0};
+    std::vector<std::pair<SubscriptionId, Callback>> subscribers_;
+};
+
+} // namespace sysmon
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include <vector>
 
 namespace sysmon {
 
@@ -18,9 +19,24 @@ struct Configuration {
     uint32_t networkSampleIntervalMs{1000};     // Default: 1 second
     uint32_t processSampleIntervalMs{2000};     // Default: 2 seconds
     
+    // Adaptive sampling: intervals above are starting points within [min, max]
+    bool adaptiveSampling{true};                // Follow signal volatility
+    uint32_t adaptiveMinIntervalMs{250};        // Fastest rate during bursts
+    uint32_t adaptiveMaxIntervalMs{10000};      // Slowest rate when idle
+    double volatilityThreshold{5.0};            // Delta (percentage points) that counts as a burst
+    
     // Alert thresholds (percentages)
     double cpuAlertThreshold{90.0};             // Default: 90%
     double memoryAlertThreshold{90.0};          // Default: 90%
+    std::vector<std::string> alertRules;        // Rule expressions, e.g. "proc(name=java).rss > 8GiB for 1m"
+    
+    // Anomaly detection: per-series baselines, alerts on z-score deviations
+    bool anomalyDetection{true};                // Score every system, core and device series
+    bool anomalyProcesses{true};                // Also per-process CPU and memory series
+    double anomalyRaiseZ{4.0};                  // |z| that raises an anomaly
+    double anomalyClearZ{2.0};                  // |z| below which it clears again (hysteresis)
+    uint32_t anomalyHalfLifeSec{600};           // How quickly baselines forget old samples
+    uint32_t anomalySeasonBuckets{24};          // Time-of-day baselines per host series (0 = off)
     
     // Display preferences
     uint32_t targetFrameRateHz{30};             // Default: 30 FPS
@@ -31,6 +47,52 @@ struct Configuration {
     // Process tree settings
     bool expandTreeByDefault{false};            // Expand all tree nodes
     uint32_t maxProcessDisplay{1000};           // Max processes to display
+    std::string processSortBy{"cpu"};           // cpu, memory, name or pid
+    bool flatProcessList{false};                // One sorted list instead of the tree
+    std::string processGroupBy{"none"};         // Aggregate view: none, executable, user or cgroup
+    uint32_t historyProcesses{2048};            // Processes keeping a CPU/memory/I/O wait history (0 = off)
+    uint32_t topProcessIndexSize{32};           // K: processes kept per top-K index (CPU, memory)
+    double deltaCpuEpsilon{1.0};                // CPU change (percentage points) a scan delta reports
+    uint64_t deltaMemoryEpsilonBytes{1u << 20}; // Memory change a scan delta reports
+    
+    // Platform collection settings
+    bool useIoUring{true};                      // Batch procfs reads via io_uring (Linux)
+    std::string procRoot{"/proc"};              // procfs the Linux collectors read (a fixture copy for tests)
+    std::string sysRoot{"/sys"};                // sysfs used to tell whole disks from partitions
+    double cpuBudgetPercent{0.0};               // Own CPU budget, % of one core (0 = unlimited)
+    
+    // Headless export (--headless replaces the UI)
+    bool headless{false};                       // Stream snapshots instead of showing the UI
+    std::string exportFormat{"jsonl"};          // jsonl, csv or binary
+    std::string exportOutput;                   // Output file (empty or "-" = stdout)
+    uint32_t exportTopProcesses{0};             // Top-N processes by CPU per snapshot
+    uint32_t exportTopGroups{0};                // Top-N groups by CPU per grouping per snapshot (jsonl)
+    std::string recordFile;                     // Columnar recording output (empty = off)
+    
+    // Prometheus/OpenMetrics scrape endpoint
+    std::string metricsListen;                  // "host:port" or ":port" (empty = off)
+    uint32_t metricsTopProcesses{10};           // Top-N processes by CPU per scrape
+    uint32_t metricsTopGroups{10};              // Top-N groups by CPU per grouping per scrape
+    std::string sharedMemoryName;               // POSIX shm object for local readers (empty = off)
+    
+    // Replay (--replay replaces the platform collectors)
+    std::string replayFile;                     // Recording to play back (empty = live)
+    double replaySpeed{1.0};                    // Playback rate; 0 = as fast as possible
+    
+    // Collector daemon (--attach replaces the platform collectors)
+    std::string daemonSocket;                   // Unix socket to serve attached UIs on (empty = off)
+    std::string attachSocket;                   // Daemon socket to take snapshots from (empty = local)
+    uint32_t attachMaxUpdateHz{0};              // Updates/s requested from the daemon (0 = all)
+    
+    // Fleet view (--fleet shows remote agents instead of this host)
+    std::string fleetListen;                    // "host:port" or ":port" to accept agents on (empty = off)
+    std::string agentTarget;                    // Aggregator "host:port" to stream to (empty = off)
+    std::string agentName;                      // Host name the agent announces (empty = hostname)
+    uint32_t agentTopProcesses{10};             // Top-N processes by CPU per agent update
+    
+    // Diagnostics
+    bool debugMode{false};                      // Show self-instrumentation panel
+    std::string traceFile;                      // Chrome trace-event JSON output (empty = off)
     
     /**
      * @brief Load configuration from command-line arguments
@@ -44,8 +106,10 @@ struct Configuration {
     
     /**
      * @brief Load configuration from file
+     * @return false if the file can't be opened (@p error left empty) or a
+     *         value doesn't parse (@p error is "<file>:<line>: bad value for <key>")
      */
-    bool loadFromFile(const std::string& filepath);
+    bool loadFromFile(const std::string& filepath, std::string& error);
     
     /**
      * @brief Validate configuration values
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Configuration.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace sysmon {
+
+/**
+ * @brief Keeps sysmon's own CPU usage within a configured budget
+ *
+ * Samples the process's own CPU time (getrusage / GetProcessTimes) once per
+ * evaluation window and moves one step along a degradation ladder when usage
+ * exceeds the budget, or back one step when it falls below half of it:
+ *
+ *   1-3  stretch the process scan interval (2x, 4x, 8x)
+ *   4    additionally reduce per-process detail
+ *   5-6  additionally stretch system metric intervals (2x, 4x)
+ *
+ * Collectors read the current scales on every loop iteration.
+ * Thread-safety: All public methods are thread-safe
+ */
+class CpuBudgetGovernor {
+public:
+    explicit CpuBudgetGovernor(const Configuration& config);
+    ~CpuBudgetGovernor();
+    
+    CpuBudgetGovernor(const CpuBudgetGovernor&) = delete;
+    CpuBudgetGovernor& operator=(const CpuBudgetGovernor&) = delete;
+    
+    /**
+     * @brief Start the evaluation thread (no-op when no budget is configured)
+     */
+    void start();
+    
+    /**
+     * @brief Stop the evaluation thread
+     */
+    void stop();
+    
+    /**
+     * @brief Whether a budget is configured
+     */
+    bool enabled() const { return budgetPercent_ > 0.0; }
+    
+    /**
+     * @brief Current position on the degradation ladder (0 = full fidelity)
+     */
+    uint32_t step() const { return step_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Whether any fidelity is currently being traded for CPU
+     */
+    bool degraded() const { return step() > 0; }
+    
+    /**
+     * @brief Multiplier applied to the process scan interval
+     */
+    uint32_t processIntervalScale() const;
+    
+    /**
+     * @brief Whether collectors should skip non-essential per-process work
+     */
+    bool reducedProcessDetail() const;
+    
+    /**
+     * @brief Multiplier applied to every system metric interval
+     */
+    uint32_t systemIntervalScale() const;
+    
+    /**
+     * @brief Own CPU usage over the last window, in percent of one core
+     */
+    double selfCpuPercent() const { return selfCpuPercent_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Short description of the active degradation ("" at full fidelity)
+     */
+    const char* description() const;
+    
+    /**
+     * @brief Total user + system CPU time consumed by this process
+     */
+    static std::chrono::microseconds processCpuTime();
+    
+private:
+    void evaluationLoop();
+    void evaluate(std::chrono::microseconds cpuTime, std::chrono::steady_clock::duration wall);
+    
+    double budgetPercent_;
+    
+    std::atomic<uint32_t> step_{0};
+    std::atomic<double> selfCpuPercent_{0.0};
+    
+    std::atomic<bool> running_{false};
+    std::thread evaluationThread_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+};
+
+} // namespace sysmon
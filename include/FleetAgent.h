@@ -0,0 +1,93 @@
+#pragma once
+
+#include "SystemDataCollector.h"
+#include "ProcessTreeBuilder.h"
+#include "SnapshotStream.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Streams this host's snapshots to a fleet aggregator over TCP (--agent)
+ *
+ * Collector threads only flag that something changed; a sender thread then
+ * copies the latest metrics and top processes and sends them as deltas
+ * against what it last sent on the current connection. Snapshots published
+ * while a send is in progress are coalesced into the next one, so a slow
+ * aggregator never makes the agent queue data.
+ *
+ * If the aggregator is unreachable or goes away, the agent reconnects with
+ * exponential backoff and starts over with full frames.
+ *
+ * Thread-safety: start()/stop() from the owning thread; the counters from any thread
+ */
+class FleetAgent {
+public:
+    FleetAgent(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder);
+    ~FleetAgent();
+    
+    FleetAgent(const FleetAgent&) = delete;
+    FleetAgent& operator=(const FleetAgent&) = delete;
+    
+    /**
+     * @brief Start streaming to @p aggregatorAddress ("host:port")
+     * @param hostName Name shown in the fleet view (empty = gethostname())
+     * @param topProcesses Processes sent per update, by CPU
+     * @return false only for an unusable address; an unreachable aggregator is retried
+     */
+    bool start(const std::string& aggregatorAddress, const std::string& hostName, size_t topProcesses);
+    
+    /**
+     * @brief Stop the sender thread and close the connection
+     */
+    void stop();
+    
+    bool connected() const { return fd_.load(std::memory_order_relaxed) >= 0; }
+    const std::string& hostName() const { return hostName_; }
+    uint64_t updatesSent() const { return updatesSent_.load(std::memory_order_relaxed); }
+    uint64_t connects() const { return connects_.load(std::memory_order_relaxed); }
+    uint64_t bytesSent() const { return bytesSent_.load(std::memory_order_relaxed); }
+    
+private:
+    void senderLoop();
+    bool connectToAggregator(std::string& error);
+    bool sendUpdate();
+    bool sendAll(const std::string& bytes);
+    void disconnect();
+    
+    SystemDataCollector& dataCollector_;
+    ProcessTreeBuilder& processBuilder_;
+    std::string address_;
+    std::string hostName_;
+    size_t topProcesses_{0};
+    ChangeNotifier::SubscriptionId metricsSubscription_{0};
+    ChangeNotifier::SubscriptionId processSubscription_{0};
+    
+    std::atomic<int> fd_{-1};
+    std::atomic<bool> running_{false};
+    std::thread senderThread_;
+    std::mutex mutex_;
+    std::condition_variable wakeCv_;
+    bool pending_{false};
+    
+    std::atomic<uint64_t> updatesSent_{0};
+    std::atomic<uint64_t> connects_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    
+    // Sender-thread state: what the aggregator last received on this connection
+    uint64_t sentMetricsVersion_{0};
+    uint64_t sentProcessVersion_{0};
+    SystemMetrics sentMetrics_;
+    SystemMetrics metrics_;
+    std::vector<ProcessSummary> sentProcesses_;
+    std::vector<ProcessSummary> processes_;
+    std::string outbox_;
+    recording::ProcessDeltaScratch scratch_;
+};
+
+} // namespace sysmon
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ChangeNotifier.h"
+#include "SnapshotStream.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Latest state of one host reporting to a FleetAggregator
+ */
+struct FleetHost {
+    std::string name;                           // Announced by the agent
+    uint32_t connections{0};                    // Agents connected under this name (normally 0 or 1)
+    uint64_t lastUpdateMs{0};                   // Local wall-clock time the last metrics arrived
+    uint64_t updates{0};                        // Metrics frames received
+    SystemMetrics metrics;                      // Per-device counters are not streamed
+    std::vector<ProcessSummary> topProcesses;   // The agent's top processes by CPU, in pid order
+    
+    bool online() const { return connections > 0; }
+};
+
+/**
+ * @brief Receives the snapshots of many --agent hosts over TCP (--fleet)
+ *
+ * One thread multiplexes every agent connection with epoll, decoding frames
+ * as they arrive into the connection's own delta bases and then copying the
+ * result into the shared host table. Hosts are keyed by announced name and
+ * stay in the table (offline) after their agent disconnects, so a restarted
+ * agent picks up its old row.
+ *
+ * With agents updating about once a second, changes are published at most
+ * every PUBLISH_INTERVAL rather than per frame, so subscribers such as the UI
+ * see one batched update instead of thousands.
+ *
+ * Linux only (epoll).
+ * Thread-safety: start()/stop() from the owning thread; queries from any thread
+ */
+class FleetAggregator {
+public:
+    static constexpr auto PUBLISH_INTERVAL = std::chrono::milliseconds(200);
+    
+    FleetAggregator() = default;
+    ~FleetAggregator();
+    
+    FleetAggregator(const FleetAggregator&) = delete;
+    FleetAggregator& operator=(const FleetAggregator&) = delete;
+    
+    /**
+     * @brief Listen on @p listenAddress ("host:port" or ":port") and start accepting agents
+     */
+    bool start(const std::string& listenAddress);
+    
+    /**
+     * @brief Disconnect every agent and close the listening socket
+     */
+    void stop();
+    
+    /**
+     * @brief Copy every known host, without process lists (order unspecified)
+     */
+    void getHosts(std::vector<FleetHost>& out) const;
+    
+    /**
+     * @brief Copy one host including its top processes
+     * @return false if no agent ever announced @p name
+     */
+    bool getHost(const std::string& name, FleetHost& out) const;
+    
+    /**
+     * @brief Version of the host table (0 = nothing received yet)
+     */
+    uint64_t getVersion() const { return notifier_.version(); }
+    
+    ChangeNotifier::SubscriptionId subscribe(ChangeNotifier::Callback callback) {
+        return notifier_.subscribe(std::move(callback));
+    }
+    void unsubscribe(ChangeNotifier::SubscriptionId id) { notifier_.unsubscribe(id); }
+    
+    size_t connectedAgents() const { return connectedAgents_.load(std::memory_order_relaxed); }
+    uint64_t framesReceived() const { return framesReceived_.load(std::memory_order_relaxed); }
+    uint64_t bytesReceived() const { return bytesReceived_.load(std::memory_order_relaxed); }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t NO_HOST = static_cast<size_t>(-1);
+    
+    struct Connection {
+        int fd{-1};
+        size_t host{NO_HOST};               // Index into hosts_ once the AgentHello arrived
+        std::string inbox;                  // Bytes of an incomplete frame
+        
+        // Bases of the agent's next deltas
+        SystemMetrics metrics;
+        std::vector<ProcessSummary> processes;
+        std::vector<ProcessSummary> nextProcesses;
+    };
+    
+    void eventLoop();
+    void acceptAgents();
+    bool readFromAgent(Connection& connection);
+    bool handleFrame(Connection& connection, stream::FrameKind kind, const uint8_t* payload, size_t size);
+    void closeConnection(Connection& connection);
+    int waitTimeoutMs(Clock::time_point now) const;
+    
+    int listenFd_{-1};
+    int epollFd_{-1};
+    int wakeFd_{-1};
+    std::atomic<bool> running_{false};
+    std::thread loopThread_;
+    ChangeNotifier notifier_;
+    
+    std::atomic<size_t> connectedAgents_{0};
+    std::atomic<uint64_t> framesReceived_{0};
+    std::atomic<uint64_t> bytesReceived_{0};
+    
+    // Loop-thread state; connections are indexed by fd
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::string receiveBuffer_;
+    recording::ProcessDeltaScratch scratch_;
+    bool dirty_{false};
+    Clock::time_point lastPublish_{};
+    
+    mutable std::mutex hostsMutex_;
+    std::vector<FleetHost> hosts_;
+    std::unordered_map<std::string, size_t> hostIndex_;
+};
+
+} // namespace sysmon
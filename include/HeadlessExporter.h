@@ -0,0 +1,91 @@
+#pragma once
+
+#include "SystemDataCollector.h"
+#include "ProcessTreeBuilder.h"
+#include "Configuration.h"
+#include "MetricsSerializer.h"
+#include "AlertEngine.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Streams every published snapshot to stdout or a file (--headless)
+ *
+ * Snapshots are serialized on the collection thread into a pending buffer;
+ * a writer thread swaps it with a drained one and writes the whole batch in a
+ * single call. A slow consumer therefore only delays the writer: once the
+ * pending buffer reaches its cap further snapshots are dropped and counted
+ * instead of blocking collection.
+ *
+ * With an AlertEngine, fired and resolved alerts are interleaved with the
+ * snapshots as they happen (JSON Lines only).
+ *
+ * Thread-safety: start()/stop() from the owning thread; everything else is internal
+ */
+class HeadlessExporter {
+public:
+    HeadlessExporter(SystemDataCollector& dataCollector,
+                     ProcessTreeBuilder& processBuilder,
+                     const Configuration& config,
+                     AlertEngine* alerts = nullptr);
+    ~HeadlessExporter();
+    
+    HeadlessExporter(const HeadlessExporter&) = delete;
+    HeadlessExporter& operator=(const HeadlessExporter&) = delete;
+    
+    /**
+     * @brief Open the output and start streaming
+     * @return false if the output can't be opened or the format is unknown
+     */
+    bool start();
+    
+    /**
+     * @brief Stop streaming and flush everything still pending
+     */
+    void stop();
+    
+    /**
+     * @brief Snapshots dropped because the writer fell behind
+     */
+    uint64_t droppedSnapshots() const { return dropped_.load(std::memory_order_relaxed); }
+    
+private:
+    void onSnapshot();
+    void onAlerts();
+    void writerLoop();
+    
+    SystemDataCollector& dataCollector_;
+    ProcessTreeBuilder& processBuilder_;
+    Configuration config_;
+    
+    MetricsSerializer serializer_;
+    ChangeNotifier::SubscriptionId subscription_{0};
+    AlertEngine* alerts_;
+    ChangeNotifier::SubscriptionId alertSubscription_{0};
+    uint64_t alertCursor_{0};                   // Last event sequence written
+    std::vector<AlertEvent> alertEvents_;
+    std::FILE* output_{nullptr};
+    bool ownsOutput_{false};
+    
+    // Collection-thread scratch, reused for every snapshot
+    SystemMetrics metrics_;
+    std::vector<ProcessSummary> topProcesses_;
+    ProcessGroups groups_;
+    
+    std::mutex bufferMutex_;
+    std::condition_variable bufferCv_;
+    std::string pending_;       // Filled by the collection thread
+    std::string writing_;       // Drained by the writer thread
+    bool running_{false};
+    std::atomic<uint64_t> dropped_{0};
+    std::thread writerThread_;
+};
+
+} // namespace sysmon
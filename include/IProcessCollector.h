@@ -1,11 +1,19 @@
 #pragma once
 
-#include "ProcessInfo.h"
-#include <vector>
+#include "ProcessTable.h"
+#include "Configuration.h"
 #include <memory>
 
 namespace sysmon {
 
+/**
+ * @brief How much work a collector spends per process
+ */
+enum class ProcessDetail {
+    Full,       // Re-read every process on every scan
+    Reduced     // Collector may reuse cached data for idle processes
+};
+
 /**
  * @brief Platform abstraction interface for process enumeration
  */
@@ -14,10 +22,11 @@ public:
     virtual ~IProcessCollector() = default;
     
     /**
-     * @brief Enumerate all accessible processes
-     * @return Vector of process information structures
+     * @brief Append a row to @p out for every accessible process
+     * @note @p out arrives empty, keeping the capacity of an earlier scan; links are left
+     *       to the caller's ProcessTable::buildTree()
      */
-    virtual std::vector<std::unique_ptr<ProcessInfo>> enumerateProcesses() = 0;
+    virtual void enumerateProcesses(ProcessTable& out) = 0;
     
     /**
      * @brief Terminate a specific process
@@ -26,6 +35,12 @@ public:
      */
     virtual bool terminateProcess(uint32_t pid) = 0;
     
+    /**
+     * @brief Trade per-process accuracy for lower scan cost
+     * @note Collectors without a cheaper mode ignore this
+     */
+    virtual void setDetail(ProcessDetail /*detail*/) {}
+    
     /**
      * @brief Initialize collector
      */
@@ -40,6 +55,6 @@ public:
 /**
  * @brief Factory function to create platform-specific process collector
  */
-std::unique_ptr<IProcessCollector> createProcessCollector();
+std::unique_ptr<IProcessCollector> createProcessCollector(const Configuration& config);
 
 } // namespace sysmon
@@ -1,13 +1,14 @@
 #pragma once
 
 #include "SystemMetrics.h"
+#include "Configuration.h"
 #include <memory>
 
 namespace sysmon {
 
 /**
  * @brief Platform abstraction interface for system metric collection
- * 
+ *
  * Platform-specific implementations provide concrete behavior
  */
 class ISystemCollector {
@@ -48,6 +49,6 @@ public:
 /**
  * @brief Factory function to create platform-specific collector
  */
-std::unique_ptr<ISystemCollector> createSystemCollector();
+std::unique_ptr<ISystemCollector> createSystemCollector(const Configuration& config);
 
 } // namespace sysmon
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Instrumented operations, one latency histogram each
+ */
+enum class TraceSource : uint8_t {
+    CollectCPU,
+    CollectMemory,
+    CollectDisk,
+    CollectNetwork,
+    EnumerateProcesses,
+    BuildTree,
+    IndexNames,
+    GroupProcesses,
+    DiffProcesses,
+    GetSnapshot,
+    RenderCPU,
+    RenderMemory,
+    RenderDisk,
+    RenderNetwork,
+    RenderProcessTree,
+    RenderStatusBar,
+    RenderFleet,
+    Count
+};
+
+/**
+ * @brief Display name for a trace source
+ */
+const char* traceSourceName(TraceSource source);
+
+/**
+ * @brief HDR-style latency histogram in nanoseconds
+ *
+ * Log-linear buckets: 16 linear sub-buckets per power of two, giving ~6%
+ * worst-case relative error at any magnitude with a fixed 1k-bucket array.
+ * Thread-safety: record() is lock-free; readers see a racy but consistent-enough view.
+ */
+class LatencyHistogram {
+public:
+    void record(uint64_t nanos);
+    
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Approximate value at quantile @p q (0.0 - 1.0)
+     */
+    uint64_t percentile(double q) const;
+    
+private:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+    
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketMidpoint(size_t index);
+    
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief Process-wide self-instrumentation registry
+ *
+ * Disabled by default; when disabled ScopedTimer costs one relaxed atomic load.
+ * Span capture for Chrome trace export is a separate opt-in ring buffer.
+ */
+class Instrumentation {
+public:
+    struct Span {
+        TraceSource source{TraceSource::Count};
+        uint32_t threadId{0};
+        uint64_t startNs{0};
+        uint64_t durationNs{0};
+    };
+    
+    static Instrumentation& instance();
+    
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Start keeping the most recent @p capacity spans for trace export
+     * @note Call before collection threads start
+     */
+    void enableSpanCapture(size_t capacity);
+    
+    void record(TraceSource source, uint64_t startNs, uint64_t durationNs);
+    
+    const LatencyHistogram& histogram(TraceSource source) const {
+        return histograms_[static_cast<size_t>(source)];
+    }
+    
+    /**
+     * @brief Write captured spans as Chrome trace-event JSON (chrome://tracing, Perfetto)
+     * @note Call after collection threads have stopped
+     */
+    bool writeChromeTrace(const std::string& path) const;
+    
+    /**
+     * @brief Nanoseconds on the monotonic clock used for all spans
+     */
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+    
+private:
+    Instrumentation() = default;
+    
+    static uint32_t currentThreadId();
+    
+    std::atomic<bool> enabled_{false};
+    std::array<LatencyHistogram, static_cast<size_t>(TraceSource::Count)> histograms_;
+    
+    std::unique_ptr<Span[]> spans_;
+    size_t spanCapacity_{0};
+    std::atomic<uint64_t> spanCount_{0};
+};
+
+/**
+ * @brief Records the lifetime of the enclosing scope against a trace source
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(TraceSource source)
+        : source_(source),
+          startNs_(Instrumentation::instance().enabled() ? Instrumentation::nowNs() : 0) {
+    }
+    
+    ~ScopedTimer() {
+        if (startNs_ != 0) {
+            Instrumentation::instance().record(source_, startNs_, Instrumentation::nowNs() - startNs_);
+        }
+    }
+    
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    
+private:
+    TraceSource source_;
+    uint64_t startNs_;
+};
+
+} // namespace sysmon
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "SystemDataCollector.h"
+#include "ProcessTreeBuilder.h"
+#include "Configuration.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Exposition flavour negotiated from the scrape's Accept header
+ */
+enum class ExpositionFormat {
+    PrometheusText,     // text/plain; version=0.0.4
+    OpenMetrics         // application/openmetrics-text; version=1.0.0
+};
+
+/**
+ * @brief Append every sysmon series for one snapshot in @p format to @p out
+ *
+ * System gauges, per-core usage, per-device byte counters, @p topProcesses
+ * (CPU and memory, labelled by pid and name) and @p groups (CPU, memory
+ * and process count, labelled by grouping and key).
+ */
+void appendExposition(const SystemMetrics& metrics, const std::vector<ProcessSummary>& topProcesses,
+                      const ProcessGroups& groups, ExpositionFormat format, std::string& out);
+
+/**
+ * @brief Embedded HTTP listener serving /metrics for Prometheus (--metrics-listen)
+ *
+ * A single thread accepts and answers scrapes one at a time. The body is
+ * rendered on the server thread from copies of the latest snapshots, and only
+ * when a collector has published since the previous render; otherwise the
+ * cached body is resent. Collector threads do no work for scrapes beyond the
+ * brief lock taken to copy their snapshot.
+ *
+ * Thread-safety: start()/stop() from the owning thread; everything else is internal
+ */
+class MetricsHttpServer {
+public:
+    MetricsHttpServer(SystemDataCollector& dataCollector,
+                      ProcessTreeBuilder& processBuilder,
+                      const Configuration& config);
+    ~MetricsHttpServer();
+    
+    MetricsHttpServer(const MetricsHttpServer&) = delete;
+    MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+    
+    /**
+     * @brief Bind config.metricsListen ("host:port" or ":port") and start serving
+     * @return false if the address is invalid or can't be bound
+     */
+    bool start();
+    
+    /**
+     * @brief Stop serving and close the listening socket
+     */
+    void stop();
+    
+    uint64_t scrapesServed() const { return scrapes_.load(std::memory_order_relaxed); }
+    
+private:
+    // Rendered body for one format, reused until a collector publishes again
+    struct CachedBody {
+        std::string body;
+        uint64_t metricsVersion{0};
+        uint64_t processVersion{0};
+        bool valid{false};
+    };
+    
+    void serverLoop();
+    void handleConnection(int fd);
+    const std::string& renderBody(ExpositionFormat format);
+    
+    SystemDataCollector& dataCollector_;
+    ProcessTreeBuilder& processBuilder_;
+    Configuration config_;
+    
+    int listenFd_{-1};
+    int wakePipe_[2]{-1, -1};
+    std::atomic<bool> running_{false};
+    std::thread serverThread_;
+    std::atomic<uint64_t> scrapes_{0};
+    
+    // Server-thread scratch, reused for every scrape
+    SystemMetrics metrics_;
+    std::vector<ProcessSummary> topProcesses_;
+    ProcessGroups groups_;
+    CachedBody textBody_;
+    CachedBody openMetricsBody_;
+    std::string request_;
+    std::string header_;
+};
+
+} // namespace sysmon
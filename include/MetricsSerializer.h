@@ -0,0 +1,89 @@
+#pragma once
+
+#include "SystemMetrics.h"
+#include "ProcessInfo.h"
+#include "AlertRules.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+struct ProcessGroups;
+
+/**
+ * @brief Output encodings supported by the headless exporter
+ */
+enum class ExportFormat {
+    JsonLines,  // One JSON object per snapshot
+    Csv,        // Header row, then one row per snapshot
+    Binary      // u32 little-endian length prefix + fixed-layout record
+};
+
+/**
+ * @brief Parse "jsonl", "csv" or "binary"
+ * @return false if @p name is not a known format
+ */
+bool parseExportFormat(const std::string& name, ExportFormat& format);
+
+/**
+ * @brief Encodes snapshots by appending to a caller-owned buffer
+ *
+ * Numbers are formatted with std::to_chars straight into the buffer, so once
+ * the buffer has grown to its steady-state size no further allocation happens.
+ *
+ * Binary record layout (all integers little-endian):
+ *   u32 length (bytes after this field), u8 version,
+ *   u64 timestampMs, f64 cpuPercent, u16 coreCount, f32 coreCpu[coreCount],
+ *   u64 totalMemory, u64 usedMemory, f64 memoryPercent,
+ *   u64 diskRead, u64 diskWrite, u64 netRecv, u64 netSend,
+ *   u16 processCount, { u32 pid, u32 ppid, f32 cpu, u64 memory, u8 nameLength, name }[processCount]
+ *
+ * Thread-safety: Not thread-safe
+ */
+class MetricsSerializer {
+public:
+    static constexpr uint8_t BINARY_VERSION = 1;
+    
+    explicit MetricsSerializer(ExportFormat format);
+    
+    /**
+     * @brief Append one snapshot (and its top processes) to @p out
+     *
+     * CSV columns are fixed by the first snapshot: its core count and the
+     * configured top-N decide the header, which is emitted before that row.
+     * @p groups (optional) goes into JSON Lines only, under a "groups" key;
+     * CSV and binary records have a fixed layout and skip it.
+     */
+    void serialize(const SystemMetrics& metrics, const std::vector<ProcessSummary>& topProcesses,
+                   std::string& out, const ProcessGroups* groups = nullptr);
+    
+    /**
+     * @brief Append a fired or resolved alert to @p out
+     *
+     * JSON Lines only, as an object with an "alert" key in place of the
+     * metrics; CSV and binary records have a fixed layout and skip alerts.
+     * @return false if the format doesn't carry alerts
+     */
+    bool serializeAlert(const AlertEvent& event, std::string& out) const;
+    
+    /**
+     * @brief Fix the number of process columns in CSV output
+     */
+    void setCsvProcessColumns(size_t count) { csvProcessColumns_ = count; }
+    
+private:
+    void serializeJson(const SystemMetrics& metrics, const std::vector<ProcessSummary>& topProcesses,
+                       const ProcessGroups* groups, std::string& out) const;
+    void serializeCsv(const SystemMetrics& metrics, const std::vector<ProcessSummary>& topProcesses,
+                      std::string& out);
+    void serializeBinary(const SystemMetrics& metrics, const std::vector<ProcessSummary>& topProcesses,
+                         std::string& out) const;
+    
+    ExportFormat format_;
+    bool csvHeaderWritten_{false};
+    size_t csvCoreColumns_{0};
+    size_t csvProcessColumns_{0};
+};
+
+} // namespace sysmon
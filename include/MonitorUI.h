@@ -2,22 +2,43 @@
 
 #include "SystemDataCollector.h"
 #include "ProcessTreeBuilder.h"
+#include "ProcessOrder.h"
+#include "ProcessHistory.h"
 #include "Configuration.h"
+#include "FleetAggregator.h"
+#include "AnomalyMonitor.h"
+#include "AlertEngine.h"
 #include <ftxui/component/component.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ftxui {
+class Screen;
+class ScreenInteractive;
+}
 
 namespace sysmon {
 
 /**
  * @brief Main UI controller orchestrating all interface components
  * 
- * Manages FTXUI components, navigation, and rendering
+ * Manages FTXUI components, navigation, and rendering. With a FleetAggregator
+ * (--fleet) the main view is a sortable table of agent hosts instead, and
+ * Enter drills into one host using the same widgets as the local view.
  */
 class MonitorUI {
 public:
     MonitorUI(SystemDataCollector& dataCollector,
               ProcessTreeBuilder& processBuilder,
-              const Configuration& config);
+              const Configuration& config,
+              const CpuBudgetGovernor* governor = nullptr,
+              FleetAggregator* fleet = nullptr,
+              AnomalyMonitor* anomalies = nullptr,
+              AlertEngine* alerts = nullptr);
     
     /**
      * @brief Run the UI event loop (blocking)
@@ -29,6 +50,13 @@ public:
      */
     void shutdown();
     
+    /**
+     * @brief Draw the process tree panel once into @p screen, without a terminal
+     *
+     * Pulls the latest tree first, as a frame would. Used by benchmarks.
+     */
+    void renderProcessTree(ftxui::Screen& screen);
+    
 private:
     ftxui::Component createMainLayout();
     ftxui::Component createCPUWidget();
@@ -37,14 +65,157 @@ private:
     ftxui::Component createNetworkWidget();
     ftxui::Component createProcessTreeWidget();
     ftxui::Component createStatusBar();
+    ftxui::Component createDebugPanel();
+    ftxui::Component createFleetLayout();
+    ftxui::Component createFleetTableWidget();
+    ftxui::Component createHostProcessWidget();
+    
+    enum class FleetSortKey { Name, Cpu, Memory, Disk, Network };
+    
+    /**
+     * @brief Handle fleet navigation keys; false if @p event isn't one
+     */
+    bool handleFleetEvent(const ftxui::Event& event);
+    
+    /**
+     * @brief Handle process filter keys ('/' to type, Esc to clear); false if @p event isn't one
+     */
+    bool handleFilterEvent(const ftxui::Event& event);
+    
+    /**
+     * @brief Re-parse filterInput_; a query that doesn't parse keeps the last good one
+     */
+    void updateFilter();
+    
+    /**
+     * @brief Handle process panel keys (sort key, tree/flat, grouping, selection); false if @p event isn't one
+     */
+    bool handleProcessEvent(const ftxui::Event& event);
+    
+    /**
+     * @brief Re-sort and re-filter the process panel's rows if the snapshot, order or filter changed
+     */
+    void updateShownProcesses();
+    
+    /**
+     * @brief Re-sort the grouped view's lines if the snapshot, grouping or order changed
+     */
+    void updateShownGroups();
+    
+    /**
+     * @brief The process panel as totals per executable, user or cgroup
+     */
+    ftxui::Element renderProcessGroups();
+    
+    /**
+     * @brief Detail pane for @p row: identity plus CPU, memory and I/O wait history
+     */
+    ftxui::Element renderProcessDetail(ProcessTable::Row row);
+    
+    /**
+     * @brief Order fleetHosts_ by the current sort key
+     */
+    void sortFleetHosts();
+    
+    /**
+     * @brief Metrics the CPU/memory/disk/network widgets show: the drilled-into host's, or local
+     */
+    const SystemMetrics& displayedMetrics() const;
+    
+    /**
+     * @brief Pull snapshots whose version changed since the last frame
+     */
+    void refreshSnapshots();
+    
+    /**
+     * @brief Mark the screen dirty (called from collector threads)
+     */
+    void requestRedraw();
+    
+    /**
+     * @brief Post redraw events for new snapshots, capped at targetFrameRateHz
+     */
+    void redrawLoop(ftxui::ScreenInteractive& screen);
     
     SystemDataCollector& dataCollector_;
     ProcessTreeBuilder& processBuilder_;
+    const CpuBudgetGovernor* governor_;
     Configuration config_;
     
-    bool shouldQuit_{false};
-    int selectedProcessIndex_{0};
+    // Snapshots rendered by the widgets, re-pulled only when their version changes
+    SystemMetrics metrics_;
+    SamplingIntervals intervals_;
+    uint64_t metricsVersion_{0};
+    ProcessSnapshotPtr processSnapshot_;        // Held until a newer version is published
+    
+    // Active anomalies, largest |z| first (UI thread only)
+    AnomalyMonitor* anomalies_;
+    std::vector<Anomaly> activeAnomalies_;
+    uint64_t anomalyVersion_{0};
+    
+    // Firing alert rules, oldest first (UI thread only)
+    AlertEngine* alerts_;
+    std::vector<ActiveAlert> activeAlerts_;
+    uint64_t alertVersion_{0};
+    
+    std::mutex redrawMutex_;
+    std::condition_variable redrawCv_;
+    bool redrawPending_{false};
+    bool loopExited_{false};
+    
+    // Process filter (UI thread only)
+    ProcessFilter processFilter_;
+    std::string filterInput_;                   // As typed
+    std::string filterError_;                   // Why filterInput_ doesn't parse (empty = it does)
+    bool editingFilter_{false};
+    std::vector<uint8_t> filterVisibility_;     // ProcessFilter::Visibility per row of the snapshot
+    uint64_t filteredVersion_{0};               // Snapshot filterVisibility_ was computed for
+    bool filterStale_{true};                    // Query changed since
+    
+    // Process order and selection (UI thread only)
+    ProcessOrder processOrder_;
+    ProcessSortKey processSortKey_{ProcessSortKey::Cpu};
+    bool processSortDescending_{true};
+    bool flatProcessList_{false};
+    uint64_t orderedVersion_{0};                // Snapshot processOrder_ was computed for
+    bool orderStale_{true};                     // Sort key or mode changed since
+    std::vector<ProcessTable::Row> shownRows_;  // What the panel lists, in order (filtered, collapsed)
+    std::vector<uint32_t> shownDepths_;
+    size_t selectedLine_{0};                    // Into shownRows_
+    uint32_t selectedPid_{0};                   // With selectedStart_, so the selection survives re-sorting
+    uint64_t selectedStart_{0};
+    size_t firstShownLine_{0};                  // Scroll position
+    bool showProcessDetail_{false};
+    
+    // Grouped view, ordered by the same sort key (UI thread only)
+    bool showGroups_{false};
+    ProcessGrouping processGrouping_{ProcessGrouping::Executable};
+    uint64_t groupedVersion_{0};                // Snapshot shownGroups_ was sorted for
+    bool groupsStale_{true};                    // Grouping or sort key changed since
+    std::vector<uint32_t> shownGroups_;         // Into the snapshot's groups of processGrouping_, in order
+    size_t selectedGroupLine_{0};               // Into shownGroups_
+    std::string selectedGroupKey_;              // So the selection survives re-sorting
+    size_t firstShownGroupLine_{0};
+    
+    // Per-process sparkline history, recorded from every snapshot pulled (UI thread only)
+    ProcessHistory processHistory_;
+    std::vector<double> historySamples_;        // Scratch for one series
+    
+    std::atomic<bool> shouldQuit_{false};
     bool showKillConfirmation_{false};
+    
+    // Fleet view (UI thread only)
+    FleetAggregator* fleet_;
+    std::vector<FleetHost> fleetHosts_;         // Sorted by fleetSortKey_
+    uint64_t fleetVersion_{0};
+    FleetSortKey fleetSortKey_{FleetSortKey::Cpu};
+    bool fleetSortDescending_{true};
+    bool fleetSortPending_{false};
+    std::string selectedHost_;                  // By name, so it survives re-sorting
+    bool showHostDetail_{false};
+    FleetHost hostDetail_;                      // Drilled-into host, top processes by CPU
+    
+    ftxui::Component offscreenProcessTree_;     // renderProcessTree() only
 };
 
 } // namespace sysmon
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include <cstdint>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief What changed between two consecutive process scans
+ *
+ * Processes are matched by (pid, creationTime), so a reused pid shows up
+ * as one removal and one addition. Rows index the newer table; removed
+ * processes are copied out because the older table is recycled. A process
+ * can be both reparented and changed.
+ */
+struct ProcessDelta {
+    uint64_t baseVersion{0};                        // Snapshot the delta is against (0 = none, all added)
+    std::vector<ProcessTable::Row> added;           // Spawned since the base scan
+    std::vector<ProcessSummary> removed;            // Exited, as last seen
+    std::vector<ProcessTable::Row> reparented;      // parentPid differs (e.g. adopted by a subreaper)
+    std::vector<ProcessTable::Row> changed;         // CPU or memory moved beyond the epsilons
+    
+    /**
+     * @brief Replace the contents with the changes from @p previous to @p current
+     *
+     * O(n) with one pid index over @p previous. A process counts as changed
+     * when its CPU moved by more than @p cpuEpsilon percentage points or its
+     * memory by more than @p memoryEpsilonBytes. Reuses the lists' storage.
+     */
+    void compute(const ProcessTable& previous, const ProcessTable& current,
+                 double cpuEpsilon, uint64_t memoryEpsilonBytes);
+    
+    bool empty() const {
+        return added.empty() && removed.empty() && reparented.empty() && changed.empty();
+    }
+};
+
+} // namespace sysmon
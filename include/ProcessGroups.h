@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ProcessSearch.h"
+#include "ProcessTable.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief What processes are aggregated by
+ */
+enum class ProcessGrouping {
+    Executable,     // Process name
+    User,           // Owner (effective uid)
+    Cgroup          // Control group, i.e. container or systemd unit
+};
+
+constexpr size_t PROCESS_GROUPINGS = 3;
+
+/**
+ * @brief Parse "executable", "user" or "cgroup" (as in group_by); false if it is none of them
+ */
+bool parseProcessGrouping(std::string_view text, ProcessGrouping& grouping);
+
+/**
+ * @brief The name parseProcessGrouping() accepts for @p grouping
+ */
+const char* processGroupingName(ProcessGrouping grouping);
+
+/**
+ * @brief Processes sharing one executable, owner or control group, summed
+ */
+struct ProcessGroup {
+    std::string key;                // Name, user name (or uid), or cgroup path; "?" where unknown
+    double cpuPercent{0.0};
+    uint64_t memoryBytes{0};
+    uint32_t processCount{0};
+};
+
+/**
+ * @brief One scan's processes aggregated every way, each list heaviest CPU first
+ */
+struct ProcessGroups {
+    std::vector<ProcessGroup> byExecutable;
+    std::vector<ProcessGroup> byUser;
+    std::vector<ProcessGroup> byCgroup;
+    
+    const std::vector<ProcessGroup>& of(ProcessGrouping grouping) const {
+        return grouping == ProcessGrouping::Executable ? byExecutable
+             : grouping == ProcessGrouping::User ? byUser : byCgroup;
+    }
+    std::vector<ProcessGroup>& of(ProcessGrouping grouping) {
+        return grouping == ProcessGrouping::Executable ? byExecutable
+             : grouping == ProcessGrouping::User ? byUser : byCgroup;
+    }
+};
+
+/**
+ * @brief Aggregates each scan by executable, user and control group, built by ProcessTreeBuilder
+ *
+ * One pass over the rows feeds all three: the executable comes from the
+ * scan's name index (names already interned, so no string hashing), the
+ * control group from the table's dense cgroup ids and the user from a
+ * small hash map on uid. User names are resolved once per uid and cached.
+ * Groups keep their strings' storage between scans, so a steady set of
+ * groups re-aggregates without allocating.
+ *
+ * Thread-safety: None; owned by the enumeration thread
+ */
+class ProcessGrouper {
+public:
+    /**
+     * @brief Aggregate @p table into @p out
+     * @note @p names must index @p table; reuses @p out's storage
+     */
+    void group(const ProcessTable& table, const ProcessNameIndex& names, ProcessGroups& out);
+    
+private:
+    const std::string& userName(uint32_t uid);
+    
+    std::unordered_map<uint32_t, std::string> userNames_;
+    std::unordered_map<uint32_t, uint32_t> groupOfUid_;    // Scratch: uid -> group of this scan
+    std::vector<uint32_t> groupOfName_;                     // Scratch: name id -> group of this scan
+};
+
+} // namespace sysmon
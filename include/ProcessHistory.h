@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Recent CPU, memory and I/O wait samples of live processes, for sparklines
+ *
+ * A tracked process owns one slot of a pooled slab: a ring of its last
+ * SAMPLES scans in each series. Slots come from a free list, go back to it
+ * when their process exits, and never number more than the cap, so memory
+ * stays bounded however many processes run. While slots are free every
+ * process gets one; at the cap a process only gets one by being viewed,
+ * and then takes the slot viewed least recently.
+ *
+ * Processes are matched between scans by (pid, start time), with a
+ * merge-join when the table lists pids in ascending order (as /proc does).
+ *
+ * Thread-safety: None; fed from snapshots on the UI thread
+ */
+class ProcessHistory {
+public:
+    static constexpr size_t SAMPLES = 60;
+    
+    enum class Series { Cpu, Memory, IoWait };
+    
+    /**
+     * @param maxProcesses Slot cap (0 = keep no history)
+     */
+    explicit ProcessHistory(size_t maxProcesses);
+    
+    /**
+     * @brief Append one scan; rows of @p table address the history until the next call
+     */
+    void record(const ProcessTable& table);
+    
+    /**
+     * @brief Note that @p row of the last recorded table is on screen
+     *
+     * A row without a slot gets a free one, or else the least recently
+     * viewed, and starts with an empty history.
+     */
+    void view(const ProcessTable& table, ProcessTable::Row row);
+    
+    /**
+     * @brief @p row's samples of @p series, oldest first, into @p out
+     * @return false (and @p out empty) if @p row has no history
+     */
+    bool history(ProcessTable::Row row, Series series, std::vector<double>& out) const;
+    
+    size_t trackedCount() const { return slots_.size() - freeSlots_.size(); }
+    
+    /**
+     * @brief Heap bytes the slab and its bookkeeping hold
+     */
+    size_t memoryFootprint() const;
+    
+private:
+    struct Slot {
+        uint32_t pid{0};
+        uint64_t startTime{0};
+        uint64_t lastViewed{0};                     // viewClock_ of the last view (0 = never)
+        uint32_t row{ProcessTable::NONE};           // In the last recorded table; NONE = free
+        uint16_t next{0};                           // Ring position the next sample goes to
+        uint16_t count{0};                          // Samples held, up to SAMPLES
+    };
+    
+    /**
+     * @brief A free slot, a new one below the cap, or NONE
+     */
+    uint32_t takeFreeSlot();
+    void assign(uint32_t slot, const ProcessTable& table, ProcessTable::Row row);
+    
+    size_t maxSlots_;
+    
+    // The slab: slot s owns [s * SAMPLES, (s + 1) * SAMPLES) of each series
+    std::vector<float> cpu_;
+    std::vector<uint64_t> memory_;
+    std::vector<float> ioWait_;
+    
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+    std::vector<uint32_t> slotOfRow_;               // Last recorded table's row -> slot (NONE = untracked)
+    std::vector<uint32_t> matchOrder_;              // Scratch: tracked slots by pid
+    uint64_t viewClock_{0};
+};
+
+} // namespace sysmon
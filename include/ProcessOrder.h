@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sysmon {
+
+enum class ProcessSortKey { Cpu, Memory, Name, Pid };
+
+/**
+ * @brief Parse "cpu", "memory", "name" or "pid" (as in sort_by); false if it is none of them
+ */
+bool parseProcessSortKey(std::string_view text, ProcessSortKey& key);
+
+/**
+ * @brief Display order of one scan's processes, as a sorted tree or a sorted flat list
+ *
+ * In tree mode every sibling group (and the roots) is sorted and the rows
+ * come out in pre-order with their depth; in flat mode all rows are one
+ * group. Ties go to the lower pid, so the order is total.
+ *
+ * The order is kept between scans: update() first lays the new table out
+ * in the previous order, matching processes by (pid, start time) and
+ * appending new ones, then repairs each group. Small groups are
+ * insertion-sorted; large ones pull out the rows that break the order,
+ * sort just those and merge them back, O(n + k log k) for k displaced
+ * rows. Between scans few processes change rank, so a re-sort costs about
+ * one pass instead of O(n log n).
+ *
+ * Thread-safety: None; used on the UI thread
+ */
+class ProcessOrder {
+public:
+    /**
+     * @brief Re-order for @p table, starting from the order of the last call
+     * @param descending Largest first; ties still go to the lower pid
+     * @param tree Sort within sibling groups and keep the hierarchy, else one flat list
+     */
+    void update(const ProcessTable& table, ProcessSortKey key, bool descending, bool tree);
+    
+    /**
+     * @brief Rows of the last updated table in display order
+     */
+    std::span<const ProcessTable::Row> rows() const { return order_; }
+    
+    /**
+     * @brief Tree depth of each entry of rows() (all 0 in flat mode)
+     */
+    std::span<const uint32_t> depths() const { return depths_; }
+    
+    /**
+     * @brief Rows the last update() had to move out of their previous order
+     */
+    size_t displaced() const { return displaced_; }
+    
+private:
+    struct RowLess;
+    
+    void seed(const ProcessTable& table);
+    void sortGroup(ProcessTable::Row* first, ProcessTable::Row* last, const RowLess& less);
+    
+    // The previous table's processes in its row order, with their display position
+    std::vector<uint32_t> previousPid_;
+    std::vector<uint64_t> previousStart_;
+    std::vector<uint32_t> previousPosition_;
+    
+    std::vector<uint32_t> positionOfRow_;           // Scratch: row -> previous position (NONE = new)
+    std::vector<ProcessTable::Row> slots_;          // Scratch: previous position -> row
+    std::vector<ProcessTable::Row> seeded_;         // Rows in the previous order, new rows last
+    std::vector<uint32_t> groupStart_;              // Tree mode: group (0 = roots, row + 1) -> first child
+    std::vector<ProcessTable::Row> children_;       // Tree mode: rows grouped by parent, each group sorted
+    std::vector<std::pair<uint32_t, uint32_t>> stack_; // Tree mode: open groups of the walk
+    std::vector<ProcessTable::Row> inOrder_;        // Scratch: rows of a group already in order
+    std::vector<ProcessTable::Row> displacedRows_;  // Scratch: rows of a group that are not
+    
+    std::vector<ProcessTable::Row> order_;
+    std::vector<uint32_t> depths_;
+    size_t displaced_{0};
+};
+
+} // namespace sysmon
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <regex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief One scan's rows grouped by interned name, built by ProcessTreeBuilder
+ *
+ * Name ids come from a dictionary that outlives the scan, so a name keeps
+ * its id from one snapshot to the next while @c dictionary is unchanged.
+ * Anything that caches a per-name result (ProcessFilter) then only has to
+ * look at names it has not seen before.
+ */
+struct ProcessNameIndex {
+    uint64_t dictionary{0};                         // Ids are comparable between indexes with the same dictionary
+    std::vector<uint32_t> nameIdOfRow;              // Row -> name id
+    std::vector<uint32_t> groupIds;                 // Name id of each group, in first-seen row order
+    std::vector<uint32_t> groupStart;               // Group -> first entry in groupRows; one extra at the end
+    std::vector<ProcessTable::Row> groupRows;       // Rows of each group, in row order
+    
+    size_t groupCount() const { return groupIds.size(); }
+    
+    std::span<const ProcessTable::Row> rows(size_t group) const {
+        return std::span<const ProcessTable::Row>(groupRows).subspan(groupStart[group],
+                                                                     groupStart[group + 1] - groupStart[group]);
+    }
+};
+
+/**
+ * @brief Interns process names across scans and fills a ProcessNameIndex per scan
+ *
+ * One hash lookup per row and no allocation for names already seen. The
+ * dictionary is dropped (and a new dictionary number issued) once it holds
+ * far more names than a scan uses, so short-lived names can't grow it
+ * without bound.
+ *
+ * Thread-safety: None; owned by the enumeration thread
+ */
+class ProcessNameInterner {
+public:
+    void index(const ProcessTable& table, ProcessNameIndex& out);
+    
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+    };
+    
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> ids_;
+    uint64_t dictionary_{1};
+    std::vector<uint32_t> groupOfId_;               // Scratch: name id -> group of this scan
+};
+
+/**
+ * @brief Incremental process filter typed in the UI
+ *
+ * A query is whitespace-separated terms that must all hold:
+ *   word          name contains word (case-insensitive)
+ *   /regex/       name matches the ECMAScript regex (case-insensitive; closing / optional)
+ *   user:<name>   owned by the user name or numeric uid
+ *   state:<RSDZ>  scheduler state is one of the letters
+ *
+ * Name terms are evaluated once per distinct name, not per process, and
+ * the results are kept per name id: between scans of the same dictionary
+ * only newly seen names are tested, and after a keystroke only the
+ * distinct names are. Matching rows keep their ancestors visible.
+ *
+ * Thread-safety: None; used on the UI thread
+ */
+class ProcessFilter {
+public:
+    enum Visibility : uint8_t {
+        HIDDEN = 0,
+        ANCESTOR = 1,       // Shown only to keep a match's chain visible
+        MATCH = 2
+    };
+    
+    /**
+     * @brief Replace the query; an empty one matches everything
+     * @return false with @p error describing the bad term (the filter is unchanged)
+     */
+    bool setQuery(std::string_view query, std::string& error);
+    
+    const std::string& query() const { return query_; }
+    bool active() const { return !terms_.empty(); }
+    
+    /**
+     * @brief Mark every row of @p table HIDDEN, ANCESTOR or MATCH
+     * @note @p names must index @p table; reuses @p visibility's storage
+     */
+    void apply(const ProcessTable& table, const ProcessNameIndex& names, std::vector<uint8_t>& visibility);
+    
+    /**
+     * @brief Rows marked MATCH by the last apply()
+     */
+    size_t matchCount() const { return matchCount_; }
+    
+private:
+    struct Term {
+        enum class Kind { Substring, Regex, User, State } kind;
+        std::string text;                           // Lower-cased word, or the state letters
+        std::regex regex;
+        uint32_t uid{0};
+    };
+    
+    bool nameMatches(std::string_view name) const;
+    
+    bool rowMatches(const ProcessTable& table, ProcessTable::Row row) const {
+        return (!filtersUid_ || table.uid(row) == uid_) &&
+               allowedStates_[static_cast<unsigned char>(table.state(row))];
+    }
+    
+    std::string query_;
+    std::vector<Term> terms_;
+    bool hasNameTerms_{false};
+    bool hasRowTerms_{false};
+    
+    // User and state terms folded together, so a row is two lookups
+    bool filtersUid_{false};
+    uint32_t uid_{0};
+    std::array<bool, 256> allowedStates_{};
+    
+    // Per name id of cachedDictionary_: 0 = not tested yet, else 1 + match
+    std::vector<uint8_t> nameResults_;
+    uint64_t cachedDictionary_{0};
+    std::vector<ProcessTable::Row> matches_;
+    size_t matchCount_{0};
+};
+
+} // namespace sysmon
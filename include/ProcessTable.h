@@ -0,0 +1,190 @@
+#pragma once
+
+#include "ProcessInfo.h"
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief One scan's processes as parallel arrays, linked into a tree by row index
+ *
+ * Row i describes one process in every column. Names are packed into one
+ * arena and addressed by (offset, length), so a table of any size is a
+ * dozen allocations that later scans reuse, instead of one heap node per
+ * process. buildTree() links rows through parent/firstChild/nextSibling in
+ * O(n); the roots are chained through nextSibling from firstRoot().
+ *
+ * buildTree() also lays the forest out in pre-order, so every subtree is
+ * one contiguous range of preorder() and ancestry is an interval check,
+ * and stores each row's subtree CPU and memory totals, accumulated once
+ * per scan in reverse pre-order.
+ *
+ * Control groups are stored once per table: addCgroup() registers a
+ * distinct path and rows refer to it by id, so a thousand processes in one
+ * container hold one copy of its path.
+ *
+ * Thread-safety: None; the builder fills a table on its enumeration thread
+ * and publishes it in an immutable snapshot.
+ */
+class ProcessTable {
+public:
+    using Row = uint32_t;
+    static constexpr Row NONE = std::numeric_limits<Row>::max();
+    static constexpr uint32_t UNKNOWN_UID = ProcessSummary::UNKNOWN_UID;
+    static constexpr char UNKNOWN_STATE = '?';
+    static constexpr uint32_t NO_CGROUP = std::numeric_limits<uint32_t>::max();
+    
+    Row size() const { return static_cast<Row>(pid_.size()); }
+    bool empty() const { return pid_.empty(); }
+    
+    /**
+     * @brief Drop every row but keep the storage for the next scan
+     */
+    void clear();
+    
+    void reserve(size_t rows);
+    
+    /**
+     * @brief Append one process; it is unlinked until buildTree()
+     * @param uid Owner (effective uid), UNKNOWN_UID where the platform has none
+     * @param state Scheduler state letter as in ps(1) (R, S, D, Z, T, ...)
+     * @param ioWaitPercent Share of the last interval spent waiting for block I/O, 0 where unknown
+     * @return The new row
+     */
+    Row add(uint32_t pid, uint32_t parentPid, std::string_view name, double cpuPercent,
+            uint64_t memoryBytes, uint64_t creationTime, uint32_t uid = UNKNOWN_UID,
+            char state = UNKNOWN_STATE, double ioWaitPercent = 0.0);
+    Row add(const ProcessSummary& summary) {
+        return add(summary.pid, summary.parentPid, summary.name, summary.cpuPercent,
+                   summary.memoryBytes, summary.creationTime, summary.uid);
+    }
+    
+    /**
+     * @brief Append every process of @p summaries, owners and control groups included
+     *
+     * Used where processes arrive as summaries (--attach, --replay); each
+     * distinct cgroup path is registered once.
+     */
+    void addAll(const std::vector<ProcessSummary>& summaries);
+    
+    uint32_t pid(Row row) const { return pid_[row]; }
+    uint32_t parentPid(Row row) const { return parentPid_[row]; }
+    double cpuPercent(Row row) const { return cpuPercent_[row]; }
+    uint64_t memoryBytes(Row row) const { return memoryBytes_[row]; }
+    uint64_t creationTime(Row row) const { return creationTime_[row]; }
+    uint32_t uid(Row row) const { return uid_[row]; }
+    char state(Row row) const { return state_[row]; }
+    double ioWaitPercent(Row row) const { return ioWaitPercent_[row]; }
+    std::string_view name(Row row) const {
+        return std::string_view(names_).substr(nameOffset_[row], nameLength_[row]);
+    }
+    
+    /**
+     * @brief Register a control group path for rows of this table to refer to
+     * @return Its id, numbered from 0 in the order added
+     * @note The caller adds each distinct path once; the table doesn't deduplicate
+     */
+    uint32_t addCgroup(std::string_view path);
+    void setCgroup(Row row, uint32_t cgroup) { cgroup_[row] = cgroup; }
+    
+    /**
+     * @brief @p row's control group id, NO_CGROUP where unknown
+     */
+    uint32_t cgroup(Row row) const { return cgroup_[row]; }
+    uint32_t cgroupCount() const { return static_cast<uint32_t>(cgroupOffset_.size()); }
+    std::string_view cgroupPath(uint32_t cgroup) const {
+        size_t end = cgroup + 1 < cgroupOffset_.size() ? cgroupOffset_[cgroup + 1] : cgroupPaths_.size();
+        return std::string_view(cgroupPaths_).substr(cgroupOffset_[cgroup], end - cgroupOffset_[cgroup]);
+    }
+    
+    /**
+     * @brief Link every row to its parent in O(n), replacing any earlier links
+     *
+     * A process whose parent started after it (pid reuse) becomes a root.
+     * Children and roots keep their row order. Also rebuilds the pre-order
+     * layout and the subtree totals.
+     */
+    void buildTree();
+    
+    Row parent(Row row) const { return parent_[row]; }
+    Row firstChild(Row row) const { return firstChild_[row]; }
+    Row nextSibling(Row row) const { return nextSibling_[row]; }
+    Row firstRoot() const { return firstRoot_; }
+    uint32_t rootCount() const { return rootCount_; }
+    
+    /**
+     * @brief Every row in pre-order: each parent before its children, siblings in row order
+     */
+    std::span<const Row> preorder() const { return preorder_; }
+    
+    /**
+     * @brief @p row followed by all its descendants, in pre-order
+     */
+    std::span<const Row> subtree(Row row) const {
+        return std::span<const Row>(preorder_).subspan(preorderIndex_[row], subtreeEnd_[row] - preorderIndex_[row]);
+    }
+    
+    Row subtreeSize(Row row) const { return subtreeEnd_[row] - preorderIndex_[row]; }
+    
+    /**
+     * @brief Whether @p ancestor is a proper ancestor of @p row, in O(1)
+     */
+    bool isAncestor(Row ancestor, Row row) const {
+        return preorderIndex_[ancestor] < preorderIndex_[row] && preorderIndex_[row] < subtreeEnd_[ancestor];
+    }
+    
+    /**
+     * @brief CPU / memory of @p row plus its whole subtree, in O(1)
+     */
+    double subtreeCpu(Row row) const { return subtreeCpu_[row]; }
+    uint64_t subtreeMemory(Row row) const { return subtreeMemory_[row]; }
+    
+    void fillSummary(Row row, ProcessSummary& summary) const;
+    
+    /**
+     * @brief Heap bytes the table holds (capacity, not size)
+     */
+    size_t memoryFootprint() const;
+    
+private:
+    void layOutPreorder();
+    
+    // Process columns
+    std::vector<uint32_t> pid_;
+    std::vector<uint32_t> parentPid_;
+    std::vector<double> cpuPercent_;
+    std::vector<uint64_t> memoryBytes_;
+    std::vector<uint64_t> creationTime_;
+    std::vector<uint32_t> uid_;
+    std::vector<char> state_;
+    std::vector<double> ioWaitPercent_;
+    std::vector<uint32_t> nameOffset_;      // Into names_
+    std::vector<uint32_t> nameLength_;
+    std::string names_;
+    std::vector<uint32_t> cgroup_;          // Id of its path in cgroupOffset_
+    
+    // Distinct control group paths, packed like the names
+    std::vector<uint32_t> cgroupOffset_;    // Into cgroupPaths_
+    std::string cgroupPaths_;
+    
+    // Tree links (NONE = no such row)
+    std::vector<Row> parent_;
+    std::vector<Row> firstChild_;
+    std::vector<Row> nextSibling_;
+    Row firstRoot_{NONE};
+    uint32_t rootCount_{0};
+    
+    // Pre-order layout and subtree totals, rebuilt by buildTree()
+    std::vector<Row> preorder_;                 // Position -> row
+    std::vector<Row> preorderIndex_;            // Row -> position
+    std::vector<Row> subtreeEnd_;               // Row -> one past its last descendant's position
+    std::vector<double> subtreeCpu_;
+    std::vector<uint64_t> subtreeMemory_;
+};
+
+} // namespace sysmon
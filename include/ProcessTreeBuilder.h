@@ -1,24 +1,82 @@
 #pragma once
 
-#include "ProcessInfo.h"
+#include "ProcessTable.h"
+#include "ProcessDelta.h"
+#include "ProcessSearch.h"
+#include "ProcessGroups.h"
 #include "IProcessCollector.h"
 #include "Configuration.h"
+#include "ChangeNotifier.h"
+#include "CpuBudgetGovernor.h"
+#include "SampleObserver.h"
 #include <memory>
 #include <vector>
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 
 namespace sysmon {
 
+/**
+ * @brief Column a top-K process index is ordered by
+ */
+enum class ProcessRanking {
+    Cpu,        // cpuPercent
+    Memory      // memoryBytes (RSS)
+};
+
+/**
+ * @brief One published process scan; never modified once published
+ */
+struct ProcessSnapshot {
+    uint64_t version{0};                            // getVersion() that published it (0 = none yet)
+    uint64_t timestampMs{0};                        // Wall-clock time of the scan
+    ProcessTable table;                             // Tree links included
+    std::vector<ProcessTable::Row> topByCpu;        // Top-K rows of table, heaviest first
+    std::vector<ProcessTable::Row> topByMemory;
+    ProcessDelta delta;                             // Against the snapshot published before it
+    ProcessNameIndex names;                         // Rows grouped by interned name, for filtering
+    ProcessGroups groups;                           // Totals by executable, user and cgroup
+};
+
+using ProcessSnapshotPtr = std::shared_ptr<const ProcessSnapshot>;
+
 /**
  * @brief Constructs and maintains process hierarchy tree
  * 
+ * Each scan is enumerated into a ProcessTable, linked in place and
+ * published as an immutable, reference-counted ProcessSnapshot. Readers
+ * take the current one in O(1) and may keep it as long as they like; the
+ * builder never waits on them. A retired snapshot nobody holds any more is
+ * reused for the next scan, so a steady process count rebuilds without
+ * allocating.
+ *
+ * Each scan also selects the K heaviest processes by CPU and by memory
+ * (K = topProcessIndexSize, raised to the largest top-N an exporter asks
+ * for), published together with the tree, so top-N queries cost O(N)
+ * rather than a walk over every process. The snapshot also carries the
+ * delta from the previous one (spawned, exited, reparented and changed
+ * processes), so consumers needn't diff whole trees themselves, its
+ * rows grouped by interned name, so a filter tests each distinct name once,
+ * and CPU, memory and process count totals per executable, user and
+ * control group, aggregated in one pass.
+ *
  * Thread-safety: All public methods are thread-safe
  */
 class ProcessTreeBuilder {
 public:
-    explicit ProcessTreeBuilder(const Configuration& config);
+    /**
+     * @param governor Optional CPU budget governor; scales the scan interval and detail
+     */
+    explicit ProcessTreeBuilder(const Configuration& config,
+                                const CpuBudgetGovernor* governor = nullptr);
+    
+    /**
+     * @brief Enumerate through @p collector instead of createProcessCollector() (e.g. replay)
+     */
+    ProcessTreeBuilder(const Configuration& config, std::unique_ptr<IProcessCollector> collector,
+                       const CpuBudgetGovernor* governor = nullptr);
     ~ProcessTreeBuilder();
     
     /**
@@ -32,9 +90,51 @@ public:
     void stop();
     
     /**
-     * @brief Get current process tree (thread-safe copy)
+     * @brief The latest published scan (an empty version 0 one before the first)
+     * @note O(1); compare version with a held snapshot's to skip unchanged work
+     */
+    ProcessSnapshotPtr getSnapshot() const;
+    
+    /**
+     * @brief Fill @p out with the @p count heaviest processes by @p ranking, highest first
+     * @note O(count) from the top-K index when count <= K, otherwise a pass over the
+     *       table; reuses @p out's storage
      */
-    std::vector<std::unique_ptr<ProcessInfo>> getProcessTree() const;
+    void getTopProcesses(size_t count, std::vector<ProcessSummary>& out,
+                         ProcessRanking ranking = ProcessRanking::Cpu) const;
+    
+    /**
+     * @brief Fill each list of @p out with the @p count heaviest groups by CPU (0 = all)
+     * @note Copies from the published totals; reuses @p out's storage
+     */
+    void getProcessGroups(size_t count, ProcessGroups& out) const;
+    
+    /**
+     * @brief Processes kept in each top-K index
+     */
+    size_t topIndexSize() const { return topIndexSize_; }
+    
+    /**
+     * @brief Fill @p out with every process in the current tree, sorted by pid
+     * @note Reuses @p out's storage
+     */
+    void getProcessList(std::vector<ProcessSummary>& out) const;
+    
+    /**
+     * @brief Version of the latest published process tree (0 = none yet)
+     */
+    uint64_t getVersion() const;
+    
+    /**
+     * @brief Register a callback invoked whenever a new tree is published
+     * @note Callbacks run on the enumeration thread and must not block
+     */
+    ChangeNotifier::SubscriptionId subscribe(ChangeNotifier::Callback callback);
+    
+    /**
+     * @brief Remove a callback registered with subscribe()
+     */
+    void unsubscribe(ChangeNotifier::SubscriptionId id);
     
     /**
      * @brief Terminate a specific process
@@ -46,19 +146,48 @@ public:
      */
     void refresh();
     
+    /**
+     * @brief Show every scan to @p observer on the enumeration thread
+     * @note Call before start(); @p observer must outlive the builder
+     */
+    void addObserver(ISampleObserver* observer);
+    
+    /**
+     * @brief Select the @p count heaviest rows of @p table by @p ranking into @p out, highest first
+     *
+     * A bounded min-heap: O(n log count) time, O(count) space. Ties go to
+     * the lower pid so the order is stable between scans.
+     */
+    static void selectTop(const ProcessTable& table, size_t count, ProcessRanking ranking,
+                          std::vector<ProcessTable::Row>& out);
+                          
 private:
     void enumerationLoop();
-    void buildTree(std::vector<std::unique_ptr<ProcessInfo>>& processes);
-    std::unique_ptr<ProcessInfo> deepCopy(const ProcessInfo& source) const;
+    
+    /**
+     * @brief The retired snapshot if no reader still holds it, else a new one
+     */
+    std::shared_ptr<ProcessSnapshot> takeSpareSnapshot();
     
     Configuration config_;
     std::unique_ptr<IProcessCollector> collector_;
+    const CpuBudgetGovernor* governor_;
     
-    mutable std::mutex treeMutex_;
-    std::vector<std::unique_ptr<ProcessInfo>> processRoots_;
+    // Only guards swapping the pointer; readers copy it and leave
+    mutable std::mutex snapshotMutex_;
+    std::shared_ptr<ProcessSnapshot> snapshot_;
+    std::shared_ptr<ProcessSnapshot> spare_;        // Enumeration thread only
+    ProcessNameInterner interner_;                  // Enumeration thread only
+    ProcessGrouper grouper_;                        // Enumeration thread only
+    size_t topIndexSize_;
+    ChangeNotifier notifier_;
+    std::vector<ISampleObserver*> observers_;
     
     std::atomic<bool> running_{false};
     std::thread enumerationThread_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool refreshRequested_{false};
 };
 
 } // namespace sysmon
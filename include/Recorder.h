@@ -0,0 +1,51 @@
+#pragma once
+
+#include "SystemDataCollector.h"
+#include "ProcessTreeBuilder.h"
+#include "RecordingWriter.h"
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Feeds every published snapshot into a RecordingWriter (--record)
+ *
+ * Subscribes to both collectors; the callbacks copy the snapshot into reused
+ * scratch storage and hand it to the writer's queue, so the collector threads
+ * never wait on encoding or disk I/O.
+ */
+class Recorder {
+public:
+    Recorder(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder);
+    ~Recorder();
+    
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+    
+    /**
+     * @brief Create @p path and start recording
+     */
+    bool start(const std::string& path);
+    
+    /**
+     * @brief Stop recording and finalize the file index
+     */
+    void stop();
+    
+    const RecordingWriter& writer() const { return writer_; }
+    
+private:
+    SystemDataCollector& dataCollector_;
+    ProcessTreeBuilder& processBuilder_;
+    RecordingWriter writer_;
+    
+    ChangeNotifier::SubscriptionId metricsSubscription_{0};
+    ChangeNotifier::SubscriptionId processSubscription_{0};
+    
+    // Scratch reused by the collector-thread callbacks
+    SystemMetrics metrics_;
+    std::vector<ProcessSummary> processes_;
+};
+
+} // namespace sysmon
@@ -0,0 +1,354 @@
+#pragma once
+
+#include "SystemMetrics.h"
+#include "ProcessInfo.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief On-disk layout of --record files
+ *
+ * File:    FileHeader, Block*, [Index, Trailer]
+ * Block:   BlockHeader, payload (columns, see RecordingEncoder)
+ * Index:   IndexEntry[entryCount], written on clean close
+ * Trailer: u64 indexOffset, u32 entryCount, u32 reserved, char[8] TRAILER_MAGIC
+ *
+ * All integers are little-endian. A file without a trailer (crash, still being
+ * written) is recovered by walking block headers from the start.
+ */
+namespace recording {
+
+constexpr char FILE_MAGIC[8] = {'S', 'Y', 'S', 'M', 'R', 'E', 'C', '1'};
+constexpr char TRAILER_MAGIC[8] = {'S', 'Y', 'S', 'M', 'I', 'D', 'X', '1'};
+constexpr uint32_t BLOCK_MAGIC = 0x314B4C42;   // "BLK1"
+constexpr uint32_t FORMAT_VERSION = 2;
+constexpr uint32_t OWNER_COLUMNS_VERSION = 2;  // First with the uid and cgroup process columns
+
+constexpr size_t FILE_HEADER_SIZE = 16;        // magic, u32 version, u32 reserved
+constexpr size_t BLOCK_HEADER_SIZE = 36;
+constexpr size_t INDEX_ENTRY_SIZE = 32;
+constexpr size_t TRAILER_SIZE = 24;
+
+enum class BlockKind : uint8_t {
+    System = 1,     // SystemMetrics samples
+    Processes = 2   // Full process list snapshots
+};
+
+/**
+ * @brief Fixed-size header in front of every block
+ *
+ * u32 magic, u8 kind, u8 reserved[3], u32 payloadBytes, u32 sampleCount,
+ * u32 columnCount (cores for System blocks, 0 otherwise), u64 firstTimestampMs,
+ * u64 lastTimestampMs
+ */
+struct BlockHeader {
+    BlockKind kind{BlockKind::System};
+    uint32_t payloadBytes{0};
+    uint32_t sampleCount{0};
+    uint32_t columnCount{0};
+    uint64_t firstTimestampMs{0};
+    uint64_t lastTimestampMs{0};
+};
+
+/**
+ * @brief Where a block lives and which time range it covers
+ *
+ * On disk: u64 offset, u8 kind, u8 reserved[3], u32 sampleCount,
+ * u64 firstTimestampMs, u64 lastTimestampMs
+ */
+struct IndexEntry {
+    uint64_t offset{0};
+    BlockKind kind{BlockKind::System};
+    uint32_t sampleCount{0};
+    uint64_t firstTimestampMs{0};
+    uint64_t lastTimestampMs{0};
+};
+
+/**
+ * @brief One recorded process list
+ */
+struct ProcessSnapshot {
+    uint64_t timestampMs{0};
+    std::vector<ProcessSummary> processes;     // Sorted by pid
+};
+
+// ---- Primitive encoders -----------------------------------------------------
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+template <typename T>
+inline void putFixed(std::string& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out += static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief XOR a double against its predecessor and store only the non-zero bytes
+ *
+ * Control byte: high nibble = leading zero bytes, low nibble = trailing zero
+ * bytes; the 8 - leading - trailing middle bytes follow. An unchanged value is
+ * the single byte 0x80.
+ */
+inline void putXorDouble(std::string& out, double previous, double value) {
+    uint64_t a;
+    uint64_t b;
+    std::memcpy(&a, &previous, sizeof(a));
+    std::memcpy(&b, &value, sizeof(b));
+    uint64_t x = a ^ b;
+    if (x == 0) {
+        out += static_cast<char>(0x80);
+        return;
+    }
+    
+    unsigned leading = 0;
+    while (leading < 8 && ((x >> (56 - 8 * leading)) & 0xFF) == 0) {
+        ++leading;
+    }
+    unsigned trailing = 0;
+    while (trailing < 8 && ((x >> (8 * trailing)) & 0xFF) == 0) {
+        ++trailing;
+    }
+    
+    out += static_cast<char>((leading << 4) | trailing);
+    for (unsigned i = trailing; i < 8 - leading; ++i) {
+        out += static_cast<char>((x >> (8 * i)) & 0xFF);
+    }
+}
+
+/**
+ * @brief Bounds-checked cursor over an encoded buffer
+ *
+ * Any read past the end sets ok() to false and returns 0 from then on, so
+ * decoders can run to completion and check once.
+ */
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+    
+    bool ok() const { return ok_; }
+    size_t position() const { return pos_; }
+    size_t remaining() const { return ok_ ? size_ - pos_ : 0; }
+    
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= size_) {
+                ok_ = false;
+                return 0;
+            }
+            uint8_t byte = data_[pos_++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        ok_ = false;
+        return 0;
+    }
+    
+    int64_t signedVarint() { return unzigzag(varint()); }
+    
+    template <typename T>
+    T fixed() {
+        if (size_ - pos_ < sizeof(T) || !ok_) {
+            ok_ = false;
+            return 0;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            value |= static_cast<uint64_t>(data_[pos_ + i]) << (8 * i);
+        }
+        pos_ += sizeof(T);
+        return static_cast<T>(value);
+    }
+    
+    double xorDouble(double previous) {
+        uint8_t control = fixed<uint8_t>();
+        unsigned leading = control >> 4;
+        unsigned trailing = control & 0x0F;
+        if (!ok_ || leading + trailing > 8) {
+            ok_ = false;
+            return 0.0;
+        }
+        
+        uint64_t x = 0;
+        for (unsigned i = trailing; i < 8 - leading; ++i) {
+            x |= static_cast<uint64_t>(fixed<uint8_t>()) << (8 * i);
+        }
+        uint64_t bits;
+        std::memcpy(&bits, &previous, sizeof(bits));
+        bits ^= x;
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    bool bytes(std::string& out, size_t count) {
+        if (!ok_ || size_ - pos_ < count) {
+            ok_ = false;
+            return false;
+        }
+        out.assign(reinterpret_cast<const char*>(data_ + pos_), count);
+        pos_ += count;
+        return true;
+    }
+    
+    /**
+     * @brief Borrow @p count raw bytes; nullptr when the payload is short
+     */
+    const uint8_t* take(size_t count) {
+        if (!ok_ || size_ - pos_ < count) {
+            ok_ = false;
+            return nullptr;
+        }
+        const uint8_t* start = data_ + pos_;
+        pos_ += count;
+        return start;
+    }
+    
+    void skip(size_t count) {
+        if (!ok_ || size_ - pos_ < count) {
+            ok_ = false;
+            return;
+        }
+        pos_ += count;
+    }
+    
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_{0};
+    bool ok_{true};
+};
+
+/**
+ * @brief Scratch reused across putProcessDelta()/readProcessDelta() calls
+ */
+struct ProcessDeltaScratch {
+    std::vector<int64_t> previousMatch;     // Index into the previous list, -1 for new processes
+    std::vector<size_t> removedIndices;
+    std::vector<uint32_t> addedPids;
+    std::vector<bool> removed;
+};
+
+/**
+ * @brief Encode @p current against @p previous (both sorted by pid)
+ *
+ * process count; removed count + index gaps; added count + pid deltas; then
+ * per column a changed-bitmap (1 bit per process) followed by values for the
+ * set bits only: ppid, cpu in 1/100 % (zigzag delta), memory (zigzag delta),
+ * creationTime (zigzag delta), name (length, bytes), uid + 1 (0 = unknown),
+ * cgroup (length, bytes). New processes always have their bits set and delta against zero.
+ */
+void putProcessDelta(const std::vector<ProcessSummary>& previous, const std::vector<ProcessSummary>& current,
+                     std::string& out, ProcessDeltaScratch& scratch);
+
+/**
+ * @brief Decode one putProcessDelta() record into @p current (must not alias @p previous)
+ * @param version Format it was written in; before OWNER_COLUMNS_VERSION there
+ *                are no uid and cgroup columns and those stay unknown
+ * @return false on corruption
+ */
+bool readProcessDelta(ByteReader& reader, const std::vector<ProcessSummary>& previous,
+                      std::vector<ProcessSummary>& current, ProcessDeltaScratch& scratch,
+                      uint32_t version = FORMAT_VERSION);
+                      
+} // namespace recording
+
+/**
+ * @brief Turns samples into encoded blocks (no I/O, single-threaded)
+ *
+ * Samples are buffered until a block fills, then encoded column by column:
+ *
+ * System block columns (sampleCount = n, columnCount = cores):
+ *   timestamps: delta (1st) then delta-of-delta, zigzag varint, n - 1 values
+ *   cpuPercent, memoryPercent: XOR-against-previous doubles
+ *   core[c] for each core: XOR-against-previous doubles
+ *   totalMemory, usedMemory, diskRead, diskWrite, netRecv, netSend:
+ *     zigzag varint delta against the previous sample
+ *
+ * Process block (sampleCount = snapshots): timestamps as above, then per
+ *   snapshot a recording::putProcessDelta() record against the previous
+ *   snapshot's pid-sorted list, so an idle, unchanged process costs 7 bits.
+ *
+ * Every block decodes independently: "previous" starts at zero per block.
+ */
+class RecordingEncoder {
+public:
+    static constexpr uint32_t SYSTEM_SAMPLES_PER_BLOCK = 120;
+    static constexpr uint32_t PROCESS_SNAPSHOTS_PER_BLOCK = 64;
+    
+    /**
+     * @brief Buffer a system sample; appends a finished block to @p out when full
+     */
+    void addMetrics(const SystemMetrics& metrics, std::string& out);
+    
+    /**
+     * @brief Buffer a process snapshot (@p processes must be sorted by pid)
+     */
+    void addProcesses(uint64_t timestampMs, const std::vector<ProcessSummary>& processes,
+                      std::string& out);
+    
+    /**
+     * @brief Encode whatever is buffered as final (possibly short) blocks
+     */
+    void flush(std::string& out);
+    
+    /**
+     * @brief Index entries for the blocks emitted so far; offsets are relative
+     * to the start of the first block passed out through this encoder
+     */
+    const std::vector<recording::IndexEntry>& index() const { return index_; }
+    
+    /**
+     * @brief Bytes emitted so far (blocks only)
+     */
+    uint64_t bytesEncoded() const { return bytesEncoded_; }
+    
+private:
+    void flushSystem(std::string& out);
+    void flushProcesses(std::string& out);
+    void beginBlock(std::string& out, size_t& headerOffset) const;
+    void finishBlock(std::string& out, size_t headerOffset, const recording::BlockHeader& header);
+    
+    // Buffered rows, encoded column-wise on flush; slots are reused across blocks
+    std::vector<SystemMetrics> systemSamples_;
+    size_t systemSampleCount_{0};
+    std::vector<recording::ProcessSnapshot> processSnapshots_;
+    size_t processSnapshotCount_{0};
+    recording::ProcessDeltaScratch processScratch_;
+    
+    std::vector<recording::IndexEntry> index_;
+    uint64_t bytesEncoded_{0};
+};
+
+/**
+ * @brief Decode one block payload; returns false on corruption
+ * @param version The file's FORMAT_VERSION
+ */
+bool decodeSystemBlock(const recording::BlockHeader& header, const uint8_t* payload,
+                       std::vector<SystemMetrics>& out);
+bool decodeProcessBlock(const recording::BlockHeader& header, const uint8_t* payload,
+                        std::vector<recording::ProcessSnapshot>& out,
+                        uint32_t version = recording::FORMAT_VERSION);
+                        
+} // namespace sysmon
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "RecordingFormat.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Random-access reader for recording files
+ *
+ * The file is memory-mapped (read into memory on Windows); only the block
+ * index is parsed up front. Range queries binary-search the index and decode
+ * just the blocks that overlap the requested time range.
+ *
+ * Thread-safety: const methods may be called concurrently after open()
+ */
+class RecordingReader {
+public:
+    RecordingReader() = default;
+    ~RecordingReader();
+    
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+    
+    /**
+     * @brief Map @p path and load its block index
+     * @return false if the file is missing, not a recording or from a newer version
+     */
+    bool open(const std::string& path);
+    
+    void close();
+    
+    /**
+     * @brief Whether the index was rebuilt by scanning (file not closed cleanly)
+     */
+    bool recovered() const { return recovered_; }
+    
+    /**
+     * @brief recording::FORMAT_VERSION the file was written with
+     */
+    uint32_t version() const { return version_; }
+    
+    const std::vector<recording::IndexEntry>& systemBlocks() const { return systemIndex_; }
+    const std::vector<recording::IndexEntry>& processBlocks() const { return processIndex_; }
+    
+    /**
+     * @brief Earliest / latest timestamp of any recorded sample (0 if empty)
+     */
+    uint64_t firstTimestampMs() const;
+    uint64_t lastTimestampMs() const;
+    
+    /**
+     * @brief Append system samples with fromMs <= timestamp <= toMs to @p out
+     * @return Number of samples appended
+     */
+    size_t readMetrics(uint64_t fromMs, uint64_t toMs, std::vector<SystemMetrics>& out) const;
+    
+    /**
+     * @brief Append process snapshots with fromMs <= timestamp <= toMs to @p out
+     * @return Number of snapshots appended
+     */
+    size_t readProcesses(uint64_t fromMs, uint64_t toMs,
+                         std::vector<recording::ProcessSnapshot>& out) const;
+                         
+private:
+    bool loadIndex();
+    void rebuildIndex();
+    bool readBlockHeader(uint64_t offset, recording::BlockHeader& header) const;
+    void addToIndex(const recording::IndexEntry& entry);
+    
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+#ifdef _WIN32
+    std::vector<uint8_t> contents_;
+#endif
+
+    uint32_t version_{0};
+    bool recovered_{false};
+    std::vector<recording::IndexEntry> systemIndex_;
+    std::vector<recording::IndexEntry> processIndex_;
+};
+
+} // namespace sysmon
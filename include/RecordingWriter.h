@@ -0,0 +1,82 @@
+#pragma once
+
+#include "RecordingFormat.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Appends samples to a recording file from a background thread
+ *
+ * append*() only copies the sample into a pending queue; encoding and file
+ * writes happen on the writer thread. If the writer falls too far behind new
+ * samples are dropped and counted rather than blocking the caller.
+ *
+ * Thread-safety: append*() may be called from any thread; open()/close()
+ * from the owning thread only
+ */
+class RecordingWriter {
+public:
+    RecordingWriter() = default;
+    ~RecordingWriter();
+    
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+    
+    /**
+     * @brief Create (truncate) @p path, write the file header and start the writer thread
+     */
+    bool open(const std::string& path);
+    
+    /**
+     * @brief Encode what is pending, write the block index and close the file
+     */
+    void close();
+    
+    void appendMetrics(const SystemMetrics& metrics);
+    
+    /**
+     * @brief Queue a process snapshot (sorted by pid by the writer thread if needed)
+     */
+    void appendProcesses(uint64_t timestampMs, const std::vector<ProcessSummary>& processes);
+    
+    uint64_t bytesWritten() const { return bytesWritten_.load(std::memory_order_relaxed); }
+    uint64_t samplesWritten() const { return samplesWritten_.load(std::memory_order_relaxed); }
+    uint64_t droppedSamples() const { return dropped_.load(std::memory_order_relaxed); }
+    
+private:
+    struct Queue {
+        std::vector<SystemMetrics> metrics;
+        size_t metricsCount{0};
+        std::vector<recording::ProcessSnapshot> processes;
+        size_t processCount{0};
+    };
+    
+    void writerLoop();
+    void drain(Queue& queue);
+    void writeBuffer();
+    void writeIndex();
+    
+    std::FILE* file_{nullptr};
+    RecordingEncoder encoder_;
+    std::string buffer_;
+    
+    std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    Queue pending_;
+    Queue draining_;
+    bool running_{false};
+    std::thread writerThread_;
+    
+    std::atomic<uint64_t> bytesWritten_{0};
+    std::atomic<uint64_t> samplesWritten_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
+
+} // namespace sysmon
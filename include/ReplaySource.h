@@ -0,0 +1,109 @@
+#pragma once
+
+#include "RecordingReader.h"
+#include "ISystemCollector.h"
+#include "IProcessCollector.h"
+#include "Configuration.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Plays a --record file back as if it were being collected live
+ *
+ * The system and process streams each keep their own cursor and are read by
+ * one collector thread each. In timed mode (speed > 0) a stream returns the
+ * newest sample recorded at or before (recording start + elapsed * speed);
+ * at max speed (speed == 0) every call advances exactly one sample, so each
+ * recorded sample is published once, as fast as the pipeline consumes it.
+ *
+ * Samples are decoded a block-sized time range at a time, so memory stays
+ * flat regardless of the recording's length.
+ */
+class ReplaySource {
+public:
+    static constexpr double MAX_SPEED = 0.0;
+    
+    /**
+     * @brief Map @p path and start the replay clock
+     * @param speed Playback rate (1 = real time), or MAX_SPEED
+     */
+    bool open(const std::string& path, double speed);
+    
+    /**
+     * @brief Set @p config's sampling intervals to the recorded cadence divided by the speed
+     *
+     * Adaptive sampling and the CPU budget are turned off: they would skip or
+     * repeat recorded samples rather than save work.
+     */
+    void applyIntervals(Configuration& config) const;
+    
+    /**
+     * @brief Update @p current if a newer system sample is due (collection thread only)
+     * @return false when @p current is unchanged
+     */
+    bool nextMetrics(SystemMetrics& current);
+    
+    /**
+     * @brief Update @p current if a newer process snapshot is due (enumeration thread only)
+     * @return false when @p current is unchanged
+     */
+    bool nextProcesses(std::vector<ProcessSummary>& current);
+    
+    /**
+     * @brief Both streams have played their last sample
+     */
+    bool finished() const {
+        return metrics_.exhausted.load(std::memory_order_acquire) &&
+               processes_.exhausted.load(std::memory_order_acquire);
+    }
+    
+    double speed() const { return speed_; }
+    uint64_t metricsReplayed() const { return metrics_.replayed.load(std::memory_order_relaxed); }
+    uint64_t snapshotsReplayed() const { return processes_.replayed.load(std::memory_order_relaxed); }
+    
+private:
+    template <typename Sample>
+    struct Cursor {
+        std::vector<Sample> chunk;
+        size_t next{0};
+        uint64_t nextLoadMs{0};             // Start of the next time range to decode
+        uint64_t chunkMs{0};                // Recording time decoded per refill
+        uint32_t cadenceMs{0};              // Typical spacing, from the first chunk
+        std::atomic<bool> exhausted{false};
+        std::atomic<uint64_t> replayed{0};
+    };
+    
+    template <typename Sample, typename Load>
+    bool advance(Cursor<Sample>& cursor, Load load, Sample& current);
+    
+    template <typename Sample, typename Load>
+    bool refill(Cursor<Sample>& cursor, Load load);
+    
+    template <typename Sample, typename Load>
+    void rewind(Cursor<Sample>& cursor, uint64_t chunkMs, Load load);
+    
+    uint64_t targetTimestampMs() const;
+    
+    RecordingReader reader_;
+    double speed_{1.0};
+    uint64_t firstTimestampMs_{0};
+    uint64_t lastTimestampMs_{0};
+    std::chrono::steady_clock::time_point startTime_;
+    
+    Cursor<SystemMetrics> metrics_;
+    Cursor<recording::ProcessSnapshot> processes_;
+    recording::ProcessSnapshot snapshot_;   // Scratch for nextProcesses()
+};
+
+/**
+ * @brief Collectors backed by a ReplaySource, used in place of the platform factories
+ */
+std::unique_ptr<ISystemCollector> createReplaySystemCollector(std::shared_ptr<ReplaySource> source);
+std::unique_ptr<IProcessCollector> createReplayProcessCollector(std::shared_ptr<ReplaySource> source);
+
+} // namespace sysmon
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "SystemMetrics.h"
+#include "ProcessTable.h"
+#include <cstdint>
+
+namespace sysmon {
+
+// Sources present in a system sample passed to ISampleObserver
+constexpr uint32_t SAMPLE_CPU = 1u << 0;
+constexpr uint32_t SAMPLE_MEMORY = 1u << 1;
+constexpr uint32_t SAMPLE_DISK = 1u << 2;
+constexpr uint32_t SAMPLE_NETWORK = 1u << 3;
+
+/**
+ * @brief Sees every sample on the thread that collected it, before it is published
+ *
+ * Unlike a ChangeNotifier subscription, an observer gets exactly the fields
+ * collected in that pass, so a source sampled less often isn't seen twice.
+ * Observers run inline in the collection loops and must be quick.
+ */
+class ISampleObserver {
+public:
+    virtual ~ISampleObserver() = default;
+    
+    /**
+     * @brief A system sample; only the fields of @p sources (SAMPLE_* bits) are set
+     */
+    virtual void onSystemSample(const SystemMetrics& /*sample*/, uint32_t /*sources*/) {}
+    
+    /**
+     * @brief A process scan, with the tree already linked
+     */
+    virtual void onProcessScan(const ProcessTable& /*processes*/, uint64_t /*timestampMs*/) {}
+};
+
+} // namespace sysmon
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SystemDataCollector.h"
+#include "ProcessTreeBuilder.h"
+#include "SharedMetricsSegment.h"
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Publishes every snapshot into the shared-memory segment (--shm)
+ *
+ * Subscribes to both collectors and updates the segment directly from their
+ * callbacks: a system sample is a copy of a few hundred bytes, and a process
+ * update is a top-N pass over the freshly published tree.
+ */
+class SharedMemoryPublisher {
+public:
+    SharedMemoryPublisher(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder);
+    ~SharedMemoryPublisher();
+    
+    SharedMemoryPublisher(const SharedMemoryPublisher&) = delete;
+    SharedMemoryPublisher& operator=(const SharedMemoryPublisher&) = delete;
+    
+    /**
+     * @brief Create shared-memory object @p name and start publishing
+     */
+    bool start(const std::string& name);
+    
+    /**
+     * @brief Stop publishing and remove the shared-memory object
+     */
+    void stop();
+    
+private:
+    SystemDataCollector& dataCollector_;
+    ProcessTreeBuilder& processBuilder_;
+    SharedMetricsSegment segment_;
+    
+    ChangeNotifier::SubscriptionId metricsSubscription_{0};
+    ChangeNotifier::SubscriptionId processSubscription_{0};
+    
+    // Scratch reused by the collector-thread callbacks
+    SystemMetrics metrics_;
+    std::vector<ProcessSummary> topProcesses_;
+};
+
+} // namespace sysmon
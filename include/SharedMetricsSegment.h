@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SystemMetrics.h"
+#include "ProcessInfo.h"
+#include "sysmon_shm.h"
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Writer side of the shared-memory metrics segment (layout in sysmon_shm.h)
+ *
+ * Each publish is one seqlock-protected update of the mapped segment: plain
+ * stores, no system calls. System samples and process lists update disjoint
+ * fields and may come from different threads; a mutex serializes writers
+ * only, readers never take it.
+ */
+class SharedMetricsSegment {
+public:
+    SharedMetricsSegment() = default;
+    ~SharedMetricsSegment();
+    
+    SharedMetricsSegment(const SharedMetricsSegment&) = delete;
+    SharedMetricsSegment& operator=(const SharedMetricsSegment&) = delete;
+    
+    /**
+     * @brief Create (or take over) shared-memory object @p name and map it
+     */
+    bool create(const std::string& name);
+    
+    /**
+     * @brief Mark the writer gone, unmap and unlink the object
+     * @note Readers that still have it mapped keep their view of the last snapshot
+     */
+    void close();
+    
+    /**
+     * @brief Publish system metrics; cores beyond SYSMON_SHM_MAX_CORES are dropped
+     */
+    void publishMetrics(const SystemMetrics& metrics);
+    
+    /**
+     * @brief Publish up to SYSMON_SHM_MAX_PROCESSES processes, in the given order
+     */
+    void publishProcesses(const std::vector<ProcessSummary>& processes);
+    
+private:
+    template <typename Update>
+    void write(Update update);
+    
+    sysmon_shm_segment* segment_{nullptr};
+    std::string name_;
+    std::mutex writeMutex_;
+};
+
+} // namespace sysmon
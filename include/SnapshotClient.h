@@ -0,0 +1,107 @@
+#pragma once
+
+#include "SnapshotStream.h"
+#include "ISystemCollector.h"
+#include "IProcessCollector.h"
+#include "Configuration.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Receives a --daemon's snapshots over its Unix socket (--attach)
+ *
+ * A receive thread decodes frames as they arrive; the attach collectors
+ * block in nextMetrics()/nextProcesses() until a frame newer than the one
+ * they last took is available, so each decoded frame is published once and
+ * an idle client does no work. The UI on top keeps its own view state.
+ */
+class SnapshotClient {
+public:
+    SnapshotClient() = default;
+    ~SnapshotClient();
+    
+    SnapshotClient(const SnapshotClient&) = delete;
+    SnapshotClient& operator=(const SnapshotClient&) = delete;
+    
+    /**
+     * @brief Connect to @p socketPath and ask for at most @p maxUpdateHz updates/s (0 = all)
+     * @param onDisconnect Called from the receive thread if the daemon goes away
+     */
+    bool connect(const std::string& socketPath, uint32_t maxUpdateHz,
+                 std::function<void()> onDisconnect = {});
+    
+    /**
+     * @brief Disconnect and release any collector thread blocked on the next frame
+     */
+    void close();
+    
+    /**
+     * @brief Make @p config's collectors take every frame as it arrives
+     *
+     * All sampling intervals become 0 (the collectors block on the socket
+     * instead), and adaptive sampling and the CPU budget are turned off: the
+     * daemon already applies its own.
+     */
+    void applyIntervals(Configuration& config) const;
+    
+    /**
+     * @brief Wait for a metrics frame newer than the last one taken (one caller only)
+     * @return false once disconnected
+     */
+    bool nextMetrics(SystemMetrics& current);
+    
+    /**
+     * @brief Wait for a process frame newer than the last one taken (one caller only)
+     * @return false once disconnected
+     */
+    bool nextProcesses(std::vector<ProcessSummary>& current);
+    
+    bool connected() const { return connected_.load(std::memory_order_acquire); }
+    uint64_t framesReceived() const { return framesReceived_.load(std::memory_order_relaxed); }
+    uint64_t bytesReceived() const { return bytesReceived_.load(std::memory_order_relaxed); }
+    
+private:
+    void receiveLoop();
+    bool decodeFrame(stream::FrameKind kind, const uint8_t* payload, size_t size);
+    
+    int fd_{-1};
+    std::thread receiveThread_;
+    std::function<void()> onDisconnect_;
+    std::atomic<bool> connected_{false};
+    std::atomic<bool> closing_{false};
+    std::atomic<uint64_t> framesReceived_{0};
+    std::atomic<uint64_t> bytesReceived_{0};
+    
+    // Latest decoded frames, handed to the collector threads
+    std::mutex mutex_;
+    std::condition_variable frameCv_;
+    SystemMetrics metrics_;
+    uint64_t metricsFrames_{0};
+    uint64_t metricsTaken_{0};
+    std::vector<ProcessSummary> processes_;
+    uint64_t processFrames_{0};
+    uint64_t processesTaken_{0};
+    
+    // Receive-thread decode state: the bases of the next deltas
+    std::string buffer_;
+    SystemMetrics decodedMetrics_;
+    std::vector<ProcessSummary> decodedProcesses_;
+    std::vector<ProcessSummary> nextProcesses_;
+    recording::ProcessDeltaScratch scratch_;
+};
+
+/**
+ * @brief Collectors backed by a SnapshotClient, used in place of the platform factories
+ */
+std::unique_ptr<ISystemCollector> createAttachSystemCollector(std::shared_ptr<SnapshotClient> client);
+std::unique_ptr<IProcessCollector> createAttachProcessCollector(std::shared_ptr<SnapshotClient> client);
+
+} // namespace sysmon
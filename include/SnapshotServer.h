@@ -0,0 +1,121 @@
+#pragma once
+
+#include "SystemDataCollector.h"
+#include "ProcessTreeBuilder.h"
+#include "SnapshotStream.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Serves one daemon's snapshots to any number of --attach clients (--daemon)
+ *
+ * A single thread owns the listening Unix socket and every client. Collector
+ * threads only write a byte to a wake pipe when they publish; the server then
+ * copies the new snapshot once and shares it between clients.
+ *
+ * Each client gets at most its requested update rate, and at most one
+ * update is ever queued for it: while a slow client still has unsent bytes,
+ * newer snapshots are not queued behind them. Once it drains, it is sent the
+ * latest snapshot as a delta against the last one it actually received, so
+ * intermediate snapshots are coalesced away and memory stays bounded.
+ *
+ * Thread-safety: start()/stop() from the owning thread; everything else is internal
+ */
+class SnapshotServer {
+public:
+    SnapshotServer(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder);
+    ~SnapshotServer();
+    
+    SnapshotServer(const SnapshotServer&) = delete;
+    SnapshotServer& operator=(const SnapshotServer&) = delete;
+    
+    /**
+     * @brief Bind @p socketPath and start serving
+     * @return false if the path is in use by a running daemon or can't be bound
+     */
+    bool start(const std::string& socketPath);
+    
+    /**
+     * @brief Disconnect every client, close and remove the socket
+     */
+    void stop();
+    
+    uint64_t clientsServed() const { return clientsServed_.load(std::memory_order_relaxed); }
+    uint64_t updatesSent() const { return updatesSent_.load(std::memory_order_relaxed); }
+    uint64_t updatesCoalesced() const { return updatesCoalesced_.load(std::memory_order_relaxed); }
+    uint64_t bytesSent() const { return bytesSent_.load(std::memory_order_relaxed); }
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    using MetricsSnapshot = std::shared_ptr<const SystemMetrics>;
+    using ProcessSnapshot = std::shared_ptr<const std::vector<ProcessSummary>>;
+    
+    struct Client {
+        int fd{-1};
+        bool greeted{false};                // Hello received
+        std::string hello;                  // Partial hello bytes
+        Clock::duration minInterval{};      // 1 / requested rate (0 = every update)
+        Clock::time_point nextUpdateAt{};
+        
+        // What the client last received: the base of its next deltas
+        MetricsSnapshot sentMetrics;
+        ProcessSnapshot sentProcesses;
+        
+        std::string outbox;                 // At most one update
+        size_t outboxOffset{0};
+    };
+    
+    // An encoded frame from one base to the latest snapshot, shared by every
+    // client that last received the same base
+    struct CachedFrame {
+        const void* base{nullptr};
+        std::string bytes;
+    };
+    
+    void serverLoop();
+    void acceptClients();
+    bool readFromClient(Client& client);
+    bool flushClient(Client& client);
+    void pullSnapshots();
+    void queueUpdate(Client& client, Clock::time_point now);
+    const std::string& metricsFrameFrom(const SystemMetrics* base);
+    const std::string& processFrameFrom(const std::vector<ProcessSummary>* base);
+    bool isBehind(const Client& client) const;
+    int pollTimeoutMs(Clock::time_point now) const;
+    void closeClient(Client& client);
+    void wake();
+    
+    SystemDataCollector& dataCollector_;
+    ProcessTreeBuilder& processBuilder_;
+    std::string socketPath_;
+    ChangeNotifier::SubscriptionId metricsSubscription_{0};
+    ChangeNotifier::SubscriptionId processSubscription_{0};
+    
+    int listenFd_{-1};
+    int wakePipe_[2]{-1, -1};
+    std::atomic<bool> running_{false};
+    std::thread serverThread_;
+    
+    std::atomic<uint64_t> clientsServed_{0};
+    std::atomic<uint64_t> updatesSent_{0};
+    std::atomic<uint64_t> updatesCoalesced_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    
+    // Server-thread state
+    std::vector<std::unique_ptr<Client>> clients_;
+    MetricsSnapshot metrics_;
+    ProcessSnapshot processes_;
+    uint64_t metricsVersion_{0};
+    uint64_t processVersion_{0};
+    std::vector<CachedFrame> metricsFrames_;
+    std::vector<CachedFrame> processFrames_;
+    recording::ProcessDeltaScratch scratch_;
+};
+
+} // namespace sysmon
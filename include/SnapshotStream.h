@@ -0,0 +1,98 @@
+#pragma once
+
+#include "RecordingFormat.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Wire format between a --daemon and its --attach clients (Unix socket)
+ *
+ * Client -> daemon, once after connecting:
+ *   Hello: u32 HELLO_MAGIC, u16 PROTOCOL_VERSION, u16 reserved, u32 maxUpdateHz (0 = every update)
+ *
+ * Daemon -> client, a stream of frames:
+ *   u32 payloadBytes, u8 FrameKind, payload
+ *
+ * Each payload is a delta against the previous frame of the same kind sent
+ * to *that* client (zero/empty before the first), so the daemon may skip any
+ * number of intermediate snapshots for a slow client and the next frame
+ * still decodes. All integers are little-endian.
+ *
+ * Fleet agents (--agent) reuse the same frames over TCP in the other
+ * direction: an AgentHello frame naming the host, then Metrics and
+ * Processes frames (the host's top processes rather than the full list),
+ * delta-encoded against what was last sent on that connection.
+ */
+namespace stream {
+
+constexpr uint32_t HELLO_MAGIC = 0x31414D53;      // "SMA1"
+constexpr uint32_t AGENT_MAGIC = 0x31474153;      // "SAG1"
+constexpr uint16_t PROTOCOL_VERSION = 2;      // 2: processes carry uid and cgroup
+constexpr size_t HELLO_SIZE = 12;
+constexpr size_t FRAME_HEADER_SIZE = 5;
+
+// Larger frames are treated as corruption and end the connection
+constexpr uint32_t MAX_FRAME_BYTES = 64u << 20;
+
+enum class FrameKind : uint8_t {
+    Metrics = 1,    // SystemMetrics
+    Processes = 2,  // Full process list, sorted by pid
+    AgentHello = 3  // u32 AGENT_MAGIC, u16 PROTOCOL_VERSION, varint length + host name
+};
+
+// Longest host name an agent may announce
+constexpr size_t MAX_HOST_NAME_BYTES = 255;
+
+/**
+ * @brief Append a Hello message requesting at most @p maxUpdateHz updates per second
+ */
+void appendHello(std::string& out, uint32_t maxUpdateHz);
+
+/**
+ * @brief Parse a HELLO_SIZE message; false on a bad magic or version
+ */
+bool parseHello(const uint8_t* data, uint32_t& maxUpdateHz);
+
+/**
+ * @brief Append an AgentHello frame announcing @p hostName
+ */
+void appendAgentHelloFrame(std::string& out, const std::string& hostName);
+
+/**
+ * @brief Parse an AgentHello payload; false on a bad magic, version or name
+ */
+bool readAgentHelloFrame(const uint8_t* payload, size_t size, std::string& hostName);
+
+/**
+ * @brief Append a Metrics frame encoding @p current against @p previous
+ *
+ * timestamp (zigzag delta); cpu and memory percent (XOR doubles); core count
+ * then per-core XOR doubles (against zero past the previous core count);
+ * memory, disk and network counters (zigzag deltas). Per-device counters
+ * are not sent.
+ */
+void appendMetricsFrame(const SystemMetrics& previous, const SystemMetrics& current, std::string& out);
+
+/**
+ * @brief Append a Processes frame: one recording::putProcessDelta() record
+ */
+void appendProcessFrame(const std::vector<ProcessSummary>& previous, const std::vector<ProcessSummary>& current,
+                        std::string& out, recording::ProcessDeltaScratch& scratch);
+
+/**
+ * @brief Apply a Metrics payload to @p metrics (the previously decoded frame) in place
+ */
+bool readMetricsFrame(const uint8_t* payload, size_t size, SystemMetrics& metrics);
+
+/**
+ * @brief Decode a Processes payload against @p previous into @p current
+ */
+bool readProcessFrame(const uint8_t* payload, size_t size, const std::vector<ProcessSummary>& previous,
+                      std::vector<ProcessSummary>& current, recording::ProcessDeltaScratch& scratch);
+                      
+} // namespace stream
+
+} // namespace sysmon
@@ -3,13 +3,29 @@
 #include "SystemMetrics.h"
 #include "ISystemCollector.h"
 #include "Configuration.h"
+#include "ChangeNotifier.h"
+#include "AdaptiveSampler.h"
+#include "CpuBudgetGovernor.h"
+#include "SampleObserver.h"
 #include <memory>
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <vector>
 
 namespace sysmon {
 
+/**
+ * @brief Effective per-source sampling intervals (milliseconds)
+ */
+struct SamplingIntervals {
+    uint32_t cpuMs{0};
+    uint32_t memoryMs{0};
+    uint32_t diskMs{0};
+    uint32_t networkMs{0};
+};
+
 /**
  * @brief Main system data collection coordinator
  * 
@@ -18,7 +34,17 @@ namespace sysmon {
  */
 class SystemDataCollector {
 public:
-    explicit SystemDataCollector(const Configuration& config);
+    /**
+     * @param governor Optional CPU budget governor; scales every sampling interval
+     */
+    explicit SystemDataCollector(const Configuration& config,
+                                 const CpuBudgetGovernor* governor = nullptr);
+    
+    /**
+     * @brief Collect through @p collector instead of createSystemCollector() (e.g. replay)
+     */
+    SystemDataCollector(const Configuration& config, std::unique_ptr<ISystemCollector> collector,
+                        const CpuBudgetGovernor* governor = nullptr);
     ~SystemDataCollector();
     
     /**
@@ -36,23 +62,68 @@ public:
      */
     SystemMetrics getMetrics() const;
     
+    /**
+     * @brief Copy current metrics into @p out, reusing its storage (thread-safe)
+     */
+    void getMetrics(SystemMetrics& out) const;
+    
+    /**
+     * @brief Get the interval each source is currently sampled at (thread-safe)
+     */
+    SamplingIntervals getSamplingIntervals() const;
+    
+    /**
+     * @brief Version of the latest published metrics snapshot (0 = none yet)
+     */
+    uint64_t getVersion() const;
+    
+    /**
+     * @brief Register a callback invoked whenever a new snapshot is published
+     * @note Callbacks run on the collection thread and must not block
+     */
+    ChangeNotifier::SubscriptionId subscribe(ChangeNotifier::Callback callback);
+    
+    /**
+     * @brief Remove a callback registered with subscribe()
+     */
+    void unsubscribe(ChangeNotifier::SubscriptionId id);
+    
     /**
      * @brief Force immediate refresh of all metrics
      */
     void refresh();
     
+    /**
+     * @brief Show every sample to @p observer on the collection thread
+     * @note Call before start(); @p observer must outlive the collector
+     */
+    void addObserver(ISampleObserver* observer);
+    
 private:
     void collectionLoop();
-    void collectAllMetrics();
+    SamplingIntervals effectiveIntervals() const;
     
     Configuration config_;
     std::unique_ptr<ISystemCollector> collector_;
+    const CpuBudgetGovernor* governor_;
     
     mutable std::mutex metricsMutex_;
     SystemMetrics currentMetrics_;
+    SamplingIntervals intervals_;
+    ChangeNotifier notifier_;
+    std::vector<ISampleObserver*> observers_;
+    
+    // Owned by the collection thread; intervals_ mirrors them for readers
+    AdaptiveSampler cpuSampler_;
+    AdaptiveSampler memorySampler_;
+    AdaptiveSampler diskSampler_;
+    AdaptiveSampler networkSampler_;
     
     std::atomic<bool> running_{false};
     std::thread collectionThread_;
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool refreshRequested_{false};
 };
 
 } // namespace sysmon
@@ -1,10 +1,20 @@
 #pragma once
 
 #include <vector>
+#include <string>
 #include <cstdint>
 
 namespace sysmon {
 
+/**
+ * @brief Cumulative byte counters for one disk or network interface
+ */
+struct DeviceCounters {
+    std::string name;                      // Device or interface name (e.g. nvme0n1, eth0)
+    uint64_t readBytes{0};                 // Disk: bytes read; network: bytes received
+    uint64_t writeBytes{0};                // Disk: bytes written; network: bytes sent
+};
+
 /**
  * @brief Aggregates current readings for all monitored system resources
  * 
@@ -14,6 +24,7 @@ struct SystemMetrics {
     // CPU metrics
     double cpuUsagePercent{0.0};           // Overall CPU usage (0-100)
     std::vector<double> perCoreCpuUsage;   // Per-core CPU usage (0-100)
+    std::vector<double> perCoreStealPercent;  // Per-core time stolen by the hypervisor (0-100, Linux only)
     
     // Memory metrics
     uint64_t totalMemoryBytes{0};          // Total physical memory
@@ -23,10 +34,12 @@ struct SystemMetrics {
     // Disk metrics
     uint64_t diskReadBytesPerSec{0};       // Disk read throughput
     uint64_t diskWriteBytesPerSec{0};      // Disk write throughput
+    std::vector<DeviceCounters> diskDevices;  // Per-device totals since boot (where available)
     
     // Network metrics
     uint64_t networkRecvBytesPerSec{0};    // Network receive throughput
     uint64_t networkSendBytesPerSec{0};    // Network transmit throughput
+    std::vector<DeviceCounters> networkInterfaces;  // Per-interface totals since boot (where available)
     
     // Timestamp
     uint64_t timestampMs{0};               // Sample timestamp in milliseconds
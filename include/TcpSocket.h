@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+namespace sysmon {
+
+/**
+ * @brief Small POSIX socket helpers shared by the metrics endpoint, the daemon and fleet mode
+ *
+ * Addresses are "host:port", ":port" (all interfaces) or "[v6addr]:port".
+ * Sockets are created close-on-exec and blocking; on failure -1 is returned
+ * and @p error says why. Only portable POSIX calls are used (no
+ * SOCK_CLOEXEC, pipe2 or accept4), so this builds on macOS as well.
+ */
+namespace net {
+
+/**
+ * @brief Set FD_CLOEXEC on @p fd, and O_NONBLOCK too if @p nonBlocking
+ * @return false if fcntl() failed (always on Windows)
+ */
+bool setDescriptorFlags(int fd, bool nonBlocking);
+
+/**
+ * @brief Split @p address into host (possibly empty) and port
+ */
+bool splitHostPort(const std::string& address, std::string& host, std::string& port);
+
+/**
+ * @brief Bind and listen on the first address @p address resolves to
+ */
+int listenTcp(const std::string& address, std::string& error);
+
+/**
+ * @brief Connect to @p address, giving each resolved address @p timeoutSec seconds
+ *
+ * The timeout also stays on the socket for later sends (SO_SNDTIMEO), so a
+ * peer that stops reading can't block the caller indefinitely.
+ */
+int connectTcp(const std::string& address, int timeoutSec, std::string& error);
+
+} // namespace net
+
+} // namespace sysmon
@@ -0,0 +1,186 @@
+/*
+ * sysmon shared-memory metrics segment: layout and reader (C99/C++, POSIX)
+ *
+ * sysmon --shm <name> publishes every snapshot into the POSIX shared
+ * memory object <name> (default "/sysmon"). This header is self-contained so
+ * local consumers can copy it without the rest of the tree:
+ *
+ *     struct sysmon_shm_reader reader;
+ *     struct sysmon_shm_snapshot snapshot;
+ *     if (sysmon_shm_open(&reader, SYSMON_SHM_DEFAULT_NAME) == 0) {
+ *         if (sysmon_shm_read(reader.segment, &snapshot) == 0) { ... }
+ *         sysmon_shm_close(&reader);
+ *     }
+ *
+ * After sysmon_shm_open() a read is plain loads from the mapping: no system
+ * calls and no locks. Consistency comes from a sequence lock: the writer
+ * makes `sequence` odd while it updates `data` and even again afterwards, and
+ * a reader retries until it copied `data` between two equal, even values.
+ *
+ * Compatibility: readers must check `magic` and `version` (done by
+ * sysmon_shm_open). Fields are only ever appended within a version; a
+ * layout change bumps SYSMON_SHM_VERSION. All values are host-endian.
+ *
+ * Requires GCC or Clang (__atomic builtins).
+ */
+#ifndef SYSMON_SHM_H
+#define SYSMON_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYSMON_SHM_DEFAULT_NAME "/sysmon"
+#define SYSMON_SHM_MAGIC 0x314D48534D535953ULL     /* "SYSMSHM1" little-endian */
+#define SYSMON_SHM_VERSION 1u
+
+#define SYSMON_SHM_MAX_CORES 1024u
+#define SYSMON_SHM_MAX_PROCESSES 32u
+#define SYSMON_SHM_PROCESS_NAME_SIZE 32u
+
+/* Retries before sysmon_shm_read() gives up on a writer that keeps racing it */
+#define SYSMON_SHM_READ_ATTEMPTS 1000
+
+/* One of the top processes by CPU */
+struct sysmon_shm_process {
+    uint32_t pid;
+    uint32_t parent_pid;
+    double cpu_percent;                             /* 100 = one core */
+    uint64_t memory_bytes;
+    char name[SYSMON_SHM_PROCESS_NAME_SIZE];        /* NUL-terminated, truncated */
+};
+
+/* Snapshot payload; what a reader copies out */
+struct sysmon_shm_snapshot {
+    uint64_t timestamp_ms;                          /* Unix time of the system sample */
+    uint64_t metrics_updates;                       /* System samples published so far */
+    uint64_t process_updates;                       /* Process lists published so far */
+    
+    double cpu_usage_percent;
+    double memory_usage_percent;
+    uint64_t total_memory_bytes;
+    uint64_t used_memory_bytes;
+    uint64_t disk_read_bytes_per_sec;
+    uint64_t disk_write_bytes_per_sec;
+    uint64_t network_recv_bytes_per_sec;
+    uint64_t network_send_bytes_per_sec;
+    
+    uint32_t core_count;                            /* Valid entries in core_usage_percent */
+    uint32_t process_count;                         /* Valid entries in processes */
+    double core_usage_percent[SYSMON_SHM_MAX_CORES];
+    struct sysmon_shm_process processes[SYSMON_SHM_MAX_PROCESSES];
+};
+
+/* The whole shared object */
+struct sysmon_shm_segment {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t segment_size;                          /* sizeof(struct sysmon_shm_segment) */
+    uint32_t writer_pid;                            /* 0 once the writer has exited */
+    uint32_t reserved;
+    /* Sequence lock; on its own cache line so readers don't share it with data */
+    uint64_t padding[5];
+    uint64_t sequence;
+    uint64_t padding2[7];
+    struct sysmon_shm_snapshot data;
+};
+
+/*
+ * Copy a consistent snapshot into *out.
+ * Only the valid prefix of the core and process arrays is copied.
+ * Returns 0 on success, -1 if the writer kept the segment busy for
+ * SYSMON_SHM_READ_ATTEMPTS tries.
+ */
+static inline int sysmon_shm_read(const struct sysmon_shm_segment* segment,
+                                  struct sysmon_shm_snapshot* out) {
+    const struct sysmon_shm_snapshot* data = &segment->data;
+    int attempt;
+    for (attempt = 0; attempt < SYSMON_SHM_READ_ATTEMPTS; ++attempt) {
+        uint64_t before = __atomic_load_n(&segment->sequence, __ATOMIC_ACQUIRE);
+        uint32_t cores;
+        uint32_t processes;
+        if (before & 1u) {
+            continue;
+        }
+        
+        memcpy(out, data, offsetof(struct sysmon_shm_snapshot, core_usage_percent));
+        cores = out->core_count < SYSMON_SHM_MAX_CORES ? out->core_count : SYSMON_SHM_MAX_CORES;
+        processes = out->process_count < SYSMON_SHM_MAX_PROCESSES
+            ? out->process_count : SYSMON_SHM_MAX_PROCESSES;
+        memcpy(out->core_usage_percent, data->core_usage_percent, cores * sizeof(double));
+        memcpy(out->processes, data->processes, processes * sizeof(struct sysmon_shm_process));
+        
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&segment->sequence, __ATOMIC_RELAXED) == before) {
+            out->core_count = cores;
+            out->process_count = processes;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+#ifndef _WIN32
+
+struct sysmon_shm_reader {
+    const struct sysmon_shm_segment* segment;
+};
+
+/*
+ * Map the segment read-only and validate its header.
+ * Returns 0 on success, -1 if it doesn't exist or has an unknown layout.
+ */
+static inline int sysmon_shm_open(struct sysmon_shm_reader* reader, const char* name) {
+    struct stat info;
+    void* mapping;
+    int fd = shm_open(name, O_RDONLY, 0);
+    reader->segment = NULL;
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(struct sysmon_shm_segment)) {
+        close(fd);
+        return -1;
+    }
+    mapping = mmap(NULL, sizeof(struct sysmon_shm_segment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+    
+    reader->segment = (const struct sysmon_shm_segment*)mapping;
+    if (reader->segment->magic != SYSMON_SHM_MAGIC ||
+        reader->segment->version != SYSMON_SHM_VERSION ||
+        reader->segment->segment_size != sizeof(struct sysmon_shm_segment)) {
+        munmap(mapping, sizeof(struct sysmon_shm_segment));
+        reader->segment = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void sysmon_shm_close(struct sysmon_shm_reader* reader) {
+    if (reader->segment) {
+        munmap((void*)reader->segment, sizeof(struct sysmon_shm_segment));
+        reader->segment = NULL;
+    }
+}
+
+#endif /* _WIN32 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SYSMON_SHM_H */
@@ -2,9 +2,34 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <exception>
+#include <string>
 
 namespace sysmon {
 
+namespace {
+    std::string trim(const std::string& value) {
+        size_t start = value.find_first_not_of(" \t\r");
+        if (start == std::string::npos) {
+            return "";
+        }
+        size_t end = value.find_last_not_of(" \t\r");
+        return value.substr(start, end - start + 1);
+    }
+    
+    bool parseBool(const std::string& value) {
+        return value == "true" || value == "1" || value == "yes" || value == "on";
+    }
+    
+    // "max" or a multiplier such as "1", "10" or "0.5x"
+    double parseReplaySpeed(const std::string& value) {
+        if (value == "max") {
+            return 0.0;
+        }
+        return std::stod(value);
+    }
+}
+
 void Configuration::loadFromArgs(int argc, char* argv[]) {
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -13,25 +38,154 @@ void Configuration::loadFromArgs(int argc, char* argv[]) {
             cpuSampleIntervalMs = std::stoi(argv[++i]);
         } else if (arg == "--memory-interval" && i + 1 < argc) {
             memorySampleIntervalMs = std::stoi(argv[++i]);
+        } else if (arg == "--disk-interval" && i + 1 < argc) {
+            diskSampleIntervalMs = std::stoi(argv[++i]);
+        } else if (arg == "--network-interval" && i + 1 < argc) {
+            networkSampleIntervalMs = std::stoi(argv[++i]);
+        } else if (arg == "--fixed-intervals") {
+            adaptiveSampling = false;
+        } else if (arg == "--volatility-threshold" && i + 1 < argc) {
+            volatilityThreshold = std::stod(argv[++i]);
         } else if (arg == "--fps" && i + 1 < argc) {
             targetFrameRateHz = std::stoi(argv[++i]);
         } else if (arg == "--no-colors") {
             useColors = false;
         } else if (arg == "--expand-tree") {
             expandTreeByDefault = true;
+        } else if (arg == "--sort-by" && i + 1 < argc) {
+            processSortBy = argv[++i];
+        } else if (arg == "--flat") {
+            flatProcessList = true;
+        } else if (arg == "--group-by" && i + 1 < argc) {
+            processGroupBy = argv[++i];
+        } else if (arg == "--history" && i + 1 < argc) {
+            historyProcesses = std::stoi(argv[++i]);
+        } else if (arg == "--no-io-uring") {
+            useIoUring = false;
+        } else if (arg == "--proc-root" && i + 1 < argc) {
+            procRoot = argv[++i];
+        } else if (arg == "--sys-root" && i + 1 < argc) {
+            sysRoot = argv[++i];
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--format" && i + 1 < argc) {
+            exportFormat = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            exportOutput = argv[++i];
+        } else if (arg == "--top" && i + 1 < argc) {
+            exportTopProcesses = std::stoi(argv[++i]);
+        } else if (arg == "--top-groups" && i + 1 < argc) {
+            exportTopGroups = std::stoi(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (arg == "--metrics-listen" && i + 1 < argc) {
+            metricsListen = argv[++i];
+        } else if (arg == "--metrics-top" && i + 1 < argc) {
+            metricsTopProcesses = std::stoi(argv[++i]);
+        } else if (arg == "--metrics-top-groups" && i + 1 < argc) {
+            metricsTopGroups = std::stoi(argv[++i]);
+        } else if (arg == "--shm" && i + 1 < argc) {
+            sharedMemoryName = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (arg == "--replay-speed" && i + 1 < argc) {
+            replaySpeed = parseReplaySpeed(argv[++i]);
+        } else if (arg == "--daemon" && i + 1 < argc) {
+            daemonSocket = argv[++i];
+        } else if (arg == "--attach" && i + 1 < argc) {
+            attachSocket = argv[++i];
+        } else if (arg == "--attach-rate" && i + 1 < argc) {
+            attachMaxUpdateHz = std::stoi(argv[++i]);
+        } else if (arg == "--fleet" && i + 1 < argc) {
+            fleetListen = argv[++i];
+        } else if (arg == "--agent" && i + 1 < argc) {
+            agentTarget = argv[++i];
+        } else if (arg == "--agent-name" && i + 1 < argc) {
+            agentName = argv[++i];
+        } else if (arg == "--agent-top" && i + 1 < argc) {
+            agentTopProcesses = std::stoi(argv[++i]);
+        } else if (arg == "--cpu-budget" && i + 1 < argc) {
+            cpuBudgetPercent = std::stod(argv[++i]);
+        } else if (arg == "--debug") {
+            debugMode = true;
+        } else if (arg == "--trace-file" && i + 1 < argc) {
+            traceFile = argv[++i];
         } else if (arg == "--cpu-threshold" && i + 1 < argc) {
             cpuAlertThreshold = std::stod(argv[++i]);
         } else if (arg == "--memory-threshold" && i + 1 < argc) {
             memoryAlertThreshold = std::stod(argv[++i]);
+        } else if (arg == "--top-k" && i + 1 < argc) {
+            topProcessIndexSize = std::stoi(argv[++i]);
+        } else if (arg == "--delta-cpu" && i + 1 < argc) {
+            deltaCpuEpsilon = std::stod(argv[++i]);
+        } else if (arg == "--delta-memory" && i + 1 < argc) {
+            deltaMemoryEpsilonBytes = std::stoull(argv[++i]);
+        } else if (arg == "--alert" && i + 1 < argc) {
+            alertRules.push_back(argv[++i]);
+        } else if (arg == "--no-anomalies") {
+            anomalyDetection = false;
+        } else if (arg == "--no-process-anomalies") {
+            anomalyProcesses = false;
+        } else if (arg == "--anomaly-z" && i + 1 < argc) {
+            anomalyRaiseZ = std::stod(argv[++i]);
+        } else if (arg == "--anomaly-clear-z" && i + 1 < argc) {
+            anomalyClearZ = std::stod(argv[++i]);
+        } else if (arg == "--anomaly-half-life" && i + 1 < argc) {
+            anomalyHalfLifeSec = std::stoi(argv[++i]);
+        } else if (arg == "--anomaly-season-buckets" && i + 1 < argc) {
+            anomalySeasonBuckets = std::stoi(argv[++i]);
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "System Monitor - Usage:\n"
                       << "  --cpu-interval <ms>       CPU sampling interval (default: 1000)\n"
                       << "  --memory-interval <ms>    Memory sampling interval (default: 5000)\n"
+                      << "  --disk-interval <ms>      Disk sampling interval (default: 1000)\n"
+                      << "  --network-interval <ms>   Network sampling interval (default: 1000)\n"
+                      << "  --fixed-intervals         Disable adaptive sampling\n"
+                      << "  --volatility-threshold <pct>  Delta that speeds up sampling (default: 5)\n"
                       << "  --fps <rate>              Target frame rate (default: 30)\n"
                       << "  --cpu-threshold <pct>     CPU alert threshold (default: 90)\n"
                       << "  --memory-threshold <pct>  Memory alert threshold (default: 90)\n"
+                      << "  --alert <rule>            Add an alert rule, e.g. \"cpu.core[*] > 95 for 30s\"\n"
+                      << "  --no-anomalies            Disable baseline anomaly detection\n"
+                      << "  --no-process-anomalies    Watch host series only, not every process\n"
+                      << "  --anomaly-z <z>           |z| that raises an anomaly (default: 4)\n"
+                      << "  --anomaly-clear-z <z>     |z| below which it clears (default: 2)\n"
+                      << "  --anomaly-half-life <s>   Baseline half-life in seconds (default: 600)\n"
+                      << "  --anomaly-season-buckets <n>  Time-of-day baselines, 0 = off (default: 24)\n"
                       << "  --no-colors               Disable color output\n"
                       << "  --expand-tree             Expand process tree by default\n"
+                      << "  --sort-by <key>           Process order: cpu, memory, name or pid (default: cpu)\n"
+                      << "  --flat                    List processes without the tree\n"
+                      << "  --group-by <kind>         Show totals by executable, user or cgroup (default: none)\n"
+                      << "  --history <n>             Processes with a sparkline history, 0 = off (default: 2048)\n"
+                      << "  --top-k <n>               Processes kept per top-K index (default: 32)\n"
+                      << "  --delta-cpu <pct>         CPU change a scan delta reports (default: 1)\n"
+                      << "  --delta-memory <bytes>    Memory change a scan delta reports (default: 1048576)\n"
+                      << "  --no-io-uring             Use synchronous procfs reads (Linux)\n"
+                      << "  --proc-root <dir>         Read procfs from dir, e.g. a fixture (default: /proc)\n"
+                      << "  --sys-root <dir>          Read sysfs from dir (default: /sys)\n"
+                      << "  --headless                Stream snapshots instead of showing the UI\n"
+                      << "  --format <fmt>            Headless format: jsonl, csv, binary (default: jsonl)\n"
+                      << "  --output <path>           Headless output file (default: stdout)\n"
+                      << "  --top <n>                 Include the top-N processes by CPU (default: 0)\n"
+                      << "  --top-groups <n>          Include the top-N groups of each kind, jsonl (default: 0)\n"
+                      << "  --record <file>           Record metrics and process snapshots to a file\n"
+                      << "  --metrics-listen <addr>   Serve Prometheus metrics on host:port or :port\n"
+                      << "  --metrics-top <n>         Top-N processes in /metrics (default: 10)\n"
+                      << "  --metrics-top-groups <n>  Top-N groups of each kind in /metrics (default: 10)\n"
+                      << "  --shm <name>              Publish snapshots to shared memory (e.g. /sysmon)\n"
+                      << "  --replay <file>           Play back a recording instead of collecting live\n"
+                      << "  --replay-speed <x|max>    Replay rate multiplier or max (default: 1)\n"
+                      << "  --daemon <socket>         Collect once and serve attached UIs on a Unix socket\n"
+                      << "  --attach <socket>         Show a running daemon's snapshots instead of collecting\n"
+                      << "  --attach-rate <hz>        Max updates/s to request from the daemon (default: all)\n"
+                      << "  --fleet <addr>            Accept agents on host:port or :port and show the fleet\n"
+                      << "  --agent <host:port>       Stream this host's snapshots to a --fleet aggregator\n"
+                      << "  --agent-name <name>       Host name shown in the fleet view (default: hostname)\n"
+                      << "  --agent-top <n>           Top-N processes per agent update (default: 10)\n"
+                      << "  --cpu-budget <pct>        Own CPU budget in % of one core (default: unlimited)\n"
+                      << "  --debug                   Show self-instrumentation panel\n"
+                      << "  --trace-file <path>       Write Chrome trace-event JSON on exit\n"
                       << "  --help, -h                Show this help\n";
             std::exit(0);
         }
@@ -48,9 +202,20 @@ void Configuration::loadFromEnvironment() {
     if (colors && std::string(colors) == "1") {
         useColors = false;
     }
+    
+    const char* procfs = std::getenv("SYSMON_PROC_ROOT");
+    if (procfs && *procfs) {
+        procRoot = procfs;
+    }
+    
+    const char* sysfs = std::getenv("SYSMON_SYS_ROOT");
+    if (sysfs && *sysfs) {
+        sysRoot = sysfs;
+    }
 }
 
-bool Configuration::loadFromFile(const std::string& filepath) {
+bool Configuration::loadFromFile(const std::string& filepath, std::string& error) {
+    error.clear();
     std::ifstream file(filepath);
     if (!file.is_open()) {
         return false;
@@ -58,20 +223,128 @@ bool Configuration::loadFromFile(const std::string& filepath) {
     
     // Simple key=value parser
     std::string line;
+    size_t lineNumber = 0;
     while (std::getline(file, line)) {
+        ++lineNumber;
         if (line.empty() || line[0] == '#') continue;
         
+        // Strip trailing comments ("key=value   # comment")
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        
         size_t pos = line.find('=');
         if (pos != std::string::npos) {
-            std::string key = line.substr(0, pos);
-            std::string value = line.substr(pos + 1);
+            std::string key = trim(line.substr(0, pos));
+            std::string value = trim(line.substr(pos + 1));
             
-            if (key == "cpu_interval") {
-                cpuSampleIntervalMs = std::stoi(value);
-            } else if (key == "memory_interval") {
-                memorySampleIntervalMs = std::stoi(value);
-            } else if (key == "target_fps") {
-                targetFrameRateHz = std::stoi(value);
+            // A value that doesn't parse stops loading rather than the program
+            try {
+                if (key == "cpu_interval") {
+                    cpuSampleIntervalMs = std::stoi(value);
+                } else if (key == "memory_interval") {
+                    memorySampleIntervalMs = std::stoi(value);
+                } else if (key == "disk_interval") {
+                    diskSampleIntervalMs = std::stoi(value);
+                } else if (key == "network_interval") {
+                    networkSampleIntervalMs = std::stoi(value);
+                } else if (key == "process_interval") {
+                    processSampleIntervalMs = std::stoi(value);
+                } else if (key == "adaptive_sampling") {
+                    adaptiveSampling = parseBool(value);
+                } else if (key == "adaptive_min_interval") {
+                    adaptiveMinIntervalMs = std::stoi(value);
+                } else if (key == "adaptive_max_interval") {
+                    adaptiveMaxIntervalMs = std::stoi(value);
+                } else if (key == "volatility_threshold") {
+                    volatilityThreshold = std::stod(value);
+                } else if (key == "target_fps") {
+                    targetFrameRateHz = std::stoi(value);
+                } else if (key == "sort_by") {
+                    processSortBy = value;
+                } else if (key == "flat_processes") {
+                    flatProcessList = parseBool(value);
+                } else if (key == "group_by") {
+                    processGroupBy = value;
+                } else if (key == "history_processes") {
+                    historyProcesses = std::stoi(value);
+                } else if (key == "top_k") {
+                    topProcessIndexSize = std::stoi(value);
+                } else if (key == "delta_cpu") {
+                    deltaCpuEpsilon = std::stod(value);
+                } else if (key == "delta_memory") {
+                    deltaMemoryEpsilonBytes = std::stoull(value);
+                } else if (key == "cpu_threshold") {
+                    cpuAlertThreshold = std::stod(value);
+                } else if (key == "memory_threshold") {
+                    memoryAlertThreshold = std::stod(value);
+                } else if (key == "alert") {
+                    alertRules.push_back(value);
+                } else if (key == "anomaly_detection") {
+                    anomalyDetection = parseBool(value);
+                } else if (key == "anomaly_processes") {
+                    anomalyProcesses = parseBool(value);
+                } else if (key == "anomaly_raise_z") {
+                    anomalyRaiseZ = std::stod(value);
+                } else if (key == "anomaly_clear_z") {
+                    anomalyClearZ = std::stod(value);
+                } else if (key == "anomaly_half_life") {
+                    anomalyHalfLifeSec = std::stoi(value);
+                } else if (key == "anomaly_season_buckets") {
+                    anomalySeasonBuckets = std::stoi(value);
+                } else if (key == "io_uring") {
+                    useIoUring = parseBool(value);
+                } else if (key == "proc_root") {
+                    procRoot = value;
+                } else if (key == "sys_root") {
+                    sysRoot = value;
+                } else if (key == "export_format") {
+                    exportFormat = value;
+                } else if (key == "export_output") {
+                    exportOutput = value;
+                } else if (key == "export_top") {
+                    exportTopProcesses = std::stoi(value);
+                } else if (key == "export_top_groups") {
+                    exportTopGroups = std::stoi(value);
+                } else if (key == "record_file") {
+                    recordFile = value;
+                } else if (key == "metrics_listen") {
+                    metricsListen = value;
+                } else if (key == "metrics_top") {
+                    metricsTopProcesses = std::stoi(value);
+                } else if (key == "metrics_top_groups") {
+                    metricsTopGroups = std::stoi(value);
+                } else if (key == "shm_name") {
+                    sharedMemoryName = value;
+                } else if (key == "replay_file") {
+                    replayFile = value;
+                } else if (key == "replay_speed") {
+                    replaySpeed = parseReplaySpeed(value);
+                } else if (key == "daemon_socket") {
+                    daemonSocket = value;
+                } else if (key == "attach_socket") {
+                    attachSocket = value;
+                } else if (key == "attach_rate") {
+                    attachMaxUpdateHz = std::stoi(value);
+                } else if (key == "fleet_listen") {
+                    fleetListen = value;
+                } else if (key == "agent_target") {
+                    agentTarget = value;
+                } else if (key == "agent_name") {
+                    agentName = value;
+                } else if (key == "agent_top") {
+                    agentTopProcesses = std::stoi(value);
+                } else if (key == "cpu_budget") {
+                    cpuBudgetPercent = std::stod(value);
+                } else if (key == "debug_mode") {
+                    debugMode = parseBool(value);
+                } else if (key == "trace_file") {
+                    traceFile = value;
+                }
+            } catch (const std::exception&) {
+                error = filepath + ":" + std::to_string(lineNumber) + ": bad value for " + key;
+                return false;
             }
         }
     }
@@ -90,6 +363,88 @@ bool Configuration::validate() const {
         return false;
     }
     
+    if (adaptiveMinIntervalMs < 50 || adaptiveMinIntervalMs > adaptiveMaxIntervalMs) {
+        std::cerr << "Invalid adaptive interval range: " << adaptiveMinIntervalMs
+                  << "-" << adaptiveMaxIntervalMs << "\n";
+        return false;
+    }
+    
+    if (volatilityThreshold <= 0.0) {
+        std::cerr << "Invalid volatility threshold: " << volatilityThreshold << "\n";
+        return false;
+    }
+    
+    if (anomalyRaiseZ <= 0.0 || anomalyClearZ < 0.0 || anomalyClearZ >= anomalyRaiseZ) {
+        std::cerr << "Invalid anomaly thresholds: raise at " << anomalyRaiseZ
+                  << ", clear below " << anomalyClearZ << "\n";
+        return false;
+    }
+    
+    if (anomalyHalfLifeSec == 0 || anomalySeasonBuckets > 1440) {
+        std::cerr << "Invalid anomaly baseline: half-life " << anomalyHalfLifeSec
+                  << " s, " << anomalySeasonBuckets << " season buckets\n";
+        return false;
+    }
+    
+    if (exportFormat != "jsonl" && exportFormat != "json" && exportFormat != "csv" &&
+        exportFormat != "binary" && exportFormat != "bin") {
+        std::cerr << "Invalid export format: " << exportFormat << "\n";
+        return false;
+    }
+    
+    if (replaySpeed < 0.0) {
+        std::cerr << "Invalid replay speed: " << replaySpeed << "\n";
+        return false;
+    }
+    
+    if (!attachSocket.empty() && (!replayFile.empty() || !daemonSocket.empty())) {
+        std::cerr << "--attach can't be combined with --replay or --daemon\n";
+        return false;
+    }
+    
+    if (!fleetListen.empty() && (headless || !daemonSocket.empty())) {
+        std::cerr << "--fleet shows the fleet in the UI; it can't be combined with --headless or --daemon\n";
+        return false;
+    }
+    
+    if (cpuBudgetPercent < 0.0 || cpuBudgetPercent > 100.0) {
+        std::cerr << "Invalid CPU budget: " << cpuBudgetPercent << "\n";
+        return false;
+    }
+    
+    if (procRoot.empty() || sysRoot.empty()) {
+        std::cerr << "procfs and sysfs roots can't be empty\n";
+        return false;
+    }
+    
+    if (processSortBy != "cpu" && processSortBy != "memory" && processSortBy != "name" && processSortBy != "pid") {
+        std::cerr << "Invalid process sort key: " << processSortBy << "\n";
+        return false;
+    }
+    
+    if (processGroupBy != "none" && processGroupBy != "executable" && processGroupBy != "user" &&
+        processGroupBy != "cgroup") {
+        std::cerr << "Invalid process grouping: " << processGroupBy << "\n";
+        return false;
+    }
+    
+    // Every drawn row is a view; fewer slots than rows would evict on every frame
+    if (historyProcesses != 0 && historyProcesses < maxProcessDisplay) {
+        std::cerr << "Process history (" << historyProcesses << ") must be 0 or at least the displayed process limit ("
+                  << maxProcessDisplay << ")\n";
+        return false;
+    }
+    
+    if (topProcessIndexSize < 1 || topProcessIndexSize > 100000) {
+        std::cerr << "Invalid top-K index size: " << topProcessIndexSize << "\n";
+        return false;
+    }
+    
+    if (deltaCpuEpsilon < 0.0) {
+        std::cerr << "Invalid delta CPU epsilon: " << deltaCpuEpsilon << "\n";
+        return false;
+    }
+    
     if (targetFrameRateHz < 1 || targetFrameRateHz > 120) {
         std::cerr << "Invalid frame rate: " << targetFrameRateHz << "\n";
         return false;
@@ -102,10 +457,25 @@ void Configuration::print() const {
     std::cout << "Configuration:\n"
               << "  CPU Interval: " << cpuSampleIntervalMs << " ms\n"
               << "  Memory Interval: " << memorySampleIntervalMs << " ms\n"
+              << "  Adaptive Sampling: " << (adaptiveSampling ? "enabled" : "disabled")
+              << " (" << adaptiveMinIntervalMs << "-" << adaptiveMaxIntervalMs << " ms)\n"
               << "  Target FPS: " << targetFrameRateHz << "\n"
               << "  CPU Alert: " << cpuAlertThreshold << "%\n"
               << "  Memory Alert: " << memoryAlertThreshold << "%\n"
-              << "  Colors: " << (useColors ? "enabled" : "disabled") << "\n";
+              << "  Alert Rules: " << alertRules.size() << "\n"
+              << "  Anomalies: " << (anomalyDetection ? "enabled" : "disabled")
+              << " (z " << anomalyRaiseZ << "/" << anomalyClearZ << ", half-life " << anomalyHalfLifeSec
+              << " s, " << anomalySeasonBuckets << " season buckets)\n"
+              << "  Process Delta: CPU > " << deltaCpuEpsilon << " pp, memory > " << deltaMemoryEpsilonBytes
+              << " bytes\n"
+              << "  Process Order: " << processSortBy << (flatProcessList ? ", flat" : ", tree") << "\n"
+              << "  Process Groups: " << processGroupBy << "\n"
+              << "  Process History: " << historyProcesses << " processes\n"
+              << "  Colors: " << (useColors ? "enabled" : "disabled") << "\n"
+              << "  io_uring: " << (useIoUring ? "enabled" : "disabled") << "\n"
+              << "  procfs: " << procRoot << ", sysfs: " << sysRoot << "\n"
+              << "  CPU Budget: " << cpuBudgetPercent << "% of one core (0 = unlimited)\n"
+              << "  Debug Mode: " << (debugMode ? "enabled" : "disabled") << "\n";
 }
 
 } // namespace sysmon
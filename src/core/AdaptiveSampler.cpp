@@ -0,0 +1,64 @@
+#include "AdaptiveSampler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sysmon {
+
+namespace {
+    // Weight of the newest delta in the running deviation estimate
+    constexpr double EWMA_ALPHA = 0.3;
+    
+    // Per-sample decay of the observed peak for rate signals
+    constexpr double PEAK_DECAY = 0.99;
+    
+    // Back off only when recent deviation is well below the threshold
+    constexpr double STABLE_FRACTION = 0.25;
+    
+    constexpr double SPEED_UP_FACTOR = 0.5;
+    constexpr double BACK_OFF_FACTOR = 1.5;
+}
+
+AdaptiveSampler::AdaptiveSampler(uint32_t initialIntervalMs, uint32_t minIntervalMs,
+                                 uint32_t maxIntervalMs, double volatilityThreshold, Scale scale)
+    : intervalMs_(std::clamp(initialIntervalMs, minIntervalMs, std::max(minIntervalMs, maxIntervalMs))),
+      minIntervalMs_(minIntervalMs),
+      maxIntervalMs_(std::max(minIntervalMs, maxIntervalMs)),
+      threshold_(volatilityThreshold),
+      scale_(scale) {
+}
+
+double AdaptiveSampler::normalize(double value) {
+    if (scale_ == Scale::Percent) {
+        return value;
+    }
+    
+    peak_ = std::max(value, peak_ * PEAK_DECAY);
+    return peak_ > 0.0 ? 100.0 * value / peak_ : 0.0;
+}
+
+uint32_t AdaptiveSampler::update(double value) {
+    double signal = normalize(value);
+    
+    if (!hasLast_) {
+        hasLast_ = true;
+        last_ = signal;
+        return intervalMs_;
+    }
+    
+    double delta = signal - last_;
+    last_ = signal;
+    deltaVariance_ = EWMA_ALPHA * delta * delta + (1.0 - EWMA_ALPHA) * deltaVariance_;
+    double deviation = std::sqrt(deltaVariance_);
+    
+    double next = intervalMs_;
+    if (std::abs(delta) > threshold_ || deviation > threshold_) {
+        next *= SPEED_UP_FACTOR;
+    } else if (deviation < threshold_ * STABLE_FRACTION) {
+        next *= BACK_OFF_FACTOR;
+    }
+    
+    intervalMs_ = std::clamp(static_cast<uint32_t>(next), minIntervalMs_, maxIntervalMs_);
+    return intervalMs_;
+}
+
+} // namespace sysmon
@@ -0,0 +1,304 @@
+#include "AlertEngine.h"
+#include <algorithm>
+
+namespace sysmon {
+
+namespace {
+    bool holds(AlertCompare compare, double value, double threshold) {
+        switch (compare) {
+            case AlertCompare::Greater:
+                return value > threshold;
+            case AlertCompare::GreaterEqual:
+                return value >= threshold;
+            case AlertCompare::Less:
+                return value < threshold;
+            case AlertCompare::LessEqual:
+                return value <= threshold;
+        }
+        return false;
+    }
+    
+    double systemValue(AlertOperand operand, const SystemMetrics& sample) {
+        switch (operand) {
+            case AlertOperand::CpuPercent:
+                return sample.cpuUsagePercent;
+            case AlertOperand::MemoryPercent:
+                return sample.memoryUsagePercent;
+            case AlertOperand::MemoryUsedBytes:
+                return static_cast<double>(sample.usedMemoryBytes);
+            case AlertOperand::DiskReadRate:
+                return static_cast<double>(sample.diskReadBytesPerSec);
+            case AlertOperand::DiskWriteRate:
+                return static_cast<double>(sample.diskWriteBytesPerSec);
+            case AlertOperand::NetworkRecvRate:
+                return static_cast<double>(sample.networkRecvBytesPerSec);
+            case AlertOperand::NetworkSendRate:
+                return static_cast<double>(sample.networkSendBytesPerSec);
+            default:
+                return 0.0;
+        }
+    }
+    
+    bool isCoreOperand(AlertOperand operand) {
+        return operand == AlertOperand::CorePercent || operand == AlertOperand::CoreStealPercent;
+    }
+    
+    /** @brief Per-core values of a core operand; empty where the platform doesn't collect them */
+    const std::vector<double>& coreValues(AlertOperand operand, const SystemMetrics& sample) {
+        return operand == AlertOperand::CoreStealPercent ? sample.perCoreStealPercent : sample.perCoreCpuUsage;
+    }
+}
+
+bool AlertEngine::compile(const std::vector<std::string>& rules, std::string& error) {
+    AlertProgram program;
+    for (const auto& rule : rules) {
+        if (!compileAlertRule(rule, program, error)) {
+            error = "'" + rule + "': " + error;
+            return false;
+        }
+    }
+    
+    anyProcess_.clear();
+    processesByName_.clear();
+    processesByPid_.clear();
+    for (uint32_t i = 0; i < program.process.size(); ++i) {
+        const auto& instruction = program.process[i];
+        switch (instruction.selector) {
+            case AlertSelector::Any:
+                anyProcess_.push_back(i);
+                break;
+            case AlertSelector::Name:
+                processesByName_[instruction.name].push_back(i);
+                break;
+            case AlertSelector::Index:
+                processesByPid_[instruction.index].push_back(i);
+                break;
+        }
+    }
+    program_ = std::move(program);
+    return true;
+}
+
+template <typename Describe>
+bool AlertEngine::evaluate(const AlertInstruction& instruction, const InstanceKey& key, double value,
+                           uint64_t timestampMs, Describe&& describe) {
+    bool condition = holds(instruction.compare, value, instruction.threshold);
+    auto it = states_.find(key);
+    if (it == states_.end()) {
+        if (!condition) {
+            return false;
+        }
+        it = states_.emplace(key, InstanceState{}).first;
+        it->second.pendingSinceMs = timestampMs;
+    }
+    
+    InstanceState& state = it->second;
+    state.scan = scan_;
+    state.value = value;
+    
+    if (!state.firing) {
+        if (!condition) {
+            states_.erase(it);
+            return false;
+        }
+        // A clock stepped back restarts the wait rather than wrapping it
+        if (timestampMs < state.pendingSinceMs) {
+            state.pendingSinceMs = timestampMs;
+        }
+        if (timestampMs - state.pendingSinceMs < instruction.forMs) {
+            return false;
+        }
+        state.firing = true;
+        state.firedMs = timestampMs;
+        state.instance = describe();
+        pushEvent(instruction, state, true, value, timestampMs);
+        alertsFired_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    // Firing until the value is back past the clear level
+    if (holds(instruction.compare, value, instruction.clearThreshold)) {
+        return false;
+    }
+    pushEvent(instruction, state, false, value, timestampMs);
+    states_.erase(it);
+    return true;
+}
+
+void AlertEngine::pushEvent(const AlertInstruction& instruction, const InstanceState& state, bool firing,
+                            double value, uint64_t timestampMs) {
+    if (events_.size() == MAX_EVENTS) {
+        events_.pop_front();
+    }
+    AlertEvent event;
+    event.sequence = ++lastSequence_;
+    event.timestampMs = timestampMs;
+    event.firing = firing;
+    event.rule = program_.labels[instruction.rule];
+    event.instance = state.instance;
+    event.value = value;
+    event.threshold = firing ? instruction.threshold : instruction.clearThreshold;
+    events_.push_back(std::move(event));
+}
+
+void AlertEngine::onSystemSample(const SystemMetrics& sample, uint32_t sources) {
+    if (program_.system.empty()) {
+        return;
+    }
+    
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t now = sample.timestampMs;
+        
+        for (uint32_t i = 0; i < program_.system.size(); ++i) {
+            const auto& instruction = program_.system[i];
+            if (!(instruction.sources & sources)) {
+                continue;
+            }
+            
+            if (!isCoreOperand(instruction.operand)) {
+                changed |= evaluate(instruction, InstanceKey{i, 0, 0}, systemValue(instruction.operand, sample),
+                                    now, [] { return std::string(); });
+                continue;
+            }
+            
+            const auto& cores = coreValues(instruction.operand, sample);
+            uint32_t first = instruction.selector == AlertSelector::Index ? instruction.index : 0;
+            uint32_t last = instruction.selector == AlertSelector::Index
+                ? std::min<uint32_t>(instruction.index + 1, static_cast<uint32_t>(cores.size()))
+                : static_cast<uint32_t>(cores.size());
+            for (uint32_t core = first; core < last; ++core) {
+                changed |= evaluate(instruction, InstanceKey{i, core, 0}, cores[core], now,
+                                    [core] { return "core" + std::to_string(core); });
+            }
+        }
+        
+        // Instances of cores beyond this sample's count belong to CPUs taken offline
+        for (auto it = states_.begin(); it != states_.end();) {
+            uint32_t index = it->first.instruction;
+            if (index >= program_.system.size() || !isCoreOperand(program_.system[index].operand) ||
+                it->first.id < coreValues(program_.system[index].operand, sample).size() ||
+                !(program_.system[index].sources & sources)) {
+                ++it;
+                continue;
+            }
+            if (it->second.firing) {
+                pushEvent(program_.system[index], it->second, false, it->second.value, now);
+                changed = true;
+            }
+            it = states_.erase(it);
+        }
+    }
+    
+    // Subscribers are told outside the lock so they may read the events
+    if (changed) {
+        notifier_.publish();
+    }
+}
+
+void AlertEngine::onProcessScan(const ProcessTable& processes, uint64_t timestampMs) {
+    if (program_.process.empty()) {
+        return;
+    }
+    
+    auto systemCount = static_cast<uint32_t>(program_.system.size());
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++scan_;
+        
+        auto run = [&](uint32_t index, ProcessTable::Row row) {
+            const auto& instruction = program_.process[index];
+            double value = instruction.operand == AlertOperand::ProcessCpuPercent
+                ? processes.cpuPercent(row) : static_cast<double>(processes.memoryBytes(row));
+            uint32_t pid = processes.pid(row);
+            changed |= evaluate(instruction, InstanceKey{systemCount + index, pid, processes.creationTime(row)},
+                                value, timestampMs, [&processes, row, pid] {
+                                    return std::string(processes.name(row)) + "[" + std::to_string(pid) + "]";
+                                });
+        };
+        
+        for (ProcessTable::Row row = 0; row < processes.size(); ++row) {
+            for (uint32_t index : anyProcess_) {
+                run(index, row);
+            }
+            if (!processesByName_.empty()) {
+                auto named = processesByName_.find(processes.name(row));
+                if (named != processesByName_.end()) {
+                    for (uint32_t index : named->second) {
+                        run(index, row);
+                    }
+                }
+            }
+            if (!processesByPid_.empty()) {
+                auto byPid = processesByPid_.find(processes.pid(row));
+                if (byPid != processesByPid_.end()) {
+                    for (uint32_t index : byPid->second) {
+                        run(index, row);
+                    }
+                }
+            }
+        }
+        
+        // Instances missing from this scan belong to processes that exited
+        for (auto it = states_.begin(); it != states_.end();) {
+            if (it->first.instruction < systemCount || it->second.scan == scan_) {
+                ++it;
+                continue;
+            }
+            if (it->second.firing) {
+                const auto& instruction = program_.process[it->first.instruction - systemCount];
+                pushEvent(instruction, it->second, false, it->second.value, timestampMs);
+                changed = true;
+            }
+            it = states_.erase(it);
+        }
+    }
+    
+    if (changed) {
+        notifier_.publish();
+    }
+}
+
+void AlertEngine::getActive(std::vector<ActiveAlert>& out) const {
+    out.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : states_) {
+            const InstanceState& state = entry.second;
+            if (!state.firing) {
+                continue;
+            }
+            uint32_t instruction = entry.first.instruction;
+            uint32_t rule = instruction < program_.system.size()
+                ? program_.system[instruction].rule
+                : program_.process[instruction - program_.system.size()].rule;
+            out.push_back({program_.labels[rule], state.instance, state.value, state.firedMs});
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const ActiveAlert& a, const ActiveAlert& b) {
+        return a.sinceMs != b.sinceMs ? a.sinceMs < b.sinceMs : a.rule < b.rule;
+    });
+}
+
+uint64_t AlertEngine::getEvents(uint64_t after, std::vector<AlertEvent>& out) const {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& event : events_) {
+        if (event.sequence > after) {
+            out.push_back(event);
+        }
+    }
+    return std::max(after, lastSequence_);
+}
+
+ChangeNotifier::SubscriptionId AlertEngine::subscribe(ChangeNotifier::Callback callback) {
+    return notifier_.subscribe(std::move(callback));
+}
+
+void AlertEngine::unsubscribe(ChangeNotifier::SubscriptionId id) {
+    notifier_.unsubscribe(id);
+}
+
+} // namespace sysmon
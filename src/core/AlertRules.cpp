@@ -0,0 +1,354 @@
+#include "AlertRules.h"
+#include "SampleObserver.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace sysmon {
+
+namespace {
+    struct Unit {
+        const char* suffix;
+        double scale;
+    };
+    
+    // Longest suffixes first so "KiB" isn't read as "K"
+    constexpr Unit SIZE_UNITS[] = {
+        {"KiB", 1024.0}, {"MiB", 1024.0 * 1024}, {"GiB", 1024.0 * 1024 * 1024},
+        {"TiB", 1024.0 * 1024 * 1024 * 1024},
+        {"KB", 1e3}, {"MB", 1e6}, {"GB", 1e9}, {"TB", 1e12},
+        {"%", 1.0},
+    };
+    
+    constexpr Unit DURATION_UNITS[] = {
+        {"ms", 1.0}, {"s", 1000.0}, {"m", 60000.0}, {"h", 3600000.0},
+    };
+    
+    struct SystemMetric {
+        const char* name;
+        AlertOperand operand;
+        uint32_t sources;
+    };
+    
+    constexpr SystemMetric SYSTEM_METRICS[] = {
+        {"cpu", AlertOperand::CpuPercent, SAMPLE_CPU},
+        {"memory", AlertOperand::MemoryPercent, SAMPLE_MEMORY},
+        {"memory.used", AlertOperand::MemoryUsedBytes, SAMPLE_MEMORY},
+        {"disk.read", AlertOperand::DiskReadRate, SAMPLE_DISK},
+        {"disk.write", AlertOperand::DiskWriteRate, SAMPLE_DISK},
+        {"net.recv", AlertOperand::NetworkRecvRate, SAMPLE_NETWORK},
+        {"net.send", AlertOperand::NetworkSendRate, SAMPLE_NETWORK},
+    };
+    
+    /**
+     * @brief Cursor over one rule's text
+     */
+    class RuleParser {
+    public:
+        RuleParser(const std::string& text, std::string& error)
+            : text_(text), error_(error) {}
+        
+        void skipSpaces() {
+            while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+                ++pos_;
+            }
+        }
+        
+        bool atEnd() {
+            skipSpaces();
+            return pos_ == text_.size();
+        }
+        
+        bool accept(const char* token) {
+            skipSpaces();
+            size_t length = std::strlen(token);
+            if (text_.compare(pos_, length, token) != 0) {
+                return false;
+            }
+            pos_ += length;
+            return true;
+        }
+        
+        // A keyword must not run into the next word ("for" vs "format")
+        bool acceptWord(const char* word) {
+            size_t saved = pos_;
+            if (!accept(word)) {
+                return false;
+            }
+            if (pos_ < text_.size() && std::isalnum(static_cast<unsigned char>(text_[pos_]))) {
+                pos_ = saved;
+                return false;
+            }
+            return true;
+        }
+        
+        // Dotted metric path up to '[', '(' or an operator
+        std::string path() {
+            skipSpaces();
+            size_t start = pos_;
+            while (pos_ < text_.size() &&
+                   (std::isalnum(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '.' || text_[pos_] == '_')) {
+                ++pos_;
+            }
+            return text_.substr(start, pos_ - start);
+        }
+        
+        // Text up to (not including) @p terminator
+        bool until(char terminator, std::string& out) {
+            size_t end = text_.find(terminator, pos_);
+            if (end == std::string::npos) {
+                return fail(std::string("missing '") + terminator + "'");
+            }
+            out = text_.substr(pos_, end - pos_);
+            pos_ = end + 1;
+            return true;
+        }
+        
+        bool number(double& value) {
+            skipSpaces();
+            const char* begin = text_.c_str() + pos_;
+            char* end = nullptr;
+            value = std::strtod(begin, &end);
+            if (end == begin || !std::isfinite(value)) {
+                return fail("expected a number at '" + text_.substr(pos_) + "'");
+            }
+            pos_ += static_cast<size_t>(end - begin);
+            return true;
+        }
+        
+        bool unsignedInteger(uint32_t& value) {
+            skipSpaces();
+            size_t start = pos_;
+            uint64_t parsed = 0;
+            while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_])) && parsed <= UINT32_MAX) {
+                parsed = parsed * 10 + static_cast<uint64_t>(text_[pos_] - '0');
+                ++pos_;
+            }
+            if (pos_ == start || parsed > UINT32_MAX) {
+                return fail("expected an integer");
+            }
+            value = static_cast<uint32_t>(parsed);
+            return true;
+        }
+        
+        // Number with an optional size or percent unit, then an optional "/s"
+        bool quantity(double& value) {
+            if (!number(value)) {
+                return false;
+            }
+            skipSpaces();
+            for (const auto& unit : SIZE_UNITS) {
+                if (text_.compare(pos_, std::strlen(unit.suffix), unit.suffix) == 0) {
+                    pos_ += std::strlen(unit.suffix);
+                    value *= unit.scale;
+                    break;
+                }
+            }
+            accept("/s");
+            return true;
+        }
+        
+        bool duration(uint64_t& ms) {
+            double value = 0.0;
+            if (!number(value) || value < 0.0) {
+                return fail("expected a duration");
+            }
+            skipSpaces();
+            for (const auto& unit : DURATION_UNITS) {
+                size_t length = std::strlen(unit.suffix);
+                if (text_.compare(pos_, length, unit.suffix) == 0 &&
+                    (pos_ + length == text_.size() || !std::isalpha(static_cast<unsigned char>(text_[pos_ + length])))) {
+                    pos_ += length;
+                    ms = static_cast<uint64_t>(std::llround(value * unit.scale));
+                    return true;
+                }
+            }
+            return fail("duration needs a unit (ms, s, m or h)");
+        }
+        
+        bool fail(const std::string& message) {
+            if (error_.empty()) {
+                error_ = message;
+            }
+            return false;
+        }
+        
+        std::string rest() const { return text_.substr(pos_); }
+        
+    private:
+        const std::string& text_;
+        std::string& error_;
+        size_t pos_{0};
+    };
+    
+    std::string trimmed(const std::string& value) {
+        size_t start = value.find_first_not_of(" \t");
+        if (start == std::string::npos) {
+            return "";
+        }
+        size_t end = value.find_last_not_of(" \t");
+        return value.substr(start, end - start + 1);
+    }
+    
+    bool parseCompare(RuleParser& parser, AlertCompare& compare) {
+        // Two-character operators first
+        if (parser.accept(">=")) {
+            compare = AlertCompare::GreaterEqual;
+        } else if (parser.accept("<=")) {
+            compare = AlertCompare::LessEqual;
+        } else if (parser.accept(">")) {
+            compare = AlertCompare::Greater;
+        } else if (parser.accept("<")) {
+            compare = AlertCompare::Less;
+        } else {
+            return parser.fail("expected >, >=, < or <= at '" + parser.rest() + "'");
+        }
+        return true;
+    }
+    
+    bool parseProcessMetric(RuleParser& parser, AlertInstruction& instruction) {
+        std::string selector;
+        if (!parser.until(')', selector)) {
+            return false;
+        }
+        selector = trimmed(selector);
+        if (selector == "*") {
+            instruction.selector = AlertSelector::Any;
+        } else if (selector.compare(0, 5, "name=") == 0 && selector.size() > 5) {
+            instruction.selector = AlertSelector::Name;
+            instruction.name = trimmed(selector.substr(5));
+        } else if (selector.compare(0, 4, "pid=") == 0) {
+            std::string pid = trimmed(selector.substr(4));
+            std::string ignored;
+            RuleParser pidParser(pid, ignored);
+            if (!pidParser.unsignedInteger(instruction.index) || !pidParser.atEnd()) {
+                return parser.fail("bad pid in proc(" + selector + ")");
+            }
+            instruction.selector = AlertSelector::Index;
+        } else {
+            return parser.fail("proc() takes name=NAME, pid=N or *");
+        }
+        
+        if (!parser.accept(".")) {
+            return parser.fail("expected .cpu or .rss after proc(...)");
+        }
+        std::string field = parser.path();
+        if (field == "cpu") {
+            instruction.operand = AlertOperand::ProcessCpuPercent;
+        } else if (field == "rss" || field == "memory") {
+            instruction.operand = AlertOperand::ProcessRssBytes;
+        } else {
+            return parser.fail("unknown process field '" + field + "' (cpu or rss)");
+        }
+        return true;
+    }
+    
+    bool parseSystemMetric(RuleParser& parser, const std::string& path, AlertInstruction& instruction) {
+        if (path == "cpu.core") {
+            if (!parser.accept("[")) {
+                return parser.fail("expected [N] or [*] after cpu.core");
+            }
+            if (parser.accept("*")) {
+                instruction.selector = AlertSelector::Any;
+            } else if (parser.unsignedInteger(instruction.index)) {
+                instruction.selector = AlertSelector::Index;
+            } else {
+                return false;
+            }
+            if (!parser.accept("]")) {
+                return parser.fail("expected ] after the core");
+            }
+            // "cpu.core[*].usage" reads the same as "cpu.core[*]"
+            instruction.operand = AlertOperand::CorePercent;
+            if (parser.accept(".")) {
+                std::string field = parser.path();
+                if (field == "steal") {
+                    instruction.operand = AlertOperand::CoreStealPercent;
+                } else if (field != "usage") {
+                    return parser.fail("unknown core field '" + field + "' (usage or steal)");
+                }
+            }
+            instruction.sources = SAMPLE_CPU;
+            return true;
+        }
+        
+        std::string name = path == "cpu.usage" ? "cpu" : path == "memory.percent" ? "memory" : path;
+        for (const auto& metric : SYSTEM_METRICS) {
+            if (name == metric.name) {
+                instruction.operand = metric.operand;
+                instruction.sources = metric.sources;
+                return true;
+            }
+        }
+        return parser.fail("unknown metric '" + path + "'");
+    }
+}
+
+bool compileAlertRule(const std::string& source, AlertProgram& program, std::string& error) {
+    std::string text = trimmed(source);
+    std::string label;
+    
+    // An optional "label:" prefix; the rule text itself is the default label
+    size_t colon = text.find(':');
+    size_t open = text.find_first_of("([");
+    if (colon != std::string::npos && (open == std::string::npos || colon < open)) {
+        label = trimmed(text.substr(0, colon));
+        text = trimmed(text.substr(colon + 1));
+        if (label.empty()) {
+            error = "empty label";
+            return false;
+        }
+    }
+    if (label.empty()) {
+        label = text;
+    }
+    
+    AlertInstruction instruction;
+    RuleParser parser(text, error);
+    
+    std::string path = parser.path();
+    bool parsed = path == "proc" ? parser.accept("(") && parseProcessMetric(parser, instruction)
+                                 : parseSystemMetric(parser, path, instruction);
+    if (!parsed) {
+        if (error.empty()) {
+            error = "expected a metric";
+        }
+        return false;
+    }
+    
+    if (!parseCompare(parser, instruction.compare) || !parser.quantity(instruction.threshold)) {
+        return false;
+    }
+    instruction.clearThreshold = instruction.threshold;
+    
+    if (parser.acceptWord("for") && !parser.duration(instruction.forMs)) {
+        return false;
+    }
+    if (parser.acceptWord("clear") && !parser.quantity(instruction.clearThreshold)) {
+        return false;
+    }
+    if (!parser.atEnd()) {
+        error = "unexpected '" + parser.rest() + "'";
+        return false;
+    }
+    
+    // The clear level has to be on the safe side of the threshold
+    bool above = instruction.compare == AlertCompare::Greater || instruction.compare == AlertCompare::GreaterEqual;
+    if (above ? instruction.clearThreshold > instruction.threshold
+              : instruction.clearThreshold < instruction.threshold) {
+        error = "clear level must be on the other side of the threshold";
+        return false;
+    }
+    
+    instruction.rule = static_cast<uint32_t>(program.labels.size());
+    program.labels.push_back(std::move(label));
+    if (instruction.sources == 0) {
+        program.process.push_back(std::move(instruction));
+    } else {
+        program.system.push_back(std::move(instruction));
+    }
+    return true;
+}
+
+} // namespace sysmon
@@ -0,0 +1,109 @@
+#include "AnomalyDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sysmon {
+
+namespace {
+    constexpr uint64_t DAY_MS = 24ull * 3600 * 1000;
+}
+
+AnomalyDetector::AnomalyDetector(const Options& options)
+    : options_(options) {
+    if (options_.seasonBuckets > 1) {
+        bucketMs_ = DAY_MS / options_.seasonBuckets;
+    }
+}
+
+AnomalyDetector::SeriesId AnomalyDetector::addSeries(bool seasonal, double minStdDev) {
+    SeriesId id;
+    if (!freeSeries_.empty()) {
+        id = freeSeries_.back();
+        freeSeries_.pop_back();
+        series_[id] = Series{};
+    } else {
+        id = static_cast<SeriesId>(series_.size());
+        series_.emplace_back();
+    }
+    
+    Series& series = series_[id];
+    series.minStdDev = minStdDev;
+    if (seasonal && bucketMs_ > 0) {
+        if (!freeSeasons_.empty()) {
+            series.seasonOffset = freeSeasons_.back();
+            freeSeasons_.pop_back();
+            std::fill_n(seasons_.begin() + series.seasonOffset, options_.seasonBuckets, Baseline{});
+        } else {
+            series.seasonOffset = static_cast<uint32_t>(seasons_.size());
+            seasons_.resize(seasons_.size() + options_.seasonBuckets);
+        }
+    }
+    return id;
+}
+
+void AnomalyDetector::removeSeries(SeriesId id) {
+    Series& series = series_[id];
+    if (series.seasonOffset != NO_SEASONS) {
+        freeSeasons_.push_back(series.seasonOffset);
+        series.seasonOffset = NO_SEASONS;
+    }
+    freeSeries_.push_back(id);
+}
+
+void AnomalyDetector::update(Baseline& baseline, double value, double alpha) const {
+    // A running average until warmed up, then exponential decay
+    ++baseline.samples;
+    if (baseline.samples <= options_.warmupSamples) {
+        alpha = std::max(alpha, 1.0 / baseline.samples);
+    }
+    double diff = value - baseline.mean;
+    double increment = alpha * diff;
+    baseline.mean += increment;
+    baseline.variance = (1.0 - alpha) * (baseline.variance + diff * increment);
+}
+
+AnomalyDetector::Observation AnomalyDetector::observe(SeriesId id, double value, uint64_t timestampMs) {
+    Series& series = series_[id];
+    Baseline* season = nullptr;
+    if (series.seasonOffset != NO_SEASONS) {
+        season = &seasons_[series.seasonOffset + (timestampMs / bucketMs_) % options_.seasonBuckets];
+    }
+    
+    // Score against the time-of-day baseline once it knows enough, else the overall one
+    const Baseline& reference = season && season->samples >= options_.warmupSamples ? *season : series.overall;
+    bool warm = reference.samples >= options_.warmupSamples;
+    double stdDev = std::max(std::sqrt(reference.variance), series.minStdDev);
+    
+    Observation result;
+    result.mean = reference.mean;
+    result.zScore = reference.samples > 0 && stdDev > 0.0 ? (value - reference.mean) / stdDev : 0.0;
+    double magnitude = std::fabs(result.zScore);
+    if (!series.anomalous && warm && magnitude >= options_.raiseZ) {
+        series.anomalous = true;
+        result.transition = Transition::Raised;
+    } else if (series.anomalous && magnitude < options_.clearZ) {
+        series.anomalous = false;
+        result.transition = Transition::Cleared;
+    }
+    result.anomalous = series.anomalous;
+    
+    // Outliers move the baseline only as far as the raise threshold
+    double learned = value;
+    if (warm) {
+        double limit = options_.raiseZ * stdDev;
+        learned = std::clamp(value, reference.mean - limit, reference.mean + limit);
+    }
+    
+    double elapsedSec = series.lastMs > 0 && timestampMs > series.lastMs
+        ? static_cast<double>(timestampMs - series.lastMs) / 1000.0 : 0.0;
+    series.lastMs = timestampMs;
+    double alpha = 1.0 - std::exp2(-elapsedSec / options_.halfLifeSeconds);
+    update(series.overall, learned, alpha);
+    if (season) {
+        double seasonAlpha = 1.0 - std::exp2(-elapsedSec / (options_.halfLifeSeconds * options_.seasonBuckets));
+        update(*season, learned, seasonAlpha);
+    }
+    return result;
+}
+
+} // namespace sysmon
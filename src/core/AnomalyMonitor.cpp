@@ -0,0 +1,243 @@
+#include "AnomalyMonitor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace sysmon {
+
+namespace {
+    // Standard deviation floors, so flat series don't alert on their first wobble
+    constexpr double CPU_MIN_STDDEV = 1.0;                      // percentage points
+    constexpr double MEMORY_MIN_STDDEV = 0.5;                   // percentage points
+    constexpr double RATE_MIN_STDDEV = 64.0 * 1024;             // bytes/s
+    constexpr double PROCESS_CPU_MIN_STDDEV = 5.0;              // percentage points
+    constexpr double PROCESS_MEMORY_MIN_STDDEV = 64.0 * 1024 * 1024;  // bytes
+    
+    AnomalyDetector::Options detectorOptions(const Configuration& config) {
+        AnomalyDetector::Options options;
+        options.halfLifeSeconds = config.anomalyHalfLifeSec;
+        options.seasonBuckets = config.anomalySeasonBuckets;
+        options.raiseZ = config.anomalyRaiseZ;
+        options.clearZ = config.anomalyClearZ;
+        return options;
+    }
+}
+
+AnomalyMonitor::AnomalyMonitor(const Configuration& config)
+    : detector_(detectorOptions(config)) {
+}
+
+template <typename Describe>
+bool AnomalyMonitor::score(SeriesId id, double value, uint64_t timestampMs, Describe&& describe) {
+    auto observation = detector_.observe(id, value, timestampMs);
+    samplesScored_.fetch_add(1, std::memory_order_relaxed);
+    
+    switch (observation.transition) {
+        case AnomalyDetector::Transition::Raised: {
+            Anomaly anomaly;
+            describe(anomaly);
+            anomaly.value = value;
+            anomaly.mean = observation.mean;
+            anomaly.zScore = observation.zScore;
+            anomaly.sinceMs = timestampMs;
+            active_.emplace_back(id, std::move(anomaly));
+            anomaliesRaised_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        case AnomalyDetector::Transition::Cleared:
+            return clearSeries(id, false);
+        default:
+            return false;
+    }
+}
+
+AnomalyMonitor::SeriesId AnomalyMonitor::hostSeries(SeriesId& id, double minStdDev) {
+    if (id == NO_SERIES) {
+        id = detector_.addSeries(true, minStdDev);
+    }
+    return id;
+}
+
+bool AnomalyMonitor::clearSeries(SeriesId id, bool remove) {
+    if (remove) {
+        detector_.removeSeries(id);
+    }
+    auto it = std::find_if(active_.begin(), active_.end(),
+                           [id](const std::pair<SeriesId, Anomaly>& entry) { return entry.first == id; });
+    if (it == active_.end()) {
+        return false;
+    }
+    active_.erase(it);
+    return true;
+}
+
+bool AnomalyMonitor::scoreDevices(std::unordered_map<std::string, DeviceSeries>& devices,
+                                  const std::vector<DeviceCounters>& counters, const char* prefix,
+                                  const char* readName, const char* writeName, uint64_t timestampMs) {
+    bool changed = false;
+    for (auto& entry : devices) {
+        entry.second.seen = false;
+    }
+    
+    for (const auto& counter : counters) {
+        DeviceSeries& device = devices[counter.name];
+        device.seen = true;
+        if (device.read == NO_SERIES) {
+            device.read = detector_.addSeries(true, RATE_MIN_STDDEV);
+            device.write = detector_.addSeries(true, RATE_MIN_STDDEV);
+        } else if (timestampMs > device.lastMs &&
+                   counter.readBytes >= device.lastRead && counter.writeBytes >= device.lastWrite) {
+            // Counters that went backwards (device reset) just restart the rate
+            double seconds = static_cast<double>(timestampMs - device.lastMs) / 1000.0;
+            double readRate = static_cast<double>(counter.readBytes - device.lastRead) / seconds;
+            double writeRate = static_cast<double>(counter.writeBytes - device.lastWrite) / seconds;
+            changed |= score(device.read, readRate, timestampMs, [&](Anomaly& anomaly) {
+                anomaly.series = std::string(prefix) + "." + counter.name + "." + readName;
+            });
+            changed |= score(device.write, writeRate, timestampMs, [&](Anomaly& anomaly) {
+                anomaly.series = std::string(prefix) + "." + counter.name + "." + writeName;
+            });
+        }
+        device.lastRead = counter.readBytes;
+        device.lastWrite = counter.writeBytes;
+        device.lastMs = timestampMs;
+    }
+    
+    for (auto it = devices.begin(); it != devices.end();) {
+        if (it->second.seen) {
+            ++it;
+            continue;
+        }
+        changed |= clearSeries(it->second.read, true);
+        changed |= clearSeries(it->second.write, true);
+        it = devices.erase(it);
+    }
+    return changed;
+}
+
+void AnomalyMonitor::onSystemSample(const SystemMetrics& sample, uint32_t sources) {
+    bool changed = false;
+    uint64_t now = sample.timestampMs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        
+        if (sources & SAMPLE_CPU) {
+            changed |= score(hostSeries(cpu_, CPU_MIN_STDDEV), sample.cpuUsagePercent, now,
+                             [](Anomaly& anomaly) { anomaly.series = "cpu"; });
+            
+            const auto& cores = sample.perCoreCpuUsage;
+            while (cores_.size() > cores.size()) {
+                changed |= clearSeries(cores_.back(), true);
+                cores_.pop_back();
+            }
+            cores_.resize(cores.size(), NO_SERIES);
+            for (size_t core = 0; core < cores.size(); ++core) {
+                changed |= score(hostSeries(cores_[core], CPU_MIN_STDDEV), cores[core], now,
+                                 [core](Anomaly& anomaly) { anomaly.series = "cpu" + std::to_string(core); });
+            }
+        }
+        
+        if (sources & SAMPLE_MEMORY) {
+            changed |= score(hostSeries(memory_, MEMORY_MIN_STDDEV), sample.memoryUsagePercent, now,
+                             [](Anomaly& anomaly) { anomaly.series = "memory"; });
+        }
+        
+        if (sources & SAMPLE_DISK) {
+            changed |= score(hostSeries(diskRead_, RATE_MIN_STDDEV),
+                             static_cast<double>(sample.diskReadBytesPerSec), now,
+                             [](Anomaly& anomaly) { anomaly.series = "disk.read"; });
+            changed |= score(hostSeries(diskWrite_, RATE_MIN_STDDEV),
+                             static_cast<double>(sample.diskWriteBytesPerSec), now,
+                             [](Anomaly& anomaly) { anomaly.series = "disk.write"; });
+            changed |= scoreDevices(disks_, sample.diskDevices, "disk", "read", "write", now);
+        }
+        
+        if (sources & SAMPLE_NETWORK) {
+            changed |= score(hostSeries(networkRecv_, RATE_MIN_STDDEV),
+                             static_cast<double>(sample.networkRecvBytesPerSec), now,
+                             [](Anomaly& anomaly) { anomaly.series = "net.recv"; });
+            changed |= score(hostSeries(networkSend_, RATE_MIN_STDDEV),
+                             static_cast<double>(sample.networkSendBytesPerSec), now,
+                             [](Anomaly& anomaly) { anomaly.series = "net.send"; });
+            changed |= scoreDevices(interfaces_, sample.networkInterfaces, "net", "recv", "send", now);
+        }
+    }
+    
+    // Subscribers are told outside the lock so they may call getActive()
+    if (changed) {
+        notifier_.publish();
+    }
+}
+
+void AnomalyMonitor::onProcessScan(const ProcessTable& processes, uint64_t timestampMs) {
+    bool changed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++scan_;
+        
+        for (ProcessTable::Row row = 0; row < processes.size(); ++row) {
+            uint32_t pid = processes.pid(row);
+            auto [it, inserted] = processes_.try_emplace(ProcessKey{pid, processes.creationTime(row)});
+            ProcessSeries& series = it->second;
+            if (inserted) {
+                series.cpu = detector_.addSeries(false, PROCESS_CPU_MIN_STDDEV);
+                series.memory = detector_.addSeries(false, PROCESS_MEMORY_MIN_STDDEV);
+            }
+            series.scan = scan_;
+            
+            auto name = processes.name(row);
+            changed |= score(series.cpu, processes.cpuPercent(row), timestampMs, [pid, name](Anomaly& anomaly) {
+                anomaly.series = "process." + std::to_string(pid) + ".cpu";
+                anomaly.process = name;
+            });
+            changed |= score(series.memory, static_cast<double>(processes.memoryBytes(row)), timestampMs,
+                             [pid, name](Anomaly& anomaly) {
+                anomaly.series = "process." + std::to_string(pid) + ".memory";
+                anomaly.process = name;
+            });
+        }
+        
+        // Processes missing from this scan have exited
+        for (auto it = processes_.begin(); it != processes_.end();) {
+            if (it->second.scan == scan_) {
+                ++it;
+                continue;
+            }
+            changed |= clearSeries(it->second.cpu, true);
+            changed |= clearSeries(it->second.memory, true);
+            it = processes_.erase(it);
+        }
+    }
+    
+    if (changed) {
+        notifier_.publish();
+    }
+}
+
+void AnomalyMonitor::getActive(std::vector<Anomaly>& out) const {
+    out.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out.reserve(active_.size());
+        for (const auto& entry : active_) {
+            out.push_back(entry.second);
+        }
+    }
+    std::sort(out.begin(), out.end(), [](const Anomaly& a, const Anomaly& b) {
+        return std::fabs(a.zScore) > std::fabs(b.zScore);
+    });
+}
+
+ChangeNotifier::SubscriptionId AnomalyMonitor::subscribe(ChangeNotifier::Callback callback) {
+    return notifier_.subscribe(std::move(callback));
+}
+
+void AnomalyMonitor::unsubscribe(ChangeNotifier::SubscriptionId id) {
+    notifier_.unsubscribe(id);
+}
+
+size_t AnomalyMonitor::seriesCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return detector_.seriesCount();
+}
+
+} // namespace sysmon
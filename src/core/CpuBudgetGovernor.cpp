@@ -0,0 +1,150 @@
+#include "CpuBudgetGovernor.h"
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+    // Long enough that a 0.5% budget is tens of milliseconds of CPU time
+    constexpr std::chrono::seconds EVALUATION_WINDOW{5};
+    
+    // Ladder layout; see the class comment
+    constexpr uint32_t PROCESS_SCALE_STEPS = 3;
+    constexpr uint32_t REDUCED_DETAIL_STEP = PROCESS_SCALE_STEPS + 1;
+    constexpr uint32_t SYSTEM_SCALE_STEPS = 2;
+    constexpr uint32_t MAX_STEP = REDUCED_DETAIL_STEP + SYSTEM_SCALE_STEPS;
+    
+    // Relax only once usage is well under budget so the ladder doesn't oscillate
+    constexpr double RELAX_FRACTION = 0.5;
+}
+
+CpuBudgetGovernor::CpuBudgetGovernor(const Configuration& config)
+    : budgetPercent_(config.cpuBudgetPercent) {
+}
+
+CpuBudgetGovernor::~CpuBudgetGovernor() {
+    stop();
+}
+
+void CpuBudgetGovernor::start() {
+    if (!enabled() || running_) {
+        return;
+    }
+    
+    running_ = true;
+    evaluationThread_ = std::thread(&CpuBudgetGovernor::evaluationLoop, this);
+}
+
+void CpuBudgetGovernor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        running_ = false;
+    }
+    wakeCv_.notify_all();
+    if (evaluationThread_.joinable()) {
+        evaluationThread_.join();
+    }
+}
+
+uint32_t CpuBudgetGovernor::processIntervalScale() const {
+    return 1u << std::min(step(), PROCESS_SCALE_STEPS);
+}
+
+bool CpuBudgetGovernor::reducedProcessDetail() const {
+    return step() >= REDUCED_DETAIL_STEP;
+}
+
+uint32_t CpuBudgetGovernor::systemIntervalScale() const {
+    uint32_t current = step();
+    return current > REDUCED_DETAIL_STEP ? 1u << (current - REDUCED_DETAIL_STEP) : 1u;
+}
+
+const char* CpuBudgetGovernor::description() const {
+    uint32_t current = step();
+    if (current == 0) {
+        return "";
+    }
+    if (current < REDUCED_DETAIL_STEP) {
+        return "slower process scan";
+    }
+    if (current == REDUCED_DETAIL_STEP) {
+        return "reduced process detail";
+    }
+    return "slower system metrics";
+}
+
+std::chrono::microseconds CpuBudgetGovernor::processCpuTime() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return std::chrono::microseconds(0);
+    }
+    
+    // FILETIME is in 100 ns units
+    auto toMicros = [](const FILETIME& ft) {
+        ULARGE_INTEGER value;
+        value.LowPart = ft.dwLowDateTime;
+        value.HighPart = ft.dwHighDateTime;
+        return static_cast<int64_t>(value.QuadPart / 10);
+    };
+    return std::chrono::microseconds(toMicros(kernel) + toMicros(user));
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return std::chrono::microseconds(0);
+    }
+    
+    auto toMicros = [](const timeval& tv) {
+        return static_cast<int64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+    };
+    return std::chrono::microseconds(toMicros(usage.ru_utime) + toMicros(usage.ru_stime));
+#endif
+}
+
+void CpuBudgetGovernor::evaluationLoop() {
+    auto lastCpu = processCpuTime();
+    auto lastWall = std::chrono::steady_clock::now();
+    
+    while (running_) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex_);
+            wakeCv_.wait_for(lock, EVALUATION_WINDOW, [this] { return !running_; });
+        }
+        if (!running_) {
+            break;
+        }
+        
+        auto cpu = processCpuTime();
+        auto wall = std::chrono::steady_clock::now();
+        evaluate(cpu - lastCpu, wall - lastWall);
+        lastCpu = cpu;
+        lastWall = wall;
+    }
+}
+
+void CpuBudgetGovernor::evaluate(std::chrono::microseconds cpuTime,
+                                 std::chrono::steady_clock::duration wall) {
+    double wallUs = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::microseconds>(wall).count());
+    if (wallUs <= 0.0) {
+        return;
+    }
+    
+    double usage = 100.0 * static_cast<double>(cpuTime.count()) / wallUs;
+    selfCpuPercent_.store(usage, std::memory_order_relaxed);
+    
+    // One step per window: each step needs a full window to show its effect
+    uint32_t current = step();
+    if (usage > budgetPercent_ && current < MAX_STEP) {
+        step_.store(current + 1, std::memory_order_relaxed);
+    } else if (usage < budgetPercent_ * RELAX_FRACTION && current > 0) {
+        step_.store(current - 1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace sysmon
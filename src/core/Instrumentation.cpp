@@ -0,0 +1,145 @@
+#include "Instrumentation.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+
+namespace sysmon {
+
+namespace {
+    const char* const SOURCE_NAMES[] = {
+        "collectCPUMetrics",
+        "collectMemoryMetrics",
+        "collectDiskMetrics",
+        "collectNetworkMetrics",
+        "enumerateProcesses",
+        "buildTree",
+        "indexNames",
+        "groupProcesses",
+        "diffProcesses",
+        "getSnapshot",
+        "render.cpu",
+        "render.memory",
+        "render.disk",
+        "render.network",
+        "render.processTree",
+        "render.statusBar",
+        "render.fleet",
+    };
+    
+    static_assert(sizeof(SOURCE_NAMES) / sizeof(SOURCE_NAMES[0]) ==
+                  static_cast<size_t>(TraceSource::Count), "Missing trace source name");
+}
+
+const char* traceSourceName(TraceSource source) {
+    size_t index = static_cast<size_t>(source);
+    return index < static_cast<size_t>(TraceSource::Count) ? SOURCE_NAMES[index] : "unknown";
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+    
+    // Top SUB_BUCKET_BITS bits below the leading one select the sub-bucket
+    unsigned msb = 63 - static_cast<unsigned>(std::countl_zero(value));
+    unsigned shift = msb - SUB_BUCKET_BITS;
+    size_t sub = static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+    return (msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketMidpoint(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    
+    unsigned group = static_cast<unsigned>(index / SUB_BUCKETS);
+    uint64_t sub = index % SUB_BUCKETS;
+    unsigned shift = group - 1;
+    uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + ((uint64_t{1} << shift) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    buckets_[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    
+    uint64_t previous = max_.load(std::memory_order_relaxed);
+    while (nanos > previous &&
+           !max_.compare_exchange_weak(previous, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    
+    auto target = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+    target = std::max<uint64_t>(target, 1);
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucketMidpoint(i), max());
+        }
+    }
+    return max();
+}
+
+Instrumentation& Instrumentation::instance() {
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+void Instrumentation::enableSpanCapture(size_t capacity) {
+    spans_ = std::make_unique<Span[]>(capacity);
+    spanCapacity_ = capacity;
+    spanCount_ = 0;
+}
+
+uint32_t Instrumentation::currentThreadId() {
+    static std::atomic<uint32_t> nextId{1};
+    thread_local uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void Instrumentation::record(TraceSource source, uint64_t startNs, uint64_t durationNs) {
+    histograms_[static_cast<size_t>(source)].record(durationNs);
+    
+    if (spanCapacity_ > 0) {
+        // Ring buffer: the newest spans overwrite the oldest
+        uint64_t slot = spanCount_.fetch_add(1, std::memory_order_relaxed) % spanCapacity_;
+        spans_[slot] = Span{source, currentThreadId(), startNs, durationNs};
+    }
+}
+
+bool Instrumentation::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+    
+    uint64_t recorded = spanCount_.load(std::memory_order_relaxed);
+    size_t count = static_cast<size_t>(std::min<uint64_t>(recorded, spanCapacity_));
+    size_t first = recorded > spanCapacity_ ? static_cast<size_t>(recorded % spanCapacity_) : 0;
+    
+    // Complete ("X") events; timestamps are microseconds
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < count; ++i) {
+        const Span& span = spans_[(first + i) % spanCapacity_];
+        out << (i == 0 ? "" : ",\n")
+            << "{\"name\":\"" << traceSourceName(span.source) << "\","
+            << "\"cat\":\"sysmon\",\"ph\":\"X\",\"pid\":1,"
+            << "\"tid\":" << span.threadId << ","
+            << "\"ts\":" << span.startNs / 1000 << "." << (span.startNs % 1000) / 100 << ","
+            << "\"dur\":" << span.durationNs / 1000 << "." << (span.durationNs % 1000) / 100 << "}";
+    }
+    out << "\n]}\n";
+    
+    return out.good();
+}
+
+} // namespace sysmon
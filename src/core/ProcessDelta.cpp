@@ -0,0 +1,77 @@
+#include "ProcessDelta.h"
+#include "RowIndex.h"
+#include <cmath>
+
+namespace sysmon {
+
+namespace {
+    bool ascendingPids(const ProcessTable& table) {
+        for (ProcessTable::Row row = 1; row < table.size(); ++row) {
+            if (table.pid(row - 1) >= table.pid(row)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+void ProcessDelta::compute(const ProcessTable& previous, const ProcessTable& current,
+                           double cpuEpsilon, uint64_t memoryEpsilonBytes) {
+    added.clear();
+    reparented.clear();
+    changed.clear();
+    
+    std::vector<uint8_t> survived(previous.size(), 0);
+    auto match = [&](ProcessTable::Row row, ProcessTable::Row before) {
+        if (before == ProcessTable::NONE || previous.creationTime(before) != current.creationTime(row)) {
+            added.push_back(row);
+            return;
+        }
+        survived[before] = 1;
+        
+        if (previous.parentPid(before) != current.parentPid(row)) {
+            reparented.push_back(row);
+        }
+        uint64_t memoryBefore = previous.memoryBytes(before);
+        uint64_t memoryNow = current.memoryBytes(row);
+        uint64_t memoryMoved = memoryNow > memoryBefore ? memoryNow - memoryBefore : memoryBefore - memoryNow;
+        if (std::fabs(current.cpuPercent(row) - previous.cpuPercent(before)) > cpuEpsilon ||
+            memoryMoved > memoryEpsilonBytes) {
+            changed.push_back(row);
+        }
+    };
+    
+    if (ascendingPids(previous) && ascendingPids(current)) {
+        // /proc lists pids in ascending order, so scans usually merge without an index
+        ProcessTable::Row before = 0;
+        for (ProcessTable::Row row = 0; row < current.size(); ++row) {
+            while (before < previous.size() && previous.pid(before) < current.pid(row)) {
+                ++before;
+            }
+            bool found = before < previous.size() && previous.pid(before) == current.pid(row);
+            match(row, found ? before : ProcessTable::NONE);
+        }
+    } else {
+        RowIndex previousRows(previous.size());
+        for (ProcessTable::Row row = 0; row < previous.size(); ++row) {
+            previousRows.insert(previous.pid(row), row);
+        }
+        for (ProcessTable::Row row = 0; row < current.size(); ++row) {
+            match(row, previousRows.find(current.pid(row)));
+        }
+    }
+    
+    // Assigning over the old entries keeps their name buffers
+    size_t removedCount = 0;
+    for (ProcessTable::Row row = 0; row < previous.size(); ++row) {
+        if (!survived[row]) {
+            if (removedCount == removed.size()) {
+                removed.emplace_back();
+            }
+            previous.fillSummary(row, removed[removedCount++]);
+        }
+    }
+    removed.resize(removedCount);
+}
+
+} // namespace sysmon
@@ -0,0 +1,128 @@
+#include "ProcessGroups.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <pwd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+    const char* const GROUPING_NAMES[] = {"executable", "user", "cgroup"};
+    
+    static_assert(sizeof(GROUPING_NAMES) / sizeof(GROUPING_NAMES[0]) == PROCESS_GROUPINGS,
+                  "Missing process grouping name");
+    
+    // Key of the group collecting processes whose owner or cgroup is unknown
+    constexpr std::string_view UNKNOWN_KEY = "?";
+    
+    void reset(ProcessGroup& group, std::string_view key) {
+        group.key.assign(key);
+        group.cpuPercent = 0.0;
+        group.memoryBytes = 0;
+        group.processCount = 0;
+    }
+    
+    void add(ProcessGroup& group, const ProcessTable& table, ProcessTable::Row row) {
+        group.cpuPercent += table.cpuPercent(row);
+        group.memoryBytes += table.memoryBytes(row);
+        ++group.processCount;
+    }
+    
+    // Heaviest CPU first; ties by key so the order is stable between scans
+    void sortGroups(std::vector<ProcessGroup>& groups) {
+        std::sort(groups.begin(), groups.end(), [](const ProcessGroup& a, const ProcessGroup& b) {
+            if (a.cpuPercent != b.cpuPercent) {
+                return a.cpuPercent > b.cpuPercent;
+            }
+            return a.key < b.key;
+        });
+    }
+}
+
+bool parseProcessGrouping(std::string_view text, ProcessGrouping& grouping) {
+    for (size_t i = 0; i < PROCESS_GROUPINGS; ++i) {
+        if (text == GROUPING_NAMES[i]) {
+            grouping = static_cast<ProcessGrouping>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* processGroupingName(ProcessGrouping grouping) {
+    return GROUPING_NAMES[static_cast<size_t>(grouping)];
+}
+
+const std::string& ProcessGrouper::userName(uint32_t uid) {
+    auto it = userNames_.find(uid);
+    if (it != userNames_.end()) {
+        return it->second;
+    }
+    std::string name = uid == ProcessTable::UNKNOWN_UID ? std::string(UNKNOWN_KEY) : std::to_string(uid);
+#ifndef _WIN32
+    struct passwd entry;
+    struct passwd* found = nullptr;
+    char buffer[4096];
+    if (uid != ProcessTable::UNKNOWN_UID &&
+        getpwuid_r(static_cast<uid_t>(uid), &entry, buffer, sizeof(buffer), &found) == 0 && found) {
+        name = found->pw_name;
+    }
+#endif
+    return userNames_.emplace(uid, std::move(name)).first->second;
+}
+
+void ProcessGrouper::group(const ProcessTable& table, const ProcessNameIndex& names, ProcessGroups& out) {
+    // Executables are the name index's groups; cgroups are the table's ids,
+    // with one more slot at the end for processes whose cgroup is unknown
+    out.byExecutable.resize(names.groupCount());
+    groupOfName_.resize(names.nameIdOfRow.empty() ? 0 : *std::max_element(names.groupIds.begin(),
+                                                                         names.groupIds.end()) + 1);
+    for (uint32_t name = 0; name < names.groupCount(); ++name) {
+        groupOfName_[names.groupIds[name]] = name;
+        reset(out.byExecutable[name], table.name(names.rows(name).front()));
+    }
+    uint32_t cgroups = table.cgroupCount();
+    out.byCgroup.resize(cgroups + 1);
+    for (uint32_t cgroup = 0; cgroup < cgroups; ++cgroup) {
+        reset(out.byCgroup[cgroup], table.cgroupPath(cgroup));
+    }
+    reset(out.byCgroup[cgroups], UNKNOWN_KEY);
+    groupOfUid_.clear();
+    size_t users = 0;
+    uint32_t lastUid = ProcessTable::UNKNOWN_UID;
+    uint32_t lastUser = ProcessTable::NONE;
+    
+    // One pass over the rows in table order, feeding all three
+    for (ProcessTable::Row row = 0; row < table.size(); ++row) {
+        add(out.byExecutable[groupOfName_[names.nameIdOfRow[row]]], table, row);
+        
+        // Neighbouring rows mostly share an owner, so the hash map is only asked on a change
+        uint32_t uid = table.uid(row);
+        if (uid != lastUid || lastUser == ProcessTable::NONE) {
+            auto [it, inserted] = groupOfUid_.try_emplace(uid, static_cast<uint32_t>(users));
+            if (inserted) {
+                if (users == out.byUser.size()) {
+                    out.byUser.emplace_back();
+                }
+                reset(out.byUser[users++], userName(uid));
+            }
+            lastUid = uid;
+            lastUser = it->second;
+        }
+        add(out.byUser[lastUser], table, row);
+        
+        uint32_t cgroup = table.cgroup(row);
+        add(out.byCgroup[cgroup == ProcessTable::NO_CGROUP ? cgroups : cgroup], table, row);
+    }
+    out.byUser.resize(users);
+    if (out.byCgroup.back().processCount == 0) {
+        out.byCgroup.pop_back();
+    }
+    
+    sortGroups(out.byExecutable);
+    sortGroups(out.byUser);
+    sortGroups(out.byCgroup);
+}
+
+} // namespace sysmon
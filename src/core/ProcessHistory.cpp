@@ -0,0 +1,180 @@
+#include "ProcessHistory.h"
+#include "RowIndex.h"
+#include <algorithm>
+
+namespace sysmon {
+
+namespace {
+    // First allocation of the slab, in slots
+    constexpr size_t MIN_SLAB_SLOTS = 64;
+}
+
+ProcessHistory::ProcessHistory(size_t maxProcesses)
+    : maxSlots_(std::min<size_t>(maxProcesses, ProcessTable::NONE)) {
+}
+
+uint32_t ProcessHistory::takeFreeSlot() {
+    if (!freeSlots_.empty()) {
+        uint32_t slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        return slot;
+    }
+    if (slots_.size() >= maxSlots_) {
+        return ProcessTable::NONE;
+    }
+    // The slab grows up to the cap, doubling, and never shrinks
+    if (slots_.size() == slots_.capacity()) {
+        size_t reserved = std::min(std::max<size_t>(slots_.size() * 2, MIN_SLAB_SLOTS), maxSlots_);
+        slots_.reserve(reserved);
+        cpu_.reserve(reserved * SAMPLES);
+        memory_.reserve(reserved * SAMPLES);
+        ioWait_.reserve(reserved * SAMPLES);
+    }
+    slots_.emplace_back();
+    cpu_.resize(slots_.size() * SAMPLES);
+    memory_.resize(slots_.size() * SAMPLES);
+    ioWait_.resize(slots_.size() * SAMPLES);
+    return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+void ProcessHistory::assign(uint32_t slot, const ProcessTable& table, ProcessTable::Row row) {
+    Slot& entry = slots_[slot];
+    entry.pid = table.pid(row);
+    entry.startTime = table.creationTime(row);
+    entry.lastViewed = 0;
+    entry.row = row;
+    entry.next = 0;
+    entry.count = 0;
+    slotOfRow_[row] = slot;
+}
+
+void ProcessHistory::record(const ProcessTable& table) {
+    if (maxSlots_ == 0) {
+        return;
+    }
+    ProcessTable::Row rows = table.size();
+    slotOfRow_.assign(rows, ProcessTable::NONE);
+    
+    // Find each tracked process in the new table
+    matchOrder_.clear();
+    for (uint32_t slot = 0; slot < slots_.size(); ++slot) {
+        if (slots_[slot].row != ProcessTable::NONE) {
+            slots_[slot].row = ProcessTable::NONE;
+            matchOrder_.push_back(slot);
+        }
+    }
+    auto match = [&](uint32_t slot, ProcessTable::Row row) {
+        if (slotOfRow_[row] == ProcessTable::NONE && table.creationTime(row) == slots_[slot].startTime) {
+            slotOfRow_[row] = slot;
+            slots_[slot].row = row;
+        }
+    };
+    bool ascending = true;
+    for (ProcessTable::Row row = 1; ascending && row < rows; ++row) {
+        ascending = table.pid(row - 1) <= table.pid(row);
+    }
+    if (ascending) {
+        std::sort(matchOrder_.begin(), matchOrder_.end(),
+                  [&](uint32_t a, uint32_t b) { return slots_[a].pid < slots_[b].pid; });
+        size_t next = 0;
+        for (ProcessTable::Row row = 0; row < rows && next < matchOrder_.size(); ++row) {
+            while (next < matchOrder_.size() && slots_[matchOrder_[next]].pid < table.pid(row)) {
+                ++next;
+            }
+            if (next < matchOrder_.size() && slots_[matchOrder_[next]].pid == table.pid(row)) {
+                match(matchOrder_[next++], row);
+            }
+        }
+    } else if (!matchOrder_.empty()) {
+        RowIndex rowByPid(rows);
+        for (ProcessTable::Row row = 0; row < rows; ++row) {
+            rowByPid.insert(table.pid(row), row);
+        }
+        for (uint32_t slot : matchOrder_) {
+            ProcessTable::Row row = rowByPid.find(slots_[slot].pid);
+            if (row != ProcessTable::NONE) {
+                match(slot, row);
+            }
+        }
+    }
+    
+    // Slots of exited processes go back to the pool
+    for (uint32_t slot : matchOrder_) {
+        if (slots_[slot].row == ProcessTable::NONE) {
+            freeSlots_.push_back(slot);
+        }
+    }
+    
+    // Append this scan; untracked processes take slots while any are free
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        uint32_t slot = slotOfRow_[row];
+        if (slot == ProcessTable::NONE) {
+            slot = takeFreeSlot();
+            if (slot == ProcessTable::NONE) {
+                continue;
+            }
+            assign(slot, table, row);
+        }
+        Slot& entry = slots_[slot];
+        size_t sample = slot * SAMPLES + entry.next;
+        cpu_[sample] = static_cast<float>(table.cpuPercent(row));
+        memory_[sample] = table.memoryBytes(row);
+        ioWait_[sample] = static_cast<float>(table.ioWaitPercent(row));
+        entry.next = static_cast<uint16_t>((entry.next + 1) % SAMPLES);
+        entry.count = static_cast<uint16_t>(std::min<size_t>(entry.count + 1u, SAMPLES));
+    }
+}
+
+void ProcessHistory::view(const ProcessTable& table, ProcessTable::Row row) {
+    if (maxSlots_ == 0 || row >= slotOfRow_.size()) {
+        return;
+    }
+    uint32_t slot = slotOfRow_[row];
+    if (slot == ProcessTable::NONE) {
+        slot = takeFreeSlot();
+        if (slot == ProcessTable::NONE) {
+            // Every slot is in use: take the least recently viewed one
+            auto victim = std::min_element(slots_.begin(), slots_.end(), [](const Slot& a, const Slot& b) {
+                return a.lastViewed < b.lastViewed;
+            });
+            slot = static_cast<uint32_t>(victim - slots_.begin());
+            slotOfRow_[victim->row] = ProcessTable::NONE;
+        }
+        assign(slot, table, row);
+    }
+    slots_[slot].lastViewed = ++viewClock_;
+}
+
+bool ProcessHistory::history(ProcessTable::Row row, Series series, std::vector<double>& out) const {
+    out.clear();
+    if (row >= slotOfRow_.size() || slotOfRow_[row] == ProcessTable::NONE) {
+        return false;
+    }
+    uint32_t slot = slotOfRow_[row];
+    const Slot& entry = slots_[slot];
+    size_t base = slot * SAMPLES;
+    size_t first = (entry.next + SAMPLES - entry.count) % SAMPLES;
+    for (size_t i = 0; i < entry.count; ++i) {
+        size_t sample = base + (first + i) % SAMPLES;
+        switch (series) {
+            case Series::Cpu:
+                out.push_back(cpu_[sample]);
+                break;
+            case Series::Memory:
+                out.push_back(static_cast<double>(memory_[sample]));
+                break;
+            case Series::IoWait:
+                out.push_back(ioWait_[sample]);
+                break;
+        }
+    }
+    return true;
+}
+
+size_t ProcessHistory::memoryFootprint() const {
+    return cpu_.capacity() * sizeof(float) + memory_.capacity() * sizeof(uint64_t) +
+           ioWait_.capacity() * sizeof(float) + slots_.capacity() * sizeof(Slot) +
+           (freeSlots_.capacity() + slotOfRow_.capacity() + matchOrder_.capacity()) * sizeof(uint32_t);
+}
+
+} // namespace sysmon
@@ -0,0 +1,229 @@
+#include "ProcessOrder.h"
+#include "RowIndex.h"
+#include <algorithm>
+
+namespace sysmon {
+
+namespace {
+    // Groups up to this size are insertion-sorted in place
+    constexpr size_t INSERTION_SORT_ROWS = 32;
+    
+    constexpr std::pair<std::string_view, ProcessSortKey> SORT_KEY_NAMES[] = {
+        {"cpu", ProcessSortKey::Cpu},
+        {"memory", ProcessSortKey::Memory},
+        {"name", ProcessSortKey::Name},
+        {"pid", ProcessSortKey::Pid},
+    };
+}
+
+bool parseProcessSortKey(std::string_view text, ProcessSortKey& key) {
+    for (const auto& [name, value] : SORT_KEY_NAMES) {
+        if (text == name) {
+            key = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+struct ProcessOrder::RowLess {
+    const ProcessTable& table;
+    ProcessSortKey key;
+    bool descending;
+    
+    bool operator()(ProcessTable::Row a, ProcessTable::Row b) const {
+        switch (key) {
+            case ProcessSortKey::Cpu:
+                if (table.cpuPercent(a) != table.cpuPercent(b)) {
+                    return descending ? table.cpuPercent(a) > table.cpuPercent(b)
+                                      : table.cpuPercent(a) < table.cpuPercent(b);
+                }
+                break;
+            case ProcessSortKey::Memory:
+                if (table.memoryBytes(a) != table.memoryBytes(b)) {
+                    return descending ? table.memoryBytes(a) > table.memoryBytes(b)
+                                      : table.memoryBytes(a) < table.memoryBytes(b);
+                }
+                break;
+            case ProcessSortKey::Name:
+                if (int order = table.name(a).compare(table.name(b)); order != 0) {
+                    return descending ? order > 0 : order < 0;
+                }
+                break;
+            case ProcessSortKey::Pid:
+                return descending ? table.pid(a) > table.pid(b) : table.pid(a) < table.pid(b);
+        }
+        return table.pid(a) < table.pid(b);
+    }
+};
+
+void ProcessOrder::seed(const ProcessTable& table) {
+    ProcessTable::Row rows = table.size();
+    size_t previousRows = previousPid_.size();
+    positionOfRow_.assign(rows, ProcessTable::NONE);
+    
+    auto match = [&](size_t previous, ProcessTable::Row row) {
+        if (positionOfRow_[row] == ProcessTable::NONE && table.creationTime(row) == previousStart_[previous]) {
+            positionOfRow_[row] = previousPosition_[previous];
+        }
+    };
+    
+    // Both tables list pids in ascending order on /proc, so they merge-join
+    // in one sequential pass, as in ProcessDelta; otherwise index the new one
+    bool ascending = std::is_sorted(previousPid_.begin(), previousPid_.end());
+    for (ProcessTable::Row row = 1; ascending && row < rows; ++row) {
+        ascending = table.pid(row - 1) <= table.pid(row);
+    }
+    if (ascending) {
+        size_t previous = 0;
+        for (ProcessTable::Row row = 0; row < rows && previous < previousRows; ++row) {
+            while (previous < previousRows && previousPid_[previous] < table.pid(row)) {
+                ++previous;
+            }
+            if (previous < previousRows && previousPid_[previous] == table.pid(row)) {
+                match(previous++, row);
+            }
+        }
+    } else if (previousRows != 0) {
+        RowIndex rowByPid(rows);
+        for (ProcessTable::Row row = 0; row < rows; ++row) {
+            rowByPid.insert(table.pid(row), row);
+        }
+        for (size_t previous = 0; previous < previousRows; ++previous) {
+            ProcessTable::Row row = rowByPid.find(previousPid_[previous]);
+            if (row != ProcessTable::NONE) {
+                match(previous, row);
+            }
+        }
+    }
+    
+    // Survivors by previous position, then new rows in row order
+    slots_.assign(previousRows, ProcessTable::NONE);
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        if (positionOfRow_[row] != ProcessTable::NONE) {
+            slots_[positionOfRow_[row]] = row;
+        }
+    }
+    seeded_.clear();
+    seeded_.reserve(rows);
+    for (ProcessTable::Row row : slots_) {
+        if (row != ProcessTable::NONE) {
+            seeded_.push_back(row);
+        }
+    }
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        if (positionOfRow_[row] == ProcessTable::NONE) {
+            seeded_.push_back(row);
+        }
+    }
+}
+
+void ProcessOrder::sortGroup(ProcessTable::Row* first, ProcessTable::Row* last, const RowLess& less) {
+    size_t size = static_cast<size_t>(last - first);
+    if (size < 2) {
+        return;
+    }
+    
+    if (size <= INSERTION_SORT_ROWS) {
+        for (auto* it = first + 1; it != last; ++it) {
+            ProcessTable::Row row = *it;
+            auto* hole = it;
+            for (; hole != first && less(row, *(hole - 1)); --hole) {
+                *hole = *(hole - 1);
+            }
+            *hole = row;
+            displaced_ += hole != it;
+        }
+        return;
+    }
+    
+    // Keep the rows that extend an ordered run; a row that breaks it is
+    // pulled out together with the run's last row, which leaves at most
+    // twice as many rows out as the fewest that would do
+    inOrder_.clear();
+    displacedRows_.clear();
+    for (auto* it = first; it != last; ++it) {
+        if (!inOrder_.empty() && less(*it, inOrder_.back())) {
+            displacedRows_.push_back(inOrder_.back());
+            displacedRows_.push_back(*it);
+            inOrder_.pop_back();
+        } else {
+            inOrder_.push_back(*it);
+        }
+    }
+    if (displacedRows_.empty()) {
+        return;
+    }
+    std::sort(displacedRows_.begin(), displacedRows_.end(), less);
+    std::merge(inOrder_.begin(), inOrder_.end(), displacedRows_.begin(), displacedRows_.end(), first, less);
+    displaced_ += displacedRows_.size();
+}
+
+void ProcessOrder::update(const ProcessTable& table, ProcessSortKey key, bool descending, bool tree) {
+    ProcessTable::Row rows = table.size();
+    RowLess less{table, key, descending};
+    displaced_ = 0;
+    seed(table);
+    
+    if (!tree) {
+        order_.assign(seeded_.begin(), seeded_.end());
+        sortGroup(order_.data(), order_.data() + order_.size(), less);
+        depths_.assign(rows, 0);
+    } else {
+        // Group the seeded rows by parent (group 0 = roots, row + 1 = its
+        // children) with a stable counting sort, so each group starts out in
+        // its previous order. Counts go two slots up; placing then moves
+        // every group's start to its end, which leaves group g at
+        // [groupStart_[g], groupStart_[g + 1]).
+        auto group = [&](ProcessTable::Row row) {
+            ProcessTable::Row parent = table.parent(row);
+            return parent == ProcessTable::NONE ? 0u : parent + 1;
+        };
+        groupStart_.assign(static_cast<size_t>(rows) + 3, 0);
+        for (ProcessTable::Row row : seeded_) {
+            ++groupStart_[group(row) + 2];
+        }
+        for (size_t i = 1; i < groupStart_.size(); ++i) {
+            groupStart_[i] += groupStart_[i - 1];
+        }
+        children_.resize(rows);
+        for (ProcessTable::Row row : seeded_) {
+            children_[groupStart_[group(row) + 1]++] = row;
+        }
+        for (size_t g = 0; g <= rows; ++g) {
+            sortGroup(children_.data() + groupStart_[g], children_.data() + groupStart_[g + 1], less);
+        }
+        
+        // Pre-order walk over the sorted groups
+        order_.clear();
+        depths_.clear();
+        stack_.clear();
+        stack_.emplace_back(groupStart_[0], groupStart_[1]);
+        while (!stack_.empty()) {
+            auto& [next, end] = stack_.back();
+            if (next == end) {
+                stack_.pop_back();
+                continue;
+            }
+            ProcessTable::Row row = children_[next++];
+            order_.push_back(row);
+            depths_.push_back(static_cast<uint32_t>(stack_.size() - 1));
+            if (groupStart_[row + 1] != groupStart_[row + 2]) {
+                stack_.emplace_back(groupStart_[row + 1], groupStart_[row + 2]);
+            }
+        }
+    }
+    
+    previousPid_.resize(rows);
+    previousStart_.resize(rows);
+    previousPosition_.resize(rows);
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        previousPid_[row] = table.pid(row);
+        previousStart_[row] = table.creationTime(row);
+    }
+    for (size_t i = 0; i < order_.size(); ++i) {
+        previousPosition_[order_[i]] = static_cast<uint32_t>(i);
+    }
+}
+
+} // namespace sysmon
@@ -0,0 +1,253 @@
+#include "ProcessSearch.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#ifndef _WIN32
+#include <pwd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+    // The dictionary is rebuilt once it holds this many times the names a scan uses
+    constexpr size_t DICTIONARY_SLACK = 4;
+    constexpr size_t MIN_DICTIONARY_NAMES = 4096;
+    
+    char lower(char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    
+    bool containsIgnoringCase(std::string_view haystack, std::string_view lowerNeedle) {
+        auto found = std::search(haystack.begin(), haystack.end(), lowerNeedle.begin(), lowerNeedle.end(),
+                                 [](char a, char b) { return lower(a) == b; });
+        return found != haystack.end();
+    }
+    
+    bool resolveUser(std::string_view user, uint32_t& uid) {
+        auto result = std::from_chars(user.data(), user.data() + user.size(), uid);
+        if (result.ec == std::errc() && result.ptr == user.data() + user.size()) {
+            return true;
+        }
+#ifdef _WIN32
+        return false;
+#else
+        std::string name(user);
+        struct passwd entry;
+        struct passwd* found = nullptr;
+        char buffer[4096];
+        if (getpwnam_r(name.c_str(), &entry, buffer, sizeof(buffer), &found) != 0 || !found) {
+            return false;
+        }
+        uid = static_cast<uint32_t>(found->pw_uid);
+        return true;
+#endif
+    }
+}
+
+void ProcessNameInterner::index(const ProcessTable& table, ProcessNameIndex& out) {
+    ProcessTable::Row rows = table.size();
+    out.dictionary = dictionary_;
+    out.nameIdOfRow.resize(rows);
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        std::string_view name = table.name(row);
+        auto it = ids_.find(name);
+        if (it == ids_.end()) {
+            it = ids_.emplace(std::string(name), static_cast<uint32_t>(ids_.size())).first;
+        }
+        out.nameIdOfRow[row] = it->second;
+    }
+    
+    // Counting sort of the rows by name, groups in first-seen order
+    groupOfId_.assign(ids_.size(), ProcessTable::NONE);
+    out.groupIds.clear();
+    out.groupStart.clear();
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        uint32_t id = out.nameIdOfRow[row];
+        if (groupOfId_[id] == ProcessTable::NONE) {
+            groupOfId_[id] = static_cast<uint32_t>(out.groupIds.size());
+            out.groupIds.push_back(id);
+            out.groupStart.push_back(0);
+        }
+        ++out.groupStart[groupOfId_[id]];
+    }
+    uint32_t offset = 0;
+    for (auto& start : out.groupStart) {
+        uint32_t count = start;
+        start = offset;
+        offset += count;
+    }
+    out.groupStart.push_back(offset);
+    
+    out.groupRows.resize(rows);
+    std::vector<uint32_t>& next = groupOfId_;       // Reused: id -> next free slot of its group
+    for (size_t group = 0; group < out.groupIds.size(); ++group) {
+        next[out.groupIds[group]] = out.groupStart[group];
+    }
+    for (ProcessTable::Row row = 0; row < rows; ++row) {
+        out.groupRows[next[out.nameIdOfRow[row]]++] = row;
+    }
+    
+    // Names of exited processes stay interned; start over once they dominate
+    if (ids_.size() > std::max(DICTIONARY_SLACK * out.groupIds.size(), MIN_DICTIONARY_NAMES)) {
+        ids_.clear();
+        ++dictionary_;
+    }
+}
+
+bool ProcessFilter::setQuery(std::string_view query, std::string& error) {
+    std::vector<Term> terms;
+    size_t pos = 0;
+    while (pos < query.size()) {
+        if (std::isspace(static_cast<unsigned char>(query[pos]))) {
+            ++pos;
+            continue;
+        }
+        size_t end = pos;
+        while (end < query.size() && !std::isspace(static_cast<unsigned char>(query[end]))) {
+            ++end;
+        }
+        std::string_view word = query.substr(pos, end - pos);
+        pos = end;
+        
+        Term term;
+        if (word.front() == '/') {
+            // The closing slash is optional, so a regex matches while it is being typed
+            term.kind = Term::Kind::Regex;
+            term.text = word.substr(1, word.size() > 1 && word.back() == '/' ? word.size() - 2 : word.size() - 1);
+            try {
+                term.regex = std::regex(term.text, std::regex::ECMAScript | std::regex::icase | std::regex::optimize);
+            } catch (const std::regex_error& e) {
+                error = "Bad regex /" + term.text + "/: " + e.what();
+                return false;
+            }
+        } else if (word.rfind("user:", 0) == 0) {
+            term.kind = Term::Kind::User;
+            if (!resolveUser(word.substr(5), term.uid)) {
+                error = "Unknown user: " + std::string(word.substr(5));
+                return false;
+            }
+        } else if (word.rfind("state:", 0) == 0 && word.size() > 6) {
+            term.kind = Term::Kind::State;
+            term.text = word.substr(6);
+        } else {
+            term.kind = Term::Kind::Substring;
+            term.text.resize(word.size());
+            std::transform(word.begin(), word.end(), term.text.begin(), lower);
+        }
+        terms.push_back(std::move(term));
+    }
+    
+    // Typing on narrows the query: names that failed the old terms fail the
+    // new ones too, so only their "no" results survive
+    bool narrowed = terms.size() >= terms_.size();
+    for (size_t i = 0; narrowed && i < terms_.size(); ++i) {
+        const Term& before = terms_[i];
+        const Term& after = terms[i];
+        narrowed = before.kind == after.kind &&
+                   (before.kind == Term::Kind::Substring ? after.text.find(before.text) != std::string::npos
+                                                         : before.text == after.text && before.uid == after.uid);
+    }
+    
+    query_ = query;
+    terms_ = std::move(terms);
+    hasNameTerms_ = std::any_of(terms_.begin(), terms_.end(), [](const Term& term) {
+        return term.kind == Term::Kind::Substring || term.kind == Term::Kind::Regex;
+    });
+    hasRowTerms_ = false;
+    filtersUid_ = false;
+    allowedStates_.fill(true);
+    for (const auto& term : terms_) {
+        if (term.kind == Term::Kind::User) {
+            // Two different users can't both own a process
+            if (filtersUid_ && uid_ != term.uid) {
+                allowedStates_.fill(false);
+            }
+            filtersUid_ = true;
+            uid_ = term.uid;
+            hasRowTerms_ = true;
+        } else if (term.kind == Term::Kind::State) {
+            std::array<bool, 256> allowed{};
+            for (char state : term.text) {
+                allowed[static_cast<unsigned char>(state)] = allowedStates_[static_cast<unsigned char>(state)];
+            }
+            allowedStates_ = allowed;
+            hasRowTerms_ = true;
+        }
+    }
+    if (narrowed) {
+        std::replace(nameResults_.begin(), nameResults_.end(), uint8_t{2}, uint8_t{0});
+    } else {
+        nameResults_.clear();
+    }
+    return true;
+}
+
+bool ProcessFilter::nameMatches(std::string_view name) const {
+    for (const auto& term : terms_) {
+        if (term.kind == Term::Kind::Substring && !containsIgnoringCase(name, term.text)) {
+            return false;
+        }
+        if (term.kind == Term::Kind::Regex && !std::regex_search(name.begin(), name.end(), term.regex)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ProcessFilter::apply(const ProcessTable& table, const ProcessNameIndex& names, std::vector<uint8_t>& visibility) {
+    if (!active()) {
+        visibility.assign(table.size(), MATCH);
+        matchCount_ = table.size();
+        return;
+    }
+    visibility.assign(table.size(), HIDDEN);
+    
+    if (names.dictionary != cachedDictionary_) {
+        nameResults_.clear();
+        cachedDictionary_ = names.dictionary;
+    }
+    
+    matches_.clear();
+    if (!hasNameTerms_) {
+        // Only user/state terms: one pass in row order
+        for (ProcessTable::Row row = 0; row < table.size(); ++row) {
+            if (rowMatches(table, row)) {
+                visibility[row] = MATCH;
+                matches_.push_back(row);
+            }
+        }
+    }
+    for (size_t group = 0; hasNameTerms_ && group < names.groupCount(); ++group) {
+        auto rows = names.rows(group);
+        {
+            uint32_t id = names.groupIds[group];
+            if (id >= nameResults_.size()) {
+                nameResults_.resize(id + 1, 0);
+            }
+            if (nameResults_[id] == 0) {
+                nameResults_[id] = static_cast<uint8_t>(1 + nameMatches(table.name(rows.front())));
+            }
+            if (nameResults_[id] == 1) {
+                continue;
+            }
+        }
+        for (ProcessTable::Row row : rows) {
+            if (!hasRowTerms_ || rowMatches(table, row)) {
+                visibility[row] = MATCH;
+                matches_.push_back(row);
+            }
+        }
+    }
+    matchCount_ = matches_.size();
+    
+    // Stop at the first marked ancestor: its own chain is (or will be) marked
+    for (ProcessTable::Row row : matches_) {
+        for (auto parent = table.parent(row); parent != ProcessTable::NONE && visibility[parent] == HIDDEN;
+             parent = table.parent(parent)) {
+            visibility[parent] = ANCESTOR;
+        }
+    }
+}
+
+} // namespace sysmon
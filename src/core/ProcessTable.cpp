@@ -0,0 +1,199 @@
+#include "ProcessTable.h"
+#include "RowIndex.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace sysmon {
+
+void ProcessTable::clear() {
+    pid_.clear();
+    parentPid_.clear();
+    cpuPercent_.clear();
+    memoryBytes_.clear();
+    creationTime_.clear();
+    uid_.clear();
+    state_.clear();
+    ioWaitPercent_.clear();
+    nameOffset_.clear();
+    nameLength_.clear();
+    names_.clear();
+    cgroup_.clear();
+    cgroupOffset_.clear();
+    cgroupPaths_.clear();
+    parent_.clear();
+    firstChild_.clear();
+    nextSibling_.clear();
+    firstRoot_ = NONE;
+    rootCount_ = 0;
+    preorder_.clear();
+    preorderIndex_.clear();
+    subtreeEnd_.clear();
+    subtreeCpu_.clear();
+    subtreeMemory_.clear();
+}
+
+void ProcessTable::reserve(size_t rows) {
+    pid_.reserve(rows);
+    parentPid_.reserve(rows);
+    cpuPercent_.reserve(rows);
+    memoryBytes_.reserve(rows);
+    creationTime_.reserve(rows);
+    uid_.reserve(rows);
+    state_.reserve(rows);
+    ioWaitPercent_.reserve(rows);
+    nameOffset_.reserve(rows);
+    nameLength_.reserve(rows);
+    cgroup_.reserve(rows);
+    parent_.reserve(rows);
+    firstChild_.reserve(rows);
+    nextSibling_.reserve(rows);
+    preorder_.reserve(rows);
+    preorderIndex_.reserve(rows);
+    subtreeEnd_.reserve(rows);
+    subtreeCpu_.reserve(rows);
+    subtreeMemory_.reserve(rows);
+}
+
+ProcessTable::Row ProcessTable::add(uint32_t pid, uint32_t parentPid, std::string_view name, double cpuPercent,
+                                    uint64_t memoryBytes, uint64_t creationTime, uint32_t uid, char state,
+                                    double ioWaitPercent) {
+    Row row = size();
+    pid_.push_back(pid);
+    parentPid_.push_back(parentPid);
+    cpuPercent_.push_back(cpuPercent);
+    memoryBytes_.push_back(memoryBytes);
+    creationTime_.push_back(creationTime);
+    uid_.push_back(uid);
+    state_.push_back(state);
+    ioWaitPercent_.push_back(ioWaitPercent);
+    nameOffset_.push_back(static_cast<uint32_t>(names_.size()));
+    nameLength_.push_back(static_cast<uint32_t>(name.size()));
+    names_.append(name);
+    cgroup_.push_back(NO_CGROUP);
+    parent_.push_back(NONE);
+    firstChild_.push_back(NONE);
+    nextSibling_.push_back(NONE);
+    return row;
+}
+
+void ProcessTable::addAll(const std::vector<ProcessSummary>& summaries) {
+    reserve(size() + summaries.size());
+    // Keyed by views into the summaries, which outlive this call
+    std::unordered_map<std::string_view, uint32_t> cgroupIds;
+    for (const auto& summary : summaries) {
+        Row row = add(summary);
+        if (!summary.cgroup.empty()) {
+            auto [it, inserted] = cgroupIds.try_emplace(summary.cgroup, 0);
+            if (inserted) {
+                it->second = addCgroup(summary.cgroup);
+            }
+            cgroup_[row] = it->second;
+        }
+    }
+}
+
+uint32_t ProcessTable::addCgroup(std::string_view path) {
+    cgroupOffset_.push_back(static_cast<uint32_t>(cgroupPaths_.size()));
+    cgroupPaths_.append(path);
+    return static_cast<uint32_t>(cgroupOffset_.size() - 1);
+}
+
+void ProcessTable::buildTree() {
+    Row rows = size();
+    
+    RowIndex rowByPid(rows);
+    for (Row row = 0; row < rows; ++row) {
+        rowByPid.insert(pid_[row], row);
+    }
+    
+    for (Row row = 0; row < rows; ++row) {
+        Row parent = rowByPid.find(parentPid_[row]);
+        // The parent must predate the child, or its pid was reused
+        bool linked = parent != NONE && parent != row && creationTime_[parent] < creationTime_[row];
+        parent_[row] = linked ? parent : NONE;
+    }
+    
+    // Prepending in reverse leaves every sibling list in row order
+    std::fill(firstChild_.begin(), firstChild_.end(), NONE);
+    firstRoot_ = NONE;
+    rootCount_ = 0;
+    for (Row row = rows; row-- > 0;) {
+        Row parent = parent_[row];
+        if (parent != NONE) {
+            nextSibling_[row] = firstChild_[parent];
+            firstChild_[parent] = row;
+        } else {
+            nextSibling_[row] = firstRoot_;
+            firstRoot_ = row;
+            ++rootCount_;
+        }
+    }
+    
+    layOutPreorder();
+}
+
+void ProcessTable::layOutPreorder() {
+    Row rows = size();
+    preorder_.resize(rows);
+    preorderIndex_.resize(rows);
+    subtreeEnd_.resize(rows);
+    
+    subtreeCpu_.assign(cpuPercent_.begin(), cpuPercent_.end());
+    subtreeMemory_.assign(memoryBytes_.begin(), memoryBytes_.end());
+    
+    // Iterative walk over the links: down to the first child, else on to the
+    // next sibling, closing every subtree passed on the way back up. A closed
+    // subtree's totals are complete, so they are added to its parent there.
+    Row position = 0;
+    Row row = firstRoot_;
+    while (row != NONE) {
+        preorderIndex_[row] = position;
+        preorder_[position++] = row;
+        if (firstChild_[row] != NONE) {
+            row = firstChild_[row];
+            continue;
+        }
+        while (row != NONE) {
+            subtreeEnd_[row] = position;
+            Row parent = parent_[row];
+            if (parent != NONE) {
+                subtreeCpu_[parent] += subtreeCpu_[row];
+                subtreeMemory_[parent] += subtreeMemory_[row];
+            }
+            if (nextSibling_[row] != NONE) {
+                row = nextSibling_[row];
+                break;
+            }
+            row = parent;
+        }
+    }
+}
+
+void ProcessTable::fillSummary(Row row, ProcessSummary& summary) const {
+    summary.pid = pid_[row];
+    summary.parentPid = parentPid_[row];
+    summary.name.assign(name(row));
+    summary.cpuPercent = cpuPercent_[row];
+    summary.memoryBytes = memoryBytes_[row];
+    summary.creationTime = creationTime_[row];
+    summary.uid = uid_[row];
+    if (cgroup_[row] != NO_CGROUP) {
+        summary.cgroup.assign(cgroupPath(cgroup_[row]));
+    } else {
+        summary.cgroup.clear();
+    }
+}
+
+size_t ProcessTable::memoryFootprint() const {
+    return pid_.capacity() * sizeof(uint32_t) + parentPid_.capacity() * sizeof(uint32_t) +
+           cpuPercent_.capacity() * sizeof(double) + memoryBytes_.capacity() * sizeof(uint64_t) +
+           creationTime_.capacity() * sizeof(uint64_t) + uid_.capacity() * sizeof(uint32_t) + state_.capacity() +
+           ioWaitPercent_.capacity() * sizeof(double) +
+           (nameOffset_.capacity() + nameLength_.capacity()) * sizeof(uint32_t) + names_.capacity() +
+           (cgroup_.capacity() + cgroupOffset_.capacity()) * sizeof(uint32_t) + cgroupPaths_.capacity() +
+           (parent_.capacity() + firstChild_.capacity() + nextSibling_.capacity()) * sizeof(Row) +
+           (preorder_.capacity() + preorderIndex_.capacity() + subtreeEnd_.capacity()) * sizeof(Row) +
+           subtreeCpu_.capacity() * sizeof(double) + subtreeMemory_.capacity() * sizeof(uint64_t);
+}
+
+} // namespace sysmon
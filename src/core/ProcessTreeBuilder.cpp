@@ -1,13 +1,46 @@
 #include "ProcessTreeBuilder.h"
-#include <unordered_map>
+#include "Instrumentation.h"
+#include "sysmon_shm.h"
 #include <algorithm>
 #include <chrono>
 #include <thread>
 
 namespace sysmon {
 
-ProcessTreeBuilder::ProcessTreeBuilder(const Configuration& config)
-    : config_(config), collector_(createProcessCollector()) {
+namespace {
+    double rankValue(const ProcessTable& table, ProcessTable::Row row, ProcessRanking ranking) {
+        return ranking == ProcessRanking::Cpu ? table.cpuPercent(row) : static_cast<double>(table.memoryBytes(row));
+    }
+    
+    // "a ranks above b": heavier first, then lower pid
+    struct RanksAbove {
+        const ProcessTable& table;
+        ProcessRanking ranking;
+        bool operator()(ProcessTable::Row a, ProcessTable::Row b) const {
+            double left = rankValue(table, a, ranking);
+            double right = rankValue(table, b, ranking);
+            return left != right ? left > right : table.pid(a) < table.pid(b);
+        }
+    };
+    
+    // Large enough that every exporter's top-N is answered from the index
+    size_t topIndexSizeFor(const Configuration& config) {
+        uint32_t sharedMemoryCount = config.sharedMemoryName.empty() ? 0u : SYSMON_SHM_MAX_PROCESSES;
+        return std::max({config.topProcessIndexSize, config.exportTopProcesses, config.metricsTopProcesses,
+                         config.agentTopProcesses, sharedMemoryCount});
+    }
+}
+
+ProcessTreeBuilder::ProcessTreeBuilder(const Configuration& config,
+                                       const CpuBudgetGovernor* governor)
+    : ProcessTreeBuilder(config, createProcessCollector(config), governor) {
+}
+
+ProcessTreeBuilder::ProcessTreeBuilder(const Configuration& config,
+                                       std::unique_ptr<IProcessCollector> collector,
+                                       const CpuBudgetGovernor* governor)
+    : config_(config), collector_(std::move(collector)), governor_(governor),
+      snapshot_(std::make_shared<ProcessSnapshot>()), topIndexSize_(topIndexSizeFor(config)) {
 }
 
 ProcessTreeBuilder::~ProcessTreeBuilder() {
@@ -26,117 +59,190 @@ bool ProcessTreeBuilder::start() {
 }
 
 void ProcessTreeBuilder::stop() {
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        running_ = false;
+    }
+    wakeCv_.notify_all();
     if (enumerationThread_.joinable()) {
         enumerationThread_.join();
     }
     collector_->shutdown();
 }
 
-std::vector<std::unique_ptr<ProcessInfo>> ProcessTreeBuilder::getProcessTree() const {
-    std::lock_guard<std::mutex> lock(treeMutex_);
+ProcessSnapshotPtr ProcessTreeBuilder::getSnapshot() const {
+    ScopedTimer timer(TraceSource::GetSnapshot);
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    return snapshot_;
+}
+
+void ProcessTreeBuilder::getTopProcesses(size_t count, std::vector<ProcessSummary>& out,
+                                         ProcessRanking ranking) const {
+    ProcessSnapshotPtr snapshot = getSnapshot();
+    const ProcessTable& table = snapshot->table;
     
-    // Deep copy the tree for thread safety
-    std::vector<std::unique_ptr<ProcessInfo>> copy;
-    copy.reserve(processRoots_.size());
+    // The index holds min(K, processes) rows, so any count up to K is answered from it
+    if (count <= topIndexSize_) {
+        const auto& index = ranking == ProcessRanking::Cpu ? snapshot->topByCpu : snapshot->topByMemory;
+        out.resize(std::min(count, index.size()));
+        for (size_t i = 0; i < out.size(); ++i) {
+            table.fillSummary(index[i], out[i]);
+        }
+        return;
+    }
     
-    for (const auto& root : processRoots_) {
-        copy.push_back(deepCopy(*root));
+    // Larger requests select from the whole table
+    std::vector<ProcessTable::Row> rows;
+    selectTop(table, count, ranking, rows);
+    out.resize(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        table.fillSummary(rows[i], out[i]);
+    }
+}
+
+void ProcessTreeBuilder::getProcessGroups(size_t count, ProcessGroups& out) const {
+    ProcessSnapshotPtr snapshot = getSnapshot();
+    for (size_t i = 0; i < PROCESS_GROUPINGS; ++i) {
+        auto grouping = static_cast<ProcessGrouping>(i);
+        const auto& groups = snapshot->groups.of(grouping);
+        auto end = groups.begin() + static_cast<std::ptrdiff_t>(count == 0 ? groups.size()
+                                                                           : std::min(count, groups.size()));
+        out.of(grouping).assign(groups.begin(), end);
+    }
+}
+
+void ProcessTreeBuilder::getProcessList(std::vector<ProcessSummary>& out) const {
+    ProcessSnapshotPtr snapshot = getSnapshot();
+    const ProcessTable& table = snapshot->table;
+    out.resize(table.size());
+    for (ProcessTable::Row row = 0; row < table.size(); ++row) {
+        table.fillSummary(row, out[row]);
     }
     
-    return copy;
+    std::sort(out.begin(), out.end(), [](const ProcessSummary& a, const ProcessSummary& b) {
+        return a.pid < b.pid;
+    });
+}
+
+uint64_t ProcessTreeBuilder::getVersion() const {
+    return notifier_.version();
+}
+
+ChangeNotifier::SubscriptionId ProcessTreeBuilder::subscribe(ChangeNotifier::Callback callback) {
+    return notifier_.subscribe(std::move(callback));
+}
+
+void ProcessTreeBuilder::unsubscribe(ChangeNotifier::SubscriptionId id) {
+    notifier_.unsubscribe(id);
 }
 
 bool ProcessTreeBuilder::terminateProcess(uint32_t pid) {
     return collector_->terminateProcess(pid);
 }
 
+void ProcessTreeBuilder::addObserver(ISampleObserver* observer) {
+    observers_.push_back(observer);
+}
+
 void ProcessTreeBuilder::refresh() {
     // Trigger immediate enumeration by waking the thread
-    // (simplified - could use condition variable)
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        refreshRequested_ = true;
+    }
+    wakeCv_.notify_all();
 }
 
 void ProcessTreeBuilder::enumerationLoop() {
     using namespace std::chrono;
     
     while (running_) {
-        auto processes = collector_->enumerateProcesses();
-        buildTree(processes);
+        bool reduced = governor_ && governor_->reducedProcessDetail();
+        collector_->setDetail(reduced ? ProcessDetail::Reduced : ProcessDetail::Full);
+        
+        std::shared_ptr<ProcessSnapshot> next = takeSpareSnapshot();
+        ProcessTable& table = next->table;
+        table.clear();
+        {
+            ScopedTimer timer(TraceSource::EnumerateProcesses);
+            collector_->enumerateProcesses(table);
+        }
+        {
+            ScopedTimer timer(TraceSource::BuildTree);
+            table.buildTree();
+        }
+        {
+            ScopedTimer timer(TraceSource::IndexNames);
+            interner_.index(table, next->names);
+        }
+        {
+            ScopedTimer timer(TraceSource::GroupProcesses);
+            grouper_.group(table, next->names, next->groups);
+        }
+        next->timestampMs = static_cast<uint64_t>(duration_cast<milliseconds>(
+            system_clock::now().time_since_epoch()).count());
+        for (auto* observer : observers_) {
+            observer->onProcessScan(table, next->timestampMs);
+        }
         
+        selectTop(table, topIndexSize_, ProcessRanking::Cpu, next->topByCpu);
+        selectTop(table, topIndexSize_, ProcessRanking::Memory, next->topByMemory);
         {
-            std::lock_guard<std::mutex> lock(treeMutex_);
-            processRoots_ = std::move(processes);
+            // snapshot_ is only replaced on this thread, so it can be read unlocked here
+            ScopedTimer timer(TraceSource::DiffProcesses);
+            next->delta.compute(snapshot_->table, table, config_.deltaCpuEpsilon, config_.deltaMemoryEpsilonBytes);
+            next->delta.baseVersion = snapshot_->version;
         }
         
-        std::this_thread::sleep_for(milliseconds(config_.processSampleIntervalMs));
+        // Only this thread publishes, so the next version is known in advance
+        next->version = notifier_.version() + 1;
+        {
+            std::lock_guard<std::mutex> lock(snapshotMutex_);
+            snapshot_.swap(next);
+        }
+        spare_ = std::move(next);
+        notifier_.publish();
+        
+        uint32_t scale = governor_ ? governor_->processIntervalScale() : 1;
+        std::unique_lock<std::mutex> wakeLock(wakeMutex_);
+        wakeCv_.wait_for(wakeLock, milliseconds(config_.processSampleIntervalMs) * scale,
+                         [this] { return !running_ || refreshRequested_; });
+        refreshRequested_ = false;
     }
 }
 
-void ProcessTreeBuilder::buildTree(std::vector<std::unique_ptr<ProcessInfo>>& processes) {
-    // Create lookup map: PID -> ProcessInfo*
-    std::unordered_map<uint32_t, ProcessInfo*> pidMap;
-    for (auto& proc : processes) {
-        pidMap[proc->pid] = proc.get();
+std::shared_ptr<ProcessSnapshot> ProcessTreeBuilder::takeSpareSnapshot() {
+    // Unpublished, so a count of one means no reader can reach it any more
+    if (spare_ && spare_.use_count() == 1) {
+        // Pairs with the release of the last reader's reference before its storage is rewritten
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return std::move(spare_);
     }
-    
-    // Build parent-child relationships
-    std::vector<std::unique_ptr<ProcessInfo>> roots;
-    
-    for (auto& proc : processes) {
-        auto parentIt = pidMap.find(proc->parentPid);
-        
-        if (parentIt != pidMap.end() && parentIt->second->pid != proc->pid) {
-            // Found parent - verify creation time to avoid PID reuse issues
-            ProcessInfo* parent = parentIt->second;
-            
-            // If parent was created before child, establish relationship
-            if (parent->creationTime < proc->creationTime) {
-                proc->parent = parent;
-                // We'll move children in a second pass
-            } else {
-                // Parent PID reused - treat as root
-                proc->parent = nullptr;
-            }
-        } else {
-            // No parent found - root process
-            proc->parent = nullptr;
-        }
+    spare_.reset();
+    return std::make_shared<ProcessSnapshot>();
+}
+
+void ProcessTreeBuilder::selectTop(const ProcessTable& table, size_t count, ProcessRanking ranking,
+                                   std::vector<ProcessTable::Row>& out) {
+    RanksAbove ranksAbove{table, ranking};
+    out.clear();
+    if (count == 0) {
+        return;
     }
+    out.reserve(std::min<size_t>(count, table.size()));
     
-    // Second pass: move processes to their parents' children vectors
-    auto it = processes.begin();
-    while (it != processes.end()) {
-        if ((*it)->parent != nullptr) {
-            ProcessInfo* parent = (*it)->parent;
-            parent->children.push_back(std::move(*it));
-            it = processes.erase(it);
-        } else {
-            ++it;
+    // Min-heap of the best rows seen so far
+    for (ProcessTable::Row row = 0; row < table.size(); ++row) {
+        if (out.size() < count) {
+            out.push_back(row);
+            std::push_heap(out.begin(), out.end(), ranksAbove);
+        } else if (ranksAbove(row, out.front())) {
+            std::pop_heap(out.begin(), out.end(), ranksAbove);
+            out.back() = row;
+            std::push_heap(out.begin(), out.end(), ranksAbove);
         }
     }
-    
-    // Remaining processes in the vector are roots
-}
-
-std::unique_ptr<ProcessInfo> ProcessTreeBuilder::deepCopy(const ProcessInfo& source) const {
-    auto copy = std::make_unique<ProcessInfo>();
-    copy->pid = source.pid;
-    copy->parentPid = source.parentPid;
-    copy->name = source.name;
-    copy->cpuPercent = source.cpuPercent;
-    copy->memoryBytes = source.memoryBytes;
-    copy->creationTime = source.creationTime;
-    copy->parent = nullptr; // Don't copy parent pointer
-    
-    // Deep copy children
-    copy->children.reserve(source.children.size());
-    for (const auto& child : source.children) {
-        auto childCopy = deepCopy(*child);
-        childCopy->parent = copy.get();
-        copy->children.push_back(std::move(childCopy));
-    }
-    
-    return copy;
+    std::sort_heap(out.begin(), out.end(), ranksAbove);
 }
 
 } // namespace sysmon
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ProcessTable.h"
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief pid -> row of one ProcessTable, open addressing over one flat array sized for the scan
+ *
+ * Internal to the table code (buildTree(), ProcessDelta).
+ */
+class RowIndex {
+public:
+    explicit RowIndex(size_t rows)
+        : slots_(std::bit_ceil(rows * 2 + 1), EMPTY), mask_(slots_.size() - 1) {}
+    
+    // A pid listed twice resolves to its last row
+    void insert(uint32_t pid, ProcessTable::Row row) {
+        size_t slot = home(pid);
+        while (slots_[slot] != EMPTY && static_cast<uint32_t>(slots_[slot] >> 32) != pid) {
+            slot = (slot + 1) & mask_;
+        }
+        slots_[slot] = static_cast<uint64_t>(pid) << 32 | row;
+    }
+    
+    ProcessTable::Row find(uint32_t pid) const {
+        for (size_t slot = home(pid); slots_[slot] != EMPTY; slot = (slot + 1) & mask_) {
+            if (static_cast<uint32_t>(slots_[slot] >> 32) == pid) {
+                return static_cast<ProcessTable::Row>(slots_[slot]);
+            }
+        }
+        return ProcessTable::NONE;
+    }
+    
+private:
+    static constexpr uint64_t EMPTY = ~0ull;
+    
+    size_t home(uint32_t pid) const {
+        return static_cast<size_t>((pid * 0x9E3779B97F4A7C15ull) >> 32) & mask_;
+    }
+    
+    std::vector<uint64_t> slots_;
+    size_t mask_;
+};
+
+} // namespace sysmon
@@ -1,11 +1,44 @@
 #include "SystemDataCollector.h"
+#include "Instrumentation.h"
+#include <algorithm>
 #include <chrono>
 #include <thread>
 
 namespace sysmon {
 
-SystemDataCollector::SystemDataCollector(const Configuration& config)
-    : config_(config), collector_(createSystemCollector()) {
+namespace {
+    // Fixed intervals are an adaptive sampler whose bounds collapse to one value
+    AdaptiveSampler makeSampler(const Configuration& config, uint32_t intervalMs,
+                                AdaptiveSampler::Scale scale) {
+        if (!config.adaptiveSampling) {
+            return AdaptiveSampler(intervalMs, intervalMs, intervalMs, config.volatilityThreshold);
+        }
+        return AdaptiveSampler(intervalMs, config.adaptiveMinIntervalMs,
+                               config.adaptiveMaxIntervalMs, config.volatilityThreshold, scale);
+    }
+}
+
+SystemDataCollector::SystemDataCollector(const Configuration& config,
+                                         const CpuBudgetGovernor* governor)
+    : SystemDataCollector(config, createSystemCollector(config), governor) {
+}
+
+SystemDataCollector::SystemDataCollector(const Configuration& config,
+                                         std::unique_ptr<ISystemCollector> collector,
+                                         const CpuBudgetGovernor* governor)
+    : config_(config), collector_(std::move(collector)), governor_(governor),
+      cpuSampler_(makeSampler(config, config.cpuSampleIntervalMs, AdaptiveSampler::Scale::Percent)),
+      memorySampler_(makeSampler(config, config.memorySampleIntervalMs, AdaptiveSampler::Scale::Percent)),
+      diskSampler_(makeSampler(config, config.diskSampleIntervalMs, AdaptiveSampler::Scale::PercentOfPeak)),
+      networkSampler_(makeSampler(config, config.networkSampleIntervalMs, AdaptiveSampler::Scale::PercentOfPeak)) {
+    intervals_ = effectiveIntervals();
+}
+
+SamplingIntervals SystemDataCollector::effectiveIntervals() const {
+    // The budget governor stretches every source by the same factor
+    uint32_t scale = governor_ ? governor_->systemIntervalScale() : 1;
+    return {cpuSampler_.intervalMs() * scale, memorySampler_.intervalMs() * scale,
+            diskSampler_.intervalMs() * scale, networkSampler_.intervalMs() * scale};
 }
 
 SystemDataCollector::~SystemDataCollector() {
@@ -24,7 +57,11 @@ bool SystemDataCollector::start() {
 }
 
 void SystemDataCollector::stop() {
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        running_ = false;
+    }
+    wakeCv_.notify_all();
     if (collectionThread_.joinable()) {
         collectionThread_.join();
     }
@@ -36,8 +73,39 @@ SystemMetrics SystemDataCollector::getMetrics() const {
     return currentMetrics_;
 }
 
+void SystemDataCollector::getMetrics(SystemMetrics& out) const {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    out = currentMetrics_;
+}
+
+SamplingIntervals SystemDataCollector::getSamplingIntervals() const {
+    std::lock_guard<std::mutex> lock(metricsMutex_);
+    return intervals_;
+}
+
+uint64_t SystemDataCollector::getVersion() const {
+    return notifier_.version();
+}
+
+ChangeNotifier::SubscriptionId SystemDataCollector::subscribe(ChangeNotifier::Callback callback) {
+    return notifier_.subscribe(std::move(callback));
+}
+
+void SystemDataCollector::unsubscribe(ChangeNotifier::SubscriptionId id) {
+    notifier_.unsubscribe(id);
+}
+
+void SystemDataCollector::addObserver(ISampleObserver* observer) {
+    observers_.push_back(observer);
+}
+
 void SystemDataCollector::refresh() {
-    collectAllMetrics();
+    // Wake the collection thread and force every source to be sampled
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        refreshRequested_ = true;
+    }
+    wakeCv_.notify_all();
 }
 
 void SystemDataCollector::collectionLoop() {
@@ -50,82 +118,119 @@ void SystemDataCollector::collectionLoop() {
     
     while (running_) {
         auto now = steady_clock::now();
+        bool cpuUpdated = false;
+        bool memoryUpdated = false;
+        bool diskUpdated = false;
+        bool networkUpdated = false;
         bool updated = false;
         
+        bool forceAll = false;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            std::swap(forceAll, refreshRequested_);
+        }
+        
         SystemMetrics newMetrics;
+        SamplingIntervals due = effectiveIntervals();
         
         // CPU sampling
-        if (duration_cast<milliseconds>(now - lastCpuSample).count() >= 
-            static_cast<int64_t>(config_.cpuSampleIntervalMs)) {
+        if (forceAll || duration_cast<milliseconds>(now - lastCpuSample).count() >= 
+            static_cast<int64_t>(due.cpuMs)) {
+            ScopedTimer timer(TraceSource::CollectCPU);
             collector_->collectCPUMetrics(newMetrics);
+            cpuSampler_.update(newMetrics.cpuUsagePercent);
             lastCpuSample = now;
-            updated = true;
+            cpuUpdated = updated = true;
         }
         
         // Memory sampling
-        if (duration_cast<milliseconds>(now - lastMemorySample).count() >= 
-            static_cast<int64_t>(config_.memorySampleIntervalMs)) {
+        if (forceAll || duration_cast<milliseconds>(now - lastMemorySample).count() >= 
+            static_cast<int64_t>(due.memoryMs)) {
+            ScopedTimer timer(TraceSource::CollectMemory);
             collector_->collectMemoryMetrics(newMetrics);
+            memorySampler_.update(newMetrics.memoryUsagePercent);
             lastMemorySample = now;
-            updated = true;
+            memoryUpdated = updated = true;
         }
         
         // Disk sampling
-        if (duration_cast<milliseconds>(now - lastDiskSample).count() >= 
-            static_cast<int64_t>(config_.diskSampleIntervalMs)) {
+        if (forceAll || duration_cast<milliseconds>(now - lastDiskSample).count() >= 
+            static_cast<int64_t>(due.diskMs)) {
+            ScopedTimer timer(TraceSource::CollectDisk);
             collector_->collectDiskMetrics(newMetrics);
+            diskSampler_.update(static_cast<double>(newMetrics.diskReadBytesPerSec +
+                                                    newMetrics.diskWriteBytesPerSec));
             lastDiskSample = now;
-            updated = true;
+            diskUpdated = updated = true;
         }
         
         // Network sampling
-        if (duration_cast<milliseconds>(now - lastNetworkSample).count() >= 
-            static_cast<int64_t>(config_.networkSampleIntervalMs)) {
+        if (forceAll || duration_cast<milliseconds>(now - lastNetworkSample).count() >= 
+            static_cast<int64_t>(due.networkMs)) {
+            ScopedTimer timer(TraceSource::CollectNetwork);
             collector_->collectNetworkMetrics(newMetrics);
+            networkSampler_.update(static_cast<double>(newMetrics.networkRecvBytesPerSec +
+                                                       newMetrics.networkSendBytesPerSec));
             lastNetworkSample = now;
-            updated = true;
+            networkUpdated = updated = true;
         }
         
         if (updated) {
-            newMetrics.timestampMs = duration_cast<milliseconds>(
-                system_clock::now().time_since_epoch()).count();
+            // Replayed samples arrive with their recorded timestamp
+            if (newMetrics.timestampMs == 0) {
+                newMetrics.timestampMs = duration_cast<milliseconds>(
+                    system_clock::now().time_since_epoch()).count();
+            }
             
-            std::lock_guard<std::mutex> lock(metricsMutex_);
+            if (!observers_.empty()) {
+                uint32_t sources = (cpuUpdated ? SAMPLE_CPU : 0) | (memoryUpdated ? SAMPLE_MEMORY : 0) |
+                                   (diskUpdated ? SAMPLE_DISK : 0) | (networkUpdated ? SAMPLE_NETWORK : 0);
+                for (auto* observer : observers_) {
+                    observer->onSystemSample(newMetrics, sources);
+                }
+            }
+            
+            std::unique_lock<std::mutex> lock(metricsMutex_);
             // Merge new metrics with current (preserve values not updated this cycle)
-            if (newMetrics.cpuUsagePercent > 0) {
+            if (cpuUpdated) {
                 currentMetrics_.cpuUsagePercent = newMetrics.cpuUsagePercent;
                 currentMetrics_.perCoreCpuUsage = newMetrics.perCoreCpuUsage;
+                currentMetrics_.perCoreStealPercent = newMetrics.perCoreStealPercent;
             }
-            if (newMetrics.totalMemoryBytes > 0) {
+            if (memoryUpdated) {
                 currentMetrics_.totalMemoryBytes = newMetrics.totalMemoryBytes;
                 currentMetrics_.usedMemoryBytes = newMetrics.usedMemoryBytes;
                 currentMetrics_.memoryUsagePercent = newMetrics.memoryUsagePercent;
             }
-            currentMetrics_.diskReadBytesPerSec = newMetrics.diskReadBytesPerSec;
-            currentMetrics_.diskWriteBytesPerSec = newMetrics.diskWriteBytesPerSec;
-            currentMetrics_.networkRecvBytesPerSec = newMetrics.networkRecvBytesPerSec;
-            currentMetrics_.networkSendBytesPerSec = newMetrics.networkSendBytesPerSec;
+            if (diskUpdated) {
+                currentMetrics_.diskReadBytesPerSec = newMetrics.diskReadBytesPerSec;
+                currentMetrics_.diskWriteBytesPerSec = newMetrics.diskWriteBytesPerSec;
+                currentMetrics_.diskDevices.swap(newMetrics.diskDevices);
+            }
+            if (networkUpdated) {
+                currentMetrics_.networkRecvBytesPerSec = newMetrics.networkRecvBytesPerSec;
+                currentMetrics_.networkSendBytesPerSec = newMetrics.networkSendBytesPerSec;
+                currentMetrics_.networkInterfaces.swap(newMetrics.networkInterfaces);
+            }
             currentMetrics_.timestampMs = newMetrics.timestampMs;
+            intervals_ = effectiveIntervals();
+            lock.unlock();
+            
+            notifier_.publish();
         }
         
-        // Sleep for a short interval
-        std::this_thread::sleep_for(milliseconds(100));
+        // Sleep until the next source is due so an idle monitor doesn't poll
+        due = effectiveIntervals();
+        auto nextDue = std::min({
+            lastCpuSample + milliseconds(due.cpuMs),
+            lastMemorySample + milliseconds(due.memoryMs),
+            lastDiskSample + milliseconds(due.diskMs),
+            lastNetworkSample + milliseconds(due.networkMs),
+        });
+        
+        std::unique_lock<std::mutex> wakeLock(wakeMutex_);
+        wakeCv_.wait_until(wakeLock, nextDue, [this] { return !running_ || refreshRequested_; });
     }
 }
 
-void SystemDataCollector::collectAllMetrics() {
-    SystemMetrics newMetrics;
-    
-    collector_->collectCPUMetrics(newMetrics);
-    collector_->collectMemoryMetrics(newMetrics);
-    collector_->collectDiskMetrics(newMetrics);
-    collector_->collectNetworkMetrics(newMetrics);
-    
-    newMetrics.timestampMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    currentMetrics_ = newMetrics;
-}
-
 } // namespace sysmon
@@ -0,0 +1,149 @@
+#include "HeadlessExporter.h"
+#include <iostream>
+#include <utility>
+
+namespace sysmon {
+
+namespace {
+    // Pending output kept while the consumer is slow before snapshots are dropped
+    constexpr size_t MAX_PENDING_BYTES = 4 * 1024 * 1024;
+    
+    // Initial capacity of both buffers; covers a batch of typical snapshots
+    constexpr size_t INITIAL_BUFFER_BYTES = 64 * 1024;
+    
+    ExportFormat formatFromConfig(const Configuration& config) {
+        ExportFormat format = ExportFormat::JsonLines;
+        parseExportFormat(config.exportFormat, format);
+        return format;
+    }
+}
+
+HeadlessExporter::HeadlessExporter(SystemDataCollector& dataCollector,
+                                   ProcessTreeBuilder& processBuilder,
+                                   const Configuration& config,
+                                   AlertEngine* alerts)
+    : dataCollector_(dataCollector),
+      processBuilder_(processBuilder),
+      config_(config),
+      serializer_(formatFromConfig(config)),
+      alerts_(alerts) {
+    serializer_.setCsvProcessColumns(config_.exportTopProcesses);
+}
+
+HeadlessExporter::~HeadlessExporter() {
+    stop();
+}
+
+bool HeadlessExporter::start() {
+    ExportFormat format;
+    if (!parseExportFormat(config_.exportFormat, format)) {
+        std::cerr << "Unknown export format: " << config_.exportFormat << "\n";
+        return false;
+    }
+    
+    if (config_.exportOutput.empty() || config_.exportOutput == "-") {
+        output_ = stdout;
+        ownsOutput_ = false;
+    } else {
+        output_ = std::fopen(config_.exportOutput.c_str(), format == ExportFormat::Binary ? "ab" : "a");
+        if (!output_) {
+            std::cerr << "Failed to open " << config_.exportOutput << "\n";
+            return false;
+        }
+        ownsOutput_ = true;
+    }
+    
+    pending_.reserve(INITIAL_BUFFER_BYTES);
+    writing_.reserve(INITIAL_BUFFER_BYTES);
+    topProcesses_.reserve(config_.exportTopProcesses);
+    
+    running_ = true;
+    writerThread_ = std::thread(&HeadlessExporter::writerLoop, this);
+    subscription_ = dataCollector_.subscribe([this](uint64_t) { onSnapshot(); });
+    if (alerts_ && format == ExportFormat::JsonLines) {
+        alertSubscription_ = alerts_->subscribe([this](uint64_t) { onAlerts(); });
+    }
+    
+    return true;
+}
+
+void HeadlessExporter::stop() {
+    if (subscription_ != 0) {
+        dataCollector_.unsubscribe(subscription_);
+        subscription_ = 0;
+    }
+    if (alertSubscription_ != 0) {
+        alerts_->unsubscribe(alertSubscription_);
+        alertSubscription_ = 0;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        running_ = false;
+    }
+    bufferCv_.notify_all();
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+    
+    if (output_ && ownsOutput_) {
+        std::fclose(output_);
+    }
+    output_ = nullptr;
+}
+
+void HeadlessExporter::onSnapshot() {
+    // Runs on the collection thread right after publish; getMetrics() is uncontended here
+    dataCollector_.getMetrics(metrics_);
+    if (config_.exportTopProcesses > 0) {
+        processBuilder_.getTopProcesses(config_.exportTopProcesses, topProcesses_);
+    }
+    if (config_.exportTopGroups > 0) {
+        processBuilder_.getProcessGroups(config_.exportTopGroups, groups_);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        if (pending_.size() >= MAX_PENDING_BYTES) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        serializer_.serialize(metrics_, topProcesses_, pending_, config_.exportTopGroups > 0 ? &groups_ : nullptr);
+    }
+    bufferCv_.notify_one();
+}
+
+void HeadlessExporter::onAlerts() {
+    // Publishes come from both collector threads, so the cursor is advanced under the buffer lock.
+    // Alerts are rare and never dropped, even while snapshots are.
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex_);
+        alertCursor_ = alerts_->getEvents(alertCursor_, alertEvents_);
+        for (const auto& event : alertEvents_) {
+            serializer_.serializeAlert(event, pending_);
+        }
+    }
+    bufferCv_.notify_one();
+}
+
+void HeadlessExporter::writerLoop() {
+    std::unique_lock<std::mutex> lock(bufferMutex_);
+    while (true) {
+        bufferCv_.wait(lock, [this] { return !running_ || !pending_.empty(); });
+        if (pending_.empty() && !running_) {
+            break;
+        }
+        
+        // Swap keeps both buffers' capacity, so steady state never reallocates
+        std::swap(pending_, writing_);
+        lock.unlock();
+        
+        std::fwrite(writing_.data(), 1, writing_.size(), output_);
+        std::fflush(output_);
+        writing_.clear();
+        
+        lock.lock();
+    }
+}
+
+} // namespace sysmon
@@ -0,0 +1,462 @@
+#include "MetricsHttpServer.h"
+#include "TcpSocket.h"
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+    constexpr size_t NUMBER_BUFFER_SIZE = 64;
+    
+    // Requests larger than this are not scrapes; the connection is dropped
+    constexpr size_t MAX_REQUEST_BYTES = 8 * 1024;
+    
+    // A stalled client may hold the (single) server thread this long at most
+    constexpr int SOCKET_TIMEOUT_SEC = 2;
+    
+    constexpr size_t INITIAL_BODY_BYTES = 64 * 1024;
+    
+    constexpr const char* TEXT_CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+    constexpr const char* OPENMETRICS_CONTENT_TYPE =
+        "application/openmetrics-text; version=1.0.0; charset=utf-8";
+    
+    enum class MetricType { Gauge, Counter };
+    
+    void appendUnsigned(std::string& out, uint64_t value) {
+        char buffer[NUMBER_BUFFER_SIZE];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+    
+    void appendDouble(std::string& out, double value) {
+        char buffer[NUMBER_BUFFER_SIZE];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        if (result.ec != std::errc()) {
+            out += '0';
+            return;
+        }
+        out.append(buffer, result.ptr);
+    }
+    
+    void appendLabelValue(std::string& out, const std::string& value) {
+        out += '"';
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+    
+    // Counters are declared under their family name in OpenMetrics and under
+    // the sample name (with _total) in the Prometheus text format
+    void appendFamily(std::string& out, ExpositionFormat format, const char* name,
+                      MetricType type, const char* help) {
+        bool counter = type == MetricType::Counter;
+        const char* suffix = counter && format == ExpositionFormat::PrometheusText ? "_total" : "";
+        out += "# HELP ";
+        out += name;
+        out += suffix;
+        out += ' ';
+        out += help;
+        out += "\n# TYPE ";
+        out += name;
+        out += suffix;
+        out += counter ? " counter\n" : " gauge\n";
+    }
+    
+    void appendSampleName(std::string& out, const char* name, MetricType type) {
+        out += name;
+        if (type == MetricType::Counter) {
+            out += "_total";
+        }
+    }
+    
+    template <typename Value>
+    void appendSample(std::string& out, const char* name, MetricType type, Value value) {
+        appendSampleName(out, name, type);
+        out += ' ';
+        if constexpr (std::is_floating_point_v<Value>) {
+            appendDouble(out, value);
+        } else {
+            appendUnsigned(out, value);
+        }
+        out += '\n';
+    }
+    
+    template <typename Value>
+    void appendGauge(std::string& out, ExpositionFormat format, const char* name,
+                     const char* help, Value value) {
+        appendFamily(out, format, name, MetricType::Gauge, help);
+        appendSample(out, name, MetricType::Gauge, value);
+    }
+    
+    // One counter family with a sample per device
+    template <typename GetValue>
+    void appendDeviceCounter(std::string& out, ExpositionFormat format, const char* name,
+                             const char* help, const std::vector<DeviceCounters>& devices,
+                             GetValue valueOf) {
+        if (devices.empty()) {
+            return;
+        }
+        appendFamily(out, format, name, MetricType::Counter, help);
+        for (const auto& device : devices) {
+            appendSampleName(out, name, MetricType::Counter);
+            out += "{device=";
+            appendLabelValue(out, device.name);
+            out += "} ";
+            appendUnsigned(out, valueOf(device));
+            out += '\n';
+        }
+    }
+    
+    template <typename GetValue>
+    void appendProcessGauge(std::string& out, ExpositionFormat format, const char* name,
+                            const char* help, const std::vector<ProcessSummary>& processes,
+                            GetValue valueOf) {
+        if (processes.empty()) {
+            return;
+        }
+        appendFamily(out, format, name, MetricType::Gauge, help);
+        for (const auto& proc : processes) {
+            out += name;
+            out += "{pid=\"";
+            appendUnsigned(out, proc.pid);
+            out += "\",name=";
+            appendLabelValue(out, proc.name);
+            out += "} ";
+            auto value = valueOf(proc);
+            if constexpr (std::is_floating_point_v<decltype(value)>) {
+                appendDouble(out, value);
+            } else {
+                appendUnsigned(out, value);
+            }
+            out += '\n';
+        }
+    }
+    
+    // One family across every grouping, told apart by the "by" label
+    template <typename GetValue>
+    void appendGroupGauge(std::string& out, ExpositionFormat format, const char* name,
+                          const char* help, const ProcessGroups& groups, GetValue valueOf) {
+        if (groups.byExecutable.empty() && groups.byUser.empty() && groups.byCgroup.empty()) {
+            return;
+        }
+        appendFamily(out, format, name, MetricType::Gauge, help);
+        for (size_t i = 0; i < PROCESS_GROUPINGS; ++i) {
+            auto grouping = static_cast<ProcessGrouping>(i);
+            for (const auto& group : groups.of(grouping)) {
+                out += name;
+                out += "{by=\"";
+                out += processGroupingName(grouping);
+                out += "\",group=";
+                appendLabelValue(out, group.key);
+                out += "} ";
+                auto value = valueOf(group);
+                if constexpr (std::is_floating_point_v<decltype(value)>) {
+                    appendDouble(out, value);
+                } else {
+                    appendUnsigned(out, value);
+                }
+                out += '\n';
+            }
+        }
+    }
+    
+    bool containsIgnoreCase(const std::string& haystack, const char* needle) {
+        size_t length = std::strlen(needle);
+        if (length > haystack.size()) {
+            return false;
+        }
+        for (size_t i = 0; i + length <= haystack.size(); ++i) {
+            size_t j = 0;
+            while (j < length && std::tolower(static_cast<unsigned char>(haystack[i + j])) == needle[j]) {
+                ++j;
+            }
+            if (j == length) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+#ifndef _WIN32
+    bool sendAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+#endif
+}
+
+void appendExposition(const SystemMetrics& metrics, const std::vector<ProcessSummary>& topProcesses,
+                      const ProcessGroups& groups, ExpositionFormat format, std::string& out) {
+    appendGauge(out, format, "sysmon_cpu_usage_percent", "Overall CPU usage (0-100).",
+                metrics.cpuUsagePercent);
+    
+    appendFamily(out, format, "sysmon_cpu_core_usage_percent", MetricType::Gauge,
+                 "Per-core CPU usage (0-100).");
+    for (size_t core = 0; core < metrics.perCoreCpuUsage.size(); ++core) {
+        out += "sysmon_cpu_core_usage_percent{core=\"";
+        appendUnsigned(out, core);
+        out += "\"} ";
+        appendDouble(out, metrics.perCoreCpuUsage[core]);
+        out += '\n';
+    }
+    
+    appendGauge(out, format, "sysmon_memory_total_bytes", "Total physical memory.",
+                metrics.totalMemoryBytes);
+    appendGauge(out, format, "sysmon_memory_used_bytes", "Used physical memory.",
+                metrics.usedMemoryBytes);
+    appendGauge(out, format, "sysmon_memory_usage_percent", "Used physical memory (0-100).",
+                metrics.memoryUsagePercent);
+    
+    appendGauge(out, format, "sysmon_disk_read_bytes_per_second", "Disk read throughput, all devices.",
+                metrics.diskReadBytesPerSec);
+    appendGauge(out, format, "sysmon_disk_write_bytes_per_second", "Disk write throughput, all devices.",
+                metrics.diskWriteBytesPerSec);
+    appendGauge(out, format, "sysmon_network_receive_bytes_per_second",
+                "Network receive throughput, all interfaces except loopback.",
+                metrics.networkRecvBytesPerSec);
+    appendGauge(out, format, "sysmon_network_transmit_bytes_per_second",
+                "Network transmit throughput, all interfaces except loopback.",
+                metrics.networkSendBytesPerSec);
+    
+    appendDeviceCounter(out, format, "sysmon_disk_read_bytes", "Bytes read per block device.",
+                        metrics.diskDevices, [](const DeviceCounters& d) { return d.readBytes; });
+    appendDeviceCounter(out, format, "sysmon_disk_written_bytes", "Bytes written per block device.",
+                        metrics.diskDevices, [](const DeviceCounters& d) { return d.writeBytes; });
+    appendDeviceCounter(out, format, "sysmon_network_receive_bytes", "Bytes received per interface.",
+                        metrics.networkInterfaces, [](const DeviceCounters& d) { return d.readBytes; });
+    appendDeviceCounter(out, format, "sysmon_network_transmit_bytes", "Bytes sent per interface.",
+                        metrics.networkInterfaces, [](const DeviceCounters& d) { return d.writeBytes; });
+    
+    appendProcessGauge(out, format, "sysmon_process_cpu_usage_percent",
+                       "CPU usage of the top processes by CPU (100 = one core).", topProcesses,
+                       [](const ProcessSummary& p) { return p.cpuPercent; });
+    appendProcessGauge(out, format, "sysmon_process_memory_bytes",
+                       "Memory of the top processes by CPU.", topProcesses,
+                       [](const ProcessSummary& p) { return p.memoryBytes; });
+    
+    appendGroupGauge(out, format, "sysmon_group_cpu_usage_percent",
+                     "CPU usage of the top groups by CPU, per executable, user or cgroup (100 = one core).",
+                     groups, [](const ProcessGroup& g) { return g.cpuPercent; });
+    appendGroupGauge(out, format, "sysmon_group_memory_bytes",
+                     "Memory of the top groups by CPU, per executable, user or cgroup.", groups,
+                     [](const ProcessGroup& g) { return g.memoryBytes; });
+    appendGroupGauge(out, format, "sysmon_group_processes",
+                     "Processes in the top groups by CPU, per executable, user or cgroup.", groups,
+                     [](const ProcessGroup& g) { return static_cast<uint64_t>(g.processCount); });
+    
+    appendGauge(out, format, "sysmon_sample_timestamp_seconds", "Time the snapshot was taken.",
+                static_cast<double>(metrics.timestampMs) / 1000.0);
+    
+    if (format == ExpositionFormat::OpenMetrics) {
+        out += "# EOF\n";
+    }
+}
+
+MetricsHttpServer::MetricsHttpServer(SystemDataCollector& dataCollector,
+                                     ProcessTreeBuilder& processBuilder,
+                                     const Configuration& config)
+    : dataCollector_(dataCollector), processBuilder_(processBuilder), config_(config) {
+}
+
+MetricsHttpServer::~MetricsHttpServer() {
+    stop();
+}
+
+#ifdef _WIN32
+
+bool MetricsHttpServer::start() {
+    std::cerr << "--metrics-listen is not supported on this platform\n";
+    return false;
+}
+
+void MetricsHttpServer::stop() {
+}
+
+#else
+
+bool MetricsHttpServer::start() {
+    std::string error;
+    listenFd_ = net::listenTcp(config_.metricsListen, error);
+    if (listenFd_ < 0) {
+        std::cerr << "Cannot listen on " << config_.metricsListen << ": " << error << "\n";
+        return false;
+    }
+    // pipe2() and accept4() are Linux-only; the flags are set afterwards instead
+    if (pipe(wakePipe_) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    net::setDescriptorFlags(wakePipe_[0], false);
+    net::setDescriptorFlags(wakePipe_[1], false);
+    
+    textBody_.body.reserve(INITIAL_BODY_BYTES);
+    openMetricsBody_.body.reserve(INITIAL_BODY_BYTES);
+    topProcesses_.reserve(config_.metricsTopProcesses);
+    
+    running_ = true;
+    serverThread_ = std::thread(&MetricsHttpServer::serverLoop, this);
+    return true;
+}
+
+void MetricsHttpServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    
+    // Wake poll() so the thread sees running_ == false
+    char byte = 0;
+    if (write(wakePipe_[1], &byte, 1) < 0) {
+        // The pipe is only ever written once; nothing to recover
+    }
+    if (serverThread_.joinable()) {
+        serverThread_.join();
+    }
+    
+    close(listenFd_);
+    close(wakePipe_[0]);
+    close(wakePipe_[1]);
+    listenFd_ = -1;
+    wakePipe_[0] = wakePipe_[1] = -1;
+}
+
+void MetricsHttpServer::serverLoop() {
+    pollfd fds[2] = {{listenFd_, POLLIN, 0}, {wakePipe_[0], POLLIN, 0}};
+    
+    while (running_) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd >= 0) {
+                net::setDescriptorFlags(fd, false);
+                handleConnection(fd);
+                close(fd);
+            }
+        }
+    }
+}
+
+void MetricsHttpServer::handleConnection(int fd) {
+    timeval timeout{SOCKET_TIMEOUT_SEC, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    // Read up to the end of the request headers; scrapes have no body
+    request_.clear();
+    char buffer[2048];
+    while (request_.find("\r\n\r\n") == std::string::npos) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0 || request_.size() + static_cast<size_t>(received) > MAX_REQUEST_BYTES) {
+            return;
+        }
+        request_.append(buffer, static_cast<size_t>(received));
+    }
+    
+    size_t methodEnd = request_.find(' ');
+    size_t targetEnd = methodEnd == std::string::npos ? methodEnd : request_.find(' ', methodEnd + 1);
+    if (targetEnd == std::string::npos) {
+        return;
+    }
+    std::string_view method(request_.data(), methodEnd);
+    std::string_view target(request_.data() + methodEnd + 1, targetEnd - methodEnd - 1);
+    target = target.substr(0, target.find('?'));
+    bool head = method == "HEAD";
+    
+    const char* status = "200 OK";
+    const char* contentType = "text/plain; charset=utf-8";
+    std::string_view body;
+    if (method != "GET" && !head) {
+        status = "405 Method Not Allowed";
+        body = "Only GET and HEAD are supported\n";
+    } else if (target == "/metrics") {
+        ExpositionFormat format = containsIgnoreCase(request_, "application/openmetrics-text")
+            ? ExpositionFormat::OpenMetrics : ExpositionFormat::PrometheusText;
+        contentType = format == ExpositionFormat::OpenMetrics ? OPENMETRICS_CONTENT_TYPE : TEXT_CONTENT_TYPE;
+        body = renderBody(format);
+        scrapes_.fetch_add(1, std::memory_order_relaxed);
+    } else if (target == "/") {
+        body = "sysmon exporter: metrics are at /metrics\n";
+    } else {
+        status = "404 Not Found";
+        body = "Not found\n";
+    }
+    
+    header_.clear();
+    header_ += "HTTP/1.1 ";
+    header_ += status;
+    header_ += "\r\nContent-Type: ";
+    header_ += contentType;
+    header_ += "\r\nContent-Length: ";
+    appendUnsigned(header_, body.size());
+    header_ += "\r\nConnection: close\r\n\r\n";
+    
+    if (sendAll(fd, header_.data(), header_.size()) && !head) {
+        sendAll(fd, body.data(), body.size());
+    }
+}
+
+#endif
+
+const std::string& MetricsHttpServer::renderBody(ExpositionFormat format) {
+    CachedBody& cached = format == ExpositionFormat::OpenMetrics ? openMetricsBody_ : textBody_;
+    
+    // Re-render only when a collector has published since the last scrape
+    uint64_t metricsVersion = dataCollector_.getVersion();
+    uint64_t processVersion = processBuilder_.getVersion();
+    if (cached.valid && cached.metricsVersion == metricsVersion &&
+        cached.processVersion == processVersion) {
+        return cached.body;
+    }
+    
+    dataCollector_.getMetrics(metrics_);
+    if (config_.metricsTopProcesses > 0) {
+        processBuilder_.getTopProcesses(config_.metricsTopProcesses, topProcesses_);
+    }
+    if (config_.metricsTopGroups > 0) {
+        processBuilder_.getProcessGroups(config_.metricsTopGroups, groups_);
+    }
+    
+    cached.body.clear();
+    appendExposition(metrics_, topProcesses_, groups_, format, cached.body);
+    cached.metricsVersion = metricsVersion;
+    cached.processVersion = processVersion;
+    cached.valid = true;
+    return cached.body;
+}
+
+} // namespace sysmon
@@ -0,0 +1,324 @@
+#include "MetricsSerializer.h"
+#include "ProcessGroups.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace sysmon {
+
+namespace {
+    // Longest value to_chars can produce for the types written here
+    constexpr size_t NUMBER_BUFFER_SIZE = 64;
+    
+    void appendUnsigned(std::string& out, uint64_t value) {
+        char buffer[NUMBER_BUFFER_SIZE];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+    
+    void appendFixed(std::string& out, double value, int precision = 2) {
+        char buffer[NUMBER_BUFFER_SIZE];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                                    std::chars_format::fixed, precision);
+        if (result.ec != std::errc()) {
+            out += '0';
+            return;
+        }
+        out.append(buffer, result.ptr);
+    }
+    
+    void appendJsonString(std::string& out, const std::string& value) {
+        static const char HEX[] = "0123456789abcdef";
+        out += '"';
+        for (char c : value) {
+            auto byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (byte < 0x20) {
+                out += "\\u00";
+                out += HEX[byte >> 4];
+                out += HEX[byte & 0xF];
+            } else {
+                out += c;
+            }
+        }
+        out += '"';
+    }
+    
+    void appendCsvField(std::string& out, const std::string& value) {
+        if (value.find_first_of(",\"\n\r") == std::string::npos) {
+            out += value;
+            return;
+        }
+        out += '"';
+        for (char c : value) {
+            if (c == '"') {
+                out += '"';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+    
+    template <typename T>
+    void appendLittleEndian(std::string& out, T value) {
+        static_assert(std::numeric_limits<T>::is_integer, "Integers only");
+        using Unsigned = std::make_unsigned_t<T>;
+        auto bits = static_cast<Unsigned>(value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            out += static_cast<char>((bits >> (8 * i)) & 0xFF);
+        }
+    }
+    
+    void appendFloat(std::string& out, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        appendLittleEndian(out, bits);
+    }
+    
+    void appendDouble(std::string& out, double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        appendLittleEndian(out, bits);
+    }
+}
+
+bool parseExportFormat(const std::string& name, ExportFormat& format) {
+    if (name == "jsonl" || name == "json") {
+        format = ExportFormat::JsonLines;
+    } else if (name == "csv") {
+        format = ExportFormat::Csv;
+    } else if (name == "binary" || name == "bin") {
+        format = ExportFormat::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+MetricsSerializer::MetricsSerializer(ExportFormat format)
+    : format_(format) {
+}
+
+void MetricsSerializer::serialize(const SystemMetrics& metrics,
+                                  const std::vector<ProcessSummary>& topProcesses,
+                                  std::string& out, const ProcessGroups* groups) {
+    switch (format_) {
+        case ExportFormat::JsonLines:
+            serializeJson(metrics, topProcesses, groups, out);
+            break;
+        case ExportFormat::Csv:
+            serializeCsv(metrics, topProcesses, out);
+            break;
+        case ExportFormat::Binary:
+            serializeBinary(metrics, topProcesses, out);
+            break;
+    }
+}
+
+bool MetricsSerializer::serializeAlert(const AlertEvent& event, std::string& out) const {
+    if (format_ != ExportFormat::JsonLines) {
+        return false;
+    }
+    out += "{\"timestamp_ms\":";
+    appendUnsigned(out, event.timestampMs);
+    out += event.firing ? ",\"alert\":\"fired\",\"rule\":" : ",\"alert\":\"resolved\",\"rule\":";
+    appendJsonString(out, event.rule);
+    out += ",\"instance\":";
+    appendJsonString(out, event.instance);
+    out += ",\"value\":";
+    appendFixed(out, event.value);
+    out += ",\"threshold\":";
+    appendFixed(out, event.threshold);
+    out += "}\n";
+    return true;
+}
+
+void MetricsSerializer::serializeJson(const SystemMetrics& metrics,
+                                      const std::vector<ProcessSummary>& topProcesses,
+                                      const ProcessGroups* groups, std::string& out) const {
+    out += "{\"timestamp_ms\":";
+    appendUnsigned(out, metrics.timestampMs);
+    out += ",\"cpu_percent\":";
+    appendFixed(out, metrics.cpuUsagePercent);
+    out += ",\"cores\":[";
+    for (size_t i = 0; i < metrics.perCoreCpuUsage.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        appendFixed(out, metrics.perCoreCpuUsage[i]);
+    }
+    out += "],\"memory_total_bytes\":";
+    appendUnsigned(out, metrics.totalMemoryBytes);
+    out += ",\"memory_used_bytes\":";
+    appendUnsigned(out, metrics.usedMemoryBytes);
+    out += ",\"memory_percent\":";
+    appendFixed(out, metrics.memoryUsagePercent);
+    out += ",\"disk_read_bps\":";
+    appendUnsigned(out, metrics.diskReadBytesPerSec);
+    out += ",\"disk_write_bps\":";
+    appendUnsigned(out, metrics.diskWriteBytesPerSec);
+    out += ",\"net_recv_bps\":";
+    appendUnsigned(out, metrics.networkRecvBytesPerSec);
+    out += ",\"net_send_bps\":";
+    appendUnsigned(out, metrics.networkSendBytesPerSec);
+    
+    if (!topProcesses.empty()) {
+        out += ",\"processes\":[";
+        for (size_t i = 0; i < topProcesses.size(); ++i) {
+            const auto& proc = topProcesses[i];
+            out += i > 0 ? ",{\"pid\":" : "{\"pid\":";
+            appendUnsigned(out, proc.pid);
+            out += ",\"ppid\":";
+            appendUnsigned(out, proc.parentPid);
+            out += ",\"name\":";
+            appendJsonString(out, proc.name);
+            out += ",\"cpu_percent\":";
+            appendFixed(out, proc.cpuPercent);
+            out += ",\"memory_bytes\":";
+            appendUnsigned(out, proc.memoryBytes);
+            out += '}';
+        }
+        out += ']';
+    }
+    if (groups) {
+        out += ",\"groups\":{";
+        for (size_t i = 0; i < PROCESS_GROUPINGS; ++i) {
+            auto grouping = static_cast<ProcessGrouping>(i);
+            out += i > 0 ? ",\"" : "\"";
+            out += processGroupingName(grouping);
+            out += "\":[";
+            const auto& list = groups->of(grouping);
+            for (size_t g = 0; g < list.size(); ++g) {
+                out += g > 0 ? ",{\"key\":" : "{\"key\":";
+                appendJsonString(out, list[g].key);
+                out += ",\"processes\":";
+                appendUnsigned(out, list[g].processCount);
+                out += ",\"cpu_percent\":";
+                appendFixed(out, list[g].cpuPercent);
+                out += ",\"memory_bytes\":";
+                appendUnsigned(out, list[g].memoryBytes);
+                out += '}';
+            }
+            out += ']';
+        }
+        out += '}';
+    }
+    out += "}\n";
+}
+
+void MetricsSerializer::serializeCsv(const SystemMetrics& metrics,
+                                     const std::vector<ProcessSummary>& topProcesses,
+                                     std::string& out) {
+    if (!csvHeaderWritten_) {
+        csvCoreColumns_ = metrics.perCoreCpuUsage.size();
+        out += "timestamp_ms,cpu_percent,memory_total_bytes,memory_used_bytes,memory_percent,"
+               "disk_read_bps,disk_write_bps,net_recv_bps,net_send_bps";
+        for (size_t i = 0; i < csvCoreColumns_; ++i) {
+            out += ",core";
+            appendUnsigned(out, i);
+        }
+        for (size_t i = 0; i < csvProcessColumns_; ++i) {
+            for (const char* field : {"_pid", "_name", "_cpu_percent", "_memory_bytes"}) {
+                out += ",top";
+                appendUnsigned(out, i + 1);
+                out += field;
+            }
+        }
+        out += '\n';
+        csvHeaderWritten_ = true;
+    }
+    
+    appendUnsigned(out, metrics.timestampMs);
+    out += ',';
+    appendFixed(out, metrics.cpuUsagePercent);
+    out += ',';
+    appendUnsigned(out, metrics.totalMemoryBytes);
+    out += ',';
+    appendUnsigned(out, metrics.usedMemoryBytes);
+    out += ',';
+    appendFixed(out, metrics.memoryUsagePercent);
+    out += ',';
+    appendUnsigned(out, metrics.diskReadBytesPerSec);
+    out += ',';
+    appendUnsigned(out, metrics.diskWriteBytesPerSec);
+    out += ',';
+    appendUnsigned(out, metrics.networkRecvBytesPerSec);
+    out += ',';
+    appendUnsigned(out, metrics.networkSendBytesPerSec);
+    
+    // Columns are fixed by the header; pad or truncate to match
+    for (size_t i = 0; i < csvCoreColumns_; ++i) {
+        out += ',';
+        if (i < metrics.perCoreCpuUsage.size()) {
+            appendFixed(out, metrics.perCoreCpuUsage[i]);
+        }
+    }
+    for (size_t i = 0; i < csvProcessColumns_; ++i) {
+        if (i < topProcesses.size()) {
+            const auto& proc = topProcesses[i];
+            out += ',';
+            appendUnsigned(out, proc.pid);
+            out += ',';
+            appendCsvField(out, proc.name);
+            out += ',';
+            appendFixed(out, proc.cpuPercent);
+            out += ',';
+            appendUnsigned(out, proc.memoryBytes);
+        } else {
+            out += ",,,,";
+        }
+    }
+    out += '\n';
+}
+
+void MetricsSerializer::serializeBinary(const SystemMetrics& metrics,
+                                        const std::vector<ProcessSummary>& topProcesses,
+                                        std::string& out) const {
+    // Length is patched once the record is complete
+    size_t lengthOffset = out.size();
+    appendLittleEndian<uint32_t>(out, 0);
+    
+    appendLittleEndian<uint8_t>(out, BINARY_VERSION);
+    appendLittleEndian<uint64_t>(out, metrics.timestampMs);
+    appendDouble(out, metrics.cpuUsagePercent);
+    
+    auto coreCount = static_cast<uint16_t>(
+        std::min<size_t>(metrics.perCoreCpuUsage.size(), std::numeric_limits<uint16_t>::max()));
+    appendLittleEndian(out, coreCount);
+    for (size_t i = 0; i < coreCount; ++i) {
+        appendFloat(out, static_cast<float>(metrics.perCoreCpuUsage[i]));
+    }
+    
+    appendLittleEndian<uint64_t>(out, metrics.totalMemoryBytes);
+    appendLittleEndian<uint64_t>(out, metrics.usedMemoryBytes);
+    appendDouble(out, metrics.memoryUsagePercent);
+    appendLittleEndian<uint64_t>(out, metrics.diskReadBytesPerSec);
+    appendLittleEndian<uint64_t>(out, metrics.diskWriteBytesPerSec);
+    appendLittleEndian<uint64_t>(out, metrics.networkRecvBytesPerSec);
+    appendLittleEndian<uint64_t>(out, metrics.networkSendBytesPerSec);
+    
+    auto processCount = static_cast<uint16_t>(
+        std::min<size_t>(topProcesses.size(), std::numeric_limits<uint16_t>::max()));
+    appendLittleEndian(out, processCount);
+    for (size_t i = 0; i < processCount; ++i) {
+        const auto& proc = topProcesses[i];
+        auto nameLength = static_cast<uint8_t>(std::min<size_t>(proc.name.size(), 255));
+        appendLittleEndian<uint32_t>(out, proc.pid);
+        appendLittleEndian<uint32_t>(out, proc.parentPid);
+        appendFloat(out, static_cast<float>(proc.cpuPercent));
+        appendLittleEndian<uint64_t>(out, proc.memoryBytes);
+        appendLittleEndian(out, nameLength);
+        out.append(proc.name.data(), nameLength);
+    }
+    
+    auto length = static_cast<uint32_t>(out.size() - lengthOffset - sizeof(uint32_t));
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        out[lengthOffset + i] = static_cast<char>((length >> (8 * i)) & 0xFF);
+    }
+}
+
+} // namespace sysmon
@@ -0,0 +1,44 @@
+#include "SharedMemoryPublisher.h"
+
+namespace sysmon {
+
+SharedMemoryPublisher::SharedMemoryPublisher(SystemDataCollector& dataCollector,
+                                             ProcessTreeBuilder& processBuilder)
+    : dataCollector_(dataCollector), processBuilder_(processBuilder) {
+}
+
+SharedMemoryPublisher::~SharedMemoryPublisher() {
+    stop();
+}
+
+bool SharedMemoryPublisher::start(const std::string& name) {
+    if (!segment_.create(name)) {
+        return false;
+    }
+    
+    topProcesses_.reserve(SYSMON_SHM_MAX_PROCESSES);
+    metricsSubscription_ = dataCollector_.subscribe([this](uint64_t) {
+        dataCollector_.getMetrics(metrics_);
+        segment_.publishMetrics(metrics_);
+    });
+    processSubscription_ = processBuilder_.subscribe([this](uint64_t) {
+        processBuilder_.getTopProcesses(SYSMON_SHM_MAX_PROCESSES, topProcesses_);
+        segment_.publishProcesses(topProcesses_);
+    });
+    
+    return true;
+}
+
+void SharedMemoryPublisher::stop() {
+    if (metricsSubscription_ != 0) {
+        dataCollector_.unsubscribe(metricsSubscription_);
+        metricsSubscription_ = 0;
+    }
+    if (processSubscription_ != 0) {
+        processBuilder_.unsubscribe(processSubscription_);
+        processSubscription_ = 0;
+    }
+    segment_.close();
+}
+
+} // namespace sysmon
@@ -0,0 +1,131 @@
+#include "SharedMetricsSegment.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+SharedMetricsSegment::~SharedMetricsSegment() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool SharedMetricsSegment::create(const std::string& /*name*/) {
+    std::cerr << "Shared-memory publishing is not supported on this platform\n";
+    return false;
+}
+
+void SharedMetricsSegment::close() {
+}
+
+#else
+
+bool SharedMetricsSegment::create(const std::string& name) {
+    close();
+    
+    // Taking over a stale segment left by a crashed instance is fine: readers
+    // re-validate the header when they reopen
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "shm_open(" << name << ") failed: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (ftruncate(fd, sizeof(sysmon_shm_segment)) != 0) {
+        std::cerr << "Cannot size shared memory " << name << ": " << std::strerror(errno) << "\n";
+        ::close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, sizeof(sysmon_shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Cannot map shared memory " << name << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    
+    segment_ = static_cast<sysmon_shm_segment*>(mapping);
+    name_ = name;
+    
+    // Header last: a reader that sees the magic sees a zeroed, even sequence
+    std::memset(segment_, 0, sizeof(sysmon_shm_segment));
+    segment_->version = SYSMON_SHM_VERSION;
+    segment_->segment_size = sizeof(sysmon_shm_segment);
+    segment_->writer_pid = static_cast<uint32_t>(getpid());
+    __atomic_store_n(&segment_->magic, SYSMON_SHM_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+void SharedMetricsSegment::close() {
+    if (!segment_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        __atomic_store_n(&segment_->writer_pid, 0u, __ATOMIC_RELEASE);
+    }
+    munmap(segment_, sizeof(sysmon_shm_segment));
+    shm_unlink(name_.c_str());
+    segment_ = nullptr;
+}
+
+#endif
+
+template <typename Update>
+void SharedMetricsSegment::write(Update update) {
+    if (!segment_) {
+        return;
+    }
+    
+    // Seqlock writer: odd while the data is inconsistent, even once it is done
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    uint64_t sequence = __atomic_load_n(&segment_->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&segment_->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    update(segment_->data);
+    __atomic_store_n(&segment_->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+void SharedMetricsSegment::publishMetrics(const SystemMetrics& metrics) {
+    write([&](sysmon_shm_snapshot& data) {
+        data.timestamp_ms = metrics.timestampMs;
+        ++data.metrics_updates;
+        data.cpu_usage_percent = metrics.cpuUsagePercent;
+        data.memory_usage_percent = metrics.memoryUsagePercent;
+        data.total_memory_bytes = metrics.totalMemoryBytes;
+        data.used_memory_bytes = metrics.usedMemoryBytes;
+        data.disk_read_bytes_per_sec = metrics.diskReadBytesPerSec;
+        data.disk_write_bytes_per_sec = metrics.diskWriteBytesPerSec;
+        data.network_recv_bytes_per_sec = metrics.networkRecvBytesPerSec;
+        data.network_send_bytes_per_sec = metrics.networkSendBytesPerSec;
+        
+        size_t cores = std::min<size_t>(metrics.perCoreCpuUsage.size(), SYSMON_SHM_MAX_CORES);
+        std::copy_n(metrics.perCoreCpuUsage.begin(), cores, data.core_usage_percent);
+        data.core_count = static_cast<uint32_t>(cores);
+    });
+}
+
+void SharedMetricsSegment::publishProcesses(const std::vector<ProcessSummary>& processes) {
+    write([&](sysmon_shm_snapshot& data) {
+        ++data.process_updates;
+        size_t count = std::min<size_t>(processes.size(), SYSMON_SHM_MAX_PROCESSES);
+        for (size_t i = 0; i < count; ++i) {
+            sysmon_shm_process& slot = data.processes[i];
+            slot.pid = processes[i].pid;
+            slot.parent_pid = processes[i].parentPid;
+            slot.cpu_percent = processes[i].cpuPercent;
+            slot.memory_bytes = processes[i].memoryBytes;
+            size_t length = std::min<size_t>(processes[i].name.size(), SYSMON_SHM_PROCESS_NAME_SIZE - 1);
+            std::memcpy(slot.name, processes[i].name.data(), length);
+            slot.name[length] = '\0';
+        }
+        data.process_count = static_cast<uint32_t>(count);
+    });
+}
+
+} // namespace sysmon
@@ -2,17 +2,50 @@
 #include "SystemDataCollector.h"
 #include "ProcessTreeBuilder.h"
 #include "MonitorUI.h"
+#include "CpuBudgetGovernor.h"
+#include "HeadlessExporter.h"
+#include "Recorder.h"
+#include "MetricsHttpServer.h"
+#include "SharedMemoryPublisher.h"
+#include "ReplaySource.h"
+#include "SnapshotServer.h"
+#include "SnapshotClient.h"
+#include "FleetAgent.h"
+#include "FleetAggregator.h"
+#include "AnomalyMonitor.h"
+#include "AlertEngine.h"
+#include "Instrumentation.h"
 #include <iostream>
 #include <csignal>
+#include <cstdlib>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <thread>
 
 using namespace sysmon;
 
 // Global pointer for signal handling
 static MonitorUI* g_ui = nullptr;
 
+// Set by the signal handler in headless mode
+static volatile std::sig_atomic_t g_stopRequested = 0;
+
+// Spans kept for --trace-file (most recent wins)
+static constexpr size_t TRACE_SPAN_CAPACITY = 1 << 18;
+
+static std::string defaultConfigPath() {
+#ifdef _WIN32
+    const char* home = std::getenv("USERPROFILE");
+#else
+    const char* home = std::getenv("HOME");
+#endif
+    return home ? std::string(home) + "/.sysmonrc" : std::string();
+}
+
 void signalHandler(int signal) {
     if (signal == SIGINT || signal == SIGTERM) {
+        g_stopRequested = 1;
         if (g_ui) {
             g_ui->shutdown();
         }
@@ -20,11 +53,15 @@ void signalHandler(int signal) {
 }
 
 int main(int argc, char* argv[]) {
-    std::cout << "System Monitor v1.0.0\n";
-    std::cout << "Initializing...\n\n";
-    
-    // Load configuration
+    // Load configuration (file < environment < command line)
     Configuration config;
+    std::string configPath = defaultConfigPath();
+    std::string configError;
+    if (!configPath.empty() && !config.loadFromFile(configPath, configError) && !configError.empty()) {
+        // A missing rc file is fine; a broken one is not
+        std::cerr << configError << "\n";
+        return 1;
+    }
     config.loadFromEnvironment();
     config.loadFromArgs(argc, argv);
     
@@ -33,47 +70,312 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Headless output may go to stdout, so progress messages move to stderr
+    std::ostream& log = config.headless ? std::cerr : std::cout;
+    log << "System Monitor v1.0.0\n";
+    log << "Initializing...\n\n";
+    
+    // Self-instrumentation costs one atomic load per scope when disabled
+    if (config.debugMode || !config.traceFile.empty()) {
+        Instrumentation::instance().setEnabled(true);
+    }
+    if (!config.traceFile.empty()) {
+        Instrumentation::instance().enableSpanCapture(TRACE_SPAN_CAPACITY);
+    }
+    
     // Set up signal handlers
     std::signal(SIGINT, signalHandler);
     std::signal(SIGTERM, signalHandler);
     
     try {
+        // Replay swaps the platform collectors for the recording and paces
+        // sampling to the recorded cadence
+        std::shared_ptr<ReplaySource> replay;
+        Configuration collectorConfig = config;
+        if (!config.replayFile.empty()) {
+            replay = std::make_shared<ReplaySource>();
+            if (!replay->open(config.replayFile, config.replaySpeed)) {
+                std::cerr << "Failed to open recording " << config.replayFile << "\n";
+                return 1;
+            }
+            replay->applyIntervals(collectorConfig);
+            log << "Replaying " << config.replayFile << " at ";
+            if (config.replaySpeed == ReplaySource::MAX_SPEED) {
+                log << "max speed\n";
+            } else {
+                log << config.replaySpeed << "x\n";
+            }
+        }
+        
+        // Attaching swaps them for a running daemon's stream; the daemon's
+        // going away ends the session like Ctrl+C would
+        std::shared_ptr<SnapshotClient> attach;
+        if (!config.attachSocket.empty()) {
+            attach = std::make_shared<SnapshotClient>();
+            bool connected = attach->connect(config.attachSocket, config.attachMaxUpdateHz, [] {
+                g_stopRequested = 1;
+                if (g_ui) {
+                    g_ui->shutdown();
+                }
+            });
+            if (!connected) {
+                return 1;
+            }
+            attach->applyIntervals(collectorConfig);
+            log << "Attached to " << config.attachSocket << "\n";
+        }
+        
+        std::unique_ptr<ISystemCollector> systemSource;
+        std::unique_ptr<IProcessCollector> processSource;
+        if (replay) {
+            systemSource = createReplaySystemCollector(replay);
+            processSource = createReplayProcessCollector(replay);
+        } else if (attach) {
+            systemSource = createAttachSystemCollector(attach);
+            processSource = createAttachProcessCollector(attach);
+        } else {
+            systemSource = createSystemCollector(collectorConfig);
+            processSource = createProcessCollector(collectorConfig);
+        }
+        
+        // Sample observers are declared before the collectors so they outlive the
+        // collection threads. The fixed thresholds are alert rules like any other.
+        AlertEngine alerts;
+        {
+            std::vector<std::string> rules = {
+                "CPU: cpu > " + std::to_string(config.cpuAlertThreshold),
+                "MEMORY: memory > " + std::to_string(config.memoryAlertThreshold),
+            };
+            rules.insert(rules.end(), config.alertRules.begin(), config.alertRules.end());
+            std::string error;
+            if (!alerts.compile(rules, error)) {
+                std::cerr << "Invalid alert rule " << error << "\n";
+                return 1;
+            }
+        }
+        
+        std::unique_ptr<AnomalyMonitor> anomalies;
+        if (config.anomalyDetection) {
+            anomalies = std::make_unique<AnomalyMonitor>(config);
+        }
+        
         // Create core components
-        SystemDataCollector dataCollector(config);
-        ProcessTreeBuilder processBuilder(config);
-        MonitorUI ui(dataCollector, processBuilder, config);
+        CpuBudgetGovernor governor(collectorConfig);
+        SystemDataCollector dataCollector(collectorConfig, std::move(systemSource), &governor);
+        ProcessTreeBuilder processBuilder(collectorConfig, std::move(processSource), &governor);
+        
+        // The exporter subscribes before collection starts so no snapshot is missed
+        std::unique_ptr<HeadlessExporter> exporter;
+        if (config.headless) {
+            exporter = std::make_unique<HeadlessExporter>(dataCollector, processBuilder, config, &alerts);
+            if (!exporter->start()) {
+                return 1;
+            }
+        }
+        
+        std::unique_ptr<Recorder> recorder;
+        if (!config.recordFile.empty()) {
+            recorder = std::make_unique<Recorder>(dataCollector, processBuilder);
+            if (!recorder->start(config.recordFile)) {
+                std::cerr << "Failed to open recording " << config.recordFile << "\n";
+                return 1;
+            }
+            log << "Recording to " << config.recordFile << "\n";
+        }
+        
+        std::unique_ptr<SharedMemoryPublisher> shmPublisher;
+        if (!config.sharedMemoryName.empty()) {
+            shmPublisher = std::make_unique<SharedMemoryPublisher>(dataCollector, processBuilder);
+            if (!shmPublisher->start(config.sharedMemoryName)) {
+                return 1;
+            }
+            log << "Publishing to shared memory " << config.sharedMemoryName << "\n";
+        }
+        
+        std::unique_ptr<MetricsHttpServer> metricsServer;
+        if (!config.metricsListen.empty()) {
+            metricsServer = std::make_unique<MetricsHttpServer>(dataCollector, processBuilder, config);
+            if (!metricsServer->start()) {
+                return 1;
+            }
+            log << "Serving metrics on " << config.metricsListen << "/metrics\n";
+        }
+        
+        std::unique_ptr<SnapshotServer> daemon;
+        if (!config.daemonSocket.empty()) {
+            daemon = std::make_unique<SnapshotServer>(dataCollector, processBuilder);
+            if (!daemon->start(config.daemonSocket)) {
+                return 1;
+            }
+            log << "Serving attached clients on " << config.daemonSocket << "\n";
+        }
         
-        g_ui = &ui;
+        std::unique_ptr<FleetAgent> agent;
+        if (!config.agentTarget.empty()) {
+            agent = std::make_unique<FleetAgent>(dataCollector, processBuilder);
+            if (!agent->start(config.agentTarget, config.agentName, config.agentTopProcesses)) {
+                return 1;
+            }
+            log << "Streaming to aggregator " << config.agentTarget << " as " << agent->hostName() << "\n";
+        }
+        
+        // The fleet view shows remote hosts; local collection keeps running for
+        // the status bar and for an --agent reporting this host too
+        std::unique_ptr<FleetAggregator> fleet;
+        if (!config.fleetListen.empty()) {
+            fleet = std::make_unique<FleetAggregator>();
+            if (!fleet->start(config.fleetListen)) {
+                return 1;
+            }
+            log << "Accepting agents on " << config.fleetListen << "\n";
+        }
+        
+        // Observers must be registered before the collectors start
+        dataCollector.addObserver(&alerts);
+        if (alerts.watchesProcesses()) {
+            processBuilder.addObserver(&alerts);
+        }
+        if (anomalies) {
+            dataCollector.addObserver(anomalies.get());
+            if (config.anomalyProcesses) {
+                processBuilder.addObserver(anomalies.get());
+            }
+        }
         
         // Start data collection
-        std::cout << "Starting system data collector...\n";
+        log << "Starting system data collector...\n";
         if (!dataCollector.start()) {
             std::cerr << "Failed to start system data collector\n";
             return 1;
         }
         
-        std::cout << "Starting process tree builder...\n";
-        if (!processBuilder.start()) {
-            std::cerr << "Failed to start process tree builder\n";
-            return 1;
+        // Headless output with no consumer of process data never reads the process tree
+        bool scrapesProcesses = metricsServer && config.metricsTopProcesses > 0;
+        bool agentSendsProcesses = agent && config.agentTopProcesses > 0;
+        if ((!config.headless && !fleet) || config.exportTopProcesses > 0 || recorder || replay ||
+            scrapesProcesses || shmPublisher || daemon || agentSendsProcesses || alerts.watchesProcesses()) {
+            log << "Starting process tree builder...\n";
+            if (!processBuilder.start()) {
+                std::cerr << "Failed to start process tree builder\n";
+                return 1;
+            }
         }
         
-        // Give collectors time to gather initial data
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        
-        std::cout << "Launching UI...\n";
+        governor.start();
+        auto startTime = std::chrono::steady_clock::now();
         
-        // Run UI (blocking)
-        ui.run();
+        // An agent runs without a UI unless this host also shows the fleet
+        if (config.headless || daemon || (agent && !fleet)) {
+            // Headless replay ends with the recording
+            if (config.headless) {
+                log << "Streaming " << config.exportFormat << " (Ctrl+C to stop)...\n";
+            } else if (daemon) {
+                log << "Daemon running (Ctrl+C to stop)...\n";
+            } else {
+                log << "Agent running (Ctrl+C to stop)...\n";
+            }
+            while (!g_stopRequested && !(replay && replay->finished())) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        } else {
+            MonitorUI ui(dataCollector, processBuilder, config, &governor, fleet.get(), anomalies.get(), &alerts);
+            g_ui = &ui;
+            
+            // Give collectors time to gather initial data
+            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            
+            log << "Launching UI...\n";
+            
+            // Run UI (blocking)
+            ui.run();
+            
+            g_ui = nullptr;
+        }
         
         // Cleanup
-        std::cout << "\nShutting down...\n";
+        log << "\nShutting down...\n";
+        if (attach) {
+            // Attach collectors wait on the socket until it closes
+            if (!attach->connected()) {
+                std::cerr << "Daemon at " << config.attachSocket << " went away\n";
+            }
+            attach->close();
+        }
+        governor.stop();
         dataCollector.stop();
         processBuilder.stop();
         
-        g_ui = nullptr;
+        if (metricsServer) {
+            metricsServer->stop();
+        }
+        
+        if (shmPublisher) {
+            shmPublisher->stop();
+        }
+        
+        if (daemon) {
+            daemon->stop();
+            log << "Served " << daemon->clientsServed() << " clients: " << daemon->updatesSent()
+                << " updates (" << daemon->updatesCoalesced() << " coalesced), "
+                << daemon->bytesSent() << " bytes\n";
+        }
+        
+        if (agent) {
+            agent->stop();
+            log << "Sent " << agent->updatesSent() << " updates, " << agent->bytesSent()
+                << " bytes to " << config.agentTarget << " over " << agent->connects() << " connections\n";
+        }
+        
+        if (fleet) {
+            fleet->stop();
+            log << "Received " << fleet->framesReceived() << " frames, " << fleet->bytesReceived()
+                << " bytes from the fleet\n";
+        }
+        
+        if (alerts.alertsFired() > 0) {
+            log << alerts.alertsFired() << " alerts fired across " << alerts.ruleCount() << " rules\n";
+        }
+        
+        if (anomalies) {
+            log << "Scored " << anomalies->samplesScored() << " samples across " << anomalies->seriesCount()
+                << " series, " << anomalies->anomaliesRaised() << " anomalies raised\n";
+        }
+        
+        if (replay) {
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            log << "Replayed " << replay->metricsReplayed() << " system samples and "
+                << replay->snapshotsReplayed() << " process snapshots in " << seconds << " s ("
+                << static_cast<uint64_t>(replay->snapshotsReplayed() / seconds) << " snapshots/s)\n";
+        }
+        
+        if (recorder) {
+            recorder->stop();
+            const auto& writer = recorder->writer();
+            log << "Recorded " << writer.samplesWritten() << " samples, "
+                << writer.bytesWritten() << " bytes to " << config.recordFile << "\n";
+            if (writer.droppedSamples() > 0) {
+                std::cerr << "Dropped " << writer.droppedSamples()
+                          << " samples while the disk was behind\n";
+            }
+        }
+        
+        if (exporter) {
+            exporter->stop();
+            if (exporter->droppedSnapshots() > 0) {
+                std::cerr << "Dropped " << exporter->droppedSnapshots()
+                          << " snapshots while the output was blocked\n";
+            }
+        }
+        
+        if (!config.traceFile.empty()) {
+            if (Instrumentation::instance().writeChromeTrace(config.traceFile)) {
+                log << "Trace written to " << config.traceFile << "\n";
+            } else {
+                std::cerr << "Failed to write trace to " << config.traceFile << "\n";
+            }
+        }
         
-        std::cout << "Goodbye!\n";
+        log << "Goodbye!\n";
         
     } catch (const std::exception& e) {
         std::cerr << "Fatal error: " << e.what() << "\n";
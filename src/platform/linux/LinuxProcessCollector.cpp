@@ -1,17 +1,51 @@
 #include "IProcessCollector.h"
-#include <fstream>
-#include <sstream>
+#include "ProcfsReader.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <signal.h>
 #include <unistd.h>
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
 #include <cstring>
 
 namespace sysmon {
 
+namespace {
+    // In reduced detail, idle processes are still re-read on every Nth scan
+    constexpr uint32_t REDUCED_FULL_SCAN_EVERY = 4;
+    
+    // The cgroup dictionary is rebuilt once it holds this many times the paths a scan uses
+    constexpr size_t CGROUP_DICTIONARY_SLACK = 4;
+    constexpr size_t MIN_CGROUP_DICTIONARY_PATHS = 1024;
+    
+    // Whether @p procRoot is this host's procfs, however it is spelled ("/proc/", "//proc", a symlink)
+    bool isLiveProcfs(const std::string& procRoot) {
+        char* resolved = realpath(procRoot.c_str(), nullptr);
+        if (!resolved) {
+            return false;
+        }
+        bool live = std::strcmp(resolved, "/proc") == 0;
+        std::free(resolved);
+        return live;
+    }
+}
+
 class LinuxProcessCollector : public IProcessCollector {
 public:
-    LinuxProcessCollector() {
+    explicit LinuxProcessCollector(const Configuration& config)
+        : reader_(config.useIoUring),
+          procRoot_(config.procRoot),
+          liveProcfs_(isLiveProcfs(config.procRoot)) {
         pageSize_ = sysconf(_SC_PAGESIZE);
         clockTicks_ = sysconf(_SC_CLK_TCK);
     }
@@ -21,8 +55,7 @@ public:
     }
     
     bool initialize() override {
-        // Initialize last CPU measurement time
-        lastSampleTime_ = std::chrono::steady_clock::now();
+        bootTimeMs_ = readBootTimeMs();
         return true;
     }
     
@@ -30,129 +63,345 @@ public:
         // No cleanup needed
     }
     
-    std::vector<std::unique_ptr<ProcessInfo>> enumerateProcesses() override {
-        std::vector<std::unique_ptr<ProcessInfo>> processes;
-        
-        DIR* dir = opendir("/proc");
+    void setDetail(ProcessDetail detail) override {
+        detail_ = detail;
+    }
+    
+    void enumerateProcesses(ProcessTable& out) override {
+        DIR* dir = opendir(procRoot_.c_str());
         if (!dir) {
-            return processes;
+            return;
         }
         
+        // Reduced detail skips re-reading processes that were idle last time,
+        // with a periodic full scan so a process waking up is noticed eventually
+        bool reuseIdle = false;
+        if (detail_ == ProcessDetail::Reduced) {
+            reuseIdle = (++reducedScans_ % REDUCED_FULL_SCAN_EVERY) != 0;
+        } else {
+            reducedScans_ = 0;
+        }
+        
+        // Collect every /proc/[pid]/stat path first so they can be read as one batch
+        statPaths_.clear();
+        reusedPids_.clear();
+        cgroupFilePaths_.clear();
+        cgroupReads_.clear();
+        cgroupInTable_.assign(cgroupPaths_.size(), ProcessTable::NO_CGROUP);
         struct dirent* entry;
         while ((entry = readdir(dir)) != nullptr) {
-            // Check if directory name is a number (PID)
-            if (entry->d_type == DT_DIR) {
-                const char* name = entry->d_name;
-                if (std::isdigit(name[0])) {
-                    uint32_t pid = std::stoi(name);
-                    auto procInfo = readProcessInfo(pid);
-                    if (procInfo) {
-                        processes.push_back(std::move(procInfo));
+            // Check if directory name is a number (PID); fixture copies may sit
+            // on filesystems that don't report d_type
+            bool maybeDir = entry->d_type == DT_DIR || entry->d_type == DT_UNKNOWN;
+            if (maybeDir && std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+                if (reuseIdle) {
+                    auto pid = static_cast<uint32_t>(std::strtoul(entry->d_name, nullptr, 10));
+                    auto it = lastSamples_.find(pid);
+                    if (it != lastSamples_.end() && it->second.idle) {
+                        reusedPids_.push_back(pid);
+                        continue;
                     }
                 }
+                statPaths_.push_back(procRoot_ + "/" + entry->d_name + "/stat");
             }
         }
         
-        closedir(dir);
-        
-        // Calculate CPU percentages
         auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - lastSampleTime_);
-        double seconds = elapsed.count() / 1000.0;
-        
-        for (auto& proc : processes) {
-            auto it = lastCpuTimes_.find(proc->pid);
-            if (it != lastCpuTimes_.end()) {
-                uint64_t cpuDelta = proc->creationTime - it->second; // Reusing creationTime field temporarily
+        
+        std::unordered_map<uint32_t, ProcessSample> samples;
+        samples.reserve(statPaths_.size() + reusedPids_.size());
+        out.reserve(statPaths_.size() + reusedPids_.size());
+        
+        reader_.readBatch(statPaths_, [&](size_t, std::string_view contents) {
+            StatFields stat;
+            if (!parseStat(contents, stat)) {
+                return;
+            }
+            
+            // Calculate CPU (and block I/O wait) percentage from the tick deltas
+            // since this process was last read; a reused pid starts from zero
+            // rather than from the previous process's ticks
+            double cpuPercent = 0.0;
+            double ioWaitPercent = 0.0;
+            bool idle = false;
+            auto it = lastSamples_.find(stat.pid);
+            bool known = it != lastSamples_.end() && it->second.creationTime == stat.creationTime;
+            if (known && stat.cpuTicks >= it->second.cpuTicks) {
+                double seconds = std::chrono::duration<double>(now - it->second.sampleTime).count();
                 if (seconds > 0) {
-                    proc->cpuPercent = (cpuDelta / clockTicks_) / seconds * 100.0;
+                    double cpuSeconds = static_cast<double>(stat.cpuTicks - it->second.cpuTicks) / clockTicks_;
+                    cpuPercent = cpuSeconds / seconds * 100.0;
+                    if (stat.ioWaitTicks >= it->second.ioWaitTicks) {
+                        double waitSeconds =
+                            static_cast<double>(stat.ioWaitTicks - it->second.ioWaitTicks) / clockTicks_;
+                        ioWaitPercent = waitSeconds / seconds * 100.0;
+                    }
                 }
+                idle = stat.cpuTicks == it->second.cpuTicks;
             }
-            lastCpuTimes_[proc->pid] = proc->creationTime; // Store for next iteration
-        }
+            
+            // The owner and control group are looked up once per process rather than once per scan;
+            // a new process's cgroup file is queued for a second batch
+            uint32_t uid = known ? it->second.uid : ownerOf(dirfd(dir), stat.pid);
+            uint32_t cgroup = known ? it->second.cgroup : ProcessTable::NO_CGROUP;
+            
+            samples[stat.pid] = ProcessSample{stat.parentPid, std::string(stat.name), stat.memoryBytes,
+                                              stat.creationTime, stat.cpuTicks, stat.ioWaitTicks, now, uid,
+                                              cgroup, stat.state, idle};
+            ProcessTable::Row row = out.add(stat.pid, stat.parentPid, stat.name, cpuPercent, stat.memoryBytes,
+                                            stat.creationTime, uid, stat.state, ioWaitPercent);
+            if (known) {
+                out.setCgroup(row, tableCgroup(cgroup, out));
+            } else {
+                cgroupReads_.push_back({row, stat.pid});
+                cgroupFilePaths_.push_back(procRoot_ + "/" + std::to_string(stat.pid) + "/cgroup");
+            }
+        });
+        closedir(dir);
         
-        lastSampleTime_ = now;
+        // A process that exits before its cgroup file is read keeps NO_CGROUP
+        reader_.readBatch(cgroupFilePaths_, [&](size_t index, std::string_view contents) {
+            uint32_t cgroup = internCgroup(parseCgroup(contents));
+            samples[cgroupReads_[index].pid].cgroup = cgroup;
+            out.setCgroup(cgroupReads_[index].row, tableCgroup(cgroup, out));
+        });
         
-        return processes;
+        // Idle processes skipped above are reported from their last reading
+        for (uint32_t pid : reusedPids_) {
+            auto it = lastSamples_.find(pid);
+            const ProcessSample& sample = it->second;
+            ProcessTable::Row row = out.add(pid, sample.parentPid, sample.name, 0.0, sample.memoryBytes,
+                                            sample.creationTime, sample.uid, sample.state);
+            out.setCgroup(row, tableCgroup(sample.cgroup, out));
+            samples.emplace(pid, std::move(it->second));
+        }
+        
+        // Replacing the map also drops entries for processes that have exited
+        lastSamples_ = std::move(samples);
+        pruneCgroups(out);
     }
     
     bool terminateProcess(uint32_t pid) override {
+        // pids read from a fixture don't belong to this host
+        if (!liveProcfs_) {
+            return false;
+        }
         // Send SIGTERM for graceful termination
         return kill(pid, SIGTERM) == 0;
     }
     
 private:
-    std::unique_ptr<ProcessInfo> readProcessInfo(uint32_t pid) {
-        // Read /proc/[pid]/stat
-        std::string statPath = "/proc/" + std::to_string(pid) + "/stat";
-        std::ifstream statFile(statPath);
-        
-        if (!statFile.is_open()) {
-            return nullptr;
-        }
-        
-        auto procInfo = std::make_unique<ProcessInfo>();
-        procInfo->pid = pid;
-        
-        std::string line;
-        std::getline(statFile, line);
-        
-        // Parse stat file (format is complex due to process name containing spaces/parens)
+    // Fields of one /proc/[pid]/stat line; name points into the line
+    struct StatFields {
+        uint32_t pid{0};
+        uint32_t parentPid{0};
+        std::string_view name;
+        uint64_t memoryBytes{0};
+        uint64_t creationTime{0};
+        uint64_t cpuTicks{0};
+        uint64_t ioWaitTicks{0};
+        char state{ProcessTable::UNKNOWN_STATE};
+    };
+    
+    bool parseStat(std::string_view line, StatFields& stat) const {
+        // Format is complex due to process name containing spaces/parens:
+        // "pid (comm) state ppid ..." - comm ends at the last ')'
         size_t commStart = line.find('(');
         size_t commEnd = line.rfind(')');
         
-        if (commStart == std::string::npos || commEnd == std::string::npos) {
-            return nullptr;
+        if (commStart == std::string_view::npos || commEnd == std::string_view::npos ||
+            commEnd < commStart) {
+            return false;
         }
         
-        // Extract process name
-        procInfo->name = line.substr(commStart + 1, commEnd - commStart - 1);
-        
-        // Parse remaining fields
-        std::istringstream iss(line.substr(commEnd + 2));
-        char state;
-        uint64_t utime, stime;
-        long cutime, cstime, priority, nice, numThreads, itrealvalue;
-        unsigned long long starttime;
-        unsigned long vsize;
-        long rss;
+        size_t pos = 0;
+        stat.pid = static_cast<uint32_t>(procfs::parseU64(line, pos));
         
-        iss >> state >> procInfo->parentPid >> /* pgrp */ >> /* session */ >> /* tty_nr */
-            >> /* tpgid */ >> /* flags */ >> /* minflt */ >> /* cminflt */
-            >> /* majflt */ >> /* cmajflt */ >> utime >> stime >> cutime >> cstime
-            >> priority >> nice >> numThreads >> itrealvalue >> starttime;
+        // Extract process name
+        stat.name = line.substr(commStart + 1, commEnd - commStart - 1);
         
-        iss >> vsize >> rss;
+        // Fields after comm (1-based numbering from proc(5)):
+        // 3 state, 4 ppid, 5-13 skipped, 14 utime, 15 stime, 16-21 skipped,
+        // 22 starttime, 23 vsize, 24 rss, 25-41 skipped, 42 delayacct_blkio_ticks
+        // (0 unless the kernel has delay accounting on)
+        pos = commEnd + 2;
+        std::string_view state = procfs::nextToken(line, pos);
+        if (!state.empty()) {
+            stat.state = state[0];
+        }
+        stat.parentPid = static_cast<uint32_t>(procfs::parseU64(line, pos));
+        for (int field = 5; field <= 13; ++field) {
+            procfs::nextToken(line, pos);
+        }
+        uint64_t utime = procfs::parseU64(line, pos);
+        uint64_t stime = procfs::parseU64(line, pos);
+        for (int field = 16; field <= 21; ++field) {
+            procfs::nextToken(line, pos);
+        }
+        uint64_t starttime = procfs::parseU64(line, pos);
+        procfs::parseU64(line, pos);                        // vsize
+        uint64_t rss = procfs::parseU64(line, pos);
+        for (int field = 25; field <= 41; ++field) {
+            procfs::nextToken(line, pos);
+        }
+        stat.ioWaitTicks = procfs::parseU64(line, pos);
         
         // Calculate memory usage (RSS in pages)
-        procInfo->memoryBytes = rss * pageSize_;
+        stat.memoryBytes = rss * static_cast<uint64_t>(pageSize_);
         
-        // Store total CPU time for delta calculation
-        procInfo->creationTime = utime + stime; // Temporary storage
+        // starttime is in clock ticks since boot; convert to epoch milliseconds
+        stat.creationTime = bootTimeMs_ + starttime * 1000 / static_cast<uint64_t>(clockTicks_);
         
-        // Read actual creation time from /proc/[pid]/stat starttime field
-        // This is in clock ticks since boot
-        std::ifstream uptimeFile("/proc/uptime");
-        if (uptimeFile.is_open()) {
-            double uptime;
-            uptimeFile >> uptime;
-            // Convert starttime to absolute time
-            procInfo->creationTime = static_cast<uint64_t>(
-                (uptime - starttime / clockTicks_) * 1000);
+        stat.cpuTicks = utime + stime;
+        return true;
+    }
+    
+    uint64_t readBootTimeMs() {
+        std::string_view contents;
+        if (!reader_.readFile(procRoot_ + "/stat", contents)) {
+            return 0;
         }
         
-        return procInfo;
+        size_t pos = 0;
+        std::string_view line;
+        while (procfs::nextLine(contents, pos, line)) {
+            if (line.substr(0, 6) == "btime ") {
+                size_t fieldPos = 6;
+                return procfs::parseU64(line, fieldPos) * 1000;
+            }
+        }
+        return 0;
+    }
+    
+    // Last reading of a process; enough to report it again without re-reading
+    struct ProcessSample {
+        uint32_t parentPid{0};
+        std::string name;
+        uint64_t memoryBytes{0};
+        uint64_t creationTime{0};
+        uint64_t cpuTicks{0};
+        uint64_t ioWaitTicks{0};
+        std::chrono::steady_clock::time_point sampleTime;
+        uint32_t uid{ProcessTable::UNKNOWN_UID};
+        uint32_t cgroup{ProcessTable::NO_CGROUP};   // Id in cgroupIds_
+        char state{ProcessTable::UNKNOWN_STATE};
+        bool idle{false};
+    };
+    
+    // A new process whose cgroup file is in the second batch
+    struct CgroupRead {
+        ProcessTable::Row row;
+        uint32_t pid;
+    };
+    
+    struct PathHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view path) const { return std::hash<std::string_view>()(path); }
+    };
+    
+    // Owner of /proc/[pid], i.e. the process's effective uid
+    static uint32_t ownerOf(int procFd, uint32_t pid) {
+        char name[16];
+        auto result = std::to_chars(name, name + sizeof(name) - 1, pid);
+        *result.ptr = '\0';
+        struct stat info;
+        if (fstatat(procFd, name, &info, 0) != 0) {
+            return ProcessTable::UNKNOWN_UID;
+        }
+        return static_cast<uint32_t>(info.st_uid);
+    }
+    
+    // Control group in /proc/[pid]/cgroup @p contents: the unified hierarchy's
+    // path ("0::/..."), else the first listed hierarchy's; empty if there is none
+    static std::string_view parseCgroup(std::string_view contents) {
+        // Lines are "hierarchy-id:controllers:path"
+        std::string_view first;
+        size_t pos = 0;
+        std::string_view line;
+        while (procfs::nextLine(contents, pos, line)) {
+            size_t controllers = line.find(':');
+            size_t path = controllers == std::string_view::npos ? controllers : line.find(':', controllers + 1);
+            if (path == std::string_view::npos) {
+                continue;
+            }
+            if (line.substr(0, 3) == "0::") {
+                return line.substr(path + 1);
+            }
+            if (first.empty()) {
+                first = line.substr(path + 1);
+            }
+        }
+        return first;
+    }
+    
+    uint32_t internCgroup(std::string_view path) {
+        if (path.empty()) {
+            return ProcessTable::NO_CGROUP;
+        }
+        auto it = cgroupIds_.find(path);
+        if (it == cgroupIds_.end()) {
+            it = cgroupIds_.emplace(std::string(path), static_cast<uint32_t>(cgroupPaths_.size())).first;
+            cgroupPaths_.push_back(&it->first);
+            cgroupInTable_.push_back(ProcessTable::NO_CGROUP);
+        }
+        return it->second;
+    }
+    
+    // Table id of an interned cgroup, adding its path to @p out on first use this scan
+    uint32_t tableCgroup(uint32_t cgroup, ProcessTable& out) {
+        if (cgroup == ProcessTable::NO_CGROUP) {
+            return cgroup;
+        }
+        uint32_t& inTable = cgroupInTable_[cgroup];
+        if (inTable == ProcessTable::NO_CGROUP) {
+            inTable = out.addCgroup(*cgroupPaths_[cgroup]);
+        }
+        return inTable;
     }
     
+    // Paths of exited containers stay interned; once they dominate, re-intern
+    // just the ones @p table uses, numbered as in the table
+    void pruneCgroups(const ProcessTable& table) {
+        if (cgroupPaths_.size() <= std::max(CGROUP_DICTIONARY_SLACK * table.cgroupCount(),
+                                            MIN_CGROUP_DICTIONARY_PATHS)) {
+            return;
+        }
+        for (auto& [pid, sample] : lastSamples_) {
+            if (sample.cgroup != ProcessTable::NO_CGROUP) {
+                sample.cgroup = cgroupInTable_[sample.cgroup];
+            }
+        }
+        cgroupIds_.clear();
+        cgroupPaths_.clear();
+        for (uint32_t cgroup = 0; cgroup < table.cgroupCount(); ++cgroup) {
+            auto it = cgroupIds_.emplace(std::string(table.cgroupPath(cgroup)), cgroup).first;
+            cgroupPaths_.push_back(&it->first);
+        }
+    }
+    
+    ProcfsReader reader_;
+    std::string procRoot_;
+    bool liveProcfs_{true};
+    std::vector<std::string> statPaths_;
+    std::vector<uint32_t> reusedPids_;
+    std::vector<std::string> cgroupFilePaths_;
+    std::vector<CgroupRead> cgroupReads_;           // Parallel to cgroupFilePaths_
+    
     long pageSize_{0};
     long clockTicks_{0};
-    std::chrono::steady_clock::time_point lastSampleTime_;
-    std::unordered_map<uint32_t, uint64_t> lastCpuTimes_;
+    uint64_t bootTimeMs_{0};
+    std::unordered_map<uint32_t, ProcessSample> lastSamples_;
+    ProcessDetail detail_{ProcessDetail::Full};
+    uint32_t reducedScans_{0};
+    
+    // Control group paths interned across scans; ProcessSample::cgroup is an id here
+    std::unordered_map<std::string, uint32_t, PathHash, std::equal_to<>> cgroupIds_;
+    std::vector<const std::string*> cgroupPaths_;   // Id -> path (map keys don't move)
+    std::vector<uint32_t> cgroupInTable_;           // Id -> id in the table being filled (NO_CGROUP = not yet)
 };
 
-std::unique_ptr<IProcessCollector> createProcessCollector() {
-    return std::make_unique<LinuxProcessCollector>();
+std::unique_ptr<IProcessCollector> createProcessCollector(const Configuration& config) {
+    return std::make_unique<LinuxProcessCollector>(config);
 }
 
 } // namespace sysmon
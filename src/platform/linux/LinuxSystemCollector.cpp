@@ -1,8 +1,11 @@
 #include "ISystemCollector.h"
-#include <fstream>
-#include <sstream>
+#include "ProcfsReader.h"
+#include <algorithm>
+#include <chrono>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <dirent.h>
 #include <unistd.h>
 #include <sys/sysinfo.h>
 
@@ -10,23 +13,38 @@ namespace sysmon {
 
 class LinuxSystemCollector : public ISystemCollector {
 public:
-    LinuxSystemCollector() = default;
+    explicit LinuxSystemCollector(const Configuration& config)
+        : reader_(config.useIoUring),
+          procStat_(config.procRoot + "/stat"),
+          procMeminfo_(config.procRoot + "/meminfo"),
+          procDiskstats_(config.procRoot + "/diskstats"),
+          procNetDev_(config.procRoot + "/net/dev"),
+          sysBlock_(config.sysRoot + "/block") {
+    }
+    
     ~LinuxSystemCollector() override {
         shutdown();
     }
     
     bool initialize() override {
-        // Get number of CPU cores
-        numCores_ = sysconf(_SC_NPROCESSORS_ONLN);
+        haveWholeDisks_ = readWholeDisks();
         
-        // Read initial CPU stats
-        readCpuStats(lastTotalTime_, lastIdleTime_, lastCoreStats_);
-        
-        // Read initial network stats
-        readNetworkStats(lastNetworkRecv_, lastNetworkSent_);
+        // Read initial CPU, disk and network baselines in a single batch
+        const std::vector<std::string> baselineFiles = {procStat_, procDiskstats_, procNetDev_};
+        reader_.readBatch(baselineFiles, [this](size_t index, std::string_view contents) {
+            switch (index) {
+                case 0: parseCpuStats(contents, lastTotalTime_, lastIdleTime_, lastCoreStats_); break;
+                case 1:
+                    diskNamesChanged(contents);
+                    parseDiskStats(contents, lastDiskRead_, lastDiskWrite_, devices_, wholeDisksOrNull());
+                    break;
+                case 2: parseNetworkStats(contents, lastNetworkRecv_, lastNetworkSent_, devices_); break;
+            }
+        });
         
-        // Read initial disk stats
-        readDiskStats(lastDiskRead_, lastDiskWrite_);
+        // The cpuN lines describe the procfs being read, which may not be this host's
+        numCores_ = !lastCoreStats_.empty() ? lastCoreStats_.size()
+                                            : static_cast<size_t>(sysconf(_SC_NPROCESSORS_ONLN));
         
         return true;
     }
@@ -36,62 +54,66 @@ public:
     }
     
     void collectCPUMetrics(SystemMetrics& metrics) override {
-        uint64_t totalTime, idleTime;
-        std::vector<std::pair<uint64_t, uint64_t>> coreStats;
+        std::string_view contents;
+        if (!reader_.readFile(procStat_, contents)) {
+            return;
+        }
         
-        readCpuStats(totalTime, idleTime, coreStats);
+        uint64_t totalTime = 0, idleTime = 0;
+        parseCpuStats(contents, totalTime, idleTime, coreStats_);
         
         // Calculate overall CPU usage
         uint64_t totalDelta = totalTime - lastTotalTime_;
         uint64_t idleDelta = idleTime - lastIdleTime_;
         
         if (totalDelta > 0) {
-            metrics.cpuUsagePercent = 100.0 * (1.0 - static_cast<double>(idleDelta) / 
+            metrics.cpuUsagePercent = 100.0 * (1.0 - static_cast<double>(idleDelta) /
                                                static_cast<double>(totalDelta));
         }
         
-        // Calculate per-core CPU usage
+        // Calculate per-core CPU usage and the share a hypervisor stole from each core
         metrics.perCoreCpuUsage.resize(numCores_);
-        for (size_t i = 0; i < coreStats.size() && i < numCores_; ++i) {
-            uint64_t coreTotalDelta = coreStats[i].first - lastCoreStats_[i].first;
-            uint64_t coreIdleDelta = coreStats[i].second - lastCoreStats_[i].second;
+        metrics.perCoreStealPercent.resize(numCores_);
+        for (size_t i = 0; i < coreStats_.size() && i < numCores_ && i < lastCoreStats_.size(); ++i) {
+            uint64_t coreTotalDelta = coreStats_[i].total - lastCoreStats_[i].total;
+            uint64_t coreIdleDelta = coreStats_[i].idle - lastCoreStats_[i].idle;
+            uint64_t coreStealDelta = coreStats_[i].steal - lastCoreStats_[i].steal;
             
             if (coreTotalDelta > 0) {
-                metrics.perCoreCpuUsage[i] = 100.0 * (1.0 - static_cast<double>(coreIdleDelta) / 
+                metrics.perCoreCpuUsage[i] = 100.0 * (1.0 - static_cast<double>(coreIdleDelta) /
                                                        static_cast<double>(coreTotalDelta));
+                metrics.perCoreStealPercent[i] = 100.0 * static_cast<double>(coreStealDelta) /
+                                                 static_cast<double>(coreTotalDelta);
             }
         }
         
         lastTotalTime_ = totalTime;
         lastIdleTime_ = idleTime;
-        lastCoreStats_ = coreStats;
+        lastCoreStats_.swap(coreStats_);
     }
     
     void collectMemoryMetrics(SystemMetrics& metrics) override {
-        std::ifstream meminfo("/proc/meminfo");
-        if (!meminfo.is_open()) {
+        std::string_view contents;
+        if (!reader_.readFile(procMeminfo_, contents)) {
             return;
         }
         
-        std::string line;
         uint64_t memTotal = 0, memFree = 0, memAvailable = 0, buffers = 0, cached = 0;
         
-        while (std::getline(meminfo, line)) {
-            std::istringstream iss(line);
-            std::string key;
-            uint64_t value;
-            std::string unit;
+        size_t pos = 0;
+        std::string_view line;
+        while (procfs::nextLine(contents, pos, line)) {
+            size_t fieldPos = 0;
+            std::string_view key = procfs::nextToken(line, fieldPos);
             
-            if (iss >> key >> value >> unit) {
-                // Convert from kB to bytes
-                value *= 1024;
-                
-                if (key == "MemTotal:") memTotal = value;
-                else if (key == "MemFree:") memFree = value;
-                else if (key == "MemAvailable:") memAvailable = value;
-                else if (key == "Buffers:") buffers = value;
-                else if (key == "Cached:") cached = value;
-            }
+            // Convert from kB to bytes
+            uint64_t value = procfs::parseU64(line, fieldPos) * 1024;
+            
+            if (key == "MemTotal:") memTotal = value;
+            else if (key == "MemFree:") memFree = value;
+            else if (key == "MemAvailable:") memAvailable = value;
+            else if (key == "Buffers:") buffers = value;
+            else if (key == "Cached:") cached = value;
         }
         
         metrics.totalMemoryBytes = memTotal;
@@ -100,14 +122,24 @@ public:
         metrics.usedMemoryBytes = memTotal - availableMemory;
         
         if (memTotal > 0) {
-            metrics.memoryUsagePercent = 100.0 * static_cast<double>(metrics.usedMemoryBytes) / 
+            metrics.memoryUsagePercent = 100.0 * static_cast<double>(metrics.usedMemoryBytes) /
                                         static_cast<double>(memTotal);
         }
     }
     
     void collectDiskMetrics(SystemMetrics& metrics) override {
-        uint64_t diskRead, diskWrite;
-        readDiskStats(diskRead, diskWrite);
+        std::string_view contents;
+        if (!reader_.readFile(procDiskstats_, contents)) {
+            return;
+        }
+        
+        // Re-listed only when a disk comes or goes, so hot-plugged disks are still counted
+        if (haveWholeDisks_ && diskNamesChanged(contents)) {
+            haveWholeDisks_ = readWholeDisks();
+        }
+        
+        uint64_t diskRead = 0, diskWrite = 0;
+        parseDiskStats(contents, diskRead, diskWrite, metrics.diskDevices, wholeDisksOrNull());
         
         // Calculate rates (bytes per second)
         auto now = std::chrono::steady_clock::now();
@@ -127,8 +159,13 @@ public:
     }
     
     void collectNetworkMetrics(SystemMetrics& metrics) override {
-        uint64_t netRecv, netSent;
-        readNetworkStats(netRecv, netSent);
+        std::string_view contents;
+        if (!reader_.readFile(procNetDev_, contents)) {
+            return;
+        }
+        
+        uint64_t netRecv = 0, netSent = 0;
+        parseNetworkStats(contents, netRecv, netSent, metrics.networkInterfaces);
         
         // Calculate rates (bytes per second)
         auto now = std::chrono::steady_clock::now();
@@ -148,108 +185,218 @@ public:
     }
     
 private:
-    void readCpuStats(uint64_t& totalTime, uint64_t& idleTime, 
-                      std::vector<std::pair<uint64_t, uint64_t>>& coreStats) {
-        std::ifstream stat("/proc/stat");
-        if (!stat.is_open()) {
-            return;
+    /** @brief Cumulative jiffies of one cpuN line */
+    struct CoreTimes {
+        uint64_t total{0};
+        uint64_t idle{0};                       // idle + iowait
+        uint64_t steal{0};
+    };
+    
+    /**
+     * @brief List <sysfs>/block, whose entries are whole disks (partitions live below them)
+     *
+     * Devices stacked on other disks (dm-*, md*) are left out: their I/O is
+     * already counted on the disks listed in their slaves directory.
+     *
+     * @return false if it can't be read, e.g. in a container without sysfs
+     */
+    bool readWholeDisks() {
+        wholeDisks_.clear();
+        DIR* dir = opendir(sysBlock_.c_str());
+        if (!dir) {
+            return false;
         }
-        
-        std::string line;
-        coreStats.clear();
-        
-        while (std::getline(stat, line)) {
-            if (line.substr(0, 3) == "cpu") {
-                std::istringstream iss(line);
-                std::string cpu;
-                uint64_t user, nice, system, idle, iowait, irq, softirq, steal;
-                
-                iss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
-                
-                uint64_t total = user + nice + system + idle + iowait + irq + softirq + steal;
-                
-                if (cpu == "cpu") {
-                    // Overall CPU
-                    totalTime = total;
-                    idleTime = idle + iowait;
-                } else {
-                    // Per-core CPU
-                    coreStats.push_back({total, idle + iowait});
-                }
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (entry->d_name[0] == '.' || hasSlaves(sysBlock_ + "/" + entry->d_name + "/slaves")) {
+                continue;
             }
+            // sysfs spells a '/' in a device name ("cciss/c0d0") as '!'
+            std::string name = entry->d_name;
+            std::replace(name.begin(), name.end(), '!', '/');
+            wholeDisks_.push_back(std::move(name));
         }
+        closedir(dir);
+        return true;
     }
     
-    void readNetworkStats(uint64_t& recvBytes, uint64_t& sentBytes) {
-        std::ifstream netdev("/proc/net/dev");
-        if (!netdev.is_open()) {
-            return;
+    static bool hasSlaves(const std::string& slavesDir) {
+        DIR* dir = opendir(slavesDir.c_str());
+        if (!dir) {
+            return false;
         }
+        bool found = false;
+        struct dirent* entry;
+        while (!found && (entry = readdir(dir)) != nullptr) {
+            found = entry->d_name[0] != '.';
+        }
+        closedir(dir);
+        return found;
+    }
+    
+    /**
+     * @brief Compare the device names in @p contents (diskstats) with the last ones seen
+     * @return true, after remembering the new names, if any was added, removed or renamed
+     */
+    bool diskNamesChanged(std::string_view contents) {
+        size_t count = 0;
+        bool changed = false;
+        size_t pos = 0;
+        std::string_view line;
+        while (procfs::nextLine(contents, pos, line)) {
+            size_t fieldPos = 0;
+            procfs::parseU64(line, fieldPos);                       // major
+            procfs::parseU64(line, fieldPos);                       // minor
+            std::string_view device = procfs::nextToken(line, fieldPos);
+            if (count == diskNames_.size()) {
+                diskNames_.emplace_back(device);
+                changed = true;
+            } else if (diskNames_[count] != device) {
+                diskNames_[count].assign(device);
+                changed = true;
+            }
+            ++count;
+        }
+        if (count != diskNames_.size()) {
+            diskNames_.resize(count);
+            changed = true;
+        }
+        return changed;
+    }
+    
+    const std::vector<std::string>* wholeDisksOrNull() const {
+        return haveWholeDisks_ ? &wholeDisks_ : nullptr;
+    }
+    
+    static void parseCpuStats(std::string_view contents, uint64_t& totalTime, uint64_t& idleTime,
+                              std::vector<CoreTimes>& coreStats) {
+        coreStats.clear();
         
+        size_t pos = 0;
+        std::string_view line;
+        while (procfs::nextLine(contents, pos, line)) {
+            if (line.substr(0, 3) != "cpu") {
+                // cpu lines are always first; stop before the long intr/softirq lines
+                break;
+            }
+            
+            size_t fieldPos = 0;
+            std::string_view cpu = procfs::nextToken(line, fieldPos);
+            uint64_t user = procfs::parseU64(line, fieldPos);
+            uint64_t nice = procfs::parseU64(line, fieldPos);
+            uint64_t system = procfs::parseU64(line, fieldPos);
+            uint64_t idle = procfs::parseU64(line, fieldPos);
+            uint64_t iowait = procfs::parseU64(line, fieldPos);
+            uint64_t irq = procfs::parseU64(line, fieldPos);
+            uint64_t softirq = procfs::parseU64(line, fieldPos);
+            uint64_t steal = procfs::parseU64(line, fieldPos);
+            
+            uint64_t total = user + nice + system + idle + iowait + irq + softirq + steal;
+            
+            if (cpu == "cpu") {
+                // Overall CPU
+                totalTime = total;
+                idleTime = idle + iowait;
+            } else {
+                // Per-core CPU
+                coreStats.push_back({total, idle + iowait, steal});
+            }
+        }
+    }
+    
+    static void parseNetworkStats(std::string_view contents, uint64_t& recvBytes, uint64_t& sentBytes,
+                                  std::vector<DeviceCounters>& interfaces) {
         recvBytes = 0;
         sentBytes = 0;
+        interfaces.clear();
         
-        std::string line;
+        size_t pos = 0;
+        std::string_view line;
         // Skip header lines
-        std::getline(netdev, line);
-        std::getline(netdev, line);
+        procfs::nextLine(contents, pos, line);
+        procfs::nextLine(contents, pos, line);
         
-        while (std::getline(netdev, line)) {
-            // Skip loopback interface
-            if (line.find("lo:") != std::string::npos) {
+        while (procfs::nextLine(contents, pos, line)) {
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos) {
                 continue;
             }
             
-            std::istringstream iss(line);
-            std::string iface;
-            uint64_t recv, sent;
-            uint64_t dummy;
+            // Skip loopback interface
+            size_t nameStart = line.find_first_not_of(' ');
+            std::string_view name = line.substr(nameStart, colon - nameStart);
+            if (name == "lo") {
+                continue;
+            }
             
-            iss >> iface >> recv;
+            size_t fieldPos = colon + 1;
+            uint64_t recv = procfs::parseU64(line, fieldPos);
             // Skip 7 more fields to get to transmit bytes
-            for (int i = 0; i < 7; ++i) iss >> dummy;
-            iss >> sent;
+            for (int i = 0; i < 7; ++i) procfs::parseU64(line, fieldPos);
+            uint64_t sent = procfs::parseU64(line, fieldPos);
             
             recvBytes += recv;
             sentBytes += sent;
+            interfaces.push_back({std::string(name), recv, sent});
         }
     }
     
-    void readDiskStats(uint64_t& readBytes, uint64_t& writeBytes) {
-        std::ifstream diskstats("/proc/diskstats");
-        if (!diskstats.is_open()) {
-            return;
-        }
-        
+    // Without a whole-disk list, every device but loop and ram ones is counted,
+    // which counts partitions and stacked devices twice
+    static void parseDiskStats(std::string_view contents, uint64_t& readBytes, uint64_t& writeBytes,
+                               std::vector<DeviceCounters>& devices,
+                               const std::vector<std::string>* wholeDisks) {
         readBytes = 0;
         writeBytes = 0;
+        devices.clear();
         
-        std::string line;
-        while (std::getline(diskstats, line)) {
-            std::istringstream iss(line);
-            uint64_t major, minor;
-            std::string device;
-            uint64_t reads, readsMerged, sectorsRead, readTime;
-            uint64_t writes, writesMerged, sectorsWritten, writeTime;
+        size_t pos = 0;
+        std::string_view line;
+        while (procfs::nextLine(contents, pos, line)) {
+            size_t fieldPos = 0;
+            procfs::parseU64(line, fieldPos);                       // major
+            procfs::parseU64(line, fieldPos);                       // minor
+            std::string_view device = procfs::nextToken(line, fieldPos);
+            procfs::parseU64(line, fieldPos);                       // reads
+            procfs::parseU64(line, fieldPos);                       // reads merged
+            uint64_t sectorsRead = procfs::parseU64(line, fieldPos);
+            procfs::parseU64(line, fieldPos);                       // read time
+            procfs::parseU64(line, fieldPos);                       // writes
+            procfs::parseU64(line, fieldPos);                       // writes merged
+            uint64_t sectorsWritten = procfs::parseU64(line, fieldPos);
             
-            iss >> major >> minor >> device >> reads >> readsMerged >> sectorsRead >> readTime
-                >> writes >> writesMerged >> sectorsWritten >> writeTime;
-            
-            // Only count physical disks (sd*, nvme*, vd*)
-            if (device.find("loop") == std::string::npos &&
-                device.find("ram") == std::string::npos) {
+            // Count whole disks (those listed in <sysfs>/block, see readWholeDisks) except loop and ram devices
+            bool wholeDisk = !wholeDisks ||
+                std::find(wholeDisks->begin(), wholeDisks->end(), device) != wholeDisks->end();
+            if (wholeDisk && device.find("loop") == std::string_view::npos &&
+                device.find("ram") == std::string_view::npos) {
                 // Sector size is typically 512 bytes
                 readBytes += sectorsRead * 512;
                 writeBytes += sectorsWritten * 512;
+                devices.push_back({std::string(device), sectorsRead * 512, sectorsWritten * 512});
             }
         }
     }
     
+    ProcfsReader reader_;
+    std::string procStat_;
+    std::string procMeminfo_;
+    std::string procDiskstats_;
+    std::string procNetDev_;
+    std::string sysBlock_;
     size_t numCores_{0};
     
+    std::vector<std::string> wholeDisks_;
+    bool haveWholeDisks_{false};
+    std::vector<std::string> diskNames_;        // Devices in diskstats when wholeDisks_ was listed
+    
     uint64_t lastTotalTime_{0};
     uint64_t lastIdleTime_{0};
-    std::vector<std::pair<uint64_t, uint64_t>> lastCoreStats_;
+    std::vector<CoreTimes> coreStats_;
+    std::vector<CoreTimes> lastCoreStats_;
+    
+    // Discarded per-device counters from the initial baseline read
+    std::vector<DeviceCounters> devices_;
     
     uint64_t lastNetworkRecv_{0};
     uint64_t lastNetworkSent_{0};
@@ -260,8 +407,8 @@ private:
     std::chrono::steady_clock::time_point lastDiskTime_;
 };
 
-std::unique_ptr<ISystemCollector> createSystemCollector() {
-    return std::make_unique<LinuxSystemCollector>();
+std::unique_ptr<ISystemCollector> createSystemCollector(const Configuration& config) {
+    return std::make_unique<LinuxSystemCollector>(config);
 }
 
 } // namespace sysmon
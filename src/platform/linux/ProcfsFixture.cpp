@@ -0,0 +1,547 @@
+#include "ProcfsFixture.h"
+#include "ProcfsReader.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sysmon {
+
+namespace procfs {
+
+namespace {
+    // The system-wide files the Linux collectors read, relative to the proc root
+    const char* const SYSTEM_FILES[] = {"stat", "meminfo", "diskstats", "net/dev"};
+    
+    constexpr uint64_t UPTIME_SECONDS = 30ull * 24 * 3600;
+    constexpr uint64_t PAGE_KB = 4;
+    
+    const char* const HUB_NAMES[] = {
+        "containerd-shim", "sshd", "tmux: server", "supervisord", "gunicorn", "php-fpm"
+    };
+    const char* const USER_NAMES[] = {
+        "bash", "python3", "java", "postgres", "nginx", "node", "sleep", "sh",
+        "ruby", "redis-server", "Web Content", "cc1plus"
+    };
+    
+    // Units that non-hub processes started by pid 1 run in
+    const char* const SERVICE_NAMES[] = {
+        "cron", "dbus", "systemd-journald", "systemd-logind", "systemd-udevd", "rsyslog", "nginx",
+        "postgresql@16-main", "redis-server", "docker", "snapd", "polkit", "chrony", "prometheus-node-exporter"
+    };
+    
+    // Containers per pod under one containerd-shim, and login sessions per sshd, at most
+    constexpr uint32_t CONTAINERS_PER_POD = 4;
+    constexpr uint32_t SESSIONS_PER_SSHD = 2;
+    
+    // Owners of login sessions: user-1000.slice and up
+    constexpr uint32_t FIRST_LOGIN_UID = 1000;
+    constexpr uint32_t LOGIN_USERS = 24;
+    
+    // Whole disks first, then their partitions; every name under sys/block is a whole disk
+    struct SyntheticDisk {
+        unsigned major;
+        unsigned minor;
+        const char* name;
+        bool whole;
+    };
+    const SyntheticDisk DISKS[] = {
+        {259, 0, "nvme0n1", true}, {259, 1, "nvme0n1p1", false}, {259, 2, "nvme0n1p2", false},
+        {8, 0, "sda", true}, {8, 1, "sda1", false},
+        {7, 0, "loop0", true}, {253, 0, "dm-0", true},
+    };
+    
+    struct SyntheticProcess {
+        uint32_t pid;
+        uint32_t parentPid;
+        char state;
+        bool kernel;
+        uint32_t threads;
+        uint64_t utime;
+        uint64_t stime;
+        uint64_t starttime;
+        uint64_t rssPages;
+        std::string name;
+        std::string cgroup;         // Unified hierarchy path, filled in by assignCgroups()
+    };
+    
+    std::string systemError(const std::string& what, const std::string& path) {
+        return what + " " + path + ": " + std::strerror(errno);
+    }
+    
+    bool makeDir(const std::string& path, std::string& error) {
+        if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            error = systemError("Cannot create", path);
+            return false;
+        }
+        return true;
+    }
+    
+    bool writeFile(const std::string& path, std::string_view contents, FixtureSummary& summary, std::string& error) {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            error = systemError("Cannot create", path);
+            return false;
+        }
+        size_t written = 0;
+        while (written < contents.size()) {
+            ssize_t count = write(fd, contents.data() + written, contents.size() - written);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                error = systemError("Cannot write", path);
+                close(fd);
+                return false;
+            }
+            written += static_cast<size_t>(count);
+        }
+        close(fd);
+        ++summary.files;
+        summary.bytes += contents.size();
+        return true;
+    }
+    
+    std::vector<std::string> listDirectory(const std::string& path, bool pidsOnly) {
+        std::vector<std::string> names;
+        DIR* dir = opendir(path.c_str());
+        if (!dir) {
+            return names;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            if (entry->d_name[0] == '.') {
+                continue;
+            }
+            if (pidsOnly && !std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) {
+                continue;
+            }
+            names.emplace_back(entry->d_name);
+        }
+        closedir(dir);
+        return names;
+    }
+    
+    // A fixture never merges into an older one: stale pid directories would survive
+    bool prepareOutDir(const std::string& outDir, std::string& error) {
+        if (!makeDir(outDir, error)) {
+            return false;
+        }
+        if (!listDirectory(outDir, false).empty()) {
+            error = outDir + " is not empty";
+            return false;
+        }
+        return makeDir(outDir + "/proc", error) && makeDir(outDir + "/proc/net", error) &&
+               makeDir(outDir + "/sys", error) && makeDir(outDir + "/sys/block", error);
+    }
+    
+    void appendf(std::string& out, const char* format, ...) __attribute__((format(printf, 2, 3)));
+    
+    void appendf(std::string& out, const char* format, ...) {
+        char line[512];
+        va_list args;
+        va_start(args, format);
+        int length = std::vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        if (length > 0) {
+            out.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+        }
+    }
+    
+    using ull = unsigned long long;
+    
+    std::vector<SyntheticProcess> synthesizeProcesses(const FixtureShape& shape, uint64_t clockTicks, std::mt19937& rng) {
+        size_t total = std::max<size_t>(shape.processes, 2);
+        size_t cores = std::max<size_t>(shape.cores, 1);
+        size_t kernelThreads = std::min(total - 2, std::max(cores * 4, total / 20));
+        size_t userProcesses = total - 2 - kernelThreads;
+        size_t hubs = userProcesses > 0 ? std::max<size_t>(1, userProcesses / 200) : 0;
+        uint64_t uptimeTicks = UPTIME_SECONDS * clockTicks;
+        
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        std::lognormal_distribution<double> cpuTicks(3.0, 2.5);
+        std::lognormal_distribution<double> rssPages(6.0, 1.5);
+        std::geometric_distribution<uint32_t> extraThreads(0.3);
+        
+        std::vector<SyntheticProcess> processes;
+        processes.reserve(total);
+        processes.push_back({1, 0, 'S', false, 1, 2000, 1500, 1, 3000, "systemd", {}});
+        processes.push_back({2, 0, 'S', true, 1, 0, 30, 1, 0, "kthreadd", {}});
+        
+        std::vector<uint32_t> hubPids;
+        std::vector<uint32_t> userPids;
+        uint32_t pid = 2;
+        
+        for (size_t i = 2; i < total; ++i) {
+            // pids climb with occasional gaps left by processes that already exited
+            pid += 1 + (rng() % 4 == 0 ? static_cast<uint32_t>(rng() % 8) : 0);
+            
+            SyntheticProcess proc{};
+            proc.pid = pid;
+            proc.state = 'S';
+            proc.threads = 1;
+            
+            // Most processes are long-lived services started early; the cube skews toward boot
+            double age = static_cast<double>(i) / static_cast<double>(total);
+            proc.starttime = 1 + static_cast<uint64_t>(static_cast<double>(uptimeTicks) * age * age * age);
+            
+            size_t index = i - 2;
+            if (index < kernelThreads) {
+                proc.kernel = true;
+                proc.parentPid = 2;
+                size_t core = index % cores;
+                char name[32];
+                if (index < cores * 3) {
+                    const char* prefixes[] = {"cpuhp", "migration", "ksoftirqd"};
+                    std::snprintf(name, sizeof(name), "%s/%zu", prefixes[index / cores], core);
+                } else {
+                    std::snprintf(name, sizeof(name), "kworker/%zu:%zu", core, index / cores - 3);
+                    proc.state = 'I';
+                }
+                proc.name = name;
+                proc.stime = static_cast<uint64_t>(cpuTicks(rng)) / 4;
+            } else {
+                proc.kernel = false;
+                if (index - kernelThreads < hubs) {
+                    proc.parentPid = 1;
+                    proc.name = HUB_NAMES[rng() % std::size(HUB_NAMES)];
+                    hubPids.push_back(pid);
+                } else {
+                    double pick = unit(rng);
+                    if (pick < 0.6) {
+                        proc.parentPid = hubPids[rng() % hubPids.size()];
+                    } else if (pick < 0.9 && !userPids.empty()) {
+                        proc.parentPid = userPids[rng() % userPids.size()];
+                    } else {
+                        proc.parentPid = 1;
+                    }
+                    proc.name = USER_NAMES[rng() % std::size(USER_NAMES)];
+                    userPids.push_back(pid);
+                    
+                    double state = unit(rng);
+                    proc.state = state < 0.02 ? 'R' : state < 0.025 ? 'D' : state < 0.03 ? 'Z' : 'S';
+                }
+                // A process can't have used more CPU than its age on every core
+                uint64_t limit = (uptimeTicks - proc.starttime) * cores;
+                uint64_t ticks = std::min(static_cast<uint64_t>(cpuTicks(rng)), limit);
+                proc.utime = ticks * 4 / 5;
+                proc.stime = ticks - proc.utime;
+                proc.rssPages = proc.state == 'Z' ? 0 : static_cast<uint64_t>(rssPages(rng));
+                proc.threads = 1 + extraThreads(rng);
+            }
+            processes.push_back(std::move(proc));
+        }
+        return processes;
+    }
+    
+    std::string containerId(std::mt19937& rng) {
+        std::string id;
+        for (int i = 0; i < 4; ++i) {
+            appendf(id, "%016llx", static_cast<ull>(rng()) << 32 | rng());
+        }
+        return id;
+    }
+    
+    /**
+     * @brief Place every process in a cgroup as systemd and a container runtime would
+     *
+     * Kernel threads sit in the root, hubs in their own service, children of
+     * pid 1 in one of a few services, children of a containerd-shim in one of
+     * its pod's containers, children of sshd or tmux in a login session;
+     * everything else inherits its parent's. Uses its own generator so the
+     * stat files stay the same for a given seed.
+     */
+    void assignCgroups(std::vector<SyntheticProcess>& processes, uint32_t seed) {
+        std::mt19937 rng(seed ^ 0x63677270u);                      // "cgrp"
+        std::unordered_map<uint32_t, size_t> indexOfPid;
+        std::unordered_map<uint64_t, std::string> scopes;         // (shim or sshd pid, slot) -> scope
+        std::unordered_map<uint32_t, std::string> pods;           // shim pid -> pod slice
+        uint32_t sessions = 0;
+        
+        indexOfPid.reserve(processes.size());
+        for (size_t i = 0; i < processes.size(); ++i) {
+            SyntheticProcess& proc = processes[i];
+            indexOfPid.emplace(proc.pid, i);
+            if (proc.kernel) {
+                proc.cgroup = "/";
+                continue;
+            }
+            if (proc.pid == 1) {
+                proc.cgroup = "/init.scope";
+                continue;
+            }
+            
+            const SyntheticProcess* parent = nullptr;
+            auto it = indexOfPid.find(proc.parentPid);
+            if (it != indexOfPid.end()) {
+                parent = &processes[it->second];
+            }
+            std::string path;
+            if (!parent || parent->pid == 1) {
+                bool hub = std::find(std::begin(HUB_NAMES), std::end(HUB_NAMES), proc.name) != std::end(HUB_NAMES);
+                if (proc.name == "tmux: server") {
+                    uint32_t uid = FIRST_LOGIN_UID + static_cast<uint32_t>(rng() % LOGIN_USERS);
+                    appendf(path, "/user.slice/user-%u.slice/user@%u.service/app.slice/tmux-spawn-%u.scope",
+                            uid, uid, proc.pid);
+                } else if (hub) {
+                    appendf(path, "/system.slice/%s.service",
+                            proc.name == "containerd-shim" ? "containerd" : proc.name == "sshd" ? "ssh"
+                                                                           : proc.name.c_str());
+                } else {
+                    appendf(path, "/system.slice/%s.service", SERVICE_NAMES[rng() % std::size(SERVICE_NAMES)]);
+                }
+            } else if (parent->name == "containerd-shim") {
+                auto pod = pods.find(parent->pid);
+                if (pod == pods.end()) {
+                    std::string slice;
+                    const char* qos = rng() % 3 == 0 ? "besteffort" : "burstable";
+                    appendf(slice, "/kubepods.slice/kubepods-%s.slice/kubepods-%s-pod%08x_%04x_%04x.slice",
+                            qos, qos, static_cast<unsigned>(rng()), static_cast<unsigned>(rng() & 0xFFFF),
+                            static_cast<unsigned>(rng() & 0xFFFF));
+                    pod = pods.emplace(parent->pid, std::move(slice)).first;
+                }
+                uint64_t key = static_cast<uint64_t>(parent->pid) << 32 | (rng() % CONTAINERS_PER_POD);
+                auto scope = scopes.find(key);
+                if (scope == scopes.end()) {
+                    scope = scopes.emplace(key, pod->second + "/cri-containerd-" + containerId(rng) + ".scope").first;
+                }
+                path = scope->second;
+            } else if (parent->name == "sshd") {
+                uint64_t key = static_cast<uint64_t>(parent->pid) << 32 | (rng() % SESSIONS_PER_SSHD);
+                auto scope = scopes.find(key);
+                if (scope == scopes.end()) {
+                    std::string session;
+                    appendf(session, "/user.slice/user-%u.slice/session-%u.scope",
+                            FIRST_LOGIN_UID + static_cast<uint32_t>(rng() % LOGIN_USERS), ++sessions);
+                    scope = scopes.emplace(key, std::move(session)).first;
+                }
+                path = scope->second;
+            } else {
+                path = parent->cgroup;
+            }
+            proc.cgroup = std::move(path);
+        }
+    }
+    
+    void formatProcessStat(const SyntheticProcess& proc, size_t cores, std::string& out) {
+        // All 52 fields of proc(5); 38 exit_signal and 39 processor are the only late ones set
+        appendf(out, "%u (%s) %c %u %u %u 0 -1 %u %llu 0 %llu 0 %llu %llu 0 0 20 0 %u 0 %llu %llu %llu "
+                     "18446744073709551615 0 0 0 0 0 0 0 0 0 0 0 0 17 %u 0 0 0 0 0 0 0 0 0 0 0 0 0\n",
+                proc.pid, proc.name.c_str(), proc.state, proc.parentPid,
+                proc.kernel ? 0u : proc.pid, proc.kernel ? 0u : proc.pid,
+                proc.kernel ? 0x208040u : 0x400100u,
+                static_cast<ull>(proc.rssPages * 3), static_cast<ull>(proc.rssPages / 64),
+                static_cast<ull>(proc.utime), static_cast<ull>(proc.stime), proc.threads,
+                static_cast<ull>(proc.starttime), static_cast<ull>(proc.rssPages * PAGE_KB * 1024 * 4),
+                static_cast<ull>(proc.rssPages), static_cast<unsigned>(proc.pid % cores));
+    }
+    
+    std::string formatStat(const std::vector<SyntheticProcess>& processes, size_t cores,
+                           uint64_t clockTicks, std::mt19937& rng) {
+        std::uniform_real_distribution<double> userShare(0.05, 0.5);
+        std::uniform_real_distribution<double> systemShare(0.02, 0.12);
+        uint64_t coreTicks = UPTIME_SECONDS * clockTicks;
+        
+        // user nice system idle iowait irq softirq steal
+        std::vector<uint64_t> total(8, 0);
+        std::string lines;
+        for (size_t core = 0; core < cores; ++core) {
+            uint64_t fields[8] = {};
+            fields[0] = static_cast<uint64_t>(static_cast<double>(coreTicks) * userShare(rng));
+            fields[1] = coreTicks / 200;
+            fields[2] = static_cast<uint64_t>(static_cast<double>(coreTicks) * systemShare(rng));
+            fields[4] = coreTicks / 100;
+            fields[5] = coreTicks / 500;
+            fields[6] = coreTicks / 250;
+            fields[3] = coreTicks - fields[0] - fields[1] - fields[2] - fields[4] - fields[5] - fields[6];
+            appendf(lines, "cpu%zu %llu %llu %llu %llu %llu %llu %llu 0 0 0\n", core,
+                    static_cast<ull>(fields[0]), static_cast<ull>(fields[1]), static_cast<ull>(fields[2]),
+                    static_cast<ull>(fields[3]), static_cast<ull>(fields[4]), static_cast<ull>(fields[5]),
+                    static_cast<ull>(fields[6]));
+            for (size_t i = 0; i < 8; ++i) {
+                total[i] += fields[i];
+            }
+        }
+        
+        size_t running = 0, blocked = 0;
+        for (const auto& proc : processes) {
+            running += proc.state == 'R';
+            blocked += proc.state == 'D';
+        }
+        
+        std::string out;
+        appendf(out, "cpu  %llu %llu %llu %llu %llu %llu %llu 0 0 0\n",
+                static_cast<ull>(total[0]), static_cast<ull>(total[1]), static_cast<ull>(total[2]),
+                static_cast<ull>(total[3]), static_cast<ull>(total[4]), static_cast<ull>(total[5]),
+                static_cast<ull>(total[6]));
+        out += lines;
+        appendf(out, "intr 0\nctxt %llu\nbtime %llu\nprocesses %llu\nprocs_running %zu\nprocs_blocked %zu\nsoftirq 0\n",
+                static_cast<ull>(UPTIME_SECONDS * 4000 * cores),
+                static_cast<ull>(static_cast<uint64_t>(std::time(nullptr)) - UPTIME_SECONDS),
+                static_cast<ull>(processes.back().pid), std::max<size_t>(running, 1), blocked);
+        return out;
+    }
+    
+    std::string formatMeminfo(const std::vector<SyntheticProcess>& processes) {
+        uint64_t residentKb = 0;
+        for (const auto& proc : processes) {
+            residentKb += proc.rssPages * PAGE_KB;
+        }
+        // Shared pages make summed RSS overstate real use; keep the host at a plausible fill
+        uint64_t totalKb = std::max<uint64_t>(16ull << 20, residentKb / 2 * 3 / 2);
+        uint64_t usedKb = std::min<uint64_t>(residentKb / 2 + (1ull << 20), totalKb * 9 / 10);
+        uint64_t cachedKb = (totalKb - usedKb) / 2;
+        
+        std::string out;
+        appendf(out, "MemTotal:       %llu kB\n", static_cast<ull>(totalKb));
+        appendf(out, "MemFree:        %llu kB\n", static_cast<ull>(totalKb - usedKb - cachedKb));
+        appendf(out, "MemAvailable:   %llu kB\n", static_cast<ull>(totalKb - usedKb));
+        appendf(out, "Buffers:        %llu kB\n", static_cast<ull>(cachedKb / 16));
+        appendf(out, "Cached:         %llu kB\n", static_cast<ull>(cachedKb - cachedKb / 16));
+        appendf(out, "SwapTotal:      %llu kB\nSwapFree:       %llu kB\n",
+                static_cast<ull>(totalKb / 4), static_cast<ull>(totalKb / 4));
+        return out;
+    }
+    
+    std::string formatDiskstats() {
+        std::string out;
+        uint64_t sectors = 1ull << 30;
+        for (const auto& disk : DISKS) {
+            // A partition's counters are a share of its disk's, as in the kernel
+            uint64_t share = disk.whole ? sectors : sectors / 3;
+            appendf(out, "%4u %7u %s %llu 0 %llu 0 %llu 0 %llu 0 0 0 0 0 0 0 0 0 0\n",
+                    disk.major, disk.minor, disk.name,
+                    static_cast<ull>(share / 64), static_cast<ull>(share),
+                    static_cast<ull>(share / 128), static_cast<ull>(share / 2));
+        }
+        return out;
+    }
+    
+    std::string formatNetDev() {
+        std::string out =
+            "Inter-|   Receive                                                |  Transmit\n"
+            " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n";
+        const char* const interfaces[] = {"lo", "eth0", "eth1"};
+        uint64_t bytes = 1ull << 36;
+        for (const char* name : interfaces) {
+            appendf(out, "%6s: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n", name,
+                    static_cast<ull>(bytes), static_cast<ull>(bytes / 1200),
+                    static_cast<ull>(bytes / 3), static_cast<ull>(bytes / 3600));
+            bytes /= 4;
+        }
+        return out;
+    }
+}
+
+bool captureFixture(const std::string& procRoot, const std::string& sysRoot, const std::string& outDir,
+                    FixtureSummary& summary, std::string& error) {
+    summary = FixtureSummary{};
+    if (!prepareOutDir(outDir, error)) {
+        return false;
+    }
+    std::string procOut = outDir + "/proc/";
+    
+    ProcfsReader reader;
+    for (const char* file : SYSTEM_FILES) {
+        std::string_view contents;
+        if (!reader.readFile(procRoot + "/" + file, contents)) {
+            error = "Cannot read " + procRoot + "/" + file;
+            return false;
+        }
+        if (!writeFile(procOut + file, contents, summary, error)) {
+            return false;
+        }
+    }
+    
+    // Without sys/block the collectors count every diskstats line, as on the host
+    for (const auto& name : listDirectory(sysRoot + "/block", false)) {
+        if (!makeDir(outDir + "/sys/block/" + name, error)) {
+            return false;
+        }
+    }
+    
+    std::vector<std::string> pids = listDirectory(procRoot, true);
+    std::vector<std::string> paths;
+    paths.reserve(pids.size());
+    for (const auto& pid : pids) {
+        paths.push_back(procRoot + "/" + pid + "/stat");
+    }
+    
+    bool ok = true;
+    std::vector<std::string> captured;
+    reader.readBatch(paths, [&](size_t index, std::string_view contents) {
+        if (!ok) {
+            return;
+        }
+        std::string dir = procOut + pids[index];
+        ok = makeDir(dir, error) && writeFile(dir + "/stat", contents, summary, error);
+        summary.processes += ok;
+        captured.push_back(pids[index]);
+    });
+    
+    // Control groups of the processes captured above; one that exited since has none
+    paths.clear();
+    for (const auto& pid : captured) {
+        paths.push_back(procRoot + "/" + pid + "/cgroup");
+    }
+    reader.readBatch(paths, [&](size_t index, std::string_view contents) {
+        ok = ok && writeFile(procOut + captured[index] + "/cgroup", contents, summary, error);
+    });
+    return ok;
+}
+
+bool generateFixture(const std::string& outDir, const FixtureShape& shape,
+                     FixtureSummary& summary, std::string& error) {
+    summary = FixtureSummary{};
+    if (!prepareOutDir(outDir, error)) {
+        return false;
+    }
+    std::string procOut = outDir + "/proc/";
+    
+    // Start times are in the collector's clock ticks so creation times come out right
+    long clockTicks = sysconf(_SC_CLK_TCK);
+    uint64_t ticks = clockTicks > 0 ? static_cast<uint64_t>(clockTicks) : 100;
+    size_t cores = std::max<size_t>(shape.cores, 1);
+    std::mt19937 rng(shape.seed);
+    
+    auto processes = synthesizeProcesses(shape, ticks, rng);
+    assignCgroups(processes, shape.seed);
+    if (!writeFile(procOut + "stat", formatStat(processes, cores, ticks, rng), summary, error) ||
+        !writeFile(procOut + "meminfo", formatMeminfo(processes), summary, error) ||
+        !writeFile(procOut + "diskstats", formatDiskstats(), summary, error) ||
+        !writeFile(procOut + "net/dev", formatNetDev(), summary, error)) {
+        return false;
+    }
+    for (const auto& disk : DISKS) {
+        if (disk.whole && !makeDir(outDir + "/sys/block/" + disk.name, error)) {
+            return false;
+        }
+    }
+    
+    std::string line;
+    for (const auto& proc : processes) {
+        std::string dir = procOut + std::to_string(proc.pid);
+        line.clear();
+        formatProcessStat(proc, cores, line);
+        if (!makeDir(dir, error) || !writeFile(dir + "/stat", line, summary, error) ||
+            !writeFile(dir + "/cgroup", "0::" + proc.cgroup + "\n", summary, error)) {
+            return false;
+        }
+        ++summary.processes;
+    }
+    return true;
+}
+
+} // namespace procfs
+
+} // namespace sysmon
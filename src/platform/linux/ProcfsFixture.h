@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sysmon {
+
+/**
+ * @brief Offline procfs/sysfs trees for the Linux collectors (--proc-root, --sys-root)
+ *
+ * A fixture directory holds proc/ and sys/ subtrees with just the files the
+ * collectors read: proc/{stat,meminfo,diskstats,net/dev}, proc/<pid>/{stat,cgroup}
+ * and sys/block/<disk>. Fixtures are static snapshots, so rates computed
+ * from them are zero after the first scan.
+ */
+namespace procfs {
+
+/**
+ * @brief Shape of a synthetic host for generateFixture()
+ */
+struct FixtureShape {
+    size_t processes{1000};     // Including init, kthreadd and kernel threads
+    size_t cores{8};            // cpuN lines in proc/stat
+    uint32_t seed{1};           // The same shape and seed give the same fixture
+};
+
+// Bumped whenever generateFixture() writes different files, so cached fixtures are regenerated
+constexpr uint32_t FIXTURE_VERSION = 2;
+
+/**
+ * @brief What a capture or generation wrote
+ */
+struct FixtureSummary {
+    size_t processes{0};
+    size_t files{0};
+    uint64_t bytes{0};
+};
+
+/**
+ * @brief Copy the collector inputs under @p procRoot and @p sysRoot into @p outDir
+ *
+ * Processes that exit mid-capture are skipped; sys/block entries are
+ * recreated as empty directories. @p outDir must not exist or be empty.
+ */
+bool captureFixture(const std::string& procRoot, const std::string& sysRoot, const std::string& outDir,
+                    FixtureSummary& summary, std::string& error);
+
+/**
+ * @brief Write a synthetic host of @p shape into @p outDir
+ *
+ * pid 1 and kthreadd, a share of kernel threads under kthreadd, service
+ * hubs under pid 1 and user processes attached to hubs, to earlier user
+ * processes (deep chains) or to pid 1. CPU times, RSS and start times are
+ * heavy-tailed; stat lines carry all 52 fields. cgroup files hold one
+ * unified-hierarchy line: system.slice services, a kubepods container scope
+ * per shim child's container (a few hundred at 100k processes) and
+ * user.slice login sessions. @p outDir must not exist or be empty.
+ */
+bool generateFixture(const std::string& outDir, const FixtureShape& shape,
+                     FixtureSummary& summary, std::string& error);
+                     
+} // namespace procfs
+
+} // namespace sysmon
@@ -0,0 +1,397 @@
+#include "ProcfsReader.h"
+#include <linux/io_uring.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace sysmon {
+
+namespace {
+    // Files submitted concurrently (each uses one registered file slot)
+    constexpr unsigned RING_DEPTH = 256;
+    
+    // Per-slot read buffer; /proc/[pid]/stat and friends fit comfortably.
+    // A completely filled buffer is re-read synchronously to get the tail.
+    constexpr size_t SLOT_BUFFER_SIZE = 4096;
+    
+    // Initial size of the single-file buffer (grows for large files like /proc/stat)
+    constexpr size_t FILE_BUFFER_SIZE = 16384;
+    
+    // user_data layout: slot index in the high bits, chain step in the low bits
+    enum : uint64_t { STEP_OPEN = 0, STEP_READ = 1, STEP_CLOSE = 2, STEP_BITS = 2 };
+    
+    bool readWholeFile(const char* path, std::string& buffer, size_t& length) {
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        
+        if (buffer.size() < FILE_BUFFER_SIZE) {
+            buffer.resize(FILE_BUFFER_SIZE);
+        }
+        
+        length = 0;
+        while (true) {
+            if (length == buffer.size()) {
+                buffer.resize(buffer.size() * 2);
+            }
+            
+            ssize_t n = ::read(fd, buffer.data() + length, buffer.size() - length);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                ::close(fd);
+                return false;
+            }
+            if (n == 0) break;
+            length += static_cast<size_t>(n);
+        }
+        
+        ::close(fd);
+        return true;
+    }
+}
+
+/**
+ * @brief Minimal raw-syscall io_uring wrapper (no liburing dependency)
+ *
+ * Each file is submitted as a linked openat(direct) -> read(fixed) -> close(direct)
+ * chain into one of RING_DEPTH registered file slots, so a batch of N files costs
+ * roughly N / RING_DEPTH io_uring_enter calls instead of 3 * N syscalls.
+ */
+class ProcfsReader::IoUring {
+public:
+    static std::unique_ptr<IoUring> create() {
+        auto ring = std::unique_ptr<IoUring>(new IoUring());
+        if (!ring->setup()) {
+            return nullptr;
+        }
+        return ring;
+    }
+    
+    ~IoUring() {
+        if (sqes_ != MAP_FAILED) {
+            munmap(sqes_, sqesSize_);
+        }
+        if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_) {
+            munmap(cqRing_, cqRingSize_);
+        }
+        if (sqRing_ != MAP_FAILED) {
+            munmap(sqRing_, sqRingSize_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+    
+    /**
+     * @brief Run one batch; returns false if the ring itself failed
+     *
+     * Files whose chain fails for reasons other than the process vanishing
+     * are appended to @p retry so the caller can read them synchronously.
+     */
+    bool run(const std::vector<std::string>& paths, const CompletionHandler& handler,
+             std::vector<bool>& delivered, std::vector<size_t>& retry) {
+        size_t next = 0;
+        size_t inFlight = 0;
+        
+        while (next < paths.size() || inFlight > 0) {
+            // Fill every free slot with a new open/read/close chain
+            while (next < paths.size() && !freeSlots_.empty()) {
+                unsigned slot = freeSlots_.back();
+                freeSlots_.pop_back();
+                queueChain(slot, next, paths[next].c_str());
+                ++next;
+                ++inFlight;
+            }
+            
+            if (enter(1) < 0) {
+                return false;
+            }
+            
+            // Drain all available completions
+            unsigned head = *cqHead_;
+            unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            while (head != tail) {
+                const io_uring_cqe& cqe = cqes_[head & *cqMask_];
+                unsigned slot = static_cast<unsigned>(cqe.user_data >> STEP_BITS);
+                uint64_t step = cqe.user_data & ((1u << STEP_BITS) - 1);
+                Slot& s = slots_[slot];
+                
+                if (step == STEP_OPEN && cqe.res < 0) {
+                    s.failed = true;
+                    s.error = -cqe.res;
+                } else if (step == STEP_READ && !s.failed) {
+                    if (cqe.res < 0) {
+                        s.failed = true;
+                        s.error = -cqe.res;
+                    } else if (static_cast<size_t>(cqe.res) >= SLOT_BUFFER_SIZE) {
+                        // Truncated - let the synchronous path read the full file
+                        retry.push_back(s.index);
+                    } else {
+                        handler(s.index, std::string_view(s.buffer, static_cast<size_t>(cqe.res)));
+                        delivered[s.index] = true;
+                    }
+                }
+                
+                if (++s.completions == 3) {
+                    // The process exiting between readdir and open is routine
+                    if (s.failed && s.error != ENOENT && s.error != ESRCH && s.error != EACCES) {
+                        retry.push_back(s.index);
+                    }
+                    s = Slot{s.buffer};
+                    freeSlots_.push_back(slot);
+                    --inFlight;
+                }
+                ++head;
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+        
+        return true;
+    }
+    
+private:
+    struct Slot {
+        char* buffer{nullptr};
+        size_t index{0};
+        int completions{0};
+        bool failed{false};
+        int error{0};
+    };
+    
+    IoUring() = default;
+    
+    bool setup() {
+        io_uring_params params{};
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, RING_DEPTH * 3, &params));
+        if (fd_ < 0) {
+            // ENOSYS: old kernel; EPERM: disabled by kernel.io_uring_disabled
+            return false;
+        }
+        
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        
+        sqRing_ = mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sqRing_ == MAP_FAILED) {
+            return false;
+        }
+        
+        cqRing_ = singleMmap ? sqRing_
+                             : mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED) {
+            return false;
+        }
+        
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) {
+            return false;
+        }
+        
+        auto* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        
+        auto* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        
+        if (!probeOps()) {
+            return false;
+        }
+        
+        // Sparse fixed-file table used by openat/close "direct" descriptors
+        std::vector<int> files(RING_DEPTH, -1);
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_FILES,
+                    files.data(), RING_DEPTH) < 0) {
+            return false;
+        }
+        
+        buffers_.resize(RING_DEPTH * SLOT_BUFFER_SIZE);
+        slots_.resize(RING_DEPTH);
+        freeSlots_.reserve(RING_DEPTH);
+        for (unsigned i = 0; i < RING_DEPTH; ++i) {
+            slots_[i].buffer = buffers_.data() + i * SLOT_BUFFER_SIZE;
+            freeSlots_.push_back(RING_DEPTH - 1 - i);
+        }
+        
+        return true;
+    }
+    
+    bool probeOps() {
+        constexpr unsigned PROBE_OPS = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) + PROBE_OPS * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, PROBE_OPS) < 0) {
+            return false;
+        }
+        
+        // Direct (fixed-slot) openat/close arrived in 5.15 alongside MKDIRAT;
+        // the probe has no flag for it, so use MKDIRAT as the version marker.
+        for (int op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE, IORING_OP_MKDIRAT}) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    io_uring_sqe* nextSqe() {
+        unsigned tail = *sqTail_ + pendingSqes_;
+        unsigned idx = tail & *sqMask_;
+        sqArray_[idx] = idx;
+        ++pendingSqes_;
+        
+        auto* sqe = static_cast<io_uring_sqe*>(sqes_) + idx;
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+    
+    void queueChain(unsigned slot, size_t index, const char* path) {
+        slots_[slot].index = index;
+        uint64_t base = static_cast<uint64_t>(slot) << STEP_BITS;
+        
+        io_uring_sqe* open = nextSqe();
+        open->opcode = IORING_OP_OPENAT;
+        open->fd = AT_FDCWD;
+        open->addr = reinterpret_cast<uint64_t>(path);
+        open->open_flags = O_RDONLY;
+        open->file_index = slot + 1;
+        open->flags = IOSQE_IO_LINK;
+        open->user_data = base | STEP_OPEN;
+        
+        // Hard link so a short read (always the case for procfs) still closes the slot
+        io_uring_sqe* read = nextSqe();
+        read->opcode = IORING_OP_READ;
+        read->fd = static_cast<int>(slot);
+        read->addr = reinterpret_cast<uint64_t>(slots_[slot].buffer);
+        read->len = SLOT_BUFFER_SIZE;
+        read->off = 0;
+        read->flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+        read->user_data = base | STEP_READ;
+        
+        io_uring_sqe* close = nextSqe();
+        close->opcode = IORING_OP_CLOSE;
+        close->file_index = slot + 1;
+        close->user_data = base | STEP_CLOSE;
+    }
+    
+    // Submits every SQE the kernel hasn't consumed yet, including any left
+    // over from an earlier short submit, and waits for @p minComplete completions
+    int enter(unsigned minComplete) {
+        if (pendingSqes_ > 0) {
+            __atomic_store_n(sqTail_, *sqTail_ + pendingSqes_, __ATOMIC_RELEASE);
+            pendingSqes_ = 0;
+        }
+        
+        while (true) {
+            unsigned toSubmit = *sqTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE);
+            long ret = syscall(__NR_io_uring_enter, fd_, toSubmit, minComplete,
+                               IORING_ENTER_GETEVENTS, nullptr, 0);
+            // EINTR means nothing was submitted (the kernel returns the count
+            // otherwise), so retrying recomputes the same backlog
+            if (ret >= 0 || errno != EINTR) {
+                return static_cast<int>(ret);
+            }
+        }
+    }
+    
+    int fd_{-1};
+    void* sqRing_{MAP_FAILED};
+    void* cqRing_{MAP_FAILED};
+    void* sqes_{MAP_FAILED};
+    size_t sqRingSize_{0};
+    size_t cqRingSize_{0};
+    size_t sqesSize_{0};
+    
+    unsigned* sqHead_{nullptr};                     // Advanced by the kernel as it consumes SQEs
+    unsigned* sqTail_{nullptr};
+    unsigned* sqMask_{nullptr};
+    unsigned* sqArray_{nullptr};
+    unsigned* cqHead_{nullptr};
+    unsigned* cqTail_{nullptr};
+    unsigned* cqMask_{nullptr};
+    io_uring_cqe* cqes_{nullptr};
+    unsigned pendingSqes_{0};
+    
+    std::vector<char> buffers_;
+    std::vector<Slot> slots_;
+    std::vector<unsigned> freeSlots_;
+};
+
+ProcfsReader::ProcfsReader(bool enableIoUring) {
+    if (enableIoUring) {
+        ring_ = IoUring::create();
+    }
+}
+
+ProcfsReader::~ProcfsReader() = default;
+
+size_t ProcfsReader::readBatch(const std::vector<std::string>& paths,
+                               const CompletionHandler& handler) {
+    if (!ring_) {
+        return readBatchSync(paths, handler);
+    }
+    
+    std::vector<bool> delivered(paths.size(), false);
+    std::vector<size_t> retry;
+    if (!ring_->run(paths, handler, delivered, retry)) {
+        // Ring is unusable (e.g. resource limits); finish on the synchronous path
+        ring_.reset();
+        retry.clear();
+        for (size_t i = 0; i < paths.size(); ++i) {
+            if (!delivered[i]) retry.push_back(i);
+        }
+    }
+    
+    for (size_t index : retry) {
+        std::string_view contents;
+        if (readFile(paths[index], contents)) {
+            handler(index, contents);
+            delivered[index] = true;
+        }
+    }
+    
+    return static_cast<size_t>(std::count(delivered.begin(), delivered.end(), true));
+}
+
+bool ProcfsReader::readFile(const std::string& path, std::string_view& contents) {
+    size_t length = 0;
+    if (!readWholeFile(path.c_str(), buffer_, length)) {
+        return false;
+    }
+    contents = std::string_view(buffer_.data(), length);
+    return true;
+}
+
+size_t ProcfsReader::readBatchSync(const std::vector<std::string>& paths,
+                                   const CompletionHandler& handler) {
+    size_t completed = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        std::string_view contents;
+        if (readFile(paths[i], contents)) {
+            handler(i, contents);
+            ++completed;
+        }
+    }
+    return completed;
+}
+
+} // namespace sysmon
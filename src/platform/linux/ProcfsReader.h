@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sysmon {
+
+/**
+ * @brief Batched reader for small procfs/sysfs files
+ *
+ * Uses an io_uring submission ring (openat -> read -> close linked per file)
+ * when the kernel supports it, and falls back to synchronous open/read/close
+ * when io_uring is unavailable or disabled via kernel.io_uring_disabled.
+ *
+ * Thread-safety: Not thread-safe; each collector owns its own reader
+ */
+class ProcfsReader {
+public:
+    /**
+     * @brief Invoked once per successfully read file, in completion order
+     * @param index Position of the file in the submitted path list
+     * @param contents File contents (valid only for the duration of the call)
+     */
+    using CompletionHandler = std::function<void(size_t index, std::string_view contents)>;
+    
+    explicit ProcfsReader(bool enableIoUring = true);
+    ~ProcfsReader();
+    
+    ProcfsReader(const ProcfsReader&) = delete;
+    ProcfsReader& operator=(const ProcfsReader&) = delete;
+    
+    /**
+     * @brief Read every file in @p paths, invoking @p handler as each completes
+     * @return Number of files successfully read
+     */
+    size_t readBatch(const std::vector<std::string>& paths, const CompletionHandler& handler);
+    
+    /**
+     * @brief Read a single file into the reader's reusable buffer
+     * @return true if the file was read; @p contents stays valid until the next call
+     */
+    bool readFile(const std::string& path, std::string_view& contents);
+    
+    /**
+     * @brief Whether batches are currently served by io_uring
+     */
+    bool usingIoUring() const { return ring_ != nullptr; }
+    
+private:
+    size_t readBatchSync(const std::vector<std::string>& paths, const CompletionHandler& handler);
+    
+    class IoUring;
+    std::unique_ptr<IoUring> ring_;
+    std::string buffer_;
+};
+
+namespace procfs {
+
+/**
+ * @brief Skip leading spaces/tabs and parse an unsigned decimal field
+ *
+ * Advances @p pos past the parsed digits. Returns 0 if no digits are found.
+ */
+inline uint64_t parseU64(std::string_view text, size_t& pos) {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+        ++pos;
+    }
+    
+    uint64_t value = 0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        value = value * 10 + static_cast<uint64_t>(text[pos] - '0');
+        ++pos;
+    }
+    return value;
+}
+
+/**
+ * @brief Skip leading whitespace and return the next whitespace-delimited token
+ */
+inline std::string_view nextToken(std::string_view text, size_t& pos) {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) {
+        ++pos;
+    }
+    
+    size_t start = pos;
+    while (pos < text.size() && text[pos] != ' ' && text[pos] != '\t' && text[pos] != '\n') {
+        ++pos;
+    }
+    return text.substr(start, pos - start);
+}
+
+/**
+ * @brief Return the line starting at @p pos and advance past its newline
+ */
+inline bool nextLine(std::string_view text, size_t& pos, std::string_view& line) {
+    if (pos >= text.size()) {
+        return false;
+    }
+    
+    size_t end = text.find('\n', pos);
+    if (end == std::string_view::npos) {
+        end = text.size();
+    }
+    line = text.substr(pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+} // namespace procfs
+
+} // namespace sysmon
@@ -8,6 +8,20 @@
 
 namespace sysmon {
 
+namespace {
+    // p_stat (SIDL, SRUN, SSLEEP, SSTOP, SZOMB) as ps(1) letters
+    char stateLetter(char status) {
+        switch (status) {
+            case SIDL: return 'I';
+            case SRUN: return 'R';
+            case SSLEEP: return 'S';
+            case SSTOP: return 'T';
+            case SZOMB: return 'Z';
+            default: return ProcessTable::UNKNOWN_STATE;
+        }
+    }
+}
+
 class MacOSProcessCollector : public IProcessCollector {
 public:
     MacOSProcessCollector() = default;
@@ -24,16 +38,14 @@ public:
         // No cleanup needed
     }
     
-    std::vector<std::unique_ptr<ProcessInfo>> enumerateProcesses() override {
-        std::vector<std::unique_ptr<ProcessInfo>> processes;
-        
+    void enumerateProcesses(ProcessTable& out) override {
         // Get list of all process IDs
         int mib[4] = {CTL_KERN, KERN_PROC, KERN_PROC_ALL, 0};
         size_t size = 0;
         
         // Get size needed
         if (sysctl(mib, 4, nullptr, &size, nullptr, 0) < 0) {
-            return processes;
+            return;
         }
         
         // Allocate buffer
@@ -41,10 +53,11 @@ public:
         
         // Get actual process list
         if (sysctl(mib, 4, procList.data(), &size, nullptr, 0) < 0) {
-            return processes;
+            return;
         }
         
         size_t procCount = size / sizeof(struct kinfo_proc);
+        out.reserve(procCount);
         
         // Get current time for CPU calculation
         auto now = std::chrono::steady_clock::now();
@@ -54,50 +67,49 @@ public:
         
         for (size_t i = 0; i < procCount; ++i) {
             auto& kp = procList[i];
-            auto procInfo = std::make_unique<ProcessInfo>();
-            
-            procInfo->pid = kp.kp_proc.p_pid;
-            procInfo->parentPid = kp.kp_eproc.e_ppid;
-            procInfo->name = kp.kp_proc.p_comm;
+            auto pid = static_cast<uint32_t>(kp.kp_proc.p_pid);
+            auto parentPid = static_cast<uint32_t>(kp.kp_eproc.e_ppid);
+            double cpuPercent = 0.0;
+            uint64_t memoryBytes = 0;
+            uint64_t creationTime = 0;
             
             // Get detailed process info
             struct proc_taskinfo taskInfo;
-            int ret = proc_pidinfo(procInfo->pid, PROC_PIDTASKINFO, 0,
+            int ret = proc_pidinfo(pid, PROC_PIDTASKINFO, 0,
                                   &taskInfo, sizeof(taskInfo));
             
             if (ret == sizeof(taskInfo)) {
                 // Memory usage (resident size)
-                procInfo->memoryBytes = taskInfo.pti_resident_size;
+                memoryBytes = taskInfo.pti_resident_size;
                 
                 // CPU usage calculation
                 uint64_t totalTime = taskInfo.pti_total_user + taskInfo.pti_total_system;
                 
-                auto it = lastCpuTimes_.find(procInfo->pid);
+                auto it = lastCpuTimes_.find(pid);
                 if (it != lastCpuTimes_.end() && seconds > 0) {
                     uint64_t cpuDelta = totalTime - it->second;
                     // Convert nanoseconds to percentage
-                    procInfo->cpuPercent = (cpuDelta / 1000000000.0) / seconds * 100.0;
+                    cpuPercent = (cpuDelta / 1000000000.0) / seconds * 100.0;
                 }
                 
-                lastCpuTimes_[procInfo->pid] = totalTime;
+                lastCpuTimes_[pid] = totalTime;
             }
             
             // Get process creation time
             struct proc_bsdinfo bsdInfo;
-            ret = proc_pidinfo(procInfo->pid, PROC_PIDTBSDINFO, 0,
+            ret = proc_pidinfo(pid, PROC_PIDTBSDINFO, 0,
                               &bsdInfo, sizeof(bsdInfo));
             
             if (ret == sizeof(bsdInfo)) {
-                procInfo->creationTime = bsdInfo.pbi_start_tvsec * 1000 +
-                                        bsdInfo.pbi_start_tvusec / 1000;
+                creationTime = bsdInfo.pbi_start_tvsec * 1000 +
+                               bsdInfo.pbi_start_tvusec / 1000;
             }
             
-            processes.push_back(std::move(procInfo));
+            out.add(pid, parentPid, kp.kp_proc.p_comm, cpuPercent, memoryBytes, creationTime,
+                    static_cast<uint32_t>(kp.kp_eproc.e_ucred.cr_uid), stateLetter(kp.kp_proc.p_stat));
         }
         
         lastSampleTime_ = now;
-        
-        return processes;
     }
     
     bool terminateProcess(uint32_t pid) override {
@@ -110,7 +122,7 @@ private:
     std::unordered_map<uint32_t, uint64_t> lastCpuTimes_;
 };
 
-std::unique_ptr<IProcessCollector> createProcessCollector() {
+std::unique_ptr<IProcessCollector> createProcessCollector(const Configuration& /*config*/) {
     return std::make_unique<MacOSProcessCollector>();
 }
 
@@ -201,7 +201,7 @@ private:
     std::chrono::steady_clock::time_point lastNetworkTime_;
 };
 
-std::unique_ptr<ISystemCollector> createSystemCollector() {
+std::unique_ptr<ISystemCollector> createSystemCollector(const Configuration& /*config*/) {
     return std::make_unique<MacOSSystemCollector>();
 }
 
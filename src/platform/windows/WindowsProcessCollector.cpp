@@ -28,13 +28,11 @@ public:
         // No cleanup needed
     }
     
-    std::vector<std::unique_ptr<ProcessInfo>> enumerateProcesses() override {
-        std::vector<std::unique_ptr<ProcessInfo>> processes;
-        
+    void enumerateProcesses(ProcessTable& out) override {
         // Create snapshot of all processes
         HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
         if (snapshot == INVALID_HANDLE_VALUE) {
-            return processes;
+            return;
         }
         
         PROCESSENTRY32W pe32;
@@ -42,9 +40,10 @@ public:
         
         if (Process32FirstW(snapshot, &pe32)) {
             do {
-                auto procInfo = std::make_unique<ProcessInfo>();
-                procInfo->pid = pe32.th32ProcessID;
-                procInfo->parentPid = pe32.th32ParentProcessID;
+                std::string name;
+                double cpuPercent = 0.0;
+                uint64_t memoryBytes = 0;
+                uint64_t creationTime = 0;
                 
                 // Convert wide string to narrow string
                 int size = WideCharToMultiByte(CP_UTF8, 0, pe32.szExeFile, -1, 
@@ -53,7 +52,7 @@ public:
                     std::vector<char> buffer(size);
                     WideCharToMultiByte(CP_UTF8, 0, pe32.szExeFile, -1, 
                                        buffer.data(), size, nullptr, nullptr);
-                    procInfo->name = buffer.data();
+                    name = buffer.data();
                 }
                 
                 // Get additional process information
@@ -63,13 +62,13 @@ public:
                     // Get memory info
                     PROCESS_MEMORY_COUNTERS_EX pmc;
                     if (GetProcessMemoryInfo(hProcess, (PROCESS_MEMORY_COUNTERS*)&pmc, sizeof(pmc))) {
-                        procInfo->memoryBytes = pmc.WorkingSetSize;
+                        memoryBytes = pmc.WorkingSetSize;
                     }
                     
                     // Get CPU usage (simplified)
                     FILETIME createTime, exitTime, kernelTime, userTime;
                     if (GetProcessTimes(hProcess, &createTime, &exitTime, &kernelTime, &userTime)) {
-                        procInfo->creationTime = fileTimeToUInt64(createTime);
+                        creationTime = fileTimeToUInt64(createTime);
                         
                         // Calculate CPU percentage (requires delta sampling in real implementation)
                         uint64_t totalTime = fileTimeToUInt64(kernelTime) + fileTimeToUInt64(userTime);
@@ -80,7 +79,7 @@ public:
                             uint64_t delta = totalTime - it->second.first;
                             uint64_t timeDelta = GetTickCount64() - it->second.second;
                             if (timeDelta > 0) {
-                                procInfo->cpuPercent = (delta * 100.0) / (timeDelta * 10000.0);
+                                cpuPercent = (delta * 100.0) / (timeDelta * 10000.0);
                             }
                         }
                         lastCpuTimes_[pe32.th32ProcessID] = {totalTime, GetTickCount64()};
@@ -89,13 +88,12 @@ public:
                     CloseHandle(hProcess);
                 }
                 
-                processes.push_back(std::move(procInfo));
+                out.add(pe32.th32ProcessID, pe32.th32ParentProcessID, name, cpuPercent, memoryBytes, creationTime);
                 
             } while (Process32NextW(snapshot, &pe32));
         }
         
         CloseHandle(snapshot);
-        return processes;
     }
     
     bool terminateProcess(uint32_t pid) override {
@@ -122,7 +120,7 @@ private:
     std::unordered_map<uint32_t, std::pair<uint64_t, uint64_t>> lastCpuTimes_;
 };
 
-std::unique_ptr<IProcessCollector> createProcessCollector() {
+std::unique_ptr<IProcessCollector> createProcessCollector(const Configuration& /*config*/) {
     return std::make_unique<WindowsProcessCollector>();
 }
 
@@ -182,7 +182,7 @@ private:
     ULONGLONG lastDiskSample_{0};
 };
 
-std::unique_ptr<ISystemCollector> createSystemCollector() {
+std::unique_ptr<ISystemCollector> createSystemCollector(const Configuration& /*config*/) {
     return std::make_unique<WindowsSystemCollector>();
 }
 
@@ -0,0 +1,47 @@
+#include "Recorder.h"
+#include <chrono>
+
+namespace sysmon {
+
+Recorder::Recorder(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder)
+    : dataCollector_(dataCollector), processBuilder_(processBuilder) {
+}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+bool Recorder::start(const std::string& path) {
+    if (!writer_.open(path)) {
+        return false;
+    }
+    
+    metricsSubscription_ = dataCollector_.subscribe([this](uint64_t) {
+        dataCollector_.getMetrics(metrics_);
+        writer_.appendMetrics(metrics_);
+    });
+    
+    processSubscription_ = processBuilder_.subscribe([this](uint64_t) {
+        // The tree carries no timestamp; stamp it when it is published
+        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        processBuilder_.getProcessList(processes_);
+        writer_.appendProcesses(static_cast<uint64_t>(now), processes_);
+    });
+    
+    return true;
+}
+
+void Recorder::stop() {
+    if (metricsSubscription_ != 0) {
+        dataCollector_.unsubscribe(metricsSubscription_);
+        metricsSubscription_ = 0;
+    }
+    if (processSubscription_ != 0) {
+        processBuilder_.unsubscribe(processSubscription_);
+        processSubscription_ = 0;
+    }
+    writer_.close();
+}
+
+} // namespace sysmon
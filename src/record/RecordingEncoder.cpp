@@ -0,0 +1,501 @@
+#include "RecordingFormat.h"
+#include <cmath>
+
+namespace sysmon {
+
+using namespace recording;
+
+namespace {
+    // u64 counters stored as deltas against the previous sample
+    constexpr uint64_t SystemMetrics::* COUNTER_COLUMNS[] = {
+        &SystemMetrics::totalMemoryBytes,
+        &SystemMetrics::usedMemoryBytes,
+        &SystemMetrics::diskReadBytesPerSec,
+        &SystemMetrics::diskWriteBytesPerSec,
+        &SystemMetrics::networkRecvBytesPerSec,
+        &SystemMetrics::networkSendBytesPerSec,
+    };
+    
+    // Process CPU is stored in hundredths of a percent
+    int64_t cpuCentiPercent(double percent) {
+        return std::llround(percent * 100.0);
+    }
+    
+    template <typename GetTimestamp>
+    void putTimestamps(std::string& out, size_t count, GetTimestamp timestampAt) {
+        int64_t previousDelta = 0;
+        for (size_t i = 1; i < count; ++i) {
+            int64_t delta = static_cast<int64_t>(timestampAt(i) - timestampAt(i - 1));
+            putVarint(out, zigzag(delta - previousDelta));
+            previousDelta = delta;
+        }
+    }
+    
+    // Bitmap of which rows differ from the previous snapshot, then values for those rows only
+    template <typename Changed, typename PutValue>
+    void putChangedColumn(std::string& out, size_t count, Changed changed, PutValue putValue) {
+        size_t bitmapOffset = out.size();
+        out.append((count + 7) / 8, '\0');
+        for (size_t i = 0; i < count; ++i) {
+            if (changed(i)) {
+                out[bitmapOffset + i / 8] = static_cast<char>(out[bitmapOffset + i / 8] | (1 << (i % 8)));
+                putValue(i);
+            }
+        }
+    }
+    
+    template <typename ReadValue, typename KeepValue>
+    void readChangedColumn(ByteReader& reader, size_t count, ReadValue readValue, KeepValue keepValue) {
+        const uint8_t* bitmap = reader.take((count + 7) / 8);
+        if (!bitmap) {
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if ((bitmap[i / 8] >> (i % 8)) & 1) {
+                readValue(i);
+            } else {
+                keepValue(i);
+            }
+        }
+    }
+    
+    void readTimestamps(ByteReader& reader, uint64_t first, size_t count, std::vector<uint64_t>& out) {
+        out.resize(count);
+        if (count == 0) {
+            return;
+        }
+        out[0] = first;
+        int64_t delta = 0;
+        for (size_t i = 1; i < count; ++i) {
+            delta += reader.signedVarint();
+            out[i] = out[i - 1] + static_cast<uint64_t>(delta);
+        }
+    }
+    
+    void putBlockHeader(char* dest, const BlockHeader& header) {
+        std::string bytes;
+        bytes.reserve(BLOCK_HEADER_SIZE);
+        putFixed<uint32_t>(bytes, BLOCK_MAGIC);
+        putFixed<uint8_t>(bytes, static_cast<uint8_t>(header.kind));
+        putFixed<uint8_t>(bytes, 0);
+        putFixed<uint16_t>(bytes, 0);
+        putFixed<uint32_t>(bytes, header.payloadBytes);
+        putFixed<uint32_t>(bytes, header.sampleCount);
+        putFixed<uint32_t>(bytes, header.columnCount);
+        putFixed<uint64_t>(bytes, header.firstTimestampMs);
+        putFixed<uint64_t>(bytes, header.lastTimestampMs);
+        std::memcpy(dest, bytes.data(), BLOCK_HEADER_SIZE);
+    }
+}
+
+namespace recording {
+
+void putProcessDelta(const std::vector<ProcessSummary>& previous, const std::vector<ProcessSummary>& current,
+                     std::string& out, ProcessDeltaScratch& scratch) {
+    // Merge-walk both pid-sorted lists: matched, removed and added processes
+    scratch.previousMatch.resize(current.size());
+    scratch.removedIndices.clear();
+    scratch.addedPids.clear();
+    size_t j = 0;
+    for (size_t i = 0; i < current.size(); ++i) {
+        while (j < previous.size() && previous[j].pid < current[i].pid) {
+            scratch.removedIndices.push_back(j++);
+        }
+        if (j < previous.size() && previous[j].pid == current[i].pid) {
+            scratch.previousMatch[i] = static_cast<int64_t>(j++);
+        } else {
+            scratch.previousMatch[i] = -1;
+            scratch.addedPids.push_back(current[i].pid);
+        }
+    }
+    while (j < previous.size()) {
+        scratch.removedIndices.push_back(j++);
+    }
+    auto match = [&](size_t i) -> const ProcessSummary* {
+        return scratch.previousMatch[i] >= 0 ? &previous[static_cast<size_t>(scratch.previousMatch[i])] : nullptr;
+    };
+    
+    putVarint(out, current.size());
+    putVarint(out, scratch.removedIndices.size());
+    size_t lastIndex = 0;
+    for (size_t index : scratch.removedIndices) {
+        putVarint(out, index - lastIndex);
+        lastIndex = index;
+    }
+    putVarint(out, scratch.addedPids.size());
+    uint32_t lastPid = 0;
+    for (uint32_t pid : scratch.addedPids) {
+        putVarint(out, pid - lastPid);
+        lastPid = pid;
+    }
+    
+    size_t n = current.size();
+    putChangedColumn(out, n,
+        [&](size_t i) { return !match(i) || match(i)->parentPid != current[i].parentPid; },
+        [&](size_t i) { putVarint(out, current[i].parentPid); });
+    putChangedColumn(out, n,
+        [&](size_t i) {
+            return !match(i) || cpuCentiPercent(match(i)->cpuPercent) != cpuCentiPercent(current[i].cpuPercent);
+        },
+        [&](size_t i) {
+            int64_t base = match(i) ? cpuCentiPercent(match(i)->cpuPercent) : 0;
+            putVarint(out, zigzag(cpuCentiPercent(current[i].cpuPercent) - base));
+        });
+    putChangedColumn(out, n,
+        [&](size_t i) { return !match(i) || match(i)->memoryBytes != current[i].memoryBytes; },
+        [&](size_t i) {
+            uint64_t base = match(i) ? match(i)->memoryBytes : 0;
+            putVarint(out, zigzag(static_cast<int64_t>(current[i].memoryBytes - base)));
+        });
+    putChangedColumn(out, n,
+        [&](size_t i) { return !match(i) || match(i)->creationTime != current[i].creationTime; },
+        [&](size_t i) {
+            uint64_t base = match(i) ? match(i)->creationTime : 0;
+            putVarint(out, zigzag(static_cast<int64_t>(current[i].creationTime - base)));
+        });
+    putChangedColumn(out, n,
+        [&](size_t i) { return !match(i) || match(i)->name != current[i].name; },
+        [&](size_t i) {
+            putVarint(out, current[i].name.size());
+            out += current[i].name;
+        });
+    putChangedColumn(out, n,
+        [&](size_t i) { return !match(i) || match(i)->uid != current[i].uid; },
+        [&](size_t i) { putVarint(out, static_cast<uint32_t>(current[i].uid + 1)); });   // Unknown is 0
+    putChangedColumn(out, n,
+        [&](size_t i) { return !match(i) || match(i)->cgroup != current[i].cgroup; },
+        [&](size_t i) {
+            putVarint(out, current[i].cgroup.size());
+            out += current[i].cgroup;
+        });
+}
+
+bool readProcessDelta(ByteReader& reader, const std::vector<ProcessSummary>& previous,
+                      std::vector<ProcessSummary>& current, ProcessDeltaScratch& scratch, uint32_t version) {
+    // At least five bitmap bits per process (seven since OWNER_COLUMNS_VERSION) bound a corrupt count
+    uint64_t processCount = reader.varint();
+    uint64_t removedCount = reader.varint();
+    if (processCount / 8 > reader.remaining() || removedCount > previous.size()) {
+        return false;
+    }
+    
+    scratch.removed.assign(previous.size(), false);
+    size_t index = 0;
+    for (uint64_t r = 0; r < removedCount; ++r) {
+        index += static_cast<size_t>(reader.varint());
+        if (index >= previous.size()) {
+            return false;
+        }
+        scratch.removed[index] = true;
+    }
+    uint64_t addedCount = reader.varint();
+    if (addedCount > processCount || previous.size() - removedCount + addedCount != processCount) {
+        return false;
+    }
+    scratch.addedPids.resize(static_cast<size_t>(addedCount));
+    uint32_t lastPid = 0;
+    for (auto& pid : scratch.addedPids) {
+        lastPid += static_cast<uint32_t>(reader.varint());
+        pid = lastPid;
+    }
+    
+    // Survivors of the previous snapshot merged with the added pids
+    current.resize(static_cast<size_t>(processCount));
+    scratch.previousMatch.resize(current.size());
+    size_t j = 0;
+    size_t k = 0;
+    for (size_t i = 0; i < current.size(); ++i) {
+        while (j < previous.size() && scratch.removed[j]) {
+            ++j;
+        }
+        if (j < previous.size() && (k == scratch.addedPids.size() || previous[j].pid < scratch.addedPids[k])) {
+            current[i].pid = previous[j].pid;
+            scratch.previousMatch[i] = static_cast<int64_t>(j++);
+        } else if (k < scratch.addedPids.size()) {
+            current[i].pid = scratch.addedPids[k++];
+            scratch.previousMatch[i] = -1;
+        } else {
+            return false;
+        }
+    }
+    auto match = [&](size_t i) -> const ProcessSummary* {
+        return scratch.previousMatch[i] >= 0 ? &previous[static_cast<size_t>(scratch.previousMatch[i])] : nullptr;
+    };
+    
+    size_t n = current.size();
+    readChangedColumn(reader, n,
+        [&](size_t i) { current[i].parentPid = static_cast<uint32_t>(reader.varint()); },
+        [&](size_t i) { current[i].parentPid = match(i) ? match(i)->parentPid : 0; });
+    readChangedColumn(reader, n,
+        [&](size_t i) {
+            int64_t basis = match(i) ? cpuCentiPercent(match(i)->cpuPercent) : 0;
+            current[i].cpuPercent = static_cast<double>(basis + reader.signedVarint()) / 100.0;
+        },
+        [&](size_t i) { current[i].cpuPercent = match(i) ? match(i)->cpuPercent : 0.0; });
+    readChangedColumn(reader, n,
+        [&](size_t i) {
+            uint64_t basis = match(i) ? match(i)->memoryBytes : 0;
+            current[i].memoryBytes = basis + static_cast<uint64_t>(reader.signedVarint());
+        },
+        [&](size_t i) { current[i].memoryBytes = match(i) ? match(i)->memoryBytes : 0; });
+    readChangedColumn(reader, n,
+        [&](size_t i) {
+            uint64_t basis = match(i) ? match(i)->creationTime : 0;
+            current[i].creationTime = basis + static_cast<uint64_t>(reader.signedVarint());
+        },
+        [&](size_t i) { current[i].creationTime = match(i) ? match(i)->creationTime : 0; });
+    readChangedColumn(reader, n,
+        [&](size_t i) { reader.bytes(current[i].name, static_cast<size_t>(reader.varint())); },
+        [&](size_t i) {
+            if (match(i)) {
+                current[i].name = match(i)->name;
+            } else {
+                current[i].name.clear();
+            }
+        });
+    if (version < OWNER_COLUMNS_VERSION) {
+        for (auto& process : current) {
+            process.uid = ProcessSummary::UNKNOWN_UID;
+            process.cgroup.clear();
+        }
+        return reader.ok();
+    }
+    readChangedColumn(reader, n,
+        [&](size_t i) { current[i].uid = static_cast<uint32_t>(reader.varint() - 1); },
+        [&](size_t i) { current[i].uid = match(i) ? match(i)->uid : ProcessSummary::UNKNOWN_UID; });
+    readChangedColumn(reader, n,
+        [&](size_t i) { reader.bytes(current[i].cgroup, static_cast<size_t>(reader.varint())); },
+        [&](size_t i) {
+            if (match(i)) {
+                current[i].cgroup = match(i)->cgroup;
+            } else {
+                current[i].cgroup.clear();
+            }
+        });
+    return reader.ok();
+}
+
+} // namespace recording
+
+void RecordingEncoder::addMetrics(const SystemMetrics& metrics, std::string& out) {
+    // A block has a fixed core count; hotplug starts a new one
+    if (systemSampleCount_ > 0 &&
+        systemSamples_[0].perCoreCpuUsage.size() != metrics.perCoreCpuUsage.size()) {
+        flushSystem(out);
+    }
+    
+    if (systemSampleCount_ == systemSamples_.size()) {
+        systemSamples_.emplace_back();
+    }
+    systemSamples_[systemSampleCount_++] = metrics;
+    
+    if (systemSampleCount_ == SYSTEM_SAMPLES_PER_BLOCK) {
+        flushSystem(out);
+    }
+}
+
+void RecordingEncoder::addProcesses(uint64_t timestampMs, const std::vector<ProcessSummary>& processes,
+                                    std::string& out) {
+    if (processSnapshotCount_ == processSnapshots_.size()) {
+        processSnapshots_.emplace_back();
+    }
+    ProcessSnapshot& snapshot = processSnapshots_[processSnapshotCount_++];
+    snapshot.timestampMs = timestampMs;
+    snapshot.processes = processes;
+    
+    if (processSnapshotCount_ == PROCESS_SNAPSHOTS_PER_BLOCK) {
+        flushProcesses(out);
+    }
+}
+
+void RecordingEncoder::flush(std::string& out) {
+    flushSystem(out);
+    flushProcesses(out);
+}
+
+void RecordingEncoder::beginBlock(std::string& out, size_t& headerOffset) const {
+    headerOffset = out.size();
+    out.append(BLOCK_HEADER_SIZE, '\0');
+}
+
+void RecordingEncoder::finishBlock(std::string& out, size_t headerOffset, const BlockHeader& header) {
+    BlockHeader complete = header;
+    complete.payloadBytes = static_cast<uint32_t>(out.size() - headerOffset - BLOCK_HEADER_SIZE);
+    putBlockHeader(&out[headerOffset], complete);
+    
+    IndexEntry entry;
+    entry.offset = bytesEncoded_;
+    entry.kind = complete.kind;
+    entry.sampleCount = complete.sampleCount;
+    entry.firstTimestampMs = complete.firstTimestampMs;
+    entry.lastTimestampMs = complete.lastTimestampMs;
+    index_.push_back(entry);
+    
+    bytesEncoded_ += BLOCK_HEADER_SIZE + complete.payloadBytes;
+}
+
+void RecordingEncoder::flushSystem(std::string& out) {
+    size_t count = systemSampleCount_;
+    if (count == 0) {
+        return;
+    }
+    
+    const auto& samples = systemSamples_;
+    size_t cores = samples[0].perCoreCpuUsage.size();
+    
+    BlockHeader header;
+    header.kind = BlockKind::System;
+    header.sampleCount = static_cast<uint32_t>(count);
+    header.columnCount = static_cast<uint32_t>(cores);
+    header.firstTimestampMs = samples[0].timestampMs;
+    header.lastTimestampMs = samples[count - 1].timestampMs;
+    
+    size_t headerOffset;
+    beginBlock(out, headerOffset);
+    
+    putTimestamps(out, count, [&](size_t i) { return samples[i].timestampMs; });
+    
+    double previous = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        putXorDouble(out, previous, samples[i].cpuUsagePercent);
+        previous = samples[i].cpuUsagePercent;
+    }
+    previous = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        putXorDouble(out, previous, samples[i].memoryUsagePercent);
+        previous = samples[i].memoryUsagePercent;
+    }
+    for (size_t core = 0; core < cores; ++core) {
+        previous = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            double value = samples[i].perCoreCpuUsage[core];
+            putXorDouble(out, previous, value);
+            previous = value;
+        }
+    }
+    for (auto column : COUNTER_COLUMNS) {
+        uint64_t last = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t value = samples[i].*column;
+            putVarint(out, zigzag(static_cast<int64_t>(value - last)));
+            last = value;
+        }
+    }
+    
+    finishBlock(out, headerOffset, header);
+    systemSampleCount_ = 0;
+}
+
+void RecordingEncoder::flushProcesses(std::string& out) {
+    size_t count = processSnapshotCount_;
+    if (count == 0) {
+        return;
+    }
+    
+    const auto& snapshots = processSnapshots_;
+    
+    BlockHeader header;
+    header.kind = BlockKind::Processes;
+    header.sampleCount = static_cast<uint32_t>(count);
+    header.firstTimestampMs = snapshots[0].timestampMs;
+    header.lastTimestampMs = snapshots[count - 1].timestampMs;
+    
+    size_t headerOffset;
+    beginBlock(out, headerOffset);
+    
+    putTimestamps(out, count, [&](size_t i) { return snapshots[i].timestampMs; });
+    
+    static const std::vector<ProcessSummary> EMPTY;
+    for (size_t s = 0; s < count; ++s) {
+        putProcessDelta(s > 0 ? snapshots[s - 1].processes : EMPTY, snapshots[s].processes, out, processScratch_);
+    }
+    
+    finishBlock(out, headerOffset, header);
+    processSnapshotCount_ = 0;
+}
+
+bool decodeSystemBlock(const BlockHeader& header, const uint8_t* payload,
+                       std::vector<SystemMetrics>& out) {
+    ByteReader reader(payload, header.payloadBytes);
+    size_t count = header.sampleCount;
+    size_t cores = header.columnCount;
+    
+    // Every value takes at least one byte, which bounds corrupt counts
+    if (count > header.payloadBytes || cores * count > header.payloadBytes) {
+        return false;
+    }
+    size_t base = out.size();
+    out.resize(base + count);
+    
+    std::vector<uint64_t> timestamps;
+    readTimestamps(reader, header.firstTimestampMs, count, timestamps);
+    for (size_t i = 0; i < count; ++i) {
+        out[base + i].timestampMs = timestamps[i];
+        out[base + i].perCoreCpuUsage.resize(cores);
+    }
+    
+    double previous = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        previous = reader.xorDouble(previous);
+        out[base + i].cpuUsagePercent = previous;
+    }
+    previous = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        previous = reader.xorDouble(previous);
+        out[base + i].memoryUsagePercent = previous;
+    }
+    for (size_t core = 0; core < cores; ++core) {
+        previous = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            previous = reader.xorDouble(previous);
+            out[base + i].perCoreCpuUsage[core] = previous;
+        }
+    }
+    for (auto column : COUNTER_COLUMNS) {
+        uint64_t last = 0;
+        for (size_t i = 0; i < count; ++i) {
+            last += static_cast<uint64_t>(reader.signedVarint());
+            out[base + i].*column = last;
+        }
+    }
+    
+    if (!reader.ok()) {
+        out.resize(base);
+        return false;
+    }
+    return true;
+}
+
+bool decodeProcessBlock(const BlockHeader& header, const uint8_t* payload,
+                        std::vector<ProcessSnapshot>& out, uint32_t version) {
+    ByteReader reader(payload, header.payloadBytes);
+    size_t count = header.sampleCount;
+    if (count > header.payloadBytes) {
+        return false;
+    }
+    size_t base = out.size();
+    out.resize(base + count);
+    
+    std::vector<uint64_t> timestamps;
+    readTimestamps(reader, header.firstTimestampMs, count, timestamps);
+    
+    static const std::vector<ProcessSummary> EMPTY;
+    ProcessDeltaScratch scratch;
+    for (size_t s = 0; s < count && reader.ok(); ++s) {
+        ProcessSnapshot& snapshot = out[base + s];
+        snapshot.timestampMs = timestamps[s];
+        if (!readProcessDelta(reader, s > 0 ? out[base + s - 1].processes : EMPTY, snapshot.processes, scratch,
+                              version)) {
+            out.resize(base);
+            return false;
+        }
+    }
+    
+    if (!reader.ok()) {
+        out.resize(base);
+        return false;
+    }
+    return true;
+}
+
+} // namespace sysmon
@@ -0,0 +1,253 @@
+#include "RecordingReader.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+using namespace recording;
+
+namespace {
+    // Overlapping blocks of one kind, found by binary search on lastTimestampMs
+    template <typename DecodeBlock>
+    void forEachBlockInRange(const std::vector<IndexEntry>& index, uint64_t fromMs, uint64_t toMs,
+                             DecodeBlock decode) {
+        auto it = std::lower_bound(index.begin(), index.end(), fromMs,
+                                   [](const IndexEntry& entry, uint64_t time) {
+                                       return entry.lastTimestampMs < time;
+                                   });
+        for (; it != index.end() && it->firstTimestampMs <= toMs; ++it) {
+            decode(*it);
+        }
+    }
+}
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+bool RecordingReader::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    contents_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data_ = contents_.data();
+    size_ = contents_.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(FILE_HEADER_SIZE)) {
+        ::close(fd);
+        return false;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        size_ = 0;
+        return false;
+    }
+    data_ = static_cast<const uint8_t*>(mapping);
+#endif
+
+    if (size_ < FILE_HEADER_SIZE || std::memcmp(data_, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+        close();
+        return false;
+    }
+    ByteReader header(data_ + sizeof(FILE_MAGIC), FILE_HEADER_SIZE - sizeof(FILE_MAGIC));
+    version_ = header.fixed<uint32_t>();
+    if (version_ > FORMAT_VERSION) {
+        close();
+        return false;
+    }
+    
+    if (!loadIndex()) {
+        rebuildIndex();
+    }
+    return true;
+}
+
+void RecordingReader::close() {
+#ifdef _WIN32
+    contents_.clear();
+#else
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    version_ = 0;
+    recovered_ = false;
+    systemIndex_.clear();
+    processIndex_.clear();
+}
+
+uint64_t RecordingReader::firstTimestampMs() const {
+    uint64_t first = 0;
+    for (const auto* index : {&systemIndex_, &processIndex_}) {
+        if (!index->empty() && (first == 0 || index->front().firstTimestampMs < first)) {
+            first = index->front().firstTimestampMs;
+        }
+    }
+    return first;
+}
+
+uint64_t RecordingReader::lastTimestampMs() const {
+    uint64_t last = 0;
+    for (const auto* index : {&systemIndex_, &processIndex_}) {
+        if (!index->empty()) {
+            last = std::max(last, index->back().lastTimestampMs);
+        }
+    }
+    return last;
+}
+
+size_t RecordingReader::readMetrics(uint64_t fromMs, uint64_t toMs,
+                                    std::vector<SystemMetrics>& out) const {
+    size_t before = out.size();
+    std::vector<SystemMetrics> block;
+    forEachBlockInRange(systemIndex_, fromMs, toMs, [&](const IndexEntry& entry) {
+        BlockHeader header;
+        if (!readBlockHeader(entry.offset, header)) {
+            return;
+        }
+        block.clear();
+        if (!decodeSystemBlock(header, data_ + entry.offset + BLOCK_HEADER_SIZE, block)) {
+            return;
+        }
+        for (auto& sample : block) {
+            if (sample.timestampMs >= fromMs && sample.timestampMs <= toMs) {
+                out.push_back(std::move(sample));
+            }
+        }
+    });
+    return out.size() - before;
+}
+
+size_t RecordingReader::readProcesses(uint64_t fromMs, uint64_t toMs,
+                                      std::vector<ProcessSnapshot>& out) const {
+    size_t before = out.size();
+    std::vector<ProcessSnapshot> block;
+    forEachBlockInRange(processIndex_, fromMs, toMs, [&](const IndexEntry& entry) {
+        BlockHeader header;
+        if (!readBlockHeader(entry.offset, header)) {
+            return;
+        }
+        block.clear();
+        if (!decodeProcessBlock(header, data_ + entry.offset + BLOCK_HEADER_SIZE, block, version_)) {
+            return;
+        }
+        for (auto& snapshot : block) {
+            if (snapshot.timestampMs >= fromMs && snapshot.timestampMs <= toMs) {
+                out.push_back(std::move(snapshot));
+            }
+        }
+    });
+    return out.size() - before;
+}
+
+bool RecordingReader::loadIndex() {
+    if (size_ < FILE_HEADER_SIZE + TRAILER_SIZE) {
+        return false;
+    }
+    
+    const uint8_t* trailer = data_ + size_ - TRAILER_SIZE;
+    if (std::memcmp(trailer + 16, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0) {
+        return false;
+    }
+    
+    ByteReader reader(trailer, TRAILER_SIZE);
+    uint64_t indexOffset = reader.fixed<uint64_t>();
+    uint32_t entryCount = reader.fixed<uint32_t>();
+    if (indexOffset < FILE_HEADER_SIZE ||
+        indexOffset + static_cast<uint64_t>(entryCount) * INDEX_ENTRY_SIZE != size_ - TRAILER_SIZE) {
+        return false;
+    }
+    
+    ByteReader entries(data_ + indexOffset, static_cast<size_t>(entryCount) * INDEX_ENTRY_SIZE);
+    for (uint32_t i = 0; i < entryCount; ++i) {
+        IndexEntry entry;
+        entry.offset = entries.fixed<uint64_t>();
+        entry.kind = static_cast<BlockKind>(entries.fixed<uint8_t>());
+        entries.skip(3);
+        entry.sampleCount = entries.fixed<uint32_t>();
+        entry.firstTimestampMs = entries.fixed<uint64_t>();
+        entry.lastTimestampMs = entries.fixed<uint64_t>();
+        if (entry.offset + BLOCK_HEADER_SIZE > indexOffset) {
+            systemIndex_.clear();
+            processIndex_.clear();
+            return false;
+        }
+        addToIndex(entry);
+    }
+    return entries.ok();
+}
+
+void RecordingReader::rebuildIndex() {
+    recovered_ = true;
+    systemIndex_.clear();
+    processIndex_.clear();
+    
+    // Walk block headers; a torn final block ends the scan
+    uint64_t offset = FILE_HEADER_SIZE;
+    BlockHeader header;
+    while (readBlockHeader(offset, header)) {
+        IndexEntry entry;
+        entry.offset = offset;
+        entry.kind = header.kind;
+        entry.sampleCount = header.sampleCount;
+        entry.firstTimestampMs = header.firstTimestampMs;
+        entry.lastTimestampMs = header.lastTimestampMs;
+        addToIndex(entry);
+        offset += BLOCK_HEADER_SIZE + header.payloadBytes;
+    }
+}
+
+bool RecordingReader::readBlockHeader(uint64_t offset, BlockHeader& header) const {
+    if (offset + BLOCK_HEADER_SIZE > size_) {
+        return false;
+    }
+    
+    ByteReader reader(data_ + offset, BLOCK_HEADER_SIZE);
+    if (reader.fixed<uint32_t>() != BLOCK_MAGIC) {
+        return false;
+    }
+    header.kind = static_cast<BlockKind>(reader.fixed<uint8_t>());
+    reader.skip(3);
+    header.payloadBytes = reader.fixed<uint32_t>();
+    header.sampleCount = reader.fixed<uint32_t>();
+    header.columnCount = reader.fixed<uint32_t>();
+    header.firstTimestampMs = reader.fixed<uint64_t>();
+    header.lastTimestampMs = reader.fixed<uint64_t>();
+    
+    return reader.ok() &&
+           (header.kind == BlockKind::System || header.kind == BlockKind::Processes) &&
+           offset + BLOCK_HEADER_SIZE + header.payloadBytes <= size_;
+}
+
+void RecordingReader::addToIndex(const IndexEntry& entry) {
+    if (entry.kind == BlockKind::System) {
+        systemIndex_.push_back(entry);
+    } else if (entry.kind == BlockKind::Processes) {
+        processIndex_.push_back(entry);
+    }
+}
+
+} // namespace sysmon
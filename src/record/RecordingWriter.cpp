@@ -0,0 +1,163 @@
+#include "RecordingWriter.h"
+#include <algorithm>
+#include <utility>
+
+namespace sysmon {
+
+using namespace recording;
+
+namespace {
+    // Queued samples kept while the disk is slow before new ones are dropped
+    constexpr size_t MAX_QUEUED_METRICS = 4096;
+    constexpr size_t MAX_QUEUED_SNAPSHOTS = 64;
+}
+
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+bool RecordingWriter::open(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+    
+    buffer_.clear();
+    buffer_.append(FILE_MAGIC, sizeof(FILE_MAGIC));
+    putFixed<uint32_t>(buffer_, FORMAT_VERSION);
+    putFixed<uint32_t>(buffer_, 0);
+    writeBuffer();
+    
+    running_ = true;
+    writerThread_ = std::thread(&RecordingWriter::writerLoop, this);
+    return true;
+}
+
+void RecordingWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        running_ = false;
+    }
+    queueCv_.notify_all();
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+    
+    if (file_) {
+        encoder_.flush(buffer_);
+        writeBuffer();
+        writeIndex();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void RecordingWriter::appendMetrics(const SystemMetrics& metrics) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (!running_ || pending_.metricsCount >= MAX_QUEUED_METRICS) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (pending_.metricsCount == pending_.metrics.size()) {
+            pending_.metrics.emplace_back();
+        }
+        pending_.metrics[pending_.metricsCount++] = metrics;
+    }
+    queueCv_.notify_one();
+}
+
+void RecordingWriter::appendProcesses(uint64_t timestampMs, const std::vector<ProcessSummary>& processes) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (!running_ || pending_.processCount >= MAX_QUEUED_SNAPSHOTS) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (pending_.processCount == pending_.processes.size()) {
+            pending_.processes.emplace_back();
+        }
+        ProcessSnapshot& snapshot = pending_.processes[pending_.processCount++];
+        snapshot.timestampMs = timestampMs;
+        snapshot.processes = processes;
+    }
+    queueCv_.notify_one();
+}
+
+void RecordingWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    while (true) {
+        queueCv_.wait(lock, [this] {
+            return !running_ || pending_.metricsCount > 0 || pending_.processCount > 0;
+        });
+        bool stopping = !running_;
+        
+        // Swapping keeps both queues' slots allocated for reuse
+        std::swap(pending_, draining_);
+        lock.unlock();
+        
+        drain(draining_);
+        
+        lock.lock();
+        if (stopping && pending_.metricsCount == 0 && pending_.processCount == 0) {
+            break;
+        }
+    }
+}
+
+void RecordingWriter::drain(Queue& queue) {
+    for (size_t i = 0; i < queue.metricsCount; ++i) {
+        encoder_.addMetrics(queue.metrics[i], buffer_);
+    }
+    for (size_t i = 0; i < queue.processCount; ++i) {
+        auto& processes = queue.processes[i].processes;
+        auto byPid = [](const ProcessSummary& a, const ProcessSummary& b) { return a.pid < b.pid; };
+        if (!std::is_sorted(processes.begin(), processes.end(), byPid)) {
+            std::sort(processes.begin(), processes.end(), byPid);
+        }
+        encoder_.addProcesses(queue.processes[i].timestampMs, processes, buffer_);
+    }
+    
+    samplesWritten_.fetch_add(queue.metricsCount + queue.processCount, std::memory_order_relaxed);
+    queue.metricsCount = 0;
+    queue.processCount = 0;
+    
+    // Blocks only appear once full, so most drains write nothing
+    if (!buffer_.empty()) {
+        writeBuffer();
+    }
+}
+
+void RecordingWriter::writeBuffer() {
+    if (buffer_.empty()) {
+        return;
+    }
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fflush(file_);
+    bytesWritten_.fetch_add(buffer_.size(), std::memory_order_relaxed);
+    buffer_.clear();
+}
+
+void RecordingWriter::writeIndex() {
+    uint64_t indexOffset = bytesWritten();
+    const auto& entries = encoder_.index();
+    
+    // Encoder offsets are relative to the first block, which follows the file header
+    for (const auto& entry : entries) {
+        putFixed<uint64_t>(buffer_, entry.offset + FILE_HEADER_SIZE);
+        putFixed<uint8_t>(buffer_, static_cast<uint8_t>(entry.kind));
+        putFixed<uint8_t>(buffer_, 0);
+        putFixed<uint16_t>(buffer_, 0);
+        putFixed<uint32_t>(buffer_, entry.sampleCount);
+        putFixed<uint64_t>(buffer_, entry.firstTimestampMs);
+        putFixed<uint64_t>(buffer_, entry.lastTimestampMs);
+    }
+    
+    putFixed<uint64_t>(buffer_, indexOffset);
+    putFixed<uint32_t>(buffer_, static_cast<uint32_t>(entries.size()));
+    putFixed<uint32_t>(buffer_, 0);
+    buffer_.append(TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+    writeBuffer();
+}
+
+} // namespace sysmon
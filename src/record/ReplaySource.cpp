@@ -0,0 +1,230 @@
+#include "ReplaySource.h"
+#include <algorithm>
+#include <thread>
+
+namespace sysmon {
+
+using namespace recording;
+
+namespace {
+    // Recording time decoded per refill; about one encoder block of each kind
+    constexpr uint64_t METRICS_CHUNK_MS = 120 * 1000;
+    constexpr uint64_t PROCESSES_CHUNK_MS = 128 * 1000;
+    
+    // Used when a stream has too few samples to measure its spacing
+    constexpr uint32_t DEFAULT_METRICS_CADENCE_MS = 1000;
+    constexpr uint32_t DEFAULT_PROCESSES_CADENCE_MS = 2000;
+    
+    // Max-speed replay that has run out of samples backs off instead of spinning
+    constexpr auto EXHAUSTED_POLL = std::chrono::milliseconds(100);
+    
+    template <typename Sample>
+    uint32_t medianSpacingMs(const std::vector<Sample>& samples) {
+        if (samples.size() < 2) {
+            return 0;
+        }
+        std::vector<uint64_t> spacing;
+        spacing.reserve(samples.size() - 1);
+        for (size_t i = 1; i < samples.size(); ++i) {
+            spacing.push_back(samples[i].timestampMs - samples[i - 1].timestampMs);
+        }
+        std::nth_element(spacing.begin(), spacing.begin() + spacing.size() / 2, spacing.end());
+        return static_cast<uint32_t>(spacing[spacing.size() / 2]);
+    }
+    
+    uint32_t scaledInterval(uint32_t cadenceMs, double speed) {
+        if (speed == ReplaySource::MAX_SPEED) {
+            return 0;
+        }
+        return std::max<uint32_t>(1, static_cast<uint32_t>(cadenceMs / speed));
+    }
+    
+    /**
+     * @brief ISystemCollector that republishes recorded samples
+     *
+     * The CPU call advances the stream; the other sources report from the
+     * same sample, so replay needs all four intervals equal (applyIntervals).
+     */
+    class ReplaySystemCollector : public ISystemCollector {
+    public:
+        explicit ReplaySystemCollector(std::shared_ptr<ReplaySource> source)
+            : source_(std::move(source)) {}
+        
+        void collectCPUMetrics(SystemMetrics& metrics) override {
+            source_->nextMetrics(current_);
+            metrics.timestampMs = current_.timestampMs;
+            metrics.cpuUsagePercent = current_.cpuUsagePercent;
+            metrics.perCoreCpuUsage = current_.perCoreCpuUsage;
+        }
+        
+        void collectMemoryMetrics(SystemMetrics& metrics) override {
+            metrics.totalMemoryBytes = current_.totalMemoryBytes;
+            metrics.usedMemoryBytes = current_.usedMemoryBytes;
+            metrics.memoryUsagePercent = current_.memoryUsagePercent;
+        }
+        
+        void collectDiskMetrics(SystemMetrics& metrics) override {
+            metrics.diskReadBytesPerSec = current_.diskReadBytesPerSec;
+            metrics.diskWriteBytesPerSec = current_.diskWriteBytesPerSec;
+        }
+        
+        void collectNetworkMetrics(SystemMetrics& metrics) override {
+            metrics.networkRecvBytesPerSec = current_.networkRecvBytesPerSec;
+            metrics.networkSendBytesPerSec = current_.networkSendBytesPerSec;
+        }
+        
+        bool initialize() override { return true; }
+        void shutdown() override {}
+        
+    private:
+        std::shared_ptr<ReplaySource> source_;
+        SystemMetrics current_;
+    };
+    
+    /**
+     * @brief IProcessCollector that re-enumerates recorded snapshots
+     */
+    class ReplayProcessCollector : public IProcessCollector {
+    public:
+        explicit ReplayProcessCollector(std::shared_ptr<ReplaySource> source)
+            : source_(std::move(source)) {}
+        
+        void enumerateProcesses(ProcessTable& out) override {
+            source_->nextProcesses(current_);
+            out.addAll(current_);
+        }
+        
+        // Recorded processes are not ours to signal
+        bool terminateProcess(uint32_t /*pid*/) override { return false; }
+        
+        bool initialize() override { return true; }
+        void shutdown() override {}
+        
+    private:
+        std::shared_ptr<ReplaySource> source_;
+        std::vector<ProcessSummary> current_;
+    };
+}
+
+bool ReplaySource::open(const std::string& path, double speed) {
+    if (!reader_.open(path)) {
+        return false;
+    }
+    firstTimestampMs_ = reader_.firstTimestampMs();
+    lastTimestampMs_ = reader_.lastTimestampMs();
+    if (lastTimestampMs_ == 0) {
+        return false;
+    }
+    speed_ = speed;
+    
+    rewind(metrics_, METRICS_CHUNK_MS, [this](uint64_t from, uint64_t to, std::vector<SystemMetrics>& out) {
+        reader_.readMetrics(from, to, out);
+    });
+    rewind(processes_, PROCESSES_CHUNK_MS, [this](uint64_t from, uint64_t to, std::vector<ProcessSnapshot>& out) {
+        reader_.readProcesses(from, to, out);
+    });
+    
+    startTime_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+void ReplaySource::applyIntervals(Configuration& config) const {
+    uint32_t metricsMs = scaledInterval(metrics_.cadenceMs ? metrics_.cadenceMs : DEFAULT_METRICS_CADENCE_MS, speed_);
+    config.cpuSampleIntervalMs = metricsMs;
+    config.memorySampleIntervalMs = metricsMs;
+    config.diskSampleIntervalMs = metricsMs;
+    config.networkSampleIntervalMs = metricsMs;
+    config.processSampleIntervalMs =
+        scaledInterval(processes_.cadenceMs ? processes_.cadenceMs : DEFAULT_PROCESSES_CADENCE_MS, speed_);
+    config.adaptiveSampling = false;
+    config.cpuBudgetPercent = 0.0;
+}
+
+bool ReplaySource::nextMetrics(SystemMetrics& current) {
+    return advance(metrics_, [this](uint64_t from, uint64_t to, std::vector<SystemMetrics>& out) {
+        reader_.readMetrics(from, to, out);
+    }, current);
+}
+
+bool ReplaySource::nextProcesses(std::vector<ProcessSummary>& current) {
+    bool advanced = advance(processes_, [this](uint64_t from, uint64_t to, std::vector<ProcessSnapshot>& out) {
+        reader_.readProcesses(from, to, out);
+    }, snapshot_);
+    if (advanced) {
+        current.swap(snapshot_.processes);
+    }
+    return advanced;
+}
+
+uint64_t ReplaySource::targetTimestampMs() const {
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime_);
+    return firstTimestampMs_ + static_cast<uint64_t>(elapsed.count() * speed_);
+}
+
+template <typename Sample, typename Load>
+void ReplaySource::rewind(Cursor<Sample>& cursor, uint64_t chunkMs, Load load) {
+    cursor.chunk.clear();
+    cursor.next = 0;
+    cursor.nextLoadMs = firstTimestampMs_;
+    cursor.chunkMs = chunkMs;
+    cursor.cadenceMs = 0;
+    cursor.replayed.store(0, std::memory_order_relaxed);
+    cursor.exhausted.store(!refill(cursor, load), std::memory_order_release);
+    cursor.cadenceMs = medianSpacingMs(cursor.chunk);
+}
+
+template <typename Sample, typename Load>
+bool ReplaySource::refill(Cursor<Sample>& cursor, Load load) {
+    cursor.chunk.clear();
+    cursor.next = 0;
+    
+    // Skip over gaps in the recording until a range yields samples
+    while (cursor.chunk.empty() && cursor.nextLoadMs <= lastTimestampMs_) {
+        uint64_t to = cursor.nextLoadMs + cursor.chunkMs - 1;
+        load(cursor.nextLoadMs, to, cursor.chunk);
+        cursor.nextLoadMs = to + 1;
+    }
+    return !cursor.chunk.empty();
+}
+
+template <typename Sample, typename Load>
+bool ReplaySource::advance(Cursor<Sample>& cursor, Load load, Sample& current) {
+    if (cursor.exhausted.load(std::memory_order_relaxed)) {
+        if (speed_ == MAX_SPEED) {
+            std::this_thread::sleep_for(EXHAUSTED_POLL);
+        }
+        return false;
+    }
+    
+    // Timed replay catches up to the clock, skipping samples the polling missed
+    uint64_t target = speed_ == MAX_SPEED ? 0 : targetTimestampMs();
+    bool advanced = false;
+    while (true) {
+        if (cursor.next == cursor.chunk.size() && !refill(cursor, load)) {
+            cursor.exhausted.store(true, std::memory_order_release);
+            break;
+        }
+        Sample& sample = cursor.chunk[cursor.next];
+        if (speed_ != MAX_SPEED && sample.timestampMs > target) {
+            break;
+        }
+        current = std::move(sample);
+        ++cursor.next;
+        cursor.replayed.fetch_add(1, std::memory_order_relaxed);
+        advanced = true;
+        if (speed_ == MAX_SPEED) {
+            break;
+        }
+    }
+    return advanced;
+}
+
+std::unique_ptr<ISystemCollector> createReplaySystemCollector(std::shared_ptr<ReplaySource> source) {
+    return std::make_unique<ReplaySystemCollector>(std::move(source));
+}
+
+std::unique_ptr<IProcessCollector> createReplayProcessCollector(std::shared_ptr<ReplaySource> source) {
+    return std::make_unique<ReplayProcessCollector>(std::move(source));
+}
+
+} // namespace sysmon
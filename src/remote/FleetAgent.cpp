@@ -0,0 +1,235 @@
+#include "FleetAgent.h"
+#include "TcpSocket.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+    // Reconnect delays double from the first to the last
+    constexpr auto FIRST_RETRY_DELAY = std::chrono::milliseconds(500);
+    constexpr auto MAX_RETRY_DELAY = std::chrono::seconds(30);
+    
+    // Bounds both connect() and a send to an aggregator that stopped reading
+    constexpr int SOCKET_TIMEOUT_SEC = 5;
+}
+
+FleetAgent::FleetAgent(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder)
+    : dataCollector_(dataCollector), processBuilder_(processBuilder) {
+}
+
+FleetAgent::~FleetAgent() {
+    stop();
+}
+
+#ifdef _WIN32
+
+bool FleetAgent::start(const std::string& /*aggregatorAddress*/, const std::string& /*hostName*/,
+                       size_t /*topProcesses*/) {
+    std::cerr << "--agent is not supported on this platform\n";
+    return false;
+}
+
+void FleetAgent::stop() {
+}
+
+#else
+
+bool FleetAgent::start(const std::string& aggregatorAddress, const std::string& hostName, size_t topProcesses) {
+    std::string host, port;
+    if (!net::splitHostPort(aggregatorAddress, host, port) || host.empty()) {
+        std::cerr << "Invalid aggregator address: " << aggregatorAddress << " (expected host:port)\n";
+        return false;
+    }
+    
+    hostName_ = hostName;
+    if (hostName_.empty()) {
+        char buffer[256] = {};
+        if (gethostname(buffer, sizeof(buffer) - 1) == 0) {
+            hostName_ = buffer;
+        }
+        if (hostName_.empty()) {
+            hostName_ = "localhost";
+        }
+    }
+    hostName_.resize(std::min(hostName_.size(), stream::MAX_HOST_NAME_BYTES));
+    address_ = aggregatorAddress;
+    topProcesses_ = topProcesses;
+    sentProcesses_.reserve(topProcesses_);
+    processes_.reserve(topProcesses_);
+    
+    auto wake = [this](uint64_t) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = true;
+        }
+        wakeCv_.notify_one();
+    };
+    metricsSubscription_ = dataCollector_.subscribe(wake);
+    if (topProcesses_ > 0) {
+        processSubscription_ = processBuilder_.subscribe(wake);
+    }
+    
+    running_ = true;
+    senderThread_ = std::thread(&FleetAgent::senderLoop, this);
+    return true;
+}
+
+void FleetAgent::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    
+    dataCollector_.unsubscribe(metricsSubscription_);
+    if (processSubscription_ != 0) {
+        processBuilder_.unsubscribe(processSubscription_);
+    }
+    metricsSubscription_ = processSubscription_ = 0;
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = true;
+    }
+    wakeCv_.notify_one();
+    
+    // Unblocks a send stuck on a full socket buffer
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (fd_ >= 0) {
+            shutdown(fd_, SHUT_RDWR);
+        }
+    }
+    if (senderThread_.joinable()) {
+        senderThread_.join();
+    }
+    disconnect();
+}
+
+void FleetAgent::senderLoop() {
+    auto retryDelay = std::chrono::duration_cast<std::chrono::milliseconds>(FIRST_RETRY_DELAY);
+    bool reportedFailure = false;
+    
+    while (running_) {
+        if (fd_ < 0) {
+            std::string error;
+            if (!connectToAggregator(error)) {
+                if (!reportedFailure) {
+                    std::cerr << "Cannot reach aggregator " << address_ << ": " << error << "; retrying\n";
+                    reportedFailure = true;
+                }
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeCv_.wait_for(lock, retryDelay, [this] { return !running_; });
+                retryDelay = std::min<std::chrono::milliseconds>(retryDelay * 2, MAX_RETRY_DELAY);
+                continue;
+            }
+            if (reportedFailure) {
+                std::cerr << "Connected to aggregator " << address_ << "\n";
+                reportedFailure = false;
+            }
+            retryDelay = FIRST_RETRY_DELAY;
+        } else {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeCv_.wait(lock, [this] { return pending_; });
+            pending_ = false;
+        }
+        
+        if (running_ && !sendUpdate()) {
+            if (running_) {
+                std::cerr << "Lost connection to aggregator " << address_ << "; reconnecting\n";
+                reportedFailure = true;
+            }
+            disconnect();
+        }
+    }
+}
+
+bool FleetAgent::connectToAggregator(std::string& error) {
+    int fd = net::connectTcp(address_, SOCKET_TIMEOUT_SEC, error);
+    if (fd < 0) {
+        return false;
+    }
+    fd_ = fd;
+    connects_.fetch_add(1, std::memory_order_relaxed);
+    
+    // A new connection starts from empty bases on both ends
+    sentMetricsVersion_ = sentProcessVersion_ = 0;
+    sentMetrics_ = SystemMetrics{};
+    sentProcesses_.clear();
+    
+    outbox_.clear();
+    stream::appendAgentHelloFrame(outbox_, hostName_);
+    if (!sendAll(outbox_)) {
+        error = std::strerror(errno);
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+bool FleetAgent::sendUpdate() {
+    outbox_.clear();
+    
+    uint64_t metricsVersion = dataCollector_.getVersion();
+    if (metricsVersion != 0 && metricsVersion != sentMetricsVersion_) {
+        dataCollector_.getMetrics(metrics_);
+        stream::appendMetricsFrame(sentMetrics_, metrics_, outbox_);
+        std::swap(sentMetrics_, metrics_);
+        sentMetricsVersion_ = metricsVersion;
+    }
+    
+    uint64_t processVersion = topProcesses_ > 0 ? processBuilder_.getVersion() : 0;
+    if (processVersion != 0 && processVersion != sentProcessVersion_) {
+        processBuilder_.getTopProcesses(topProcesses_, processes_);
+        // Process deltas need both lists in pid order
+        std::sort(processes_.begin(), processes_.end(),
+                  [](const ProcessSummary& a, const ProcessSummary& b) { return a.pid < b.pid; });
+        stream::appendProcessFrame(sentProcesses_, processes_, outbox_, scratch_);
+        sentProcesses_.swap(processes_);
+        sentProcessVersion_ = processVersion;
+    }
+    
+    if (outbox_.empty()) {
+        return true;
+    }
+    if (!sendAll(outbox_)) {
+        return false;
+    }
+    updatesSent_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool FleetAgent::sendAll(const std::string& bytes) {
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        ssize_t sent = send(fd_, bytes.data() + offset, bytes.size() - offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += static_cast<size_t>(sent);
+        bytesSent_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void FleetAgent::disconnect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int fd = fd_.exchange(-1);
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+#endif
+
+} // namespace sysmon
@@ -0,0 +1,330 @@
+#include "FleetAggregator.h"
+#include "TcpSocket.h"
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+using namespace stream;
+
+namespace {
+    constexpr size_t RECEIVE_CHUNK_BYTES = 64 * 1024;
+    constexpr int MAX_EVENTS = 256;
+    
+    // An agent sends a handful of top processes, never megabytes
+    constexpr uint32_t MAX_AGENT_FRAME_BYTES = 1u << 20;
+    
+    uint64_t wallClockMs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+}
+
+FleetAggregator::~FleetAggregator() {
+    stop();
+}
+
+void FleetAggregator::getHosts(std::vector<FleetHost>& out) const {
+    std::lock_guard<std::mutex> lock(hostsMutex_);
+    out.resize(hosts_.size());
+    for (size_t i = 0; i < hosts_.size(); ++i) {
+        const FleetHost& host = hosts_[i];
+        FleetHost& copy = out[i];
+        copy.name = host.name;
+        copy.connections = host.connections;
+        copy.lastUpdateMs = host.lastUpdateMs;
+        copy.updates = host.updates;
+        copy.metrics = host.metrics;
+        copy.topProcesses.clear();
+    }
+}
+
+bool FleetAggregator::getHost(const std::string& name, FleetHost& out) const {
+    std::lock_guard<std::mutex> lock(hostsMutex_);
+    auto it = hostIndex_.find(name);
+    if (it == hostIndex_.end()) {
+        return false;
+    }
+    out = hosts_[it->second];
+    return true;
+}
+
+#ifndef __linux__
+
+bool FleetAggregator::start(const std::string& /*listenAddress*/) {
+    std::cerr << "--fleet is not supported on this platform\n";
+    return false;
+}
+
+void FleetAggregator::stop() {
+}
+
+#else
+
+bool FleetAggregator::start(const std::string& listenAddress) {
+    std::string error;
+    listenFd_ = net::listenTcp(listenAddress, error);
+    if (listenFd_ < 0) {
+        std::cerr << "Cannot listen on " << listenAddress << ": " << error << "\n";
+        return false;
+    }
+    // acceptAgents() drains the backlog until accept4() would block
+    fcntl(listenFd_, F_SETFL, fcntl(listenFd_, F_GETFL) | O_NONBLOCK);
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    
+    epoll_event listenEvent{};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = listenFd_;
+    epoll_event wakeEvent{};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.fd = wakeFd_;
+    if (epollFd_ < 0 || wakeFd_ < 0 ||
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &listenEvent) != 0 ||
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &wakeEvent) != 0) {
+        std::cerr << "Cannot set up epoll for " << listenAddress << "\n";
+        for (int* fd : {&listenFd_, &epollFd_, &wakeFd_}) {
+            if (*fd >= 0) {
+                close(*fd);
+                *fd = -1;
+            }
+        }
+        return false;
+    }
+    
+    receiveBuffer_.resize(RECEIVE_CHUNK_BYTES);
+    running_ = true;
+    loopThread_ = std::thread(&FleetAggregator::eventLoop, this);
+    return true;
+}
+
+void FleetAggregator::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    
+    uint64_t one = 1;
+    if (write(wakeFd_, &one, sizeof(one)) < 0) {
+        // Only fails if the counter is saturated, which still wakes epoll
+    }
+    if (loopThread_.joinable()) {
+        loopThread_.join();
+    }
+    
+    close(listenFd_);
+    close(epollFd_);
+    close(wakeFd_);
+    listenFd_ = epollFd_ = wakeFd_ = -1;
+}
+
+void FleetAggregator::eventLoop() {
+    epoll_event events[MAX_EVENTS];
+    
+    while (running_) {
+        int ready = epoll_wait(epollFd_, events, MAX_EVENTS, waitTimeoutMs(Clock::now()));
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        
+        for (int i = 0; i < ready && running_; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd_) {
+                acceptAgents();
+                continue;
+            }
+            if (fd == wakeFd_) {
+                continue;
+            }
+            // A connection closed earlier in this batch has no entry any more
+            if (static_cast<size_t>(fd) >= connections_.size() || !connections_[fd]) {
+                continue;
+            }
+            Connection& connection = *connections_[fd];
+            if (!readFromAgent(connection)) {
+                closeConnection(connection);
+            }
+        }
+        
+        // One publish per interval, however many frames arrived in it
+        auto now = Clock::now();
+        if (dirty_ && now - lastPublish_ >= PUBLISH_INTERVAL) {
+            dirty_ = false;
+            lastPublish_ = now;
+            notifier_.publish();
+        }
+    }
+    
+    for (auto& connection : connections_) {
+        if (connection) {
+            closeConnection(*connection);
+        }
+    }
+    connections_.clear();
+}
+
+int FleetAggregator::waitTimeoutMs(Clock::time_point now) const {
+    if (!dirty_) {
+        return -1;
+    }
+    auto wait = std::max(lastPublish_ + PUBLISH_INTERVAL - now, Clock::duration::zero());
+    return static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
+}
+
+void FleetAggregator::acceptAgents() {
+    while (true) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+        if (fd < 0) {
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            continue;
+        }
+        
+        if (static_cast<size_t>(fd) >= connections_.size()) {
+            connections_.resize(static_cast<size_t>(fd) + 1);
+        }
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connections_[fd] = std::move(connection);
+        connectedAgents_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool FleetAggregator::readFromAgent(Connection& connection) {
+    while (true) {
+        ssize_t received = recv(connection.fd, receiveBuffer_.data(), receiveBuffer_.size(), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        bytesReceived_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+        
+        // Whole frames are decoded straight from the shared receive buffer;
+        // only a trailing partial frame is kept per connection
+        const char* data = receiveBuffer_.data();
+        size_t size = static_cast<size_t>(received);
+        bool buffered = !connection.inbox.empty();
+        if (buffered) {
+            connection.inbox.append(data, size);
+            data = connection.inbox.data();
+            size = connection.inbox.size();
+        }
+        
+        size_t consumed = 0;
+        while (size - consumed >= FRAME_HEADER_SIZE) {
+            const auto* header = reinterpret_cast<const uint8_t*>(data + consumed);
+            recording::ByteReader reader(header, FRAME_HEADER_SIZE);
+            uint32_t payloadBytes = reader.fixed<uint32_t>();
+            auto kind = static_cast<FrameKind>(reader.fixed<uint8_t>());
+            if (payloadBytes > MAX_AGENT_FRAME_BYTES) {
+                return false;
+            }
+            if (size - consumed - FRAME_HEADER_SIZE < payloadBytes) {
+                break;
+            }
+            if (!handleFrame(connection, kind, header + FRAME_HEADER_SIZE, payloadBytes)) {
+                return false;
+            }
+            consumed += FRAME_HEADER_SIZE + payloadBytes;
+        }
+        
+        if (buffered) {
+            connection.inbox.erase(0, consumed);
+        } else {
+            connection.inbox.assign(data + consumed, size - consumed);
+        }
+        
+        if (static_cast<size_t>(received) < receiveBuffer_.size()) {
+            return true;
+        }
+    }
+}
+
+bool FleetAggregator::handleFrame(Connection& connection, FrameKind kind, const uint8_t* payload, size_t size) {
+    if (kind == FrameKind::AgentHello) {
+        std::string name;
+        if (connection.host != NO_HOST || !readAgentHelloFrame(payload, size, name)) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(hostsMutex_);
+        auto [it, inserted] = hostIndex_.try_emplace(name, hosts_.size());
+        if (inserted) {
+            hosts_.emplace_back();
+            hosts_.back().name = name;
+        }
+        connection.host = it->second;
+        ++hosts_[connection.host].connections;
+        dirty_ = true;
+        return true;
+    }
+    
+    // Anything else needs to know which host it belongs to
+    if (connection.host == NO_HOST) {
+        return false;
+    }
+    
+    switch (kind) {
+        case FrameKind::Metrics: {
+            if (!readMetricsFrame(payload, size, connection.metrics)) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(hostsMutex_);
+            FleetHost& host = hosts_[connection.host];
+            host.metrics = connection.metrics;
+            host.lastUpdateMs = wallClockMs();
+            ++host.updates;
+            break;
+        }
+        case FrameKind::Processes: {
+            if (!readProcessFrame(payload, size, connection.processes, connection.nextProcesses, scratch_)) {
+                return false;
+            }
+            connection.processes.swap(connection.nextProcesses);
+            std::lock_guard<std::mutex> lock(hostsMutex_);
+            hosts_[connection.host].topProcesses = connection.processes;
+            break;
+        }
+        default:
+            // Kinds added by newer agents are skipped
+            return true;
+    }
+    framesReceived_.fetch_add(1, std::memory_order_relaxed);
+    dirty_ = true;
+    return true;
+}
+
+void FleetAggregator::closeConnection(Connection& connection) {
+    int fd = connection.fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    
+    if (connection.host != NO_HOST) {
+        std::lock_guard<std::mutex> lock(hostsMutex_);
+        --hosts_[connection.host].connections;
+        dirty_ = true;
+    }
+    connectedAgents_.fetch_sub(1, std::memory_order_relaxed);
+    connections_[fd].reset();
+}
+
+#endif
+
+} // namespace sysmon
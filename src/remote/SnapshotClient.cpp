@@ -0,0 +1,302 @@
+#include "SnapshotClient.h"
+#include "TcpSocket.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+using namespace stream;
+
+namespace {
+    constexpr size_t RECEIVE_CHUNK_BYTES = 64 * 1024;
+    
+    // Collector threads of a disconnected client back off instead of spinning
+    constexpr auto DISCONNECTED_POLL = std::chrono::milliseconds(100);
+    
+    /**
+     * @brief ISystemCollector that republishes the daemon's metrics
+     *
+     * The CPU call waits for the next frame; the other sources report from
+     * the same frame, so attaching needs all four intervals equal (applyIntervals).
+     */
+    class AttachSystemCollector : public ISystemCollector {
+    public:
+        explicit AttachSystemCollector(std::shared_ptr<SnapshotClient> client)
+            : client_(std::move(client)) {}
+        
+        void collectCPUMetrics(SystemMetrics& metrics) override {
+            client_->nextMetrics(current_);
+            metrics.timestampMs = current_.timestampMs;
+            metrics.cpuUsagePercent = current_.cpuUsagePercent;
+            metrics.perCoreCpuUsage = current_.perCoreCpuUsage;
+        }
+        
+        void collectMemoryMetrics(SystemMetrics& metrics) override {
+            metrics.totalMemoryBytes = current_.totalMemoryBytes;
+            metrics.usedMemoryBytes = current_.usedMemoryBytes;
+            metrics.memoryUsagePercent = current_.memoryUsagePercent;
+        }
+        
+        void collectDiskMetrics(SystemMetrics& metrics) override {
+            metrics.diskReadBytesPerSec = current_.diskReadBytesPerSec;
+            metrics.diskWriteBytesPerSec = current_.diskWriteBytesPerSec;
+        }
+        
+        void collectNetworkMetrics(SystemMetrics& metrics) override {
+            metrics.networkRecvBytesPerSec = current_.networkRecvBytesPerSec;
+            metrics.networkSendBytesPerSec = current_.networkSendBytesPerSec;
+        }
+        
+        bool initialize() override { return client_->connected(); }
+        void shutdown() override {}
+        
+    private:
+        std::shared_ptr<SnapshotClient> client_;
+        SystemMetrics current_;
+    };
+    
+    /**
+     * @brief IProcessCollector that re-enumerates the daemon's process lists
+     */
+    class AttachProcessCollector : public IProcessCollector {
+    public:
+        explicit AttachProcessCollector(std::shared_ptr<SnapshotClient> client)
+            : client_(std::move(client)) {}
+        
+        void enumerateProcesses(ProcessTable& out) override {
+            client_->nextProcesses(current_);
+            out.addAll(current_);
+        }
+        
+        // Same host, so the client signals directly, with its own permissions
+        // rather than the daemon's
+        bool terminateProcess(uint32_t pid) override {
+#ifdef _WIN32
+            (void)pid;
+            return false;
+#else
+            return kill(static_cast<pid_t>(pid), SIGTERM) == 0;
+#endif
+        }
+        
+        bool initialize() override { return client_->connected(); }
+        void shutdown() override {}
+        
+    private:
+        std::shared_ptr<SnapshotClient> client_;
+        std::vector<ProcessSummary> current_;
+    };
+}
+
+SnapshotClient::~SnapshotClient() {
+    close();
+}
+
+void SnapshotClient::applyIntervals(Configuration& config) const {
+    config.cpuSampleIntervalMs = 0;
+    config.memorySampleIntervalMs = 0;
+    config.diskSampleIntervalMs = 0;
+    config.networkSampleIntervalMs = 0;
+    config.processSampleIntervalMs = 0;
+    config.adaptiveSampling = false;
+    config.cpuBudgetPercent = 0.0;
+}
+
+bool SnapshotClient::nextMetrics(SystemMetrics& current) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    frameCv_.wait(lock, [this] { return metricsFrames_ != metricsTaken_ || !connected(); });
+    if (metricsFrames_ == metricsTaken_) {
+        lock.unlock();
+        std::this_thread::sleep_for(DISCONNECTED_POLL);
+        return false;
+    }
+    current = metrics_;
+    metricsTaken_ = metricsFrames_;
+    return true;
+}
+
+bool SnapshotClient::nextProcesses(std::vector<ProcessSummary>& current) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    frameCv_.wait(lock, [this] { return processFrames_ != processesTaken_ || !connected(); });
+    if (processFrames_ == processesTaken_) {
+        lock.unlock();
+        std::this_thread::sleep_for(DISCONNECTED_POLL);
+        return false;
+    }
+    // The next decoded list is copied into the caller's old storage
+    current.swap(processes_);
+    processesTaken_ = processFrames_;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool SnapshotClient::connect(const std::string& /*socketPath*/, uint32_t /*maxUpdateHz*/,
+                             std::function<void()> /*onDisconnect*/) {
+    std::cerr << "--attach is not supported on this platform\n";
+    return false;
+}
+
+void SnapshotClient::close() {
+}
+
+#else
+
+bool SnapshotClient::connect(const std::string& socketPath, uint32_t maxUpdateHz,
+                             std::function<void()> onDisconnect) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid daemon socket path: " << socketPath << "\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ >= 0) {
+        net::setDescriptorFlags(fd_, false);
+    }
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Cannot attach to " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        return false;
+    }
+    
+    std::string hello;
+    appendHello(hello, maxUpdateHz);
+    if (send(fd_, hello.data(), hello.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(hello.size())) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    
+    onDisconnect_ = std::move(onDisconnect);
+    closing_ = false;
+    connected_ = true;
+    receiveThread_ = std::thread(&SnapshotClient::receiveLoop, this);
+    return true;
+}
+
+void SnapshotClient::close() {
+    if (fd_ < 0) {
+        return;
+    }
+    closing_ = true;
+    shutdown(fd_, SHUT_RDWR);
+    if (receiveThread_.joinable()) {
+        receiveThread_.join();
+    }
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void SnapshotClient::receiveLoop() {
+    size_t consumed = 0;
+    while (true) {
+        // Frames are parsed in place; the consumed prefix is dropped once per read
+        if (consumed > 0) {
+            buffer_.erase(0, consumed);
+            consumed = 0;
+        }
+        size_t filled = buffer_.size();
+        buffer_.resize(filled + RECEIVE_CHUNK_BYTES);
+        ssize_t received = recv(fd_, &buffer_[filled], RECEIVE_CHUNK_BYTES, 0);
+        if (received <= 0) {
+            if (received < 0 && errno == EINTR) {
+                buffer_.resize(filled);
+                continue;
+            }
+            break;
+        }
+        buffer_.resize(filled + static_cast<size_t>(received));
+        bytesReceived_.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+        
+        bool valid = true;
+        while (valid && buffer_.size() - consumed >= FRAME_HEADER_SIZE) {
+            const auto* header = reinterpret_cast<const uint8_t*>(buffer_.data() + consumed);
+            recording::ByteReader reader(header, FRAME_HEADER_SIZE);
+            uint32_t payloadBytes = reader.fixed<uint32_t>();
+            auto kind = static_cast<FrameKind>(reader.fixed<uint8_t>());
+            if (payloadBytes > MAX_FRAME_BYTES) {
+                valid = false;
+                break;
+            }
+            if (buffer_.size() - consumed - FRAME_HEADER_SIZE < payloadBytes) {
+                break;
+            }
+            valid = decodeFrame(kind, header + FRAME_HEADER_SIZE, payloadBytes);
+            consumed += FRAME_HEADER_SIZE + payloadBytes;
+        }
+        if (!valid) {
+            std::cerr << "Corrupt frame from the daemon; detaching\n";
+            break;
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connected_ = false;
+    }
+    frameCv_.notify_all();
+    if (!closing_ && onDisconnect_) {
+        onDisconnect_();
+    }
+}
+
+bool SnapshotClient::decodeFrame(FrameKind kind, const uint8_t* payload, size_t size) {
+    switch (kind) {
+        case FrameKind::Metrics: {
+            if (!readMetricsFrame(payload, size, decodedMetrics_)) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                metrics_ = decodedMetrics_;
+                ++metricsFrames_;
+            }
+            break;
+        }
+        case FrameKind::Processes: {
+            if (!readProcessFrame(payload, size, decodedProcesses_, nextProcesses_, scratch_)) {
+                return false;
+            }
+            decodedProcesses_.swap(nextProcesses_);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                processes_ = decodedProcesses_;
+                ++processFrames_;
+            }
+            break;
+        }
+        default:
+            // Kinds added by newer daemons are skipped
+            return true;
+    }
+    framesReceived_.fetch_add(1, std::memory_order_relaxed);
+    frameCv_.notify_all();
+    return true;
+}
+
+#endif
+
+std::unique_ptr<ISystemCollector> createAttachSystemCollector(std::shared_ptr<SnapshotClient> client) {
+    return std::make_unique<AttachSystemCollector>(std::move(client));
+}
+
+std::unique_ptr<IProcessCollector> createAttachProcessCollector(std::shared_ptr<SnapshotClient> client) {
+    return std::make_unique<AttachProcessCollector>(std::move(client));
+}
+
+} // namespace sysmon
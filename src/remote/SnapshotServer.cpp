@@ -0,0 +1,363 @@
+#include "SnapshotServer.h"
+#include "TcpSocket.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace {
+    constexpr size_t RECEIVE_BUFFER_SIZE = 256;
+}
+
+SnapshotServer::SnapshotServer(SystemDataCollector& dataCollector, ProcessTreeBuilder& processBuilder)
+    : dataCollector_(dataCollector), processBuilder_(processBuilder) {
+}
+
+SnapshotServer::~SnapshotServer() {
+    stop();
+}
+
+#ifdef _WIN32
+
+bool SnapshotServer::start(const std::string& /*socketPath*/) {
+    std::cerr << "--daemon is not supported on this platform\n";
+    return false;
+}
+
+void SnapshotServer::stop() {
+}
+
+#else
+
+bool SnapshotServer::start(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid daemon socket path: " << socketPath << "\n";
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    
+    // A socket left behind by a daemon that died is replaced; a live one is not
+    struct stat info;
+    if (lstat(socketPath.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            std::cerr << socketPath << " exists and is not a socket\n";
+            return false;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (live) {
+            std::cerr << "A daemon is already serving " << socketPath << "\n";
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+    
+    // SOCK_CLOEXEC, SOCK_NONBLOCK, pipe2() and accept4() are Linux-only; the flags are set with fcntl()
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0 || !net::setDescriptorFlags(listenFd_, true) ||
+        bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd_, SOMAXCONN) != 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (listenFd_ >= 0) {
+            close(listenFd_);
+            listenFd_ = -1;
+        }
+        return false;
+    }
+    if (pipe(wakePipe_) != 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+        unlink(socketPath.c_str());
+        return false;
+    }
+    net::setDescriptorFlags(wakePipe_[0], true);
+    net::setDescriptorFlags(wakePipe_[1], true);
+    socketPath_ = socketPath;
+    
+    // Collector threads only poke the server; it copies the snapshot itself
+    metricsSubscription_ = dataCollector_.subscribe([this](uint64_t) { wake(); });
+    processSubscription_ = processBuilder_.subscribe([this](uint64_t) { wake(); });
+    
+    running_ = true;
+    serverThread_ = std::thread(&SnapshotServer::serverLoop, this);
+    return true;
+}
+
+void SnapshotServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+    
+    dataCollector_.unsubscribe(metricsSubscription_);
+    processBuilder_.unsubscribe(processSubscription_);
+    metricsSubscription_ = processSubscription_ = 0;
+    
+    wake();
+    if (serverThread_.joinable()) {
+        serverThread_.join();
+    }
+    
+    close(listenFd_);
+    close(wakePipe_[0]);
+    close(wakePipe_[1]);
+    listenFd_ = -1;
+    wakePipe_[0] = wakePipe_[1] = -1;
+    unlink(socketPath_.c_str());
+}
+
+void SnapshotServer::wake() {
+    // A full pipe already guarantees a wake-up
+    char byte = 0;
+    if (write(wakePipe_[1], &byte, 1) < 0) {
+        return;
+    }
+}
+
+void SnapshotServer::serverLoop() {
+    std::vector<pollfd> fds;
+    pullSnapshots();
+    
+    while (running_) {
+        fds.clear();
+        fds.push_back({listenFd_, POLLIN, 0});
+        fds.push_back({wakePipe_[0], POLLIN, 0});
+        for (const auto& client : clients_) {
+            short events = client->outbox.empty() ? POLLIN : POLLIN | POLLOUT;
+            fds.push_back({client->fd, events, 0});
+        }
+        
+        if (poll(fds.data(), fds.size(), pollTimeoutMs(Clock::now())) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (!running_) {
+            break;
+        }
+        
+        if (fds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(wakePipe_[0], drain, sizeof(drain)) > 0) {
+            }
+            pullSnapshots();
+        }
+        
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            Client& client = *clients_[i];
+            short revents = fds[i + 2].revents;
+            bool alive = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                alive = readFromClient(client);
+            }
+            if (alive && (revents & POLLOUT)) {
+                alive = flushClient(client);
+            }
+            if (!alive) {
+                closeClient(client);
+            }
+        }
+        
+        if (fds[0].revents & POLLIN) {
+            acceptClients();
+        }
+        
+        // Clients that are drained, behind and due get the latest snapshot
+        auto now = Clock::now();
+        for (auto& client : clients_) {
+            if (client->fd >= 0 && client->greeted && client->outbox.empty() &&
+                isBehind(*client) && now >= client->nextUpdateAt) {
+                queueUpdate(*client, now);
+                if (!flushClient(*client)) {
+                    closeClient(*client);
+                }
+            }
+        }
+        
+        clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+                                      [](const std::unique_ptr<Client>& client) { return client->fd < 0; }),
+                       clients_.end());
+    }
+    
+    for (auto& client : clients_) {
+        closeClient(*client);
+    }
+    clients_.clear();
+}
+
+void SnapshotServer::acceptClients() {
+    while (true) {
+        int fd = accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            return;
+        }
+        net::setDescriptorFlags(fd, true);
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        clients_.push_back(std::move(client));
+        clientsServed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool SnapshotServer::readFromClient(Client& client) {
+    char buffer[RECEIVE_BUFFER_SIZE];
+    while (true) {
+        ssize_t received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        if (client.greeted) {
+            // Nothing is expected after the hello
+            continue;
+        }
+        
+        size_t needed = stream::HELLO_SIZE - client.hello.size();
+        client.hello.append(buffer, std::min(needed, static_cast<size_t>(received)));
+        if (client.hello.size() < stream::HELLO_SIZE) {
+            continue;
+        }
+        
+        uint32_t maxUpdateHz = 0;
+        if (!stream::parseHello(reinterpret_cast<const uint8_t*>(client.hello.data()), maxUpdateHz)) {
+            return false;
+        }
+        client.greeted = true;
+        client.minInterval = maxUpdateHz > 0
+            ? std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / maxUpdateHz
+            : Clock::duration::zero();
+        client.nextUpdateAt = Clock::now();
+    }
+}
+
+bool SnapshotServer::flushClient(Client& client) {
+    while (client.outboxOffset < client.outbox.size()) {
+        ssize_t sent = send(client.fd, client.outbox.data() + client.outboxOffset,
+                            client.outbox.size() - client.outboxOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client.outboxOffset += static_cast<size_t>(sent);
+        bytesSent_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    }
+    client.outbox.clear();
+    client.outboxOffset = 0;
+    return true;
+}
+
+void SnapshotServer::closeClient(Client& client) {
+    if (client.fd >= 0) {
+        close(client.fd);
+        client.fd = -1;
+    }
+}
+
+void SnapshotServer::pullSnapshots() {
+    uint64_t metricsVersion = dataCollector_.getVersion();
+    uint64_t processVersion = processBuilder_.getVersion();
+    if (metricsVersion == metricsVersion_ && processVersion == processVersion_) {
+        return;
+    }
+    
+    // Clients that never got the snapshot being replaced skip straight to the new one
+    for (const auto& client : clients_) {
+        if (client->fd >= 0 && client->greeted && isBehind(*client)) {
+            updatesCoalesced_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    if (metricsVersion != metricsVersion_) {
+        auto metrics = std::make_shared<SystemMetrics>();
+        dataCollector_.getMetrics(*metrics);
+        metrics_ = std::move(metrics);
+        metricsVersion_ = metricsVersion;
+        metricsFrames_.clear();
+    }
+    if (processVersion != processVersion_) {
+        auto processes = std::make_shared<std::vector<ProcessSummary>>();
+        processBuilder_.getProcessList(*processes);
+        processes_ = std::move(processes);
+        processVersion_ = processVersion;
+        processFrames_.clear();
+    }
+}
+
+bool SnapshotServer::isBehind(const Client& client) const {
+    return (metrics_ && client.sentMetrics != metrics_) || (processes_ && client.sentProcesses != processes_);
+}
+
+void SnapshotServer::queueUpdate(Client& client, Clock::time_point now) {
+    if (metrics_ && client.sentMetrics != metrics_) {
+        client.outbox += metricsFrameFrom(client.sentMetrics.get());
+        client.sentMetrics = metrics_;
+    }
+    if (processes_ && client.sentProcesses != processes_) {
+        client.outbox += processFrameFrom(client.sentProcesses.get());
+        client.sentProcesses = processes_;
+    }
+    client.nextUpdateAt = now + client.minInterval;
+    updatesSent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Cached frames are dropped whenever the latest snapshot changes, and a base
+// snapshot can't be freed and reallocated in between, so bases compare by address
+const std::string& SnapshotServer::metricsFrameFrom(const SystemMetrics* base) {
+    for (const auto& frame : metricsFrames_) {
+        if (frame.base == base) {
+            return frame.bytes;
+        }
+    }
+    static const SystemMetrics NONE;
+    metricsFrames_.push_back({base, {}});
+    stream::appendMetricsFrame(base ? *base : NONE, *metrics_, metricsFrames_.back().bytes);
+    return metricsFrames_.back().bytes;
+}
+
+const std::string& SnapshotServer::processFrameFrom(const std::vector<ProcessSummary>* base) {
+    for (const auto& frame : processFrames_) {
+        if (frame.base == base) {
+            return frame.bytes;
+        }
+    }
+    static const std::vector<ProcessSummary> NONE;
+    processFrames_.push_back({base, {}});
+    stream::appendProcessFrame(base ? *base : NONE, *processes_, processFrames_.back().bytes, scratch_);
+    return processFrames_.back().bytes;
+}
+
+int SnapshotServer::pollTimeoutMs(Clock::time_point now) const {
+    // Only rate-limited clients waiting for their next slot need a timer
+    auto wait = Clock::duration::max();
+    for (const auto& client : clients_) {
+        if (client->greeted && client->outbox.empty() && isBehind(*client)) {
+            wait = std::min(wait, std::max(client->nextUpdateAt - now, Clock::duration::zero()));
+        }
+    }
+    if (wait == Clock::duration::max()) {
+        return -1;
+    }
+    // Round up so the client is due when poll() returns
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+    return static_cast<int>(std::min<int64_t>(ms, 60000));
+}
+
+#endif
+
+} // namespace sysmon
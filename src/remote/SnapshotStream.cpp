@@ -0,0 +1,133 @@
+#include "SnapshotStream.h"
+#include <algorithm>
+
+namespace sysmon {
+
+namespace stream {
+
+using namespace recording;
+
+namespace {
+    // Same counter order as --record system blocks
+    constexpr uint64_t SystemMetrics::* COUNTER_FIELDS[] = {
+        &SystemMetrics::totalMemoryBytes,
+        &SystemMetrics::usedMemoryBytes,
+        &SystemMetrics::diskReadBytesPerSec,
+        &SystemMetrics::diskWriteBytesPerSec,
+        &SystemMetrics::networkRecvBytesPerSec,
+        &SystemMetrics::networkSendBytesPerSec,
+    };
+    
+    size_t beginFrame(std::string& out, FrameKind kind) {
+        size_t offset = out.size();
+        out.append(FRAME_HEADER_SIZE, '\0');
+        out[offset + 4] = static_cast<char>(kind);
+        return offset;
+    }
+    
+    void finishFrame(std::string& out, size_t offset) {
+        auto payloadBytes = static_cast<uint32_t>(out.size() - offset - FRAME_HEADER_SIZE);
+        for (size_t i = 0; i < 4; ++i) {
+            out[offset + i] = static_cast<char>((payloadBytes >> (8 * i)) & 0xFF);
+        }
+    }
+}
+
+void appendHello(std::string& out, uint32_t maxUpdateHz) {
+    putFixed<uint32_t>(out, HELLO_MAGIC);
+    putFixed<uint16_t>(out, PROTOCOL_VERSION);
+    putFixed<uint16_t>(out, 0);
+    putFixed<uint32_t>(out, maxUpdateHz);
+}
+
+bool parseHello(const uint8_t* data, uint32_t& maxUpdateHz) {
+    ByteReader reader(data, HELLO_SIZE);
+    if (reader.fixed<uint32_t>() != HELLO_MAGIC || reader.fixed<uint16_t>() != PROTOCOL_VERSION) {
+        return false;
+    }
+    reader.skip(2);
+    maxUpdateHz = reader.fixed<uint32_t>();
+    return reader.ok();
+}
+
+void appendAgentHelloFrame(std::string& out, const std::string& hostName) {
+    size_t offset = beginFrame(out, FrameKind::AgentHello);
+    putFixed<uint32_t>(out, AGENT_MAGIC);
+    putFixed<uint16_t>(out, PROTOCOL_VERSION);
+    size_t length = std::min(hostName.size(), MAX_HOST_NAME_BYTES);
+    putVarint(out, length);
+    out.append(hostName, 0, length);
+    finishFrame(out, offset);
+}
+
+bool readAgentHelloFrame(const uint8_t* payload, size_t size, std::string& hostName) {
+    ByteReader reader(payload, size);
+    if (reader.fixed<uint32_t>() != AGENT_MAGIC || reader.fixed<uint16_t>() != PROTOCOL_VERSION) {
+        return false;
+    }
+    uint64_t length = reader.varint();
+    if (length == 0 || length > MAX_HOST_NAME_BYTES) {
+        return false;
+    }
+    return reader.bytes(hostName, static_cast<size_t>(length)) && reader.remaining() == 0;
+}
+
+void appendMetricsFrame(const SystemMetrics& previous, const SystemMetrics& current, std::string& out) {
+    size_t offset = beginFrame(out, FrameKind::Metrics);
+    
+    putVarint(out, zigzag(static_cast<int64_t>(current.timestampMs - previous.timestampMs)));
+    putXorDouble(out, previous.cpuUsagePercent, current.cpuUsagePercent);
+    putXorDouble(out, previous.memoryUsagePercent, current.memoryUsagePercent);
+    
+    const auto& cores = current.perCoreCpuUsage;
+    putVarint(out, cores.size());
+    for (size_t core = 0; core < cores.size(); ++core) {
+        double base = core < previous.perCoreCpuUsage.size() ? previous.perCoreCpuUsage[core] : 0.0;
+        putXorDouble(out, base, cores[core]);
+    }
+    for (auto field : COUNTER_FIELDS) {
+        putVarint(out, zigzag(static_cast<int64_t>(current.*field - previous.*field)));
+    }
+    
+    finishFrame(out, offset);
+}
+
+void appendProcessFrame(const std::vector<ProcessSummary>& previous, const std::vector<ProcessSummary>& current,
+                        std::string& out, ProcessDeltaScratch& scratch) {
+    size_t offset = beginFrame(out, FrameKind::Processes);
+    putProcessDelta(previous, current, out, scratch);
+    finishFrame(out, offset);
+}
+
+bool readMetricsFrame(const uint8_t* payload, size_t size, SystemMetrics& metrics) {
+    ByteReader reader(payload, size);
+    
+    metrics.timestampMs += static_cast<uint64_t>(reader.signedVarint());
+    metrics.cpuUsagePercent = reader.xorDouble(metrics.cpuUsagePercent);
+    metrics.memoryUsagePercent = reader.xorDouble(metrics.memoryUsagePercent);
+    
+    // Every core costs at least one byte, which bounds a corrupt count
+    uint64_t cores = reader.varint();
+    if (cores > reader.remaining()) {
+        return false;
+    }
+    metrics.perCoreCpuUsage.resize(static_cast<size_t>(cores), 0.0);
+    for (auto& usage : metrics.perCoreCpuUsage) {
+        usage = reader.xorDouble(usage);
+    }
+    for (auto field : COUNTER_FIELDS) {
+        metrics.*field += static_cast<uint64_t>(reader.signedVarint());
+    }
+    
+    return reader.ok() && reader.remaining() == 0;
+}
+
+bool readProcessFrame(const uint8_t* payload, size_t size, const std::vector<ProcessSummary>& previous,
+                      std::vector<ProcessSummary>& current, ProcessDeltaScratch& scratch) {
+    ByteReader reader(payload, size);
+    return readProcessDelta(reader, previous, current, scratch) && reader.remaining() == 0;
+}
+
+} // namespace stream
+
+} // namespace sysmon
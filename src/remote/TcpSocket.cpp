@@ -0,0 +1,156 @@
+#include "TcpSocket.h"
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace sysmon {
+
+namespace net {
+
+bool splitHostPort(const std::string& address, std::string& host, std::string& port) {
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos || colon + 1 == address.size()) {
+        return false;
+    }
+    host = address.substr(0, colon);
+    port = address.substr(colon + 1);
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        host = host.substr(1, host.size() - 2);
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+bool setDescriptorFlags(int /*fd*/, bool /*nonBlocking*/) {
+    return false;
+}
+
+int listenTcp(const std::string& /*address*/, std::string& error) {
+    error = "not supported on this platform";
+    return -1;
+}
+
+int connectTcp(const std::string& /*address*/, int /*timeoutSec*/, std::string& error) {
+    error = "not supported on this platform";
+    return -1;
+}
+
+#else
+
+bool setDescriptorFlags(int fd, bool nonBlocking) {
+    int descriptorFlags = fcntl(fd, F_GETFD);
+    if (descriptorFlags < 0 || fcntl(fd, F_SETFD, descriptorFlags | FD_CLOEXEC) != 0) {
+        return false;
+    }
+    if (!nonBlocking) {
+        return true;
+    }
+    int statusFlags = fcntl(fd, F_GETFL);
+    return statusFlags >= 0 && fcntl(fd, F_SETFL, statusFlags | O_NONBLOCK) == 0;
+}
+
+namespace {
+    addrinfo* resolve(const std::string& address, bool passive, std::string& error) {
+        std::string host, port;
+        if (!splitHostPort(address, host, port)) {
+            error = "invalid address (expected host:port)";
+            return nullptr;
+        }
+        
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = passive ? AI_PASSIVE : 0;
+        addrinfo* addresses = nullptr;
+        int status = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &addresses);
+        if (status != 0) {
+            error = gai_strerror(status);
+            return nullptr;
+        }
+        return addresses;
+    }
+}
+
+int listenTcp(const std::string& address, std::string& error) {
+    addrinfo* addresses = resolve(address, true, error);
+    if (!addresses) {
+        return -1;
+    }
+    
+    int listenFd = -1;
+    int lastError = 0;
+    for (addrinfo* entry = addresses; entry && listenFd < 0; entry = entry->ai_next) {
+        int fd = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (fd < 0) {
+            lastError = errno;
+            continue;
+        }
+        setDescriptorFlags(fd, false);
+        int reuse = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(fd, entry->ai_addr, entry->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0) {
+            listenFd = fd;
+        } else {
+            lastError = errno;
+            close(fd);
+        }
+    }
+    freeaddrinfo(addresses);
+    
+    if (listenFd < 0) {
+        error = std::strerror(lastError);
+    }
+    return listenFd;
+}
+
+int connectTcp(const std::string& address, int timeoutSec, std::string& error) {
+    addrinfo* addresses = resolve(address, false, error);
+    if (!addresses) {
+        return -1;
+    }
+    
+    timeval timeout{};
+    timeout.tv_sec = timeoutSec;
+    int connectedFd = -1;
+    int lastError = 0;
+    for (addrinfo* entry = addresses; entry && connectedFd < 0; entry = entry->ai_next) {
+        int fd = socket(entry->ai_family, entry->ai_socktype, entry->ai_protocol);
+        if (fd < 0) {
+            lastError = errno;
+            continue;
+        }
+        setDescriptorFlags(fd, false);
+        // Linux bounds connect() by the send timeout too
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd, entry->ai_addr, entry->ai_addrlen) == 0) {
+            int noDelay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            connectedFd = fd;
+        } else {
+            lastError = errno;
+            close(fd);
+        }
+    }
+    freeaddrinfo(addresses);
+    
+    if (connectedFd < 0) {
+        error = std::strerror(lastError);
+    }
+    return connectedFd;
+}
+
+#endif
+
+} // namespace net
+
+} // namespace sysmon
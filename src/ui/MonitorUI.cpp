@@ -1,16 +1,30 @@
 #include "MonitorUI.h"
+#include "Instrumentation.h"
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
+#include <ftxui/screen/screen.hpp>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <thread>
 
 using namespace ftxui;
 
 namespace sysmon {
 
 namespace {
+    // Firing alerts named in the status bar before the rest are only counted
+    constexpr size_t MAX_STATUS_ALERTS = 2;
+    
+    // Columns of the CPU sparkline in each process row
+    constexpr size_t ROW_SPARKLINE_WIDTH = 16;
+    
+    const char* const SPARKLINE_LEVELS[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+    
     std::string formatBytes(uint64_t bytes) {
         const char* units[] = {"B", "KB", "MB", "GB", "TB"};
         int unit = 0;
@@ -32,32 +46,261 @@ namespace {
         return oss.str();
     }
     
+    std::string formatDuration(uint64_t nanos) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(1);
+        if (nanos < 1000) {
+            oss << nanos << "ns";
+        } else if (nanos < 1000000) {
+            oss << nanos / 1e3 << "us";
+        } else if (nanos < 1000000000) {
+            oss << nanos / 1e6 << "ms";
+        } else {
+            oss << nanos / 1e9 << "s";
+        }
+        return oss.str();
+    }
+    
     Color getUsageColor(double percent) {
         if (percent < 60.0) return Color::Green;
         if (percent < 80.0) return Color::Yellow;
         return Color::Red;
     }
+    
+    // The last width samples as bars scaled to their largest (at least floor),
+    // right-aligned so the newest sample is always in the last column
+    std::string sparkline(const std::vector<double>& samples, size_t width, double floor) {
+        size_t shown = std::min(samples.size(), width);
+        double top = floor;
+        for (size_t i = samples.size() - shown; i < samples.size(); ++i) {
+            top = std::max(top, samples[i]);
+        }
+        std::string line(width - shown, ' ');
+        for (size_t i = samples.size() - shown; i < samples.size(); ++i) {
+            auto level = static_cast<size_t>(std::max(samples[i], 0.0) / top * 7.0 + 0.5);
+            line += SPARKLINE_LEVELS[std::min<size_t>(level, 7)];
+        }
+        return line;
+    }
+    
+    std::string formatAge(uint64_t updateMs, uint64_t nowMs) {
+        if (updateMs == 0) {
+            return "-";
+        }
+        uint64_t seconds = nowMs > updateMs ? (nowMs - updateMs) / 1000 : 0;
+        if (seconds < 120) {
+            return std::to_string(seconds) + "s";
+        }
+        if (seconds < 7200) {
+            return std::to_string(seconds / 60) + "m";
+        }
+        return std::to_string(seconds / 3600) + "h";
+    }
 }
 
 MonitorUI::MonitorUI(SystemDataCollector& dataCollector,
                      ProcessTreeBuilder& processBuilder,
-                     const Configuration& config)
+                     const Configuration& config,
+                     const CpuBudgetGovernor* governor,
+                     FleetAggregator* fleet,
+                     AnomalyMonitor* anomalies,
+                     AlertEngine* alerts)
     : dataCollector_(dataCollector),
       processBuilder_(processBuilder),
-      config_(config) {
+      governor_(governor),
+      config_(config),
+      anomalies_(anomalies),
+      alerts_(alerts),
+      processHistory_(config.historyProcesses),
+      fleet_(fleet) {
+    // validate() has checked the key; cpu and memory list the largest first
+    parseProcessSortKey(config_.processSortBy, processSortKey_);
+    processSortDescending_ = processSortKey_ == ProcessSortKey::Cpu || processSortKey_ == ProcessSortKey::Memory;
+    flatProcessList_ = config_.flatProcessList;
+    showGroups_ = parseProcessGrouping(config_.processGroupBy, processGrouping_);
 }
 
 void MonitorUI::run() {
     auto screen = ScreenInteractive::Fullscreen();
-    auto mainLayout = createMainLayout();
+    auto mainLayout = fleet_ ? createFleetLayout() : createMainLayout();
+    
+    auto withKeys = CatchEvent(mainLayout, [&](Event event) {
+        // While a filter is typed, every key belongs to it
+        if (!fleet_ && handleFilterEvent(event)) {
+            return true;
+        }
+        if (event == Event::Character('q')) {
+            screen.Exit();
+            return true;
+        }
+        if (fleet_ && handleFleetEvent(event)) {
+            return true;
+        }
+        if (!fleet_ && handleProcessEvent(event)) {
+            return true;
+        }
+        if (event == Event::Character('r')) {
+            dataCollector_.refresh();
+            processBuilder_.refresh();
+            return true;
+        }
+        return false;
+    });
+    
+    // Redraw only when a collector publishes a new snapshot
+    auto metricsSubscription = dataCollector_.subscribe([this](uint64_t) { requestRedraw(); });
+    auto processSubscription = processBuilder_.subscribe([this](uint64_t) { requestRedraw(); });
+    ChangeNotifier::SubscriptionId fleetSubscription = 0;
+    if (fleet_) {
+        fleetSubscription = fleet_->subscribe([this](uint64_t) { requestRedraw(); });
+    }
+    ChangeNotifier::SubscriptionId anomalySubscription = 0;
+    if (anomalies_) {
+        anomalySubscription = anomalies_->subscribe([this](uint64_t) { requestRedraw(); });
+    }
+    ChangeNotifier::SubscriptionId alertSubscription = 0;
+    if (alerts_) {
+        alertSubscription = alerts_->subscribe([this](uint64_t) { requestRedraw(); });
+    }
+    std::thread redrawThread(&MonitorUI::redrawLoop, this, std::ref(screen));
     
-    screen.Loop(mainLayout);
+    screen.Loop(withKeys);
+    
+    dataCollector_.unsubscribe(metricsSubscription);
+    processBuilder_.unsubscribe(processSubscription);
+    if (fleet_) {
+        fleet_->unsubscribe(fleetSubscription);
+    }
+    if (anomalies_) {
+        anomalies_->unsubscribe(anomalySubscription);
+    }
+    if (alerts_) {
+        alerts_->unsubscribe(alertSubscription);
+    }
+    {
+        std::lock_guard<std::mutex> lock(redrawMutex_);
+        loopExited_ = true;
+    }
+    redrawCv_.notify_all();
+    redrawThread.join();
 }
 
 void MonitorUI::shutdown() {
+    // May be called from a signal handler: only set the flag, redrawLoop() acts on it
     shouldQuit_ = true;
 }
 
+void MonitorUI::renderProcessTree(Screen& screen) {
+    refreshSnapshots();
+    if (!offscreenProcessTree_) {
+        offscreenProcessTree_ = createProcessTreeWidget();
+    }
+    Render(screen, offscreenProcessTree_->Render());
+}
+
+void MonitorUI::refreshSnapshots() {
+    uint64_t metricsVersion = dataCollector_.getVersion();
+    if (metricsVersion != metricsVersion_) {
+        metrics_ = dataCollector_.getMetrics();
+        intervals_ = dataCollector_.getSamplingIntervals();
+        metricsVersion_ = metricsVersion;
+    }
+    
+    if (!processSnapshot_ || processBuilder_.getVersion() != processSnapshot_->version) {
+        processSnapshot_ = processBuilder_.getSnapshot();
+        processHistory_.record(processSnapshot_->table);
+    }
+    
+    if (anomalies_) {
+        uint64_t anomalyVersion = anomalies_->getVersion();
+        if (anomalyVersion != anomalyVersion_) {
+            anomalies_->getActive(activeAnomalies_);
+            anomalyVersion_ = anomalyVersion;
+        }
+    }
+    
+    if (alerts_) {
+        uint64_t alertVersion = alerts_->getVersion();
+        if (alertVersion != alertVersion_) {
+            alerts_->getActive(activeAlerts_);
+            alertVersion_ = alertVersion;
+        }
+    }
+    
+    if (!fleet_) {
+        return;
+    }
+    uint64_t fleetVersion = fleet_->getVersion();
+    if (fleetVersion != fleetVersion_) {
+        fleet_->getHosts(fleetHosts_);
+        fleetSortPending_ = true;
+        if (showHostDetail_ && fleet_->getHost(selectedHost_, hostDetail_)) {
+            std::sort(hostDetail_.topProcesses.begin(), hostDetail_.topProcesses.end(),
+                      [](const ProcessSummary& a, const ProcessSummary& b) { return a.cpuPercent > b.cpuPercent; });
+        }
+        fleetVersion_ = fleetVersion;
+    }
+    if (fleetSortPending_) {
+        sortFleetHosts();
+        fleetSortPending_ = false;
+    }
+}
+
+const SystemMetrics& MonitorUI::displayedMetrics() const {
+    return showHostDetail_ ? hostDetail_.metrics : metrics_;
+}
+
+void MonitorUI::requestRedraw() {
+    {
+        std::lock_guard<std::mutex> lock(redrawMutex_);
+        redrawPending_ = true;
+    }
+    redrawCv_.notify_one();
+}
+
+void MonitorUI::redrawLoop(ScreenInteractive& screen) {
+    using namespace std::chrono;
+    
+    const auto frameInterval = microseconds(1000000 / std::max<uint32_t>(config_.targetFrameRateHz, 1));
+    // shutdown() can't notify the condition variable from a signal handler,
+    // so wake up occasionally to check the flag
+    const auto quitPollInterval = milliseconds(250);
+    auto lastFrame = steady_clock::now() - frameInterval;
+    
+    std::unique_lock<std::mutex> lock(redrawMutex_);
+    while (!loopExited_) {
+        redrawCv_.wait_for(lock, quitPollInterval,
+                           [this] { return redrawPending_ || loopExited_ || shouldQuit_; });
+        
+        if (shouldQuit_ && !loopExited_) {
+            lock.unlock();
+            screen.Exit();
+            lock.lock();
+            redrawCv_.wait(lock, [this] { return loopExited_; });
+            break;
+        }
+        if (!redrawPending_ || loopExited_) {
+            continue;
+        }
+        
+        // Snapshots published within one frame interval coalesce into a single redraw
+        auto nextFrame = lastFrame + frameInterval;
+        if (steady_clock::now() < nextFrame) {
+            redrawCv_.wait_until(lock, nextFrame, [this] { return loopExited_; });
+            if (loopExited_) {
+                break;
+            }
+        }
+        
+        redrawPending_ = false;
+        lastFrame = steady_clock::now();
+        
+        lock.unlock();
+        screen.PostEvent(Event::Custom);
+        lock.lock();
+    }
+}
+
 Component MonitorUI::createMainLayout() {
     auto cpuWidget = createCPUWidget();
     auto memoryWidget = createMemoryWidget();
@@ -65,6 +308,7 @@ Component MonitorUI::createMainLayout() {
     auto networkWidget = createNetworkWidget();
     auto processWidget = createProcessTreeWidget();
     auto statusBar = createStatusBar();
+    auto debugPanel = createDebugPanel();
     
     auto layout = Container::Vertical({
         cpuWidget,
@@ -77,8 +321,10 @@ Component MonitorUI::createMainLayout() {
         statusBar,
     });
     
-    return Renderer(layout, [=] {
-        return vbox({
+    return Renderer(layout, [=, this] {
+        refreshSnapshots();
+        
+        Elements rows = {
             cpuWidget->Render() | border | size(HEIGHT, EQUAL, 8),
             memoryWidget->Render() | border | size(HEIGHT, EQUAL, 5),
             hbox({
@@ -87,15 +333,23 @@ Component MonitorUI::createMainLayout() {
                 networkWidget->Render() | border | flex,
             }) | size(HEIGHT, EQUAL, 5),
             processWidget->Render() | border | flex,
-            separator(),
-            statusBar->Render() | size(HEIGHT, EQUAL, 1),
-        });
+        };
+        
+        if (config_.debugMode) {
+            rows.push_back(debugPanel->Render() | border);
+        }
+        
+        rows.push_back(separator());
+        rows.push_back(statusBar->Render() | size(HEIGHT, EQUAL, 1));
+        
+        return vbox(std::move(rows));
     });
 }
 
 Component MonitorUI::createCPUWidget() {
     return Renderer([&] {
-        auto metrics = dataCollector_.getMetrics();
+        ScopedTimer timer(TraceSource::RenderCPU);
+        const auto& metrics = displayedMetrics();
         
         Elements cores;
         for (size_t i = 0; i < metrics.perCoreCpuUsage.size() && i < 16; ++i) {
@@ -104,7 +358,7 @@ Component MonitorUI::createCPUWidget() {
             
             cores.push_back(vbox({
                 text("Core " + std::to_string(i)),
-                gauge(usage / 100.0) | color,
+                gauge(usage / 100.0) | ftxui::color(color),
                 text(formatPercentage(usage)) | align_right,
             }));
         }
@@ -116,7 +370,7 @@ Component MonitorUI::createCPUWidget() {
                 vbox({
                     text("Overall:"),
                     gauge(metrics.cpuUsagePercent / 100.0) | 
-                        getUsageColor(metrics.cpuUsagePercent),
+                        color(getUsageColor(metrics.cpuUsagePercent)),
                     text(formatPercentage(metrics.cpuUsagePercent)) | bold,
                 }) | size(WIDTH, EQUAL, 20),
                 separator(),
@@ -128,7 +382,8 @@ Component MonitorUI::createCPUWidget() {
 
 Component MonitorUI::createMemoryWidget() {
     return Renderer([&] {
-        auto metrics = dataCollector_.getMetrics();
+        ScopedTimer timer(TraceSource::RenderMemory);
+        const auto& metrics = displayedMetrics();
         
         return vbox({
             text("Memory") | bold,
@@ -139,7 +394,7 @@ Component MonitorUI::createMemoryWidget() {
                 text("Total: " + formatBytes(metrics.totalMemoryBytes)),
                 separator(),
                 gauge(metrics.memoryUsagePercent / 100.0) | 
-                    getUsageColor(metrics.memoryUsagePercent) | flex,
+                    color(getUsageColor(metrics.memoryUsagePercent)) | flex,
                 separator(),
                 text(formatPercentage(metrics.memoryUsagePercent)) | bold,
             }),
@@ -149,7 +404,8 @@ Component MonitorUI::createMemoryWidget() {
 
 Component MonitorUI::createDiskWidget() {
     return Renderer([&] {
-        auto metrics = dataCollector_.getMetrics();
+        ScopedTimer timer(TraceSource::RenderDisk);
+        const auto& metrics = displayedMetrics();
         
         return vbox({
             text("Disk I/O") | bold,
@@ -162,7 +418,8 @@ Component MonitorUI::createDiskWidget() {
 
 Component MonitorUI::createNetworkWidget() {
     return Renderer([&] {
-        auto metrics = dataCollector_.getMetrics();
+        ScopedTimer timer(TraceSource::RenderNetwork);
+        const auto& metrics = displayedMetrics();
         
         return vbox({
             text("Network I/O") | bold,
@@ -175,90 +432,854 @@ Component MonitorUI::createNetworkWidget() {
 
 Component MonitorUI::createProcessTreeWidget() {
     return Renderer([&] {
-        auto processes = processBuilder_.getProcessTree();
+        ScopedTimer timer(TraceSource::RenderProcessTree);
+        if (showGroups_) {
+            return renderProcessGroups();
+        }
+        const ProcessTable& processes = processSnapshot_->table;
+        bool filtering = processFilter_.active();
+        updateShownProcesses();
         
-        Elements processLines;
-        processLines.push_back(hbox({
-            text("PID") | size(WIDTH, EQUAL, 8),
+        // The sorted column is marked with its direction
+        auto heading = [&](const std::string& label, ProcessSortKey key) {
+            return text(key == processSortKey_ ? label + (processSortDescending_ ? " v" : " ^") : label);
+        };
+        bool withHistory = config_.historyProcesses != 0;
+        Elements headings = {
+            heading("PID", ProcessSortKey::Pid) | size(WIDTH, EQUAL, 8),
             separator(),
-            text("CPU%") | size(WIDTH, EQUAL, 8),
+            heading("CPU%", ProcessSortKey::Cpu) | size(WIDTH, EQUAL, 8),
             separator(),
-            text("Memory") | size(WIDTH, EQUAL, 12),
+            heading("Memory", ProcessSortKey::Memory) | size(WIDTH, EQUAL, 12),
             separator(),
-            text("Name") | flex,
-        }) | bold);
-        
-        processLines.push_back(separator());
+        };
+        if (withHistory) {
+            headings.push_back(text("CPU history") | size(WIDTH, EQUAL, ROW_SPARKLINE_WIDTH));
+            headings.push_back(separator());
+        }
+        headings.push_back(heading("Name", ProcessSortKey::Name) | flex);
+        auto header = hbox(std::move(headings)) | bold;
         
-        // Flatten tree for display (limit to avoid overflow)
-        std::function<void(const ProcessInfo&, int, int&)> addProcess;
-        addProcess = [&](const ProcessInfo& proc, int depth, int& count) {
-            if (count >= static_cast<int>(config_.maxProcessDisplay)) return;
-            
+        Elements processLines;
+        auto addLine = [&](ProcessTable::Row row, uint32_t depth, bool selected) {
             std::string indent(depth * 2, ' ');
             
-            processLines.push_back(hbox({
-                text(std::to_string(proc.pid)) | size(WIDTH, EQUAL, 8),
+            Elements cells = {
+                text(std::to_string(processes.pid(row))) | size(WIDTH, EQUAL, 8),
                 separator(),
-                text(formatPercentage(proc.cpuPercent)) | size(WIDTH, EQUAL, 8),
+                text(formatPercentage(processes.cpuPercent(row))) | size(WIDTH, EQUAL, 8),
                 separator(),
-                text(formatBytes(proc.memoryBytes)) | size(WIDTH, EQUAL, 12),
+                text(formatBytes(processes.memoryBytes(row))) | size(WIDTH, EQUAL, 12),
                 separator(),
-                text(indent + proc.name) | flex,
-            }));
-            
-            ++count;
-            
-            if (config_.expandTreeByDefault || depth == 0) {
-                for (const auto& child : proc.children) {
-                    addProcess(*child, depth + 1, count);
-                }
+            };
+            // Drawing a row counts as viewing it, which keeps (or gets) it a history slot
+            if (withHistory) {
+                processHistory_.view(processes, row);
+                processHistory_.history(row, ProcessHistory::Series::Cpu, historySamples_);
+                cells.push_back(text(sparkline(historySamples_, ROW_SPARKLINE_WIDTH, 1.0)) |
+                                size(WIDTH, EQUAL, ROW_SPARKLINE_WIDTH));
+                cells.push_back(separator());
+            }
+            cells.push_back(text(indent.append(processes.name(row))) | flex);
+            auto line = hbox(std::move(cells));
+            // Rows shown only as the ancestors of a match are dimmed
+            if (filtering && filterVisibility_[row] == ProcessFilter::ANCESTOR) {
+                line = line | dim;
             }
+            // focus keeps the selected row scrolled into view
+            processLines.push_back(selected ? line | inverted | focus : line);
         };
         
-        int count = 0;
-        for (const auto& root : processes) {
-            addProcess(*root, 0, count);
+        // Only a window of maxProcessDisplay lines that holds the selection is drawn
+        size_t capacity = std::max<size_t>(config_.maxProcessDisplay, 1);
+        if (selectedLine_ < firstShownLine_) {
+            firstShownLine_ = selectedLine_;
+        } else if (selectedLine_ >= firstShownLine_ + capacity) {
+            firstShownLine_ = selectedLine_ + 1 - capacity;
+        }
+        size_t lastShownLine = std::min(shownRows_.size(), firstShownLine_ + capacity);
+        for (size_t line = firstShownLine_; line < lastShownLine; ++line) {
+            addLine(shownRows_[line], shownDepths_[line], line == selectedLine_);
         }
         
-        return vbox({
-            text("Processes (" + std::to_string(processes.size()) + " roots)") | bold,
+        // Churn since the previous scan, straight from the published delta
+        const ProcessDelta& delta = processSnapshot_->delta;
+        std::string churn;
+        if (delta.baseVersion != 0) {
+            churn = "+" + std::to_string(delta.added.size()) + " spawned  -" + std::to_string(delta.removed.size()) +
+                    " exited  " + std::to_string(delta.reparented.size()) + " reparented";
+        }
+        
+        // Filter line: what is typed, then how many processes match or why it doesn't parse
+        Element filterLine = text("");
+        if (editingFilter_ || filtering) {
+            std::string typed = "Filter: " + filterInput_ + (editingFilter_ ? "_" : "");
+            filterLine = !filterError_.empty()
+                ? hbox({text(typed), text("  " + filterError_) | color(Color::Red)})
+                : hbox({text(typed), text("  " + std::to_string(processFilter_.matchCount()) + " matching") | dim});
+        }
+        
+        std::string title = flatProcessList_ ? "Processes (" + std::to_string(processes.size()) + ")"
+                                             : "Processes (" + std::to_string(processes.rootCount()) + " roots)";
+        Elements panel = {
+            hbox({
+                text(title) | bold,
+                text("  "),
+                filterLine,
+                filler(),
+                text(churn) | dim,
+            }),
             separator(),
-            vbox(processLines),
-        });
+            header,
+            separator(),
+            vbox(std::move(processLines)) | yframe | flex,
+        };
+        if (showProcessDetail_ && !shownRows_.empty()) {
+            panel.push_back(separator());
+            panel.push_back(renderProcessDetail(shownRows_[selectedLine_]));
+        }
+        return vbox(std::move(panel));
     });
 }
 
 Component MonitorUI::createStatusBar() {
     return Renderer([&] {
-        auto metrics = dataCollector_.getMetrics();
+        ScopedTimer timer(TraceSource::RenderStatusBar);
+        const auto& metrics = displayedMetrics();
         
-        // Format current time
+        // Format current time; replay shows the recorded time instead
+        bool replaying = !config_.replayFile.empty();
         auto now = std::chrono::system_clock::now();
+        if (replaying && metrics.timestampMs != 0) {
+            now = std::chrono::system_clock::time_point(std::chrono::milliseconds(metrics.timestampMs));
+        }
         auto time_t = std::chrono::system_clock::to_time_t(now);
         std::tm tm;
+#ifdef _WIN32
         localtime_s(&tm, &time_t);
-        
+#else
+        localtime_r(&time_t, &tm);
+#endif
+
         std::ostringstream timeStr;
-        timeStr << std::put_time(&tm, "%H:%M:%S");
+        if (replaying) {
+            timeStr << "REPLAY ";
+            if (config_.replaySpeed == 0.0) {
+                timeStr << "max ";
+            } else {
+                timeStr << config_.replaySpeed << "x ";
+            }
+            timeStr << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+        } else if (!config_.attachSocket.empty()) {
+            timeStr << "ATTACHED " << std::put_time(&tm, "%H:%M:%S");
+        } else if (fleet_) {
+            size_t online = std::count_if(fleetHosts_.begin(), fleetHosts_.end(),
+                                          [](const FleetHost& host) { return host.online(); });
+            timeStr << "FLEET " << online << "/" << fleetHosts_.size() << " online "
+                    << std::put_time(&tm, "%H:%M:%S");
+        } else {
+            timeStr << std::put_time(&tm, "%H:%M:%S");
+        }
         
-        // Check for alerts
+        // Alert rules are evaluated on the collector threads; only the firing set is shown
         std::string alerts;
-        if (metrics.cpuUsagePercent > config_.cpuAlertThreshold) {
-            alerts += " [CPU ALERT] ";
+        if (!fleet_) {
+            for (size_t i = 0; i < activeAlerts_.size() && i < MAX_STATUS_ALERTS; ++i) {
+                const ActiveAlert& alert = activeAlerts_[i];
+                alerts += " [" + alert.rule + " ALERT" + (alert.instance.empty() ? "" : " " + alert.instance) + "] ";
+            }
+            if (activeAlerts_.size() > MAX_STATUS_ALERTS) {
+                alerts += "(+" + std::to_string(activeAlerts_.size() - MAX_STATUS_ALERTS) + " more) ";
+            }
+        }
+        
+        // Anomalies describe this host, so the fleet table leaves them out
+        if (!activeAnomalies_.empty() && !fleet_) {
+            const Anomaly& worst = activeAnomalies_.front();
+            std::ostringstream anomaly;
+            anomaly << std::fixed << std::setprecision(1) << std::showpos
+                    << " [ANOMALY " << (worst.process.empty() ? worst.series : worst.process + " " + worst.series)
+                    << " z=" << worst.zScore << std::noshowpos;
+            if (activeAnomalies_.size() > 1) {
+                anomaly << " (+" << activeAnomalies_.size() - 1 << " more)";
+            }
+            anomaly << "] ";
+            alerts += anomaly.str();
         }
-        if (metrics.memoryUsagePercent > config_.memoryAlertThreshold) {
-            alerts += " [MEMORY ALERT] ";
+        
+        // Effective sampling intervals (adaptive sampling moves these at runtime)
+        std::ostringstream sampling;
+        sampling << std::fixed << std::setprecision(1)
+                 << "cpu " << intervals_.cpuMs / 1000.0 << "s"
+                 << " mem " << intervals_.memoryMs / 1000.0 << "s"
+                 << " disk " << intervals_.diskMs / 1000.0 << "s"
+                 << " net " << intervals_.networkMs / 1000.0 << "s";
+        
+        // Fidelity the CPU budget governor is currently giving up
+        std::string degraded;
+        if (governor_ && governor_->degraded()) {
+            std::ostringstream status;
+            status << std::fixed << std::setprecision(2)
+                   << " [DEGRADED: " << governor_->description()
+                   << ", self " << governor_->selfCpuPercent() << "%] ";
+            degraded = status.str();
         }
         
         return hbox({
             text(timeStr.str()),
             separator(),
+            text(sampling.str()) | dim,
+            separator(),
+            text(degraded) | color(Color::Yellow),
             text(alerts) | color(Color::Red) | bold,
             filler(),
-            text("q:Quit r:Refresh Tab:Navigate") | dim,
+            text(!fleet_ ? "q:Quit r:Refresh /:Filter c/m/n/p:Sort t:Tree g:Group Enter:Details"
+                 : showHostDetail_ ? "q:Quit Esc:Back"
+                 : "q:Quit Enter:Details c/m/d/n/h:Sort") | dim,
+        });
+    });
+}
+
+Component MonitorUI::createDebugPanel() {
+    return Renderer([&] {
+        auto cell = [](const std::string& value, int width) {
+            return text(value) | align_right | size(WIDTH, EQUAL, width);
+        };
+        
+        Elements rows;
+        rows.push_back(hbox({
+            text("Source") | flex,
+            cell("Count", 10),
+            cell("p50", 10),
+            cell("p99", 10),
+            cell("Max", 10),
+        }) | bold);
+        
+        const auto& instrumentation = Instrumentation::instance();
+        for (size_t i = 0; i < static_cast<size_t>(TraceSource::Count); ++i) {
+            auto source = static_cast<TraceSource>(i);
+            const auto& histogram = instrumentation.histogram(source);
+            
+            rows.push_back(hbox({
+                text(traceSourceName(source)) | flex,
+                cell(std::to_string(histogram.count()), 10),
+                cell(formatDuration(histogram.percentile(0.50)), 10),
+                cell(formatDuration(histogram.percentile(0.99)), 10),
+                cell(formatDuration(histogram.max()), 10),
+            }));
+        }
+        
+        return vbox({
+            text("Self-Instrumentation") | bold,
+            separator(),
+            vbox(std::move(rows)),
         });
     });
 }
 
+Component MonitorUI::createFleetLayout() {
+    auto cpuWidget = createCPUWidget();
+    auto memoryWidget = createMemoryWidget();
+    auto diskWidget = createDiskWidget();
+    auto networkWidget = createNetworkWidget();
+    auto fleetTable = createFleetTableWidget();
+    auto hostProcesses = createHostProcessWidget();
+    auto statusBar = createStatusBar();
+    auto debugPanel = createDebugPanel();
+    
+    return Renderer([=, this] {
+        refreshSnapshots();
+        
+        Elements rows;
+        if (showHostDetail_) {
+            // The local view's widgets, fed the host's metrics by displayedMetrics()
+            std::string title = "Host " + hostDetail_.name;
+            if (!hostDetail_.online()) {
+                title += " (offline)";
+            }
+            rows = {
+                text(title) | bold,
+                cpuWidget->Render() | border | size(HEIGHT, EQUAL, 8),
+                memoryWidget->Render() | border | size(HEIGHT, EQUAL, 5),
+                hbox({
+                    diskWidget->Render() | border | flex,
+                    separator(),
+                    networkWidget->Render() | border | flex,
+                }) | size(HEIGHT, EQUAL, 5),
+                hostProcesses->Render() | border | flex,
+            };
+        } else {
+            rows = {fleetTable->Render() | border | flex};
+        }
+        
+        if (config_.debugMode) {
+            rows.push_back(debugPanel->Render() | border);
+        }
+        
+        rows.push_back(separator());
+        rows.push_back(statusBar->Render() | size(HEIGHT, EQUAL, 1));
+        
+        return vbox(std::move(rows));
+    });
+}
+
+Component MonitorUI::createFleetTableWidget() {
+    return Renderer([&] {
+        ScopedTimer timer(TraceSource::RenderFleet);
+        
+        auto heading = [&](const std::string& label, FleetSortKey key, int width) {
+            std::string marked = label;
+            if (key == fleetSortKey_) {
+                marked += fleetSortDescending_ ? " v" : " ^";
+            }
+            return text(marked) | size(WIDTH, EQUAL, width);
+        };
+        
+        Elements rows;
+        rows.push_back(hbox({
+            heading("Host", FleetSortKey::Name, 24) | flex,
+            separator(),
+            text("Age") | size(WIDTH, EQUAL, 5),
+            separator(),
+            heading("CPU%", FleetSortKey::Cpu, 8),
+            separator(),
+            heading("Mem%", FleetSortKey::Memory, 8),
+            separator(),
+            text("Memory") | size(WIDTH, EQUAL, 22),
+            separator(),
+            heading("Disk/s", FleetSortKey::Disk, 12),
+            separator(),
+            heading("Net/s", FleetSortKey::Network, 12),
+            separator(),
+            text("Cores") | size(WIDTH, EQUAL, 5),
+        }) | bold);
+        rows.push_back(separator());
+        
+        uint64_t nowMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        
+        Elements hostRows;
+        for (const auto& host : fleetHosts_) {
+            const auto& metrics = host.metrics;
+            auto row = hbox({
+                text(host.name) | size(WIDTH, EQUAL, 24) | flex,
+                separator(),
+                text(host.online() ? formatAge(host.lastUpdateMs, nowMs) : "down") | size(WIDTH, EQUAL, 5),
+                separator(),
+                text(formatPercentage(metrics.cpuUsagePercent)) | color(getUsageColor(metrics.cpuUsagePercent)) |
+                    size(WIDTH, EQUAL, 8),
+                separator(),
+                text(formatPercentage(metrics.memoryUsagePercent)) |
+                    color(getUsageColor(metrics.memoryUsagePercent)) | size(WIDTH, EQUAL, 8),
+                separator(),
+                text(formatBytes(metrics.usedMemoryBytes) + " / " + formatBytes(metrics.totalMemoryBytes)) |
+                    size(WIDTH, EQUAL, 22),
+                separator(),
+                text(formatBytes(metrics.diskReadBytesPerSec + metrics.diskWriteBytesPerSec)) |
+                    size(WIDTH, EQUAL, 12),
+                separator(),
+                text(formatBytes(metrics.networkRecvBytesPerSec + metrics.networkSendBytesPerSec)) |
+                    size(WIDTH, EQUAL, 12),
+                separator(),
+                text(std::to_string(metrics.perCoreCpuUsage.size())) | size(WIDTH, EQUAL, 5),
+            });
+            if (!host.online()) {
+                row = row | dim;
+            }
+            // focus keeps the selected row scrolled into view
+            if (host.name == selectedHost_) {
+                row = row | inverted | focus;
+            }
+            hostRows.push_back(row);
+        }
+        
+        if (hostRows.empty()) {
+            hostRows.push_back(text("Waiting for agents on " + config_.fleetListen + "...") | dim);
+        }
+        
+        return vbox({
+            text("Fleet (" + std::to_string(fleetHosts_.size()) + " hosts)") | bold,
+            separator(),
+            vbox(std::move(rows)),
+            vbox(std::move(hostRows)) | yframe | flex,
+        });
+    });
+}
+
+Component MonitorUI::createHostProcessWidget() {
+    return Renderer([&] {
+        ScopedTimer timer(TraceSource::RenderProcessTree);
+        
+        Elements lines;
+        lines.push_back(hbox({
+            text("PID") | size(WIDTH, EQUAL, 8),
+            separator(),
+            text("CPU%") | size(WIDTH, EQUAL, 8),
+            separator(),
+            text("Memory") | size(WIDTH, EQUAL, 12),
+            separator(),
+            text("Name") | flex,
+        }) | bold);
+        lines.push_back(separator());
+        
+        for (const auto& proc : hostDetail_.topProcesses) {
+            lines.push_back(hbox({
+                text(std::to_string(proc.pid)) | size(WIDTH, EQUAL, 8),
+                separator(),
+                text(formatPercentage(proc.cpuPercent)) | size(WIDTH, EQUAL, 8),
+                separator(),
+                text(formatBytes(proc.memoryBytes)) | size(WIDTH, EQUAL, 12),
+                separator(),
+                text(proc.name) | flex,
+            }));
+        }
+        
+        return vbox({
+            text("Top processes by CPU") | bold,
+            separator(),
+            vbox(std::move(lines)),
+        });
+    });
+}
+
+bool MonitorUI::handleFilterEvent(const Event& event) {
+    if (!editingFilter_) {
+        if (event == Event::Character('/')) {
+            editingFilter_ = true;
+            return true;
+        }
+        if (event == Event::Escape && !filterInput_.empty()) {
+            filterInput_.clear();
+            updateFilter();
+            return true;
+        }
+        return false;
+    }
+    
+    // Enter keeps the filter and returns the keys; Esc drops it
+    if (event == Event::Return) {
+        editingFilter_ = false;
+    } else if (event == Event::Escape) {
+        editingFilter_ = false;
+        filterInput_.clear();
+        updateFilter();
+    } else if (event == Event::Backspace) {
+        if (!filterInput_.empty()) {
+            filterInput_.pop_back();
+            updateFilter();
+        }
+    } else if (event.is_character()) {
+        filterInput_ += event.character();
+        updateFilter();
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void MonitorUI::updateFilter() {
+    std::string error;
+    filterError_ = processFilter_.setQuery(filterInput_, error) ? "" : error;
+    filterStale_ = true;
+}
+
+void MonitorUI::updateShownProcesses() {
+    const ProcessTable& processes = processSnapshot_->table;
+    uint64_t version = processSnapshot_->version;
+    
+    bool filtering = processFilter_.active();
+    bool refiltered = filterStale_ || (filtering && filteredVersion_ != version);
+    if (filtering && refiltered) {
+        processFilter_.apply(processes, processSnapshot_->names, filterVisibility_);
+        filteredVersion_ = version;
+    }
+    filterStale_ = false;
+    
+    // Re-sorted once per scan, starting from the last order
+    bool reordered = orderStale_ || orderedVersion_ != version;
+    if (reordered) {
+        processOrder_.update(processes, processSortKey_, processSortDescending_, !flatProcessList_);
+        orderedVersion_ = version;
+        orderStale_ = false;
+    }
+    if (!reordered && !refiltered) {
+        return;
+    }
+    
+    auto rows = processOrder_.rows();
+    auto depths = processOrder_.depths();
+    shownRows_.clear();
+    shownDepths_.clear();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (filtering) {
+            // The flat list shows matches only; the tree keeps their ancestors
+            auto visibility = filterVisibility_[rows[i]];
+            if (visibility == ProcessFilter::HIDDEN || (flatProcessList_ && visibility == ProcessFilter::ANCESTOR)) {
+                continue;
+            }
+        } else if (!flatProcessList_ && !config_.expandTreeByDefault && depths[i] > 1) {
+            continue;
+        }
+        shownRows_.push_back(rows[i]);
+        shownDepths_.push_back(depths[i]);
+    }
+    
+    // Follow the selected process to its new line; if it is gone, stay on the same line
+    for (size_t line = 0; line < shownRows_.size(); ++line) {
+        ProcessTable::Row row = shownRows_[line];
+        if (processes.pid(row) == selectedPid_ && processes.creationTime(row) == selectedStart_) {
+            selectedLine_ = line;
+            break;
+        }
+    }
+    if (shownRows_.empty()) {
+        selectedLine_ = 0;
+        return;
+    }
+    selectedLine_ = std::min(selectedLine_, shownRows_.size() - 1);
+    selectedPid_ = processes.pid(shownRows_[selectedLine_]);
+    selectedStart_ = processes.creationTime(shownRows_[selectedLine_]);
+}
+
+void MonitorUI::updateShownGroups() {
+    uint64_t version = processSnapshot_->version;
+    if (!groupsStale_ && groupedVersion_ == version) {
+        return;
+    }
+    groupedVersion_ = version;
+    groupsStale_ = false;
+    
+    // A few thousand groups at most, so a full sort per scan is cheap
+    const auto& groups = processSnapshot_->groups.of(processGrouping_);
+    shownGroups_.resize(groups.size());
+    for (uint32_t i = 0; i < shownGroups_.size(); ++i) {
+        shownGroups_[i] = i;
+    }
+    std::sort(shownGroups_.begin(), shownGroups_.end(), [&](uint32_t a, uint32_t b) {
+        const ProcessGroup& left = processSortDescending_ ? groups[b] : groups[a];
+        const ProcessGroup& right = processSortDescending_ ? groups[a] : groups[b];
+        switch (processSortKey_) {
+            case ProcessSortKey::Cpu:
+                if (left.cpuPercent != right.cpuPercent) {
+                    return left.cpuPercent < right.cpuPercent;
+                }
+                break;
+            case ProcessSortKey::Memory:
+                if (left.memoryBytes != right.memoryBytes) {
+                    return left.memoryBytes < right.memoryBytes;
+                }
+                break;
+            case ProcessSortKey::Pid:
+                // Groups have no pid; p orders them by process count instead
+                if (left.processCount != right.processCount) {
+                    return left.processCount < right.processCount;
+                }
+                break;
+            case ProcessSortKey::Name:
+                return left.key < right.key;
+        }
+        // Ties on a numeric key stay in ascending key order whichever the direction
+        return groups[a].key < groups[b].key;
+    });
+    
+    // Follow the selected group to its new line; if it is gone, stay on the same line
+    auto selected = std::find_if(shownGroups_.begin(), shownGroups_.end(),
+                                 [&](uint32_t group) { return groups[group].key == selectedGroupKey_; });
+    if (selected != shownGroups_.end()) {
+        selectedGroupLine_ = static_cast<size_t>(selected - shownGroups_.begin());
+    }
+    if (shownGroups_.empty()) {
+        selectedGroupLine_ = 0;
+        return;
+    }
+    selectedGroupLine_ = std::min(selectedGroupLine_, shownGroups_.size() - 1);
+    selectedGroupKey_ = groups[shownGroups_[selectedGroupLine_]].key;
+}
+
+Element MonitorUI::renderProcessGroups() {
+    updateShownGroups();
+    const auto& groups = processSnapshot_->groups.of(processGrouping_);
+    
+    auto heading = [&](const std::string& label, ProcessSortKey key) {
+        return text(key == processSortKey_ ? label + (processSortDescending_ ? " v" : " ^") : label);
+    };
+    static const char* const KEY_HEADINGS[] = {"Executable", "User", "Cgroup"};
+    auto header = hbox({
+        heading("Procs", ProcessSortKey::Pid) | size(WIDTH, EQUAL, 8),
+        separator(),
+        heading("CPU%", ProcessSortKey::Cpu) | size(WIDTH, EQUAL, 8),
+        separator(),
+        heading("Memory", ProcessSortKey::Memory) | size(WIDTH, EQUAL, 12),
+        separator(),
+        heading(KEY_HEADINGS[static_cast<size_t>(processGrouping_)], ProcessSortKey::Name) | flex,
+    }) | bold;
+    
+    // The same window as the process list: maxProcessDisplay lines holding the selection
+    size_t capacity = std::max<size_t>(config_.maxProcessDisplay, 1);
+    if (selectedGroupLine_ < firstShownGroupLine_) {
+        firstShownGroupLine_ = selectedGroupLine_;
+    } else if (selectedGroupLine_ >= firstShownGroupLine_ + capacity) {
+        firstShownGroupLine_ = selectedGroupLine_ + 1 - capacity;
+    }
+    Elements groupLines;
+    size_t lastShownLine = std::min(shownGroups_.size(), firstShownGroupLine_ + capacity);
+    for (size_t line = firstShownGroupLine_; line < lastShownLine; ++line) {
+        const ProcessGroup& group = groups[shownGroups_[line]];
+        auto row = hbox({
+            text(std::to_string(group.processCount)) | size(WIDTH, EQUAL, 8),
+            separator(),
+            text(formatPercentage(group.cpuPercent)) | size(WIDTH, EQUAL, 8),
+            separator(),
+            text(formatBytes(group.memoryBytes)) | size(WIDTH, EQUAL, 12),
+            separator(),
+            text(group.key) | flex,
+        });
+        groupLines.push_back(line == selectedGroupLine_ ? row | inverted | focus : row);
+    }
+    
+    std::string title = std::string("Processes by ") + processGroupingName(processGrouping_) + " (" +
+                        std::to_string(groups.size()) + " groups)";
+    return vbox({
+        hbox({
+            text(title) | bold,
+            filler(),
+            text("g: next grouping") | dim,
+        }),
+        separator(),
+        header,
+        separator(),
+        vbox(std::move(groupLines)) | yframe | flex,
+    });
+}
+
+Element MonitorUI::renderProcessDetail(ProcessTable::Row row) {
+    const ProcessTable& processes = processSnapshot_->table;
+    processHistory_.view(processes, row);
+    
+    std::string title = std::string(processes.name(row)) + "  pid " + std::to_string(processes.pid(row)) +
+                        "  parent " + std::to_string(processes.parentPid(row)) + "  state " +
+                        std::string(1, processes.state(row));
+    if (processes.uid(row) != ProcessTable::UNKNOWN_UID) {
+        title += "  uid " + std::to_string(processes.uid(row));
+    }
+    
+    // One line per series: the whole ring as a sparkline, then its summary
+    auto seriesLine = [&](const std::string& label, ProcessHistory::Series series,
+                          std::string (*format)(double)) {
+        if (!processHistory_.history(row, series, historySamples_) || historySamples_.empty()) {
+            return hbox({text(label) | size(WIDTH, EQUAL, 10), text("no history yet") | dim});
+        }
+        double latest = historySamples_.back();
+        double peak = *std::max_element(historySamples_.begin(), historySamples_.end());
+        double sum = 0.0;
+        for (double sample : historySamples_) {
+            sum += sample;
+        }
+        double mean = sum / static_cast<double>(historySamples_.size());
+        return hbox({
+            text(label) | size(WIDTH, EQUAL, 10),
+            text(sparkline(historySamples_, ProcessHistory::SAMPLES, 1.0)),
+            text("  now " + format(latest) + "  avg " + format(mean) + "  max " + format(peak)) | dim,
+        });
+    };
+    auto bytes = [](double value) { return formatBytes(static_cast<uint64_t>(value)); };
+    
+    return vbox({
+        text(title) | bold,
+        seriesLine("CPU", ProcessHistory::Series::Cpu, formatPercentage),
+        seriesLine("Memory", ProcessHistory::Series::Memory, bytes),
+        seriesLine("I/O wait", ProcessHistory::Series::IoWait, formatPercentage),
+    });
+}
+
+bool MonitorUI::handleProcessEvent(const Event& event) {
+    static const std::pair<char, ProcessSortKey> SORT_KEYS[] = {
+        {'c', ProcessSortKey::Cpu},
+        {'m', ProcessSortKey::Memory},
+        {'n', ProcessSortKey::Name},
+        {'p', ProcessSortKey::Pid},
+    };
+    for (const auto& [key, sortKey] : SORT_KEYS) {
+        if (event == Event::Character(key)) {
+            // Pressing the active key again flips the direction; names and pids sort up first
+            if (sortKey == processSortKey_) {
+                processSortDescending_ = !processSortDescending_;
+            } else {
+                processSortKey_ = sortKey;
+                processSortDescending_ = sortKey == ProcessSortKey::Cpu || sortKey == ProcessSortKey::Memory;
+            }
+            orderStale_ = true;
+            groupsStale_ = true;
+            return true;
+        }
+    }
+    // g cycles the grouped view: executable, user, cgroup, then back to the processes
+    if (event == Event::Character('g')) {
+        if (!showGroups_) {
+            showGroups_ = true;
+            processGrouping_ = ProcessGrouping::Executable;
+        } else if (processGrouping_ == ProcessGrouping::Cgroup) {
+            showGroups_ = false;
+        } else {
+            processGrouping_ = static_cast<ProcessGrouping>(static_cast<size_t>(processGrouping_) + 1);
+        }
+        groupsStale_ = true;
+        selectedGroupLine_ = 0;
+        selectedGroupKey_.clear();
+        return true;
+    }
+    if (event == Event::Character('t')) {
+        flatProcessList_ = !flatProcessList_;
+        orderStale_ = true;
+        return true;
+    }
+    if (event == Event::Return) {
+        showProcessDetail_ = !showProcessDetail_;
+        return true;
+    }
+    
+    if (showGroups_) {
+        updateShownGroups();
+    }
+    size_t lines = showGroups_ ? shownGroups_.size() : shownRows_.size();
+    if (lines == 0) {
+        return false;
+    }
+    
+    size_t line = showGroups_ ? selectedGroupLine_ : selectedLine_;
+    size_t last = lines - 1;
+    constexpr size_t PAGE_ROWS = 20;
+    
+    if (event == Event::ArrowUp) {
+        line = line > 0 ? line - 1 : 0;
+    } else if (event == Event::ArrowDown) {
+        line = std::min(line + 1, last);
+    } else if (event == Event::PageUp) {
+        line = line > PAGE_ROWS ? line - PAGE_ROWS : 0;
+    } else if (event == Event::PageDown) {
+        line = std::min(line + PAGE_ROWS, last);
+    } else if (event == Event::Home) {
+        line = 0;
+    } else if (event == Event::End) {
+        line = last;
+    } else {
+        return false;
+    }
+    
+    if (showGroups_) {
+        selectedGroupLine_ = line;
+        selectedGroupKey_ = processSnapshot_->groups.of(processGrouping_)[shownGroups_[line]].key;
+        return true;
+    }
+    const ProcessTable& processes = processSnapshot_->table;
+    selectedLine_ = line;
+    selectedPid_ = processes.pid(shownRows_[line]);
+    selectedStart_ = processes.creationTime(shownRows_[line]);
+    return true;
+}
+
+bool MonitorUI::handleFleetEvent(const Event& event) {
+    if (showHostDetail_) {
+        if (event == Event::Escape || event == Event::Backspace) {
+            showHostDetail_ = false;
+            return true;
+        }
+        return false;
+    }
+    
+    static const std::pair<char, FleetSortKey> SORT_KEYS[] = {
+        {'h', FleetSortKey::Name},
+        {'c', FleetSortKey::Cpu},
+        {'m', FleetSortKey::Memory},
+        {'d', FleetSortKey::Disk},
+        {'n', FleetSortKey::Network},
+    };
+    for (const auto& [key, sortKey] : SORT_KEYS) {
+        if (event == Event::Character(key)) {
+            // Pressing the active key again flips the direction; names sort A-Z first
+            if (sortKey == fleetSortKey_) {
+                fleetSortDescending_ = !fleetSortDescending_;
+            } else {
+                fleetSortKey_ = sortKey;
+                fleetSortDescending_ = sortKey != FleetSortKey::Name;
+            }
+            fleetSortPending_ = true;
+            return true;
+        }
+    }
+    
+    if (fleetHosts_.empty()) {
+        return false;
+    }
+    
+    auto selected = std::find_if(fleetHosts_.begin(), fleetHosts_.end(),
+                                 [&](const FleetHost& host) { return host.name == selectedHost_; });
+    int index = selected == fleetHosts_.end() ? 0 : static_cast<int>(selected - fleetHosts_.begin());
+    int last = static_cast<int>(fleetHosts_.size()) - 1;
+    constexpr int PAGE_ROWS = 20;
+    
+    if (event == Event::ArrowUp) {
+        index = std::max(index - 1, 0);
+    } else if (event == Event::ArrowDown) {
+        index = std::min(index + 1, last);
+    } else if (event == Event::PageUp) {
+        index = std::max(index - PAGE_ROWS, 0);
+    } else if (event == Event::PageDown) {
+        index = std::min(index + PAGE_ROWS, last);
+    } else if (event == Event::Home) {
+        index = 0;
+    } else if (event == Event::End) {
+        index = last;
+    } else if (event == Event::Return) {
+        selectedHost_ = fleetHosts_[index].name;
+        showHostDetail_ = fleet_->getHost(selectedHost_, hostDetail_);
+        std::sort(hostDetail_.topProcesses.begin(), hostDetail_.topProcesses.end(),
+                  [](const ProcessSummary& a, const ProcessSummary& b) { return a.cpuPercent > b.cpuPercent; });
+        return true;
+    } else {
+        return false;
+    }
+    
+    selectedHost_ = fleetHosts_[index].name;
+    return true;
+}
+
+void MonitorUI::sortFleetHosts() {
+    auto value = [this](const FleetHost& host) -> double {
+        const auto& m = host.metrics;
+        switch (fleetSortKey_) {
+            case FleetSortKey::Cpu:
+                return m.cpuUsagePercent;
+            case FleetSortKey::Memory:
+                return m.memoryUsagePercent;
+            case FleetSortKey::Disk:
+                return static_cast<double>(m.diskReadBytesPerSec + m.diskWriteBytesPerSec);
+            case FleetSortKey::Network:
+                return static_cast<double>(m.networkRecvBytesPerSec + m.networkSendBytesPerSec);
+            case FleetSortKey::Name:
+                break;
+        }
+        return 0.0;
+    };
+    
+    // Ties (and the name column) fall back to the name so rows don't jitter
+    bool descending = fleetSortDescending_;
+    bool byName = fleetSortKey_ == FleetSortKey::Name;
+    std::sort(fleetHosts_.begin(), fleetHosts_.end(), [&](const FleetHost& a, const FleetHost& b) {
+        if (!byName) {
+            double va = value(a);
+            double vb = value(b);
+            if (va != vb) {
+                return descending ? va > vb : va < vb;
+            }
+            return a.name < b.name;
+        }
+        return descending ? a.name > b.name : a.name < b.name;
+    });
+    
+    if (selectedHost_.empty() && !fleetHosts_.empty()) {
+        selectedHost_ = fleetHosts_.front().name;
+    }
+}
+
 } // namespace sysmon